@@ -14,8 +14,11 @@
 #define ABCG_HPP_
 
 #include "abcgApplication.hpp"
+#include "abcgEntityPool.hpp"
 #include "abcgException.hpp"
 #include "abcgExternal.hpp"
+#include "abcgMeshLOD.hpp"
+#include "abcgSpatialHash.hpp"
 #include "abcgTrackball.hpp"
 #include "abcgUtil.hpp"
 #include "abcgWindow.hpp"
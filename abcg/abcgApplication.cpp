@@ -12,6 +12,7 @@
 
 #include <SDL_image.h>
 
+#include <filesystem>
 #include <span>
 
 #include "abcgException.hpp"
@@ -21,12 +22,6 @@
 #include "abcgOpenGLExternal.hpp"
 #endif
 
-// @cond Skipped by Doxygen
-#define TINYOBJLOADER_IMPLEMENTATION
-// @endcond
-
-#include "tiny_obj_loader.h"
-
 #if defined(__EMSCRIPTEN__)
 void abcg::mainLoopCallback(void *userData) {
   abcg::Application &app{*(static_cast<abcg::Application *>(userData))};
@@ -61,6 +56,11 @@ abcg::Application::Application([[maybe_unused]] int argc, char **argv) {
 #endif
 
   abcg::Application::m_assetsPath = abcg::Application::m_basePath + "/assets/";
+
+  std::error_code errorCode;
+  auto const executablePath{std::filesystem::absolute(argv_str, errorCode)};
+  abcg::Application::m_executablePath =
+      errorCode ? argv_str : executablePath.string();
 }
 
 /**
@@ -145,6 +145,20 @@ std::string const &abcg::Application::getBasePath() noexcept {
   return m_basePath;
 }
 
+/**
+ * @brief Returns the path to the application's executable.
+ *
+ * @return Absolute path to the executable, as resolved from the first program
+ * argument when the application was constructed.
+ *
+ * @remark This is used to tell apart the files that different applications
+ * store in a shared directory, such as the default pipeline cache of
+ * abcg::VulkanWindow.
+ */
+std::string const &abcg::Application::getExecutablePath() noexcept {
+  return m_executablePath;
+}
+
 void abcg::Application::mainLoopIterator([[maybe_unused]] bool &done) const {
   SDL_Event event{};
   while (SDL_PollEvent(&event) != 0) {
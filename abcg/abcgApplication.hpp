@@ -42,6 +42,7 @@ public:
 
   static std::string const &getAssetsPath() noexcept;
   static std::string const &getBasePath() noexcept;
+  static std::string const &getExecutablePath() noexcept;
 
 private:
   void mainLoopIterator(bool &done) const;
@@ -56,6 +57,7 @@ private:
   // See https://bugs.llvm.org/show_bug.cgi?id=48040
   static inline std::string m_assetsPath;
   static inline std::string m_basePath;
+  static inline std::string m_executablePath;
   // NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
 };
 
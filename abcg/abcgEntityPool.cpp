@@ -0,0 +1,147 @@
+/**
+ * @file abcgEntityPool.cpp
+ * @brief Definition of the update kernels of abcg::EntityPool columns.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgEntityPool.hpp"
+
+#include <cmath>
+
+#include "abcgException.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define ABCG_ENTITY_POOL_SSE2
+#if defined(__AVX__)
+#define ABCG_ENTITY_POOL_AVX
+#endif
+#endif
+
+namespace {
+#if defined(ABCG_ENTITY_POOL_SSE2)
+// Rounds toward negative infinity. SSE2 has no floor instruction, so the
+// values are truncated and those that were rounded up are decremented. Only
+// valid for values that fit in a 32-bit integer.
+inline __m128 floor4(__m128 value) {
+  auto const truncated{_mm_cvtepi32_ps(_mm_cvttps_epi32(value))};
+  auto const roundedUp{_mm_cmpgt_ps(truncated, value)};
+  return _mm_sub_ps(truncated, _mm_and_ps(roundedUp, _mm_set1_ps(1.0f)));
+}
+#endif
+} // namespace
+
+/**
+ * @brief Integrates a column of values over a time step.
+ *
+ * Computes `values[i] += (rates[i] + baseRate) * deltaTime` for each element,
+ * eight or four elements at a time when AVX or SSE2 is available.
+ *
+ * @param values Values to be updated, such as one coordinate of the positions
+ * of the entities.
+ * @param rates Rates of change of the values, such as the same coordinate of
+ * the velocities of the entities.
+ * @param deltaTime Time step.
+ * @param baseRate Rate added to all rates, such as the velocity of a moving
+ * frame of reference.
+ *
+ * @throw abcg::RuntimeError if the spans have different sizes.
+ */
+void abcg::integrate(std::span<float> values, std::span<float const> rates,
+                     float deltaTime, float baseRate) {
+  if (values.size() != rates.size()) {
+    throw abcg::RuntimeError(
+        "Values and rates must have the same number of elements");
+  }
+
+  [[maybe_unused]] auto *const value{values.data()};
+  [[maybe_unused]] auto const *const rate{rates.data()};
+  std::size_t index{};
+
+#if defined(ABCG_ENTITY_POOL_AVX)
+  auto const baseRate8{_mm256_set1_ps(baseRate)};
+  auto const deltaTime8{_mm256_set1_ps(deltaTime)};
+  for (; index + 8 <= values.size(); index += 8) {
+    auto const sum{_mm256_add_ps(_mm256_loadu_ps(rate + index), // NOLINT
+                                 baseRate8)};
+    _mm256_storeu_ps(value + index, // NOLINT
+                     _mm256_add_ps(_mm256_loadu_ps(value + index), // NOLINT
+                                   _mm256_mul_ps(sum, deltaTime8)));
+  }
+#endif
+
+#if defined(ABCG_ENTITY_POOL_SSE2)
+  auto const baseRate4{_mm_set1_ps(baseRate)};
+  auto const deltaTime4{_mm_set1_ps(deltaTime)};
+  for (; index + 4 <= values.size(); index += 4) {
+    auto const sum{_mm_add_ps(_mm_loadu_ps(rate + index), // NOLINT
+                              baseRate4)};
+    _mm_storeu_ps(value + index, // NOLINT
+                  _mm_add_ps(_mm_loadu_ps(value + index), // NOLINT
+                             _mm_mul_ps(sum, deltaTime4)));
+  }
+#endif
+
+  for (; index < values.size(); ++index) {
+    values[index] += (rates[index] + baseRate) * deltaTime;
+  }
+}
+
+/**
+ * @brief Wraps a column of values around an interval.
+ *
+ * Each value is moved by a whole number of interval lengths into
+ * [`min`, `max`], as in a toroidal world or for periodic angles. The values
+ * are wrapped without branches, eight or four elements at a time when AVX or
+ * SSE2 is available.
+ *
+ * @param values Values to be wrapped.
+ * @param min Lower bound of the interval.
+ * @param max Upper bound of the interval.
+ *
+ * @throw abcg::RuntimeError if the interval is empty.
+ */
+void abcg::wrap(std::span<float> values, float min, float max) {
+  if (max <= min) {
+    throw abcg::RuntimeError("Invalid wrap-around interval");
+  }
+
+  [[maybe_unused]] auto *const value{values.data()};
+  auto const length{max - min};
+  std::size_t index{};
+
+#if defined(ABCG_ENTITY_POOL_AVX)
+  auto const min8{_mm256_set1_ps(min)};
+  auto const length8{_mm256_set1_ps(length)};
+  for (; index + 8 <= values.size(); index += 8) {
+    auto const local{
+        _mm256_sub_ps(_mm256_loadu_ps(value + index), min8)}; // NOLINT
+    auto const periods{_mm256_floor_ps(_mm256_div_ps(local, length8))};
+    _mm256_storeu_ps(
+        value + index, // NOLINT
+        _mm256_add_ps(min8,
+                      _mm256_sub_ps(local, _mm256_mul_ps(length8, periods))));
+  }
+#endif
+
+#if defined(ABCG_ENTITY_POOL_SSE2)
+  auto const min4{_mm_set1_ps(min)};
+  auto const length4{_mm_set1_ps(length)};
+  for (; index + 4 <= values.size(); index += 4) {
+    auto const local{_mm_sub_ps(_mm_loadu_ps(value + index), min4)}; // NOLINT
+    auto const periods{floor4(_mm_div_ps(local, length4))};
+    _mm_storeu_ps(value + index, // NOLINT
+                  _mm_add_ps(min4, _mm_sub_ps(local,
+                                              _mm_mul_ps(length4, periods))));
+  }
+#endif
+
+  for (; index < values.size(); ++index) {
+    auto const local{values[index] - min};
+    values[index] = min + (local - length * std::floor(local / length));
+  }
+}
@@ -0,0 +1,186 @@
+/**
+ * @file abcgEntityPool.hpp
+ * @brief Header file of abcg::EntityPool.
+ *
+ * Declaration of abcg::EntityPool and of the update kernels of its columns.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_ENTITY_POOL_HPP_
+#define ABCG_ENTITY_POOL_HPP_
+
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace abcg {
+template <typename... TColumns> class EntityPool;
+
+void integrate(std::span<float> values, std::span<float const> rates,
+               float deltaTime, float baseRate = 0.0f);
+void wrap(std::span<float> values, float min, float max);
+} // namespace abcg
+
+/**
+ * @brief Contiguous pool of entities stored as a structure of arrays.
+ *
+ * Each attribute of the entities is stored in its own array (a column), so
+ * that update loops read and write contiguous memory and can be vectorized,
+ * as done by abcg::integrate and abcg::wrap for columns of floats. Entities
+ * are removed by moving the last entity into the vacated slot, so the order
+ * of the entities is not preserved.
+ *
+ * Columns of `bool` are not supported, as `std::vector<bool>` is not
+ * contiguous. Use `uint8_t` instead.
+ *
+ * Example:
+ * @code
+ * enum Column { PositionX, VelocityX };
+ * abcg::EntityPool<float, float> pool;
+ * pool.add(0.0f, 0.5f);
+ * abcg::integrate(pool.get<PositionX>(), pool.get<VelocityX>(), deltaTime);
+ * abcg::wrap(pool.get<PositionX>(), -1.0f, 1.0f);
+ * @endcode
+ *
+ * @tparam TColumns Types of the attributes of an entity.
+ */
+template <typename... TColumns> class abcg::EntityPool {
+  static_assert(sizeof...(TColumns) > 0, "An entity must have attributes");
+  static_assert((!std::is_same_v<TColumns, bool> && ...),
+                "Columns of bool are not contiguous; use uint8_t instead");
+
+public:
+  template <std::size_t Index>
+  using ColumnType = std::tuple_element_t<Index, std::tuple<TColumns...>>;
+
+  std::size_t add(TColumns const &...values);
+  void remove(std::size_t index);
+  void clear() noexcept;
+  void reserve(std::size_t capacity);
+
+  template <std::size_t Index>
+  [[nodiscard]] std::span<ColumnType<Index>> get() noexcept;
+  template <std::size_t Index>
+  [[nodiscard]] std::span<ColumnType<Index> const> get() const noexcept;
+
+  [[nodiscard]] std::size_t getSize() const noexcept;
+  [[nodiscard]] bool isEmpty() const noexcept;
+
+private:
+  std::tuple<std::vector<TColumns>...> m_columns;
+};
+
+/**
+ * @brief Appends an entity to the pool.
+ *
+ * @param values Attributes of the entity, in the order of the columns.
+ *
+ * @return Index of the new entity.
+ */
+template <typename... TColumns>
+std::size_t abcg::EntityPool<TColumns...>::add(TColumns const &...values) {
+  std::apply([&](auto &...columns) { (columns.push_back(values), ...); },
+             m_columns);
+  return getSize() - 1;
+}
+
+/**
+ * @brief Removes an entity from the pool in constant time.
+ *
+ * The last entity is moved into the slot of the removed entity. To remove
+ * several entities in a single pass, remove them in decreasing order of
+ * index.
+ *
+ * @param index Index of the entity to be removed.
+ */
+template <typename... TColumns>
+void abcg::EntityPool<TColumns...>::remove(std::size_t index) {
+  auto const last{getSize() - 1};
+  std::apply(
+      [index, last](auto &...columns) {
+        if (index != last) {
+          ((columns[index] = std::move(columns[last])), ...);
+        }
+        (columns.pop_back(), ...);
+      },
+      m_columns);
+}
+
+/**
+ * @brief Removes all entities from the pool.
+ */
+template <typename... TColumns>
+void abcg::EntityPool<TColumns...>::clear() noexcept {
+  std::apply([](auto &...columns) { (columns.clear(), ...); }, m_columns);
+}
+
+/**
+ * @brief Reserves storage for a number of entities.
+ *
+ * @param capacity Number of entities.
+ */
+template <typename... TColumns>
+void abcg::EntityPool<TColumns...>::reserve(std::size_t capacity) {
+  std::apply([capacity](auto &...columns) { (columns.reserve(capacity), ...); },
+             m_columns);
+}
+
+/**
+ * @brief Returns the values of a column.
+ *
+ * The span is invalidated by any call that adds or removes entities.
+ *
+ * @tparam Index Index of the column.
+ *
+ * @return Values of the attribute for all entities.
+ */
+template <typename... TColumns>
+template <std::size_t Index>
+std::span<typename abcg::EntityPool<TColumns...>::template ColumnType<Index>>
+abcg::EntityPool<TColumns...>::get() noexcept {
+  return std::get<Index>(m_columns);
+}
+
+/**
+ * @brief Returns the values of a column.
+ *
+ * @tparam Index Index of the column.
+ *
+ * @return Values of the attribute for all entities.
+ */
+template <typename... TColumns>
+template <std::size_t Index>
+std::span<
+    typename abcg::EntityPool<TColumns...>::template ColumnType<Index> const>
+abcg::EntityPool<TColumns...>::get() const noexcept {
+  return std::get<Index>(m_columns);
+}
+
+/**
+ * @brief Returns the number of entities.
+ *
+ * @return Number of entities of the pool.
+ */
+template <typename... TColumns>
+std::size_t abcg::EntityPool<TColumns...>::getSize() const noexcept {
+  return std::get<0>(m_columns).size();
+}
+
+/**
+ * @brief Returns whether the pool has no entities.
+ *
+ * @return `true` if the pool is empty.
+ */
+template <typename... TColumns>
+bool abcg::EntityPool<TColumns...>::isEmpty() const noexcept {
+  return getSize() == 0;
+}
+
+#endif
@@ -13,44 +13,418 @@
 #include <cppitertools/itertools.hpp>
 #include <gsl/gsl>
 
-#include <span>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
 #include <vector>
 
+#include "abcgException.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define ABCG_IMAGE_SSE2
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+// GCC and Clang compile the SSSE3 and AVX2 kernels regardless of the target
+// flags, and the kernels are selected at runtime from the features of the CPU
+#define ABCG_IMAGE_RUNTIME_DISPATCH
+#define ABCG_IMAGE_SSSE3
+#define ABCG_IMAGE_AVX2
+#define ABCG_IMAGE_TARGET(isa) __attribute__((target(isa)))
+#else
+#if defined(__SSSE3__) || defined(__AVX2__)
+#define ABCG_IMAGE_SSSE3
+#endif
+#if defined(__AVX2__)
+#define ABCG_IMAGE_AVX2
+#endif
+#define ABCG_IMAGE_TARGET(isa)
+#endif
+#endif
+
+namespace {
+// Images with at least this number of bytes are downsampled by multiple threads
+constexpr std::size_t parallelThreshold{4 * 1024 * 1024};
+
+#if defined(ABCG_IMAGE_SSSE3)
+[[nodiscard]] bool hasSSSE3() {
+#if defined(ABCG_IMAGE_RUNTIME_DISPATCH)
+  static bool const supported{__builtin_cpu_supports("ssse3") != 0};
+  return supported;
+#else
+  return true;
+#endif
+}
+
+// Byte shuffles that reverse the order of 16 RGB pixels held in 3 registers.
+// Output register i is the bitwise OR of the input registers j shuffled with
+// mask 3i + j
+constexpr auto rgbReverseMasks{[] {
+  std::array<std::array<char, 16>, 9> masks{};
+  for (std::size_t output{}; output < 48; ++output) {
+    auto const source{3 * (15 - output / 3) + output % 3};
+    for (std::size_t input{}; input < 3; ++input) {
+      masks.at(3 * (output / 16) + input).at(output % 16) =
+          source / 16 == input ? static_cast<char>(source % 16)
+                               : static_cast<char>(-1);
+    }
+  }
+  return masks;
+}()};
+
+// Stores the 16 RGB pixels of source, in reverse order, in destination. The
+// blocks must not overlap.
+ABCG_IMAGE_TARGET("ssse3")
+inline void reverseRGBBlock(__m128i const *source, __m128i *destination) {
+  auto const *const masks{
+      reinterpret_cast<__m128i const *>(rgbReverseMasks.data())}; // NOLINT
+  auto const input0{_mm_loadu_si128(source)};
+  auto const input1{_mm_loadu_si128(source + 1)}; // NOLINT
+  auto const input2{_mm_loadu_si128(source + 2)}; // NOLINT
+  for (auto const output : iter::range(3)) {
+    auto const *const outputMasks{masks + 3 * output}; // NOLINT
+    _mm_storeu_si128(
+        destination + output, // NOLINT
+        _mm_or_si128(
+            _mm_or_si128(
+                _mm_shuffle_epi8(input0, _mm_loadu_si128(outputMasks)),
+                _mm_shuffle_epi8(input1,
+                                 _mm_loadu_si128(outputMasks + 1))), // NOLINT
+            _mm_shuffle_epi8(input2,
+                             _mm_loadu_si128(outputMasks + 2)))); // NOLINT
+  }
+}
+
+// Swaps blocks of 16 RGB pixels (48 bytes, three whole registers) from both
+// ends of a row while they do not overlap, so that stores never partially
+// overlap the loads of the next iteration
+ABCG_IMAGE_TARGET("ssse3")
+void reverseRGBBlocksSSSE3(std::byte *row, std::size_t &left,
+                           std::size_t &right) {
+  while (right - left >= 96) {
+    right -= 48;
+    auto *const leftPtr{reinterpret_cast<__m128i *>(row + left)};   // NOLINT
+    auto *const rightPtr{reinterpret_cast<__m128i *>(row + right)}; // NOLINT
+    std::array<std::byte, 48> leftBlock;                           // NOLINT
+    std::memcpy(leftBlock.data(), leftPtr, leftBlock.size());
+    reverseRGBBlock(rightPtr, leftPtr);
+    reverseRGBBlock(reinterpret_cast<__m128i const *>( // NOLINT
+                        leftBlock.data()),
+                    rightPtr);
+    left += 48;
+  }
+}
+#endif
+
+#if defined(ABCG_IMAGE_AVX2)
+[[nodiscard]] bool hasAVX2() {
+#if defined(ABCG_IMAGE_RUNTIME_DISPATCH)
+  static bool const supported{__builtin_cpu_supports("avx2") != 0};
+  return supported;
+#else
+  return true;
+#endif
+}
+
+// Swaps blocks of 8 RGBA pixels from both ends of a row while they do not
+// overlap
+ABCG_IMAGE_TARGET("avx2")
+void reverseRGBABlocksAVX2(std::byte *row, std::size_t &left,
+                           std::size_t &right) {
+  auto const reverse{_mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0)};
+  while (right - left >= 64) {
+    right -= 32;
+    auto *const leftPtr{reinterpret_cast<__m256i *>(row + left)};   // NOLINT
+    auto *const rightPtr{reinterpret_cast<__m256i *>(row + right)}; // NOLINT
+    auto const leftBlock{_mm256_loadu_si256(leftPtr)};
+    auto const rightBlock{_mm256_loadu_si256(rightPtr)};
+    _mm256_storeu_si256(leftPtr,
+                        _mm256_permutevar8x32_epi32(rightBlock, reverse));
+    _mm256_storeu_si256(rightPtr,
+                        _mm256_permutevar8x32_epi32(leftBlock, reverse));
+    left += 32;
+  }
+}
+#endif
+
+#if defined(ABCG_IMAGE_SSE2)
+// Swaps blocks of 4 RGBA pixels from both ends of a row while they do not
+// overlap
+void reverseRGBABlocksSSE2(std::byte *row, std::size_t &left,
+                           std::size_t &right) {
+  while (right - left >= 32) {
+    right -= 16;
+    auto *const leftPtr{reinterpret_cast<__m128i *>(row + left)};   // NOLINT
+    auto *const rightPtr{reinterpret_cast<__m128i *>(row + right)}; // NOLINT
+    auto const leftBlock{_mm_loadu_si128(leftPtr)};
+    auto const rightBlock{_mm_loadu_si128(rightPtr)};
+    _mm_storeu_si128(leftPtr,
+                     _mm_shuffle_epi32(rightBlock, _MM_SHUFFLE(0, 1, 2, 3)));
+    _mm_storeu_si128(rightPtr,
+                     _mm_shuffle_epi32(leftBlock, _MM_SHUFFLE(0, 1, 2, 3)));
+    left += 16;
+  }
+}
+#endif
+
+// Swaps the pixels at the given byte offsets of a row
+template <std::size_t BytesPerPixel>
+void swapPixels(std::byte *row, std::size_t left, std::size_t right) {
+  std::array<std::byte, BytesPerPixel> pixel;            // NOLINT
+  std::memcpy(pixel.data(), row + left, BytesPerPixel);  // NOLINT
+  std::memcpy(row + left, row + right, BytesPerPixel);   // NOLINT
+  std::memcpy(row + right, pixel.data(), BytesPerPixel); // NOLINT
+}
+
+// Reverses the order of the pixels of a row, in place. The vectorized kernels
+// swap blocks of pixels from both ends until the blocks would overlap, and the
+// remaining pixels in the middle are swapped one by one.
+template <std::size_t BytesPerPixel>
+void reverseRow(std::byte *row, std::size_t width) {
+  std::size_t left{};
+  std::size_t right{width * BytesPerPixel};
+
+#if defined(ABCG_IMAGE_AVX2)
+  if constexpr (BytesPerPixel == 4) {
+    if (hasAVX2()) {
+      reverseRGBABlocksAVX2(row, left, right);
+    }
+  }
+#endif
+
+#if defined(ABCG_IMAGE_SSE2)
+  if constexpr (BytesPerPixel == 4) {
+    reverseRGBABlocksSSE2(row, left, right);
+  }
+#endif
+
+#if defined(ABCG_IMAGE_SSSE3)
+  if constexpr (BytesPerPixel == 3) {
+    if (hasSSSE3()) {
+      reverseRGBBlocksSSSE3(row, left, right);
+    }
+  }
+#endif
+
+  while (right - left >= 2 * BytesPerPixel) {
+    right -= BytesPerPixel;
+    swapPixels<BytesPerPixel>(row, left, right);
+    left += BytesPerPixel;
+  }
+}
+
+void reverseRow(std::byte *row, std::size_t width, std::size_t bytesPerPixel) {
+  switch (bytesPerPixel) {
+  case 3:
+    reverseRow<3>(row, width);
+    break;
+  case 4:
+    reverseRow<4>(row, width);
+    break;
+  case 1:
+    std::reverse(row, row + width); // NOLINT
+    break;
+  default:
+    for (std::size_t left{}, right{(width - 1) * bytesPerPixel};
+         width > 1 && left < right;
+         left += bytesPerPixel, right -= bytesPerPixel) {
+      std::swap_ranges(row + left, row + left + bytesPerPixel, // NOLINT
+                       row + right);                           // NOLINT
+    }
+    break;
+  }
+}
+
+// Swaps two rows through a small buffer on the stack, one chunk at a time, so
+// that the copies are done by memcpy
+void swapRows(std::byte *first, std::byte *second, std::size_t size) {
+  std::array<std::byte, 4096> buffer; // NOLINT
+  for (std::size_t offset{}; offset < size; offset += buffer.size()) {
+    auto const chunkSize{std::min(buffer.size(), size - offset)};
+    std::memcpy(buffer.data(), first + offset, chunkSize);   // NOLINT
+    std::memcpy(first + offset, second + offset, chunkSize); // NOLINT
+    std::memcpy(second + offset, buffer.data(), chunkSize);  // NOLINT
+  }
+}
+
+// Number of entries of the tables that encode linear intensities to bytes
+constexpr std::size_t encodeTableSize{16384};
+
+// Lookup tables for converting 8-bit color channels to linear intensities in
+// [0, 1], and back
+struct ColorTables {
+  std::array<float, 256> decode{};
+  std::array<std::uint8_t, encodeTableSize> encode{};
+};
+
+// Returns the tables of the sRGB transfer function, or the identity tables if
+// sRGB is false
+ColorTables const &getColorTables(bool sRGB) {
+  auto const createTables{[](bool withTransferFunction) {
+    ColorTables tables{};
+    for (auto const index : iter::range(tables.decode.size())) {
+      auto value{gsl::narrow_cast<float>(index) / 255.0f};
+      if (withTransferFunction) {
+        value = value <= 0.04045f ? value / 12.92f
+                                  : std::pow((value + 0.055f) / 1.055f, 2.4f);
+      }
+      tables.decode.at(index) = value;
+    }
+    for (auto const index : iter::range(tables.encode.size())) {
+      auto value{gsl::narrow_cast<float>(index) /
+                 gsl::narrow_cast<float>(encodeTableSize - 1)};
+      if (withTransferFunction) {
+        value = value <= 0.0031308f
+                    ? value * 12.92f
+                    : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+      }
+      tables.encode.at(index) = gsl::narrow_cast<std::uint8_t>(
+          std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    }
+    return tables;
+  }};
+  static ColorTables const sRGBTables{createTables(true)};
+  static ColorTables const linearTables{createTables(false)};
+  return sRGB ? sRGBTables : linearTables;
+}
+
+// Returns the first index and the number of texels of a source dimension of
+// the given size that are averaged into the destination texel at the given
+// index. Blocks have 2 texels, but the last block also includes the last
+// texel if size is odd, and the single texel is used if size is 1
+inline std::pair<std::size_t, std::size_t> getBlock(std::size_t index,
+                                                    std::size_t size) {
+  if (size == 1) {
+    return {0, 1};
+  }
+  return {2 * index, 2 * index + 3 == size ? 3 : 2};
+}
+
+// Decodes a row of RGBA8 texels to linear intensities and adds them to sums.
+// Color channels are decoded with the given tables; alpha is always linear
+void accumulateRow(std::byte const *row, std::size_t width,
+                   ColorTables const &color, ColorTables const &alpha,
+                   float *sums) {
+  auto const decode{[](std::array<float, 256> const &table, std::byte value) {
+    return table[std::to_integer<std::size_t>(value)];
+  }};
+  for (auto const index :
+       iter::range(std::size_t{}, width * 4, std::size_t{4})) {
+    sums[index] += decode(color.decode, row[index]);         // NOLINT
+    sums[index + 1] += decode(color.decode, row[index + 1]); // NOLINT
+    sums[index + 2] += decode(color.decode, row[index + 2]); // NOLINT
+    sums[index + 3] += decode(alpha.decode, row[index + 3]); // NOLINT
+  }
+}
+
+// Averages blocks of texels of a row of sums, and stores the encoded averages
+// in a row of RGBA8 texels
+void encodeRow(float const *sums, std::size_t width, std::size_t numRows,
+               ColorTables const &color, ColorTables const &alpha,
+               std::byte *row) {
+  auto const destinationWidth{std::max<std::size_t>(width / 2, 1)};
+  for (auto const column : iter::range(destinationWidth)) {
+    auto const [first, count]{getBlock(column, width)};
+    // Scale from the sum of intensities to an index of the encoding table
+    auto const scale{static_cast<float>(encodeTableSize - 1) /
+                     gsl::narrow_cast<float>(count * numRows)};
+
+    // Indices are rounded to nearest
+    std::array<std::int32_t, 4> indices{};
+#if defined(ABCG_IMAGE_SSE2)
+    auto sum{_mm_setzero_ps()};
+    for (auto const index : iter::range(first, first + count)) {
+      sum = _mm_add_ps(sum, _mm_loadu_ps(sums + index * 4)); // NOLINT
+    }
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(indices.data()), // NOLINT
+        _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(sum, _mm_set1_ps(scale)),
+                                    _mm_set1_ps(0.5f))));
+#else
+    for (auto const channel : iter::range(indices.size())) {
+      auto sum{0.0f};
+      for (auto const index : iter::range(first, first + count)) {
+        sum += sums[index * 4 + channel]; // NOLINT
+      }
+      indices.at(channel) = static_cast<std::int32_t>(sum * scale + 0.5f);
+    }
+#endif
+
+    for (auto const channel : iter::range(indices.size())) {
+      auto const &table{channel < 3 ? color.encode : alpha.encode};
+      auto const index{std::min(
+          gsl::narrow_cast<std::size_t>(indices.at(channel)),
+          encodeTableSize - 1)};
+      row[column * 4 + channel] = // NOLINT
+          static_cast<std::byte>(table[index]);
+    }
+  }
+}
+
+// Calls function(first, last) for ranges of [0, count) on multiple threads if
+// the image is large enough, or for the whole range on the calling thread
+template <typename Function>
+void forEachRange(std::size_t count, std::size_t sizeInBytes,
+                  Function const &function) {
+#if defined(__EMSCRIPTEN__)
+  auto const numThreads{std::size_t{1}};
+#else
+  auto const numThreads{
+      sizeInBytes < parallelThreshold
+          ? std::size_t{1}
+          : std::min<std::size_t>(
+                count, std::max(1U, std::thread::hardware_concurrency()))};
+#endif
+  if (numThreads <= 1) {
+    function(std::size_t{}, count);
+    return;
+  }
+
+  // The calling thread processes the first range
+  std::vector<std::jthread> threads;
+  threads.reserve(numThreads - 1);
+  auto const rangeSize{(count + numThreads - 1) / numThreads};
+  for (auto const index : iter::range(std::size_t{1}, numThreads)) {
+    auto const first{index * rangeSize};
+    auto const last{std::min(first + rangeSize, count)};
+    if (first < last) {
+      threads.emplace_back(function, first, last);
+    }
+  }
+  function(std::size_t{}, std::min(rangeSize, count));
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+} // namespace
+
 /**
  * @brief Flips an image horizontally.
  *
- * Reverses each row of the image, in place.
+ * Reverses each row of the image, in place. RGB and RGBA images are processed
+ * with SIMD instructions when available. On x86 with GCC or Clang, the SSSE3
+ * and AVX2 kernels are selected at runtime from the features of the CPU.
  *
  * @param surface SDL surface of a RGB or RGBA image.
  */
 void abcg::flipHorizontally(SDL_Surface &surface) {
-  auto const bytesPerPixel{gsl::narrow<int>(surface.format->BytesPerPixel)};
-  auto const widthInBytes{gsl::narrow<std::size_t>(surface.w * bytesPerPixel)};
+  auto const bytesPerPixel{
+      gsl::narrow<std::size_t>(surface.format->BytesPerPixel)};
+  auto const width{gsl::narrow<std::size_t>(surface.w)};
   auto const height{gsl::narrow<std::size_t>(surface.h)};
-  std::span const pixels{static_cast<std::byte *>(surface.pixels),
-                         widthInBytes * height};
-
-  // Temporary row of pixels for the swap
-  std::vector<std::byte> pixelRow(gsl::narrow<std::size_t>(widthInBytes), {});
+  auto const pitch{gsl::narrow<std::size_t>(surface.pitch)};
+  if (width < 2) {
+    return;
+  }
 
   SDL_LockSurface(&surface);
 
-  // For each row
+  // Flipping is bound by memory bandwidth, so it is done on the calling thread
+  auto *const pixels{static_cast<std::byte *>(surface.pixels)};
   for (auto const rowIndex : iter::range(height)) {
-    auto const rowStart{widthInBytes * rowIndex};
-    auto const rowEnd{rowStart + widthInBytes};
-    // For each pixel (RGB/RGA) of current row
-    auto srcBegin{pixels.begin() + gsl::narrow<long>(rowEnd)};
-    auto dstBegin{pixelRow.begin()};
-    for ([[maybe_unused]] auto const pixelIndex : iter::range(surface.w)) {
-      srcBegin -= bytesPerPixel;
-      std::copy(srcBegin, srcBegin + bytesPerPixel, dstBegin);
-      dstBegin += bytesPerPixel;
-    }
-    // std::ranges::copy(pixelRow, pixels.subspan(rowStart).begin());
-    std::copy(pixelRow.begin(),
-              pixelRow.begin() + gsl::narrow<long>(widthInBytes),
-              pixels.subspan(rowStart).begin());
+    reverseRow(pixels + rowIndex * pitch, width, bytesPerPixel); // NOLINT
   }
 
   SDL_UnlockSurface(&surface);
@@ -59,44 +433,82 @@ void abcg::flipHorizontally(SDL_Surface &surface) {
 /**
  * @brief Flips an image vertically.
  *
- * Reverses each column of the image, in place.
+ * Reverses each column of the image, in place. Each pair of rows is swapped
+ * in chunks of at most 4 KiB through a buffer on the stack, so no row-sized
+ * buffer is allocated.
  *
  * @param surface SDL surface of a RGB or RGBA image.
  */
 void abcg::flipVertically(SDL_Surface &surface) {
-  auto const bytesPerPixel{gsl::narrow<int>(surface.format->BytesPerPixel)};
-  auto const widthInBytes{gsl::narrow<std::size_t>(surface.w * bytesPerPixel)};
+  auto const bytesPerPixel{
+      gsl::narrow<std::size_t>(surface.format->BytesPerPixel)};
+  auto const widthInBytes{gsl::narrow<std::size_t>(surface.w) * bytesPerPixel};
   auto const height{gsl::narrow<std::size_t>(surface.h)};
-  std::span const pixels{static_cast<std::byte *>(surface.pixels),
-                         gsl::narrow<std::size_t>(widthInBytes * height)};
-
-  // Temporary row of pixels for the swap
-  std::vector<std::byte> pixelRow(widthInBytes, std::byte{});
+  auto const pitch{gsl::narrow<std::size_t>(surface.pitch)};
 
   SDL_LockSurface(&surface);
 
   // If height is odd, won't swap the middle row
-  for (auto const halfHeight{height / 2};
-       auto const rowIndex : iter::range(halfHeight)) {
-    auto const rowStartFromTop{widthInBytes * rowIndex};
-    auto const rowStartFromBottom{widthInBytes * (height - rowIndex - 1)};
-
-    auto const &topSpan{pixels.subspan(rowStartFromTop)};
-    auto const &bottomSpan{pixels.subspan(rowStartFromBottom)};
-
-    // std::ranges::copy(topSpan.subspan(0, widthInBytes), pixelRow.begin());
-    // std::ranges::copy(bottomSpan.subspan(0, widthInBytes), topSpan.begin());
-    // std::ranges::copy(pixelRow, bottomSpan.begin());
-    std::copy(topSpan.begin(),
-              topSpan.begin() + gsl::narrow<long>(widthInBytes),
-              pixelRow.begin());
-    std::copy(bottomSpan.begin(),
-              bottomSpan.begin() + gsl::narrow<long>(widthInBytes),
-              topSpan.begin());
-    std::copy(pixelRow.begin(),
-              pixelRow.begin() + gsl::narrow<long>(widthInBytes),
-              bottomSpan.begin());
+  auto *const pixels{static_cast<std::byte *>(surface.pixels)};
+  for (auto const rowIndex : iter::range(height / 2)) {
+    auto *const top{pixels + rowIndex * pitch};                     // NOLINT
+    auto *const bottom{pixels + (height - rowIndex - 1) * pitch}; // NOLINT
+    swapRows(top, bottom, widthInBytes);
   }
 
   SDL_UnlockSurface(&surface);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Computes the next mipmap level of an RGBA image.
+ *
+ * Each texel of the destination image is the average of a 2x2 block of
+ * texels of the source image, computed in linear space. The destination image
+ * has half the width and half the height of the source image, rounded down,
+ * but never less than 1. If a dimension of the source image is odd, the last
+ * block of that dimension is 3 texels wide, so that every source texel
+ * contributes to the result. Color channels are averaged with SIMD
+ * instructions when available, and large images are processed by multiple
+ * threads.
+ *
+ * @param source Texels of the source image, with 4 bytes per texel and no
+ * padding between rows.
+ * @param width Width of the source image.
+ * @param height Height of the source image.
+ * @param destination Texels of the destination image, with the same layout
+ * as the source image.
+ * @param sRGB Whether the color channels are encoded with the sRGB transfer
+ * function. The alpha channel is always linear.
+ */
+void abcg::downsampleRGBA(std::span<std::byte const> source, std::size_t width,
+                          std::size_t height, std::span<std::byte> destination,
+                          bool sRGB) {
+  auto const destinationWidth{std::max<std::size_t>(width / 2, 1)};
+  auto const destinationHeight{std::max<std::size_t>(height / 2, 1)};
+  if (source.size() < width * height * 4 ||
+      destination.size() < destinationWidth * destinationHeight * 4) {
+    throw abcg::RuntimeError("Invalid image size for downsampling");
+  }
+
+  auto const &color{getColorTables(sRGB)};
+  auto const &alpha{getColorTables(false)};
+
+  auto const *const sourceTexels{source.data()};
+  auto *const destinationTexels{destination.data()};
+  forEachRange(
+      destinationHeight, source.size(),
+      [=, &color, &alpha](std::size_t firstRow, std::size_t lastRow) {
+        // Sums of the decoded texels of the rows of each block
+        std::vector<float> sums(width * 4);
+        for (auto const row : iter::range(firstRow, lastRow)) {
+          std::fill(sums.begin(), sums.end(), 0.0f);
+          auto const [first, count]{getBlock(row, height)};
+          for (auto const sourceRow : iter::range(first, first + count)) {
+            accumulateRow(sourceTexels + sourceRow * width * 4, // NOLINT
+                          width, color, alpha, sums.data());
+          }
+          encodeRow(sums.data(), width, count, color, alpha,
+                    destinationTexels + row * destinationWidth * 4); // NOLINT
+        }
+      });
+}
@@ -13,9 +13,15 @@
 
 #include <SDL_image.h>
 
+#include <cstddef>
+#include <span>
+
 namespace abcg {
 void flipHorizontally(SDL_Surface &surface);
 void flipVertically(SDL_Surface &surface);
+void downsampleRGBA(std::span<std::byte const> source, std::size_t width,
+                    std::size_t height, std::span<std::byte> destination,
+                    bool sRGB = true);
 } // namespace abcg
 
 #endif
@@ -0,0 +1,805 @@
+/**
+ * @file abcgMesh.cpp
+ * @brief Definition of the ABCg binary mesh format.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgMesh.hpp"
+
+#include <cppitertools/itertools.hpp>
+#include <fmt/core.h>
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <thread>
+
+#include "abcgException.hpp"
+#include "abcgUtil.hpp"
+
+// The OBJ loader is implemented here, so that tools that only use the mesh
+// sources do not need the rest of the framework
+// @cond Skipped by Doxygen
+#define TINYOBJLOADER_IMPLEMENTATION
+// @endcond
+
+#include "tiny_obj_loader.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr std::array<char, 8> meshMagic{'A', 'B', 'C', 'G', 'M', 'E', 'S', 'H'};
+constexpr uint32_t meshVersion{1};
+
+// Vertex and index data start at multiples of this number of bytes, and so
+// do the streams of de-interleaved attributes
+constexpr std::size_t meshAlignment{16};
+
+static_assert(sizeof(abcg::MeshFileHeader) == 88,
+              "The mesh file header must not contain padding");
+
+// Attributes in the order they are laid out, and their number of components
+constexpr std::array<std::pair<abcg::MeshAttribute, std::size_t>, 4>
+    meshAttributes{{{abcg::MeshAttribute::Position, 3},
+                    {abcg::MeshAttribute::Normal, 3},
+                    {abcg::MeshAttribute::TexCoord, 2},
+                    {abcg::MeshAttribute::Color, 4}}};
+
+[[nodiscard]] std::size_t align(std::size_t value) {
+  return (value + meshAlignment - 1) / meshAlignment * meshAlignment;
+}
+
+[[nodiscard]] bool hasAttribute(uint32_t attributes,
+                                abcg::MeshAttribute attribute) {
+  return (attributes & static_cast<uint32_t>(attribute)) != 0;
+}
+
+// Returns the size in bytes of an interleaved vertex
+[[nodiscard]] std::size_t getVertexSize(uint32_t attributes) {
+  std::size_t size{};
+  for (auto const &[attribute, components] : meshAttributes) {
+    if (hasAttribute(attributes, attribute)) {
+      size += components * sizeof(float);
+    }
+  }
+  return size;
+}
+
+// Returns the size in bytes of the vertex data described by a header
+[[nodiscard]] std::size_t
+getVertexDataSize(abcg::MeshFileHeader const &header) {
+  if (header.interleaved != 0) {
+    return getVertexSize(header.attributes) * header.vertexCount;
+  }
+  std::size_t size{};
+  for (auto const &[attribute, components] : meshAttributes) {
+    if (hasAttribute(header.attributes, attribute)) {
+      size = align(size) + components * sizeof(float) * header.vertexCount;
+    }
+  }
+  return size;
+}
+
+// Returns whether all indices of the index data refer to one of the vertices.
+// The largest index is reserved for primitive restart
+template <typename T>
+[[nodiscard]] bool areIndicesValid(std::span<std::byte const> indexData,
+                                   uint32_t vertexCount) {
+  for (auto const offset :
+       iter::range(std::size_t{}, indexData.size(), sizeof(T))) {
+    T index{};
+    std::memcpy(&index, indexData.data() + offset, sizeof(T)); // NOLINT
+    if (index >= vertexCount || index == std::numeric_limits<T>::max()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Copies the elements of an attribute to its stream in the vertex data
+template <typename T>
+void writeStream(std::vector<std::byte> &vertexData,
+                 std::vector<T> const &elements,
+                 abcg::MeshStream const &stream) {
+  for (auto &&[index, element] : iter::enumerate(elements)) {
+    std::memcpy(vertexData.data() + stream.offset + // NOLINT
+                    index * stream.stride,
+                &element, sizeof(T));
+  }
+}
+
+// Size of the post-transform vertex cache assumed by abcg::optimizeVertexCache
+constexpr std::size_t vertexCacheSize{16};
+
+// Unique vertices of a shape of an OBJ file, as index triples, and the
+// indices of its triangles
+struct ShapeMesh {
+  std::vector<tinyobj::index_t> vertices;
+  std::vector<uint32_t> indices;
+  bool hasNormals{true};
+  bool hasTexCoords{true};
+};
+
+[[nodiscard]] bool isSameVertex(tinyobj::index_t const &lhs,
+                                tinyobj::index_t const &rhs) {
+  return lhs.vertex_index == rhs.vertex_index &&
+         lhs.normal_index == rhs.normal_index &&
+         lhs.texcoord_index == rhs.texcoord_index;
+}
+
+// Maps the index triples of the corners of a shape to unique vertices, with
+// an open-addressing hash table with linear probing that is at most half full
+[[nodiscard]] ShapeMesh
+deduplicate(std::vector<tinyobj::index_t> const &corners) {
+  constexpr auto emptySlot{std::numeric_limits<uint32_t>::max()};
+
+  ShapeMesh shape;
+  shape.indices.reserve(corners.size());
+  auto const mask{
+      std::bit_ceil(std::max<std::size_t>(corners.size() * 2, 1)) - 1};
+  std::vector<uint32_t> slots(mask + 1, emptySlot);
+
+  for (auto const &corner : corners) {
+    auto slot{abcg::hashCombine(corner.vertex_index, corner.normal_index,
+                                corner.texcoord_index) &
+              mask};
+    while (slots[slot] != emptySlot &&
+           !isSameVertex(shape.vertices[slots[slot]], corner)) {
+      slot = (slot + 1) & mask;
+    }
+    if (slots[slot] == emptySlot) {
+      slots[slot] = gsl::narrow_cast<uint32_t>(shape.vertices.size());
+      shape.vertices.push_back(corner);
+      shape.hasNormals = shape.hasNormals && corner.normal_index >= 0;
+      shape.hasTexCoords = shape.hasTexCoords && corner.texcoord_index >= 0;
+    }
+    shape.indices.push_back(slots[slot]);
+  }
+  return shape;
+}
+
+// Reads the element at an index of a flat array of OBJ attributes. Returns
+// false if the index is out of range
+template <glm::length_t N>
+[[nodiscard]] bool fetch(std::vector<tinyobj::real_t> const &values, int index,
+                         glm::vec<N, float> &element) {
+  auto const first{gsl::narrow_cast<std::size_t>(index) * std::size_t{N}};
+  if (index < 0 || first + std::size_t{N} > values.size()) {
+    return false;
+  }
+  for (auto const component : iter::range(N)) {
+    element[component] =
+        values[first + gsl::narrow_cast<std::size_t>(component)];
+  }
+  return true;
+}
+
+// Calls function(index) for each index in [0, count), distributing the
+// indices among threads
+template <typename Function>
+void parallelFor(std::size_t count, Function const &function) {
+#if defined(__EMSCRIPTEN__)
+  auto const numThreads{std::size_t{1}};
+#else
+  auto const numThreads{std::min<std::size_t>(
+      count, std::max(1U, std::thread::hardware_concurrency()))};
+#endif
+  std::atomic<std::size_t> next{};
+  auto const worker{[&next, count, &function] {
+    for (auto index{next++}; index < count; index = next++) {
+      function(index);
+    }
+  }};
+
+  // The calling thread is also a worker. The threads are joined even if the
+  // function throws on the calling thread
+  std::vector<std::jthread> threads;
+  for ([[maybe_unused]] auto const index : iter::range(std::size_t{1},
+                                                      numThreads)) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+} // namespace
+
+/**
+ * @brief Writes a mesh to a file in the ABCg binary mesh format.
+ *
+ * Indices are stored with 16 bits if the mesh has fewer than 65536 vertices,
+ * and with 32 bits otherwise, as the 16-bit index 0xFFFF is reserved for
+ * primitive restart. The bounding box of the positions is computed and stored
+ * in the header.
+ *
+ * @param path Path to the file.
+ * @param mesh Mesh data.
+ * @param interleaved Whether to store the attributes interleaved, or as one
+ * stream per attribute.
+ *
+ * @throw abcg::RuntimeError if the mesh data is inconsistent or if the file
+ * could not be written.
+ *
+ * @sa abcg::MeshFile for loading the file.
+ */
+void abcg::saveMesh(std::string_view path, MeshData const &mesh,
+                    bool interleaved) {
+  auto const vertexCount{mesh.positions.size()};
+  auto const isOptional{[vertexCount](auto const &elements) {
+    return elements.empty() || elements.size() == vertexCount;
+  }};
+  if (!isOptional(mesh.normals) || !isOptional(mesh.texCoords) ||
+      !isOptional(mesh.colors)) {
+    throw abcg::RuntimeError(
+        "Vertex attributes must have the same number of elements");
+  }
+  if (std::ranges::any_of(mesh.indices, [vertexCount](auto index) {
+        return index >= vertexCount;
+      })) {
+    throw abcg::RuntimeError("Mesh index out of range");
+  }
+
+  MeshFileHeader header;
+  header.magic = meshMagic;
+  header.version = meshVersion;
+  header.attributes = static_cast<uint32_t>(MeshAttribute::Position);
+  header.interleaved = interleaved ? 1U : 0U;
+  // The largest 16-bit index is reserved for primitive restart
+  header.indexSize = vertexCount < 65536 ? 2U : 4U;
+  header.vertexCount = gsl::narrow<uint32_t>(vertexCount);
+  header.indexCount = gsl::narrow<uint32_t>(mesh.indices.size());
+  if (!mesh.normals.empty()) {
+    header.attributes |= static_cast<uint32_t>(MeshAttribute::Normal);
+  }
+  if (!mesh.texCoords.empty()) {
+    header.attributes |= static_cast<uint32_t>(MeshAttribute::TexCoord);
+  }
+  if (!mesh.colors.empty()) {
+    header.attributes |= static_cast<uint32_t>(MeshAttribute::Color);
+  }
+
+  // Bounding box
+  if (!mesh.positions.empty()) {
+    header.boundsMin = header.boundsMax = mesh.positions.front();
+    for (auto const &position : mesh.positions) {
+      header.boundsMin = glm::min(header.boundsMin, position);
+      header.boundsMax = glm::max(header.boundsMax, position);
+    }
+  }
+
+  // Vertex data
+  std::vector<std::byte> vertexData(getVertexDataSize(header));
+  writeStream(vertexData, mesh.positions,
+              *MeshFile::getStream(header, MeshAttribute::Position));
+  if (auto const stream{MeshFile::getStream(header, MeshAttribute::Normal)}) {
+    writeStream(vertexData, mesh.normals, *stream);
+  }
+  if (auto const stream{MeshFile::getStream(header, MeshAttribute::TexCoord)}) {
+    writeStream(vertexData, mesh.texCoords, *stream);
+  }
+  if (auto const stream{MeshFile::getStream(header, MeshAttribute::Color)}) {
+    writeStream(vertexData, mesh.colors, *stream);
+  }
+
+  // Index data
+  std::vector<std::byte> indexData(header.indexSize * mesh.indices.size());
+  if (header.indexSize == 2) {
+    for (auto &&[position, index] : iter::enumerate(mesh.indices)) {
+      auto const index16{gsl::narrow_cast<uint16_t>(index)};
+      std::memcpy(indexData.data() + position * 2, // NOLINT
+                  &index16, sizeof(index16));
+    }
+  } else {
+    std::memcpy(indexData.data(), mesh.indices.data(), indexData.size());
+  }
+
+  header.vertexDataOffset = align(sizeof(MeshFileHeader));
+  header.vertexDataSize = vertexData.size();
+  header.indexDataOffset = align(header.vertexDataOffset + vertexData.size());
+  header.indexDataSize = indexData.size();
+
+  std::ofstream stream{std::filesystem::path{path}, std::ios::binary};
+  std::array<char, meshAlignment> const padding{};
+  auto const write{[&stream, &padding](void const *data, std::size_t size) {
+    stream.write(static_cast<char const *>(data),
+                 gsl::narrow<std::streamsize>(size));
+    // Pad to the next multiple of the alignment
+    stream.write(padding.data(),
+                 gsl::narrow<std::streamsize>(align(size) - size));
+  }};
+  write(&header, sizeof(header));
+  write(vertexData.data(), vertexData.size());
+  write(indexData.data(), indexData.size());
+  if (!stream) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to write mesh file {}", path));
+  }
+}
+
+/**
+ * @brief Loads a triangle mesh from an OBJ file.
+ *
+ * Faces are triangulated, and each distinct combination of position, normal
+ * and texture coordinate indices of a shape becomes a vertex. The
+ * deduplication uses an open-addressing hash table per shape, and shapes are
+ * processed in parallel. Vertices are not shared between shapes.
+ *
+ * Normals and texture coordinates are loaded only if all faces have them.
+ * Colors are loaded only if all positions have them.
+ *
+ * @param path Path to the OBJ file.
+ * @param optimizeForVertexCache Whether to reorder the triangles and vertices
+ * with abcg::optimizeVertexCache.
+ *
+ * @return Mesh data of all shapes of the file.
+ *
+ * @throw abcg::RuntimeError if the file could not be loaded or has invalid
+ * indices.
+ */
+abcg::MeshData abcg::loadOBJ(std::string_view path,
+                             bool optimizeForVertexCache) {
+  tinyobj::ObjReaderConfig config;
+  config.vertex_color = false;
+  tinyobj::ObjReader reader;
+  if (!reader.ParseFromFile(std::string{path}, config)) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to load OBJ file {} ({})", path, reader.Error()));
+  }
+  if (!reader.Warning().empty()) {
+    fmt::print("Warning: {}\n", reader.Warning());
+  }
+
+  auto const &attrib{reader.GetAttrib()};
+  auto const &shapes{reader.GetShapes()};
+
+  std::vector<ShapeMesh> shapeMeshes(shapes.size());
+  parallelFor(shapes.size(), [&shapes, &shapeMeshes](std::size_t index) {
+    shapeMeshes[index] = deduplicate(shapes[index].mesh.indices);
+  });
+
+  // Offsets of the vertices and indices of each shape in the mesh
+  std::vector<std::size_t> vertexOffsets(shapes.size() + 1);
+  std::vector<std::size_t> indexOffsets(shapes.size() + 1);
+  auto hasNormals{!attrib.normals.empty()};
+  auto hasTexCoords{!attrib.texcoords.empty()};
+  for (auto &&[index, shape] : iter::enumerate(shapeMeshes)) {
+    vertexOffsets[index + 1] = vertexOffsets[index] + shape.vertices.size();
+    indexOffsets[index + 1] = indexOffsets[index] + shape.indices.size();
+    hasNormals = hasNormals && shape.hasNormals;
+    hasTexCoords = hasTexCoords && shape.hasTexCoords;
+  }
+  auto const hasColors{!attrib.colors.empty()};
+
+  MeshData mesh;
+  auto const vertexCount{vertexOffsets.back()};
+  mesh.positions.resize(vertexCount);
+  mesh.normals.resize(hasNormals ? vertexCount : 0);
+  mesh.texCoords.resize(hasTexCoords ? vertexCount : 0);
+  mesh.colors.resize(hasColors ? vertexCount : 0);
+  mesh.indices.resize(indexOffsets.back());
+
+  std::atomic<bool> valid{true};
+  parallelFor(shapes.size(), [&](std::size_t shapeIndex) {
+    auto const &shape{shapeMeshes[shapeIndex]};
+    auto const vertexOffset{vertexOffsets[shapeIndex]};
+    for (auto &&[index, vertex] : iter::enumerate(shape.vertices)) {
+      auto const target{vertexOffset + index};
+      auto isValid{fetch(attrib.vertices, vertex.vertex_index,
+                         mesh.positions[target])};
+      if (hasNormals) {
+        isValid = isValid && fetch(attrib.normals, vertex.normal_index,
+                                   mesh.normals[target]);
+      }
+      if (hasTexCoords) {
+        isValid = isValid && fetch(attrib.texcoords, vertex.texcoord_index,
+                                   mesh.texCoords[target]);
+      }
+      if (hasColors) {
+        glm::vec3 color{};
+        isValid = isValid && fetch(attrib.colors, vertex.vertex_index, color);
+        mesh.colors[target] = glm::vec4{color, 1.0f};
+      }
+      if (!isValid) {
+        valid = false;
+        return;
+      }
+    }
+    std::ranges::transform(
+        shape.indices, std::next(mesh.indices.begin(),
+                                 gsl::narrow<std::ptrdiff_t>(
+                                     indexOffsets[shapeIndex])),
+        [vertexOffset](uint32_t index) {
+          return gsl::narrow_cast<uint32_t>(index + vertexOffset);
+        });
+  });
+  if (!valid) {
+    throw abcg::RuntimeError(
+        fmt::format("Invalid vertex index in OBJ file {}", path));
+  }
+
+  if (optimizeForVertexCache) {
+    optimizeVertexCache(mesh);
+  }
+  return mesh;
+}
+
+/**
+ * @brief Reorders the triangles and vertices of a mesh for the
+ * post-transform vertex cache.
+ *
+ * Triangles are reordered with the Tipsify algorithm (Sander, Nehab and
+ * Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced
+ * Overdraw", 2007), assuming a cache of 16 vertices. Vertices are then sorted
+ * in the order they are first referenced, which improves the locality of
+ * vertex fetches. Vertices not referenced by any triangle are removed.
+ *
+ * @param mesh Mesh data to be modified in place.
+ *
+ * @throw abcg::RuntimeError if the number of indices is not a multiple of 3,
+ * or if an index is out of range.
+ */
+void abcg::optimizeVertexCache(MeshData &mesh) {
+  auto const vertexCount{mesh.positions.size()};
+  auto const triangleCount{mesh.indices.size() / 3};
+  if (mesh.indices.size() % 3 != 0) {
+    throw abcg::RuntimeError("Number of indices is not a multiple of 3");
+  }
+  if (std::ranges::any_of(mesh.indices, [vertexCount](auto index) {
+        return index >= vertexCount;
+      })) {
+    throw abcg::RuntimeError("Mesh index out of range");
+  }
+
+  // Number of triangles not yet emitted that use each vertex
+  std::vector<uint32_t> liveCounts(vertexCount);
+  for (auto const index : mesh.indices) {
+    ++liveCounts[index];
+  }
+
+  // Triangles adjacent to each vertex, in compressed rows
+  std::vector<std::size_t> adjacencyOffsets(vertexCount + 1);
+  for (auto const vertex : iter::range(vertexCount)) {
+    adjacencyOffsets[vertex + 1] =
+        adjacencyOffsets[vertex] + liveCounts[vertex];
+  }
+  std::vector<uint32_t> adjacency(mesh.indices.size());
+  {
+    auto cursors{adjacencyOffsets};
+    for (auto &&[corner, index] : iter::enumerate(mesh.indices)) {
+      adjacency[cursors[index]++] = gsl::narrow_cast<uint32_t>(corner / 3);
+    }
+  }
+
+  std::vector<std::size_t> timestamps(vertexCount);
+  std::vector<bool> emitted(triangleCount);
+  std::vector<uint32_t> deadEnds;
+  std::vector<uint32_t> candidates;
+  std::vector<uint32_t> indices;
+  indices.reserve(mesh.indices.size());
+  auto time{vertexCacheSize + 1};
+  std::size_t nextInputVertex{};
+
+  // Returns the most recently referenced vertex that still has triangles to
+  // emit, or the next such vertex in input order
+  auto const skipDeadEnd{[&]() -> std::optional<uint32_t> {
+    while (!deadEnds.empty()) {
+      auto const vertex{deadEnds.back()};
+      deadEnds.pop_back();
+      if (liveCounts[vertex] > 0) {
+        return vertex;
+      }
+    }
+    for (; nextInputVertex < vertexCount; ++nextInputVertex) {
+      if (liveCounts[nextInputVertex] > 0) {
+        return gsl::narrow_cast<uint32_t>(nextInputVertex);
+      }
+    }
+    return std::nullopt;
+  }};
+
+  auto fanningVertex{skipDeadEnd()};
+  while (fanningVertex) {
+    // Emit the remaining triangles around the fanning vertex
+    candidates.clear();
+    for (auto const adjacencyIndex :
+         iter::range(adjacencyOffsets[*fanningVertex],
+                     adjacencyOffsets[*fanningVertex + 1])) {
+      auto const triangle{adjacency[adjacencyIndex]};
+      if (emitted[triangle]) {
+        continue;
+      }
+      emitted[triangle] = true;
+      for (auto const corner : iter::range(3U)) {
+        auto const vertex{mesh.indices[triangle * 3U + corner]};
+        indices.push_back(vertex);
+        deadEnds.push_back(vertex);
+        candidates.push_back(vertex);
+        --liveCounts[vertex];
+        if (time - timestamps[vertex] > vertexCacheSize) {
+          timestamps[vertex] = time++;
+        }
+      }
+    }
+
+    // The next fanning vertex is the oldest candidate that will still be in
+    // the cache after its remaining triangles are emitted
+    std::optional<uint32_t> nextVertex;
+    std::size_t bestPriority{};
+    for (auto const vertex : candidates) {
+      if (liveCounts[vertex] == 0) {
+        continue;
+      }
+      auto const age{time - timestamps[vertex]};
+      auto const priority{age + 2 * std::size_t{liveCounts[vertex]} <=
+                                  vertexCacheSize
+                              ? age
+                              : 0};
+      if (!nextVertex || priority > bestPriority) {
+        nextVertex = vertex;
+        bestPriority = priority;
+      }
+    }
+    fanningVertex = nextVertex ? nextVertex : skipDeadEnd();
+  }
+
+  // Renumber the vertices in the order of first reference
+  constexpr auto unreferenced{std::numeric_limits<uint32_t>::max()};
+  std::vector<uint32_t> remap(vertexCount, unreferenced);
+  uint32_t referencedCount{};
+  for (auto &index : indices) {
+    if (remap[index] == unreferenced) {
+      remap[index] = referencedCount++;
+    }
+    index = remap[index];
+  }
+  auto const reorder{[&remap, referencedCount](auto &elements) {
+    if (elements.empty()) {
+      return;
+    }
+    std::remove_reference_t<decltype(elements)> reordered(referencedCount);
+    for (auto &&[index, element] : iter::enumerate(elements)) {
+      if (remap[index] != unreferenced) {
+        reordered[remap[index]] = element;
+      }
+    }
+    elements = std::move(reordered);
+  }};
+  reorder(mesh.positions);
+  reorder(mesh.normals);
+  reorder(mesh.texCoords);
+  reorder(mesh.colors);
+  mesh.indices = std::move(indices);
+}
+
+/**
+ * @brief Destructor. Unmaps the file.
+ */
+abcg::MeshFile::~MeshFile() { close(); }
+
+/**
+ * @brief Maps a mesh file into memory.
+ *
+ * The file is mapped read-only. The indices are read once to check that they
+ * refer to existing vertices, so that they can be safely used for drawing. The
+ * vertex data is not read until it is accessed, e.g., when it is copied to a
+ * buffer.
+ *
+ * @param path Path to the file.
+ *
+ * @throw abcg::RuntimeError if the file could not be mapped, or if it is not
+ * a valid mesh file.
+ */
+void abcg::MeshFile::open(std::string_view path) {
+  close();
+
+  std::string const pathString{path};
+#if defined(_WIN32)
+  m_file = CreateFileA(pathString.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                       nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  LARGE_INTEGER fileSize{};
+  if (m_file == INVALID_HANDLE_VALUE || GetFileSizeEx(m_file, &fileSize) == 0) {
+    m_file = nullptr;
+    throw abcg::RuntimeError(fmt::format("Failed to open mesh file {}", path));
+  }
+  m_mapping =
+      CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  void const *address{m_mapping != nullptr
+                          ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)
+                          : nullptr};
+  if (address == nullptr) {
+    close();
+    throw abcg::RuntimeError(fmt::format("Failed to map mesh file {}", path));
+  }
+  m_data = {static_cast<std::byte const *>(address),
+            gsl::narrow<std::size_t>(fileSize.QuadPart)};
+#else
+  auto const fileDescriptor{::open(pathString.c_str(), O_RDONLY)}; // NOLINT
+  struct stat status {};
+  if (fileDescriptor < 0 || fstat(fileDescriptor, &status) != 0) {
+    if (fileDescriptor >= 0) {
+      ::close(fileDescriptor);
+    }
+    throw abcg::RuntimeError(fmt::format("Failed to open mesh file {}", path));
+  }
+  auto const fileSize{gsl::narrow<std::size_t>(status.st_size)};
+  void *address{fileSize > 0 ? mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE,
+                                    fileDescriptor, 0)
+                             : MAP_FAILED}; // NOLINT
+  // The mapping remains valid after closing the file
+  ::close(fileDescriptor);
+  if (address == MAP_FAILED) { // NOLINT
+    throw abcg::RuntimeError(fmt::format("Failed to map mesh file {}", path));
+  }
+  m_data = {static_cast<std::byte const *>(address), fileSize};
+#endif
+
+  // Validate the header and the location of the data
+  auto const isValid{[this] {
+    if (m_data.size() < sizeof(MeshFileHeader)) {
+      return false;
+    }
+    std::memcpy(&m_header, m_data.data(), sizeof(MeshFileHeader));
+    auto const isInside{[this](uint64_t offset, uint64_t size) {
+      return offset <= m_data.size() && size <= m_data.size() - offset;
+    }};
+    return m_header.magic == meshMagic && m_header.version == meshVersion &&
+           hasAttribute(m_header.attributes, MeshAttribute::Position) &&
+           (m_header.indexSize == 2 || m_header.indexSize == 4) &&
+           m_header.vertexDataOffset % meshAlignment == 0 &&
+           m_header.indexDataOffset % meshAlignment == 0 &&
+           m_header.vertexDataSize == getVertexDataSize(m_header) &&
+           m_header.indexDataSize ==
+               uint64_t{m_header.indexSize} * m_header.indexCount &&
+           isInside(m_header.vertexDataOffset, m_header.vertexDataSize) &&
+           isInside(m_header.indexDataOffset, m_header.indexDataSize) &&
+           (m_header.indexSize == 2
+                ? areIndicesValid<uint16_t>(getIndexData(), m_header.vertexCount)
+                : areIndicesValid<uint32_t>(getIndexData(),
+                                            m_header.vertexCount));
+  }};
+  if (!isValid()) {
+    close();
+    throw abcg::RuntimeError(fmt::format("Invalid mesh file {}", path));
+  }
+}
+
+/**
+ * @brief Unmaps the file.
+ *
+ * Spans returned by abcg::MeshFile::getVertexData and
+ * abcg::MeshFile::getIndexData are invalidated.
+ */
+void abcg::MeshFile::close() {
+#if defined(_WIN32)
+  if (!m_data.empty()) {
+    UnmapViewOfFile(m_data.data());
+  }
+  if (m_mapping != nullptr) {
+    CloseHandle(m_mapping);
+    m_mapping = nullptr;
+  }
+  if (m_file != nullptr) {
+    CloseHandle(m_file);
+    m_file = nullptr;
+  }
+#else
+  if (!m_data.empty()) {
+    munmap(const_cast<std::byte *>(m_data.data()), // NOLINT
+           m_data.size());
+  }
+#endif
+  m_data = {};
+  m_header = {};
+}
+
+/**
+ * @brief Returns the header of the file.
+ *
+ * @return Header of the file, or a zero-initialized header if no file is
+ * mapped.
+ */
+abcg::MeshFileHeader const &abcg::MeshFile::getHeader() const noexcept {
+  return m_header;
+}
+
+/**
+ * @brief Returns the vertex data.
+ *
+ * @return View of the vertex data in the mapped file.
+ *
+ * @sa abcg::MeshFile::getStream for the layout of the vertex attributes.
+ */
+std::span<std::byte const> abcg::MeshFile::getVertexData() const noexcept {
+  if (m_data.empty()) {
+    return {};
+  }
+  return m_data.subspan(
+      gsl::narrow_cast<std::size_t>(m_header.vertexDataOffset),
+      gsl::narrow_cast<std::size_t>(m_header.vertexDataSize));
+}
+
+/**
+ * @brief Returns the index data.
+ *
+ * @return View of the index data in the mapped file, as 16-bit or 32-bit
+ * unsigned integers according to abcg::MeshFileHeader::indexSize.
+ */
+std::span<std::byte const> abcg::MeshFile::getIndexData() const noexcept {
+  if (m_data.empty()) {
+    return {};
+  }
+  return m_data.subspan(
+      gsl::narrow_cast<std::size_t>(m_header.indexDataOffset),
+      gsl::narrow_cast<std::size_t>(m_header.indexDataSize));
+}
+
+/**
+ * @brief Returns the location of a vertex attribute in the vertex data.
+ *
+ * @param attribute Vertex attribute.
+ *
+ * @return Location of the attribute, or `std::nullopt` if the vertices do not
+ * have the attribute.
+ */
+std::optional<abcg::MeshStream>
+abcg::MeshFile::getStream(MeshAttribute attribute) const noexcept {
+  return getStream(m_header, attribute);
+}
+
+/**
+ * @brief Returns the location of a vertex attribute in the vertex data
+ * described by a header.
+ *
+ * @param header Header of a mesh file.
+ * @param attribute Vertex attribute.
+ *
+ * @return Location of the attribute, or `std::nullopt` if the vertices do not
+ * have the attribute.
+ */
+std::optional<abcg::MeshStream>
+abcg::MeshFile::getStream(MeshFileHeader const &header,
+                          MeshAttribute attribute) noexcept {
+  if (!hasAttribute(header.attributes, attribute)) {
+    return std::nullopt;
+  }
+
+  std::size_t offset{};
+  for (auto const &[current, components] : meshAttributes) {
+    if (!hasAttribute(header.attributes, current)) {
+      continue;
+    }
+    auto const size{components * sizeof(float)};
+    if (header.interleaved == 0) {
+      offset = align(offset);
+    }
+    if (current == attribute) {
+      return MeshStream{.offset = offset,
+                        .stride = header.interleaved != 0
+                                      ? getVertexSize(header.attributes)
+                                      : size,
+                        .components = components};
+    }
+    offset += header.interleaved != 0 ? size : size * header.vertexCount;
+  }
+  return std::nullopt;
+}
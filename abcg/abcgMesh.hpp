@@ -0,0 +1,163 @@
+/**
+ * @file abcgMesh.hpp
+ * @brief Declaration of the ABCg binary mesh format.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_MESH_HPP_
+#define ABCG_MESH_HPP_
+
+#include "abcgExternal.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace abcg {
+enum class MeshAttribute : uint32_t;
+struct MeshFileHeader;
+struct MeshStream;
+struct MeshData;
+class MeshFile;
+
+void saveMesh(std::string_view path, MeshData const &mesh,
+              bool interleaved = true);
+MeshData loadOBJ(std::string_view path, bool optimizeForVertexCache = false);
+void optimizeVertexCache(MeshData &mesh);
+} // namespace abcg
+
+/**
+ * @brief Vertex attributes of a mesh.
+ *
+ * All attributes are stored as 32-bit floats. Attributes are laid out in the
+ * order of their enumerators, both within an interleaved vertex and in the
+ * sequence of de-interleaved streams.
+ */
+enum class abcg::MeshAttribute : uint32_t {
+  /** @brief 3D position (3 floats). */
+  Position = 1U << 0U,
+  /** @brief Normal vector (3 floats). */
+  Normal = 1U << 1U,
+  /** @brief Texture coordinates (2 floats). */
+  TexCoord = 1U << 2U,
+  /** @brief RGBA color (4 floats). */
+  Color = 1U << 3U
+};
+
+/**
+ * @brief Header of a mesh file.
+ *
+ * The header is stored at the beginning of the file, in little-endian byte
+ * order. It is followed by the vertex data and the index data, each starting
+ * at a multiple of 16 bytes.
+ */
+struct abcg::MeshFileHeader {
+  /** @brief File identifier (`"ABCGMESH"`). */
+  std::array<char, 8> magic{};
+  /** @brief Version of the file format. */
+  uint32_t version{};
+  /** @brief Bitwise OR of the abcg::MeshAttribute values of the vertices. */
+  uint32_t attributes{};
+  /** @brief Whether the attributes are interleaved (1) or stored as one
+   * stream per attribute (0). */
+  uint32_t interleaved{};
+  /** @brief Size of an index in bytes (2 or 4). */
+  uint32_t indexSize{};
+  /** @brief Number of vertices. */
+  uint32_t vertexCount{};
+  /** @brief Number of indices. */
+  uint32_t indexCount{};
+  /** @brief Minimum corner of the axis-aligned bounding box. */
+  glm::vec3 boundsMin{};
+  /** @brief Maximum corner of the axis-aligned bounding box. */
+  glm::vec3 boundsMax{};
+  /** @brief Offset of the vertex data from the beginning of the file. */
+  uint64_t vertexDataOffset{};
+  /** @brief Size of the vertex data in bytes. */
+  uint64_t vertexDataSize{};
+  /** @brief Offset of the index data from the beginning of the file. */
+  uint64_t indexDataOffset{};
+  /** @brief Size of the index data in bytes. */
+  uint64_t indexDataSize{};
+};
+
+/**
+ * @brief Location of a vertex attribute in the vertex data of a mesh.
+ */
+struct abcg::MeshStream {
+  /** @brief Offset in bytes of the attribute of the first vertex. */
+  std::size_t offset{};
+  /** @brief Distance in bytes between the attributes of consecutive
+   * vertices. */
+  std::size_t stride{};
+  /** @brief Number of float components of the attribute. */
+  std::size_t components{};
+};
+
+/**
+ * @brief Indexed triangle mesh, as loaded with abcg::loadOBJ or written with
+ * abcg::saveMesh.
+ *
+ * Optional attributes are either empty or have the same number of elements
+ * as `positions`.
+ */
+struct abcg::MeshData {
+  /** @brief Vertex positions. */
+  std::vector<glm::vec3> positions;
+  /** @brief Vertex normals (optional). */
+  std::vector<glm::vec3> normals;
+  /** @brief Vertex texture coordinates (optional). */
+  std::vector<glm::vec2> texCoords;
+  /** @brief Vertex colors (optional). */
+  std::vector<glm::vec4> colors;
+  /** @brief Indices of the triangles. */
+  std::vector<uint32_t> indices;
+};
+
+/**
+ * @brief Read-only view of a mesh file mapped into memory.
+ *
+ * The vertex and index data can be copied directly to vertex and index
+ * buffers, without parsing.
+ *
+ * @sa abcg::saveMesh.
+ */
+class abcg::MeshFile {
+public:
+  MeshFile() = default;
+  MeshFile(MeshFile const &) = delete;
+  MeshFile(MeshFile &&) = delete;
+  MeshFile &operator=(MeshFile const &) = delete;
+  MeshFile &operator=(MeshFile &&) = delete;
+  ~MeshFile();
+
+  void open(std::string_view path);
+  void close();
+
+  [[nodiscard]] MeshFileHeader const &getHeader() const noexcept;
+  [[nodiscard]] std::span<std::byte const> getVertexData() const noexcept;
+  [[nodiscard]] std::span<std::byte const> getIndexData() const noexcept;
+  [[nodiscard]] std::optional<MeshStream>
+  getStream(MeshAttribute attribute) const noexcept;
+
+  [[nodiscard]] static std::optional<MeshStream>
+  getStream(MeshFileHeader const &header, MeshAttribute attribute) noexcept;
+
+private:
+  std::span<std::byte const> m_data;
+  MeshFileHeader m_header{};
+#if defined(_WIN32)
+  void *m_file{};
+  void *m_mapping{};
+#endif
+};
+
+#endif
@@ -0,0 +1,483 @@
+/**
+ * @file abcgMeshLOD.cpp
+ * @brief Definition of mesh simplification and level-of-detail selection.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgMeshLOD.hpp"
+
+#include <cppitertools/itertools.hpp>
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <queue>
+
+#include "abcgException.hpp"
+
+namespace {
+// Symmetric 4x4 matrix of the quadric error metric of Garland and Heckbert,
+// stored as its upper triangle, and the sum of the areas of its planes
+struct Quadric {
+  std::array<double, 10> coefficients{};
+  double weight{};
+
+  // Adds the squared distance to the plane dot(normal, x) + offset = 0,
+  // weighted by area
+  void addPlane(glm::dvec3 const &normal, double offset, double area) {
+    std::array const plane{normal.x, normal.y, normal.z, offset};
+    std::size_t coefficient{};
+    for (auto const row : iter::range(plane.size())) {
+      for (auto const column : iter::range(row, plane.size())) {
+        coefficients.at(coefficient++) +=
+            area * plane.at(row) * plane.at(column);
+      }
+    }
+    weight += area;
+  }
+
+  Quadric &operator+=(Quadric const &other) {
+    for (auto &&[coefficient, otherCoefficient] :
+         iter::zip(coefficients, other.coefficients)) {
+      coefficient += otherCoefficient;
+    }
+    weight += other.weight;
+    return *this;
+  }
+
+  // Returns the mean squared distance of a point to the planes
+  [[nodiscard]] double evaluate(glm::dvec3 const &point) const {
+    auto const &[aa, ab, ac, ad, bb, bc, bd, cc, cd, dd]{coefficients};
+    auto const [x, y, z]{std::array{point.x, point.y, point.z}};
+    auto const error{aa * x * x + 2 * ab * x * y + 2 * ac * x * z +
+                     2 * ad * x + bb * y * y + 2 * bc * y * z + 2 * bd * y +
+                     cc * z * z + 2 * cd * z + dd};
+    return std::max(error, 0.0) /
+           std::max(weight, std::numeric_limits<double>::min());
+  }
+};
+
+// Collapse of the vertex `from` onto the vertex `to`. The versions of the
+// vertices identify outdated collapses
+struct Collapse {
+  double cost{};
+  uint32_t from{};
+  uint32_t to{};
+  uint32_t fromVersion{};
+  uint32_t toVersion{};
+
+  bool operator>(Collapse const &other) const { return cost > other.cost; }
+};
+
+// Simplifies a mesh with half-edge collapses in order of increasing quadric
+// error. Vertices are never moved or created, so the simplified mesh indexes
+// the vertices of the original mesh
+class Simplifier {
+public:
+  explicit Simplifier(abcg::MeshData const &mesh);
+
+  void simplify(std::size_t targetTriangleCount);
+
+  [[nodiscard]] std::vector<uint32_t> getIndices() const;
+  [[nodiscard]] std::size_t getTriangleCount() const noexcept {
+    return m_triangleCount;
+  }
+  [[nodiscard]] float getError() const noexcept {
+    return gsl::narrow_cast<float>(std::sqrt(m_maxCost));
+  }
+
+private:
+  [[nodiscard]] std::vector<uint32_t> getNeighbors(uint32_t vertex) const;
+  [[nodiscard]] bool isValid(Collapse const &collapse) const;
+  void pushCollapse(uint32_t first, uint32_t second);
+  void pushCollapses(uint32_t vertex);
+  void collapse(Collapse const &collapse);
+
+  std::vector<glm::vec3> const &m_positions;
+  std::vector<uint32_t> m_indices;
+  std::vector<bool> m_aliveTriangles;
+  std::vector<std::vector<uint32_t>> m_vertexTriangles;
+  std::vector<Quadric> m_quadrics;
+  std::vector<bool> m_locked;
+  std::vector<uint32_t> m_versions;
+  std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>>
+      m_collapses;
+  std::size_t m_triangleCount{};
+  double m_maxCost{};
+};
+
+Simplifier::Simplifier(abcg::MeshData const &mesh)
+    : m_positions{mesh.positions}, m_indices{mesh.indices},
+      m_aliveTriangles(mesh.indices.size() / 3, true),
+      m_vertexTriangles(mesh.positions.size()),
+      m_quadrics(mesh.positions.size()), m_locked(mesh.positions.size()),
+      m_versions(mesh.positions.size()),
+      m_triangleCount{mesh.indices.size() / 3} {
+  std::vector<uint64_t> edges;
+  edges.reserve(m_indices.size());
+  for (auto const triangle : iter::range(m_triangleCount)) {
+    std::array<uint32_t, 3> const vertices{m_indices[triangle * 3],
+                                           m_indices[triangle * 3 + 1],
+                                           m_indices[triangle * 3 + 2]};
+    glm::dvec3 const p0{m_positions[vertices[0]]};
+    auto const cross{glm::cross(glm::dvec3{m_positions[vertices[1]]} - p0,
+                                glm::dvec3{m_positions[vertices[2]]} - p0)};
+    auto const length{glm::length(cross)};
+    Quadric quadric;
+    if (length > 0.0) {
+      auto const normal{cross / length};
+      quadric.addPlane(normal, -glm::dot(normal, p0), length / 2);
+    }
+
+    for (auto const corner : iter::range(vertices.size())) {
+      auto const vertex{vertices.at(corner)};
+      auto const next{vertices.at((corner + 1) % vertices.size())};
+      m_vertexTriangles[vertex].push_back(
+          gsl::narrow_cast<uint32_t>(triangle));
+      m_quadrics[vertex] += quadric;
+      edges.push_back(uint64_t{std::min(vertex, next)} << 32U |
+                      std::max(vertex, next));
+    }
+  }
+
+  // Vertices of border and non-manifold edges are locked, so that borders,
+  // and seams of vertices split by attributes, are preserved
+  std::ranges::sort(edges);
+  for (auto first{edges.begin()}; first != edges.end();) {
+    auto const last{std::find_if(first, edges.end(), [first](uint64_t edge) {
+      return edge != *first;
+    })};
+    if (std::distance(first, last) != 2) {
+      m_locked[gsl::narrow_cast<std::size_t>(*first >> 32U)] = true;
+      m_locked[gsl::narrow_cast<std::size_t>(*first & 0xFFFFFFFFU)] = true;
+    }
+    first = last;
+  }
+
+  auto const duplicates{std::ranges::unique(edges)};
+  edges.erase(duplicates.begin(), duplicates.end());
+  for (auto const edge : edges) {
+    pushCollapse(gsl::narrow_cast<uint32_t>(edge >> 32U),
+                 gsl::narrow_cast<uint32_t>(edge & 0xFFFFFFFFU));
+  }
+}
+
+// Collapses edges until the number of triangles is at most the target, or
+// until there are no valid collapses left
+void Simplifier::simplify(std::size_t targetTriangleCount) {
+  while (m_triangleCount > targetTriangleCount && !m_collapses.empty()) {
+    auto const next{m_collapses.top()};
+    m_collapses.pop();
+    if (isValid(next)) {
+      collapse(next);
+    }
+  }
+}
+
+std::vector<uint32_t> Simplifier::getIndices() const {
+  std::vector<uint32_t> indices;
+  indices.reserve(m_triangleCount * 3);
+  for (auto &&[triangle, alive] : iter::enumerate(m_aliveTriangles)) {
+    if (alive) {
+      auto const first{std::next(m_indices.begin(),
+                                 gsl::narrow<std::ptrdiff_t>(triangle * 3))};
+      indices.insert(indices.end(), first, std::next(first, 3));
+    }
+  }
+  return indices;
+}
+
+// Returns the sorted vertices that share a triangle with a vertex
+std::vector<uint32_t> Simplifier::getNeighbors(uint32_t vertex) const {
+  std::vector<uint32_t> neighbors;
+  for (auto const triangle : m_vertexTriangles[vertex]) {
+    if (!m_aliveTriangles[triangle]) {
+      continue;
+    }
+    for (auto const corner : iter::range(3U)) {
+      auto const neighbor{m_indices[triangle * 3U + corner]};
+      if (neighbor != vertex) {
+        neighbors.push_back(neighbor);
+      }
+    }
+  }
+  std::ranges::sort(neighbors);
+  auto const duplicates{std::ranges::unique(neighbors)};
+  neighbors.erase(duplicates.begin(), duplicates.end());
+  return neighbors;
+}
+
+// A collapse is valid if it is up to date, keeps the mesh manifold, and does
+// not flip the orientation of the remaining triangles
+bool Simplifier::isValid(Collapse const &collapse) const {
+  if (m_versions[collapse.from] != collapse.fromVersion ||
+      m_versions[collapse.to] != collapse.toVersion) {
+    return false;
+  }
+
+  // Link condition: the common neighbors of the vertices must be the
+  // opposite vertices of the triangles of the edge
+  auto const fromNeighbors{getNeighbors(collapse.from)};
+  auto const toNeighbors{getNeighbors(collapse.to)};
+  std::vector<uint32_t> commonNeighbors;
+  std::ranges::set_intersection(fromNeighbors, toNeighbors,
+                                std::back_inserter(commonNeighbors));
+
+  std::size_t edgeTriangleCount{};
+  for (auto const triangle : m_vertexTriangles[collapse.from]) {
+    if (!m_aliveTriangles[triangle]) {
+      continue;
+    }
+    auto const first{triangle * 3U};
+    std::array<glm::vec3, 3> positions{};
+    auto sharesEdge{false};
+    for (auto const corner : iter::range(3U)) {
+      auto const vertex{m_indices[first + corner]};
+      sharesEdge = sharesEdge || vertex == collapse.to;
+      positions.at(corner) = m_positions[vertex];
+    }
+    if (sharesEdge) {
+      ++edgeTriangleCount;
+      continue;
+    }
+
+    auto const normal{glm::cross(positions[1] - positions[0],
+                                 positions[2] - positions[0])};
+    for (auto const corner : iter::range(3U)) {
+      if (m_indices[first + corner] == collapse.from) {
+        positions.at(corner) = m_positions[collapse.to];
+      }
+    }
+    auto const collapsedNormal{glm::cross(positions[1] - positions[0],
+                                          positions[2] - positions[0])};
+    if (glm::dot(normal, collapsedNormal) <= 0.0f) {
+      return false;
+    }
+  }
+  return commonNeighbors.size() == edgeTriangleCount;
+}
+
+// Pushes the cheapest collapse of the edge between two vertices, if any of
+// them is not locked
+void Simplifier::pushCollapse(uint32_t first, uint32_t second) {
+  auto quadric{m_quadrics[first]};
+  quadric += m_quadrics[second];
+
+  std::optional<Collapse> cheapest;
+  for (auto const &[from, to] : {std::pair{first, second},
+                                 std::pair{second, first}}) {
+    if (m_locked[from]) {
+      continue;
+    }
+    auto const cost{quadric.evaluate(m_positions[to])};
+    if (!cheapest || cost < cheapest->cost) {
+      cheapest = Collapse{.cost = cost,
+                          .from = from,
+                          .to = to,
+                          .fromVersion = m_versions[from],
+                          .toVersion = m_versions[to]};
+    }
+  }
+  if (cheapest) {
+    m_collapses.push(*cheapest);
+  }
+}
+
+void Simplifier::pushCollapses(uint32_t vertex) {
+  for (auto const neighbor : getNeighbors(vertex)) {
+    pushCollapse(vertex, neighbor);
+  }
+}
+
+void Simplifier::collapse(Collapse const &collapse) {
+  auto &toTriangles{m_vertexTriangles[collapse.to]};
+  for (auto const triangle : m_vertexTriangles[collapse.from]) {
+    if (!m_aliveTriangles[triangle]) {
+      continue;
+    }
+    auto const first{std::next(m_indices.begin(),
+                               gsl::narrow_cast<std::ptrdiff_t>(triangle) * 3)};
+    auto const last{std::next(first, 3)};
+    if (std::find(first, last, collapse.to) != last) {
+      // Triangles of the collapsed edge become degenerate
+      m_aliveTriangles[triangle] = false;
+      --m_triangleCount;
+    } else {
+      std::replace(first, last, collapse.from, collapse.to);
+      toTriangles.push_back(triangle);
+    }
+  }
+  std::erase_if(toTriangles, [this](uint32_t triangle) {
+    return !m_aliveTriangles[triangle];
+  });
+  m_vertexTriangles[collapse.from] = {};
+
+  m_quadrics[collapse.to] += m_quadrics[collapse.from];
+  ++m_versions[collapse.from];
+  ++m_versions[collapse.to];
+  m_maxCost = std::max(m_maxCost, collapse.cost);
+
+  pushCollapses(collapse.to);
+}
+} // namespace
+
+/**
+ * @brief Generates a chain of levels of detail of a mesh.
+ *
+ * The mesh is simplified by collapsing edges in order of increasing quadric
+ * error (Garland and Heckbert, "Surface Simplification Using Quadric Error
+ * Metrics", 1997). Each edge collapse merges one vertex onto the other, so
+ * all levels index the vertices of the original mesh.
+ *
+ * Vertices of border edges are not collapsed. This includes vertices split
+ * by distinct normals or texture coordinates, as these form borders in the
+ * connectivity of the triangles. Thus, meshes with many attribute seams
+ * cannot be simplified as much as smooth, connected meshes.
+ *
+ * @param mesh Mesh data of the most detailed level.
+ * @param levelCount Maximum number of levels, including the original mesh.
+ * @param reduction Ratio between the number of triangles of consecutive
+ * levels, in the range (0, 1).
+ *
+ * @return Levels of detail in decreasing order of detail, starting with the
+ * original mesh with zero error. Fewer than `levelCount` levels are returned
+ * if the mesh cannot be simplified further.
+ *
+ * @throw abcg::RuntimeError if the reduction is out of range, if the number
+ * of indices is not a multiple of 3, or if an index is out of range.
+ *
+ * @sa abcg::LODSelector for selecting a level.
+ */
+std::vector<abcg::MeshLOD>
+abcg::generateLODs(MeshData const &mesh, std::size_t levelCount,
+                   float reduction) {
+  if (reduction <= 0.0f || reduction >= 1.0f) {
+    throw abcg::RuntimeError("LOD reduction must be in the range (0, 1)");
+  }
+  if (mesh.indices.size() % 3 != 0) {
+    throw abcg::RuntimeError("Number of indices is not a multiple of 3");
+  }
+  if (std::ranges::any_of(mesh.indices, [&mesh](auto index) {
+        return index >= mesh.positions.size();
+      })) {
+    throw abcg::RuntimeError("Mesh index out of range");
+  }
+
+  std::vector<MeshLOD> levels;
+  if (levelCount == 0) {
+    return levels;
+  }
+  levels.push_back({.indices = mesh.indices, .error = 0.0f});
+
+  Simplifier simplifier{mesh};
+  auto targetTriangleCount{gsl::narrow_cast<double>(mesh.indices.size() / 3)};
+  while (levels.size() < levelCount) {
+    targetTriangleCount *= static_cast<double>(reduction);
+    auto const previousTriangleCount{simplifier.getTriangleCount()};
+    simplifier.simplify(gsl::narrow_cast<std::size_t>(targetTriangleCount));
+    if (simplifier.getTriangleCount() == previousTriangleCount) {
+      break;
+    }
+    levels.push_back(
+        {.indices = simplifier.getIndices(), .error = simplifier.getError()});
+  }
+  return levels;
+}
+
+/**
+ * @brief Sets the camera used to project the errors.
+ *
+ * @param viewMatrix View matrix of the camera.
+ * @param fieldOfViewY Vertical field of view of the perspective projection,
+ * in radians.
+ * @param viewportHeight Height of the viewport in pixels.
+ */
+void abcg::LODSelector::setCamera(glm::mat4 const &viewMatrix,
+                                  float fieldOfViewY, float viewportHeight) {
+  m_eye = glm::vec3{glm::inverse(viewMatrix)[3]};
+  m_projectionScale = viewportHeight / (2.0f * std::tan(fieldOfViewY / 2.0f));
+}
+
+/**
+ * @brief Sets the maximum projected error of a selected level.
+ *
+ * @param pixels Error threshold in pixels. The default is 1.
+ */
+void abcg::LODSelector::setErrorThreshold(float pixels) noexcept {
+  m_errorThreshold = pixels;
+}
+
+/**
+ * @brief Returns the maximum projected error of a selected level.
+ *
+ * @return Error threshold in pixels.
+ */
+float abcg::LODSelector::getErrorThreshold() const noexcept {
+  return m_errorThreshold;
+}
+
+/**
+ * @brief Returns the size in pixels of a geometric error at a distance from
+ * the camera.
+ *
+ * @param error Geometric error in world units.
+ * @param distance Distance from the camera in world units.
+ *
+ * @return Projected error in pixels, or infinity if the distance is not
+ * positive.
+ */
+float abcg::LODSelector::getProjectedError(float error,
+                                           float distance) const noexcept {
+  if (distance <= 0.0f) {
+    return std::numeric_limits<float>::infinity();
+  }
+  return error * m_projectionScale / distance;
+}
+
+/**
+ * @brief Selects the level of detail of a mesh to be drawn.
+ *
+ * The errors of the levels are scaled by the largest scale factor of the
+ * model matrix, and projected at the distance from the camera to the
+ * bounding sphere of the bounding box.
+ *
+ * @param levels Levels of detail in decreasing order of detail, as returned
+ * by abcg::generateLODs.
+ * @param modelMatrix Model matrix of the mesh.
+ * @param boundsMin Minimum corner of the bounding box of the mesh, in model
+ * space.
+ * @param boundsMax Maximum corner of the bounding box of the mesh, in model
+ * space.
+ *
+ * @return Index of the coarsest level whose projected error is within the
+ * threshold, or 0 if none is.
+ */
+std::size_t abcg::LODSelector::select(std::span<MeshLOD const> levels,
+                                      glm::mat4 const &modelMatrix,
+                                      glm::vec3 const &boundsMin,
+                                      glm::vec3 const &boundsMax) const {
+  auto const scale{std::max({glm::length(glm::vec3{modelMatrix[0]}),
+                             glm::length(glm::vec3{modelMatrix[1]}),
+                             glm::length(glm::vec3{modelMatrix[2]})})};
+  auto const center{
+      glm::vec3{modelMatrix * glm::vec4{(boundsMin + boundsMax) / 2.0f, 1.0f}}};
+  auto const radius{glm::length(boundsMax - boundsMin) / 2.0f * scale};
+  auto const distance{glm::length(center - m_eye) - radius};
+
+  for (auto level{levels.size()}; level > 1; --level) {
+    if (getProjectedError(levels[level - 1].error * scale, distance) <=
+        m_errorThreshold) {
+      return level - 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file abcgMeshLOD.hpp
+ * @brief Declaration of mesh simplification and level-of-detail selection.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_MESH_LOD_HPP_
+#define ABCG_MESH_LOD_HPP_
+
+#include "abcgMesh.hpp"
+
+#include <span>
+#include <vector>
+
+namespace abcg {
+struct MeshLOD;
+class LODSelector;
+
+std::vector<MeshLOD> generateLODs(MeshData const &mesh,
+                                  std::size_t levelCount = 4,
+                                  float reduction = 0.5f);
+} // namespace abcg
+
+/**
+ * @brief Level of detail of a mesh.
+ *
+ * All levels of a mesh index the same vertices, so they can share a single
+ * vertex buffer and differ only in their index buffers.
+ *
+ * @sa abcg::generateLODs.
+ */
+struct abcg::MeshLOD {
+  /** @brief Indices of the triangles of this level. */
+  std::vector<uint32_t> indices;
+  /** @brief Estimated geometric error with respect to the original mesh, in
+   * the units of the vertex positions. */
+  float error{};
+};
+
+/**
+ * @brief Selects levels of detail by their projected screen-space error.
+ *
+ * The selected level is the coarsest one whose geometric error, projected
+ * onto the viewport at the distance of the bounding sphere of the mesh, is
+ * at most the error threshold in pixels.
+ */
+class abcg::LODSelector {
+public:
+  void setCamera(glm::mat4 const &viewMatrix, float fieldOfViewY,
+                 float viewportHeight);
+  void setErrorThreshold(float pixels) noexcept;
+  [[nodiscard]] float getErrorThreshold() const noexcept;
+
+  [[nodiscard]] float getProjectedError(float error,
+                                        float distance) const noexcept;
+  [[nodiscard]] std::size_t select(std::span<MeshLOD const> levels,
+                                   glm::mat4 const &modelMatrix,
+                                   glm::vec3 const &boundsMin,
+                                   glm::vec3 const &boundsMax) const;
+
+private:
+  glm::vec3 m_eye{};
+  float m_projectionScale{1.0f};
+  float m_errorThreshold{1.0f};
+};
+
+#endif
@@ -15,7 +15,12 @@
 
 #include "abcg.hpp"
 #include "abcgOpenGLImage.hpp"
+#include "abcgOpenGLMesh.hpp"
+#include "abcgOpenGLProgramBuilder.hpp"
+#include "abcgOpenGLShapeBatch.hpp"
 #include "abcgOpenGLShader.hpp"
+#include "abcgOpenGLTextureLoader.hpp"
+#include "abcgOpenGLUploadRing.hpp"
 #include "abcgOpenGLWindow.hpp"
 
 #endif
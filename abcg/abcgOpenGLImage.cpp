@@ -15,8 +15,237 @@
 #include <fmt/core.h>
 #include <gsl/gsl>
 
+#include <algorithm>
+#include <vector>
+
 #include "abcgException.hpp"
 
+namespace {
+// Internal formats of block-compressed textures, defined by the
+// EXT_texture_compression_s3tc, EXT_texture_sRGB, ARB_texture_compression_rgtc,
+// ARB_texture_compression_bptc and ARB_ES3_compatibility extensions
+constexpr GLenum compressedRGBS3TCDXT1{0x83F0};
+constexpr GLenum compressedRGBAS3TCDXT1{0x83F1};
+constexpr GLenum compressedRGBAS3TCDXT3{0x83F2};
+constexpr GLenum compressedRGBAS3TCDXT5{0x83F3};
+constexpr GLenum compressedSRGBS3TCDXT1{0x8C4C};
+constexpr GLenum compressedSRGBAlphaS3TCDXT1{0x8C4D};
+constexpr GLenum compressedSRGBAlphaS3TCDXT3{0x8C4E};
+constexpr GLenum compressedSRGBAlphaS3TCDXT5{0x8C4F};
+constexpr GLenum compressedRedRGTC1{0x8DBB};
+constexpr GLenum compressedSignedRedRGTC1{0x8DBC};
+constexpr GLenum compressedRGRGTC2{0x8DBD};
+constexpr GLenum compressedSignedRGRGTC2{0x8DBE};
+constexpr GLenum compressedRGBABPTCUnorm{0x8E8C};
+constexpr GLenum compressedSRGBAlphaBPTCUnorm{0x8E8D};
+constexpr GLenum compressedRGBBPTCSignedFloat{0x8E8E};
+constexpr GLenum compressedRGBBPTCUnsignedFloat{0x8E8F};
+constexpr GLenum compressedRGB8ETC2{0x9274};
+constexpr GLenum compressedSRGB8ETC2{0x9275};
+constexpr GLenum compressedRGB8PunchthroughAlpha1ETC2{0x9276};
+constexpr GLenum compressedSRGB8PunchthroughAlpha1ETC2{0x9277};
+constexpr GLenum compressedRGBA8ETC2EAC{0x9278};
+constexpr GLenum compressedSRGB8Alpha8ETC2EAC{0x9279};
+
+// Calls fun with the pointer to be passed to the glTexImage functions. If the
+// upload ring has enough free space, the pixels are copied to the ring and the
+// pointer is an offset into its buffer
+template <typename T>
+void unpackPixels(std::span<std::byte const> pixels,
+                  abcg::OpenGLUploadRing *uploadRing, T const &fun) {
+  std::optional<std::size_t> offset;
+  if (uploadRing != nullptr) {
+    offset = uploadRing->write(pixels);
+  }
+  if (!offset) {
+    fun(static_cast<void const *>(pixels.data()));
+    return;
+  }
+
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadRing->getBuffer());
+  fun(reinterpret_cast<void const *>(*offset)); // NOLINT
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+// Specifies the image of a texture target, sourcing the pixels from the upload
+// ring if it has enough free space
+void texImage2D(GLenum target, abcg::OpenGLImage const &image,
+                abcg::OpenGLUploadRing *uploadRing) {
+  auto const &surface{*image.surface};
+  unpackPixels({static_cast<std::byte const *>(surface.pixels),
+                image.getSizeInBytes()},
+               uploadRing, [&](void const *pixels) {
+                 glTexImage2D(target, 0,
+                              gsl::narrow<GLint>(image.internalFormat),
+                              surface.w, surface.h, 0, image.format,
+                              GL_UNSIGNED_BYTE, pixels);
+               });
+}
+
+// Returns whether a block-compressed internal format is supported by the
+// current context
+[[nodiscard]] bool isCompressedFormatSupported(GLenum internalFormat) {
+#if defined(__EMSCRIPTEN__)
+  // WebGL lists the formats of all enabled compression extensions
+  GLint count{};
+  glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+  std::vector<GLint> formats(gsl::narrow<std::size_t>(count));
+  glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+  return std::ranges::find(formats, gsl::narrow<GLint>(internalFormat)) !=
+         formats.end();
+#else
+  auto const s3tc{GLEW_EXT_texture_compression_s3tc == GL_TRUE};
+  switch (internalFormat) {
+  case compressedRGBS3TCDXT1:
+  case compressedRGBAS3TCDXT1:
+  case compressedRGBAS3TCDXT3:
+  case compressedRGBAS3TCDXT5:
+    return s3tc;
+  case compressedSRGBS3TCDXT1:
+  case compressedSRGBAlphaS3TCDXT1:
+  case compressedSRGBAlphaS3TCDXT3:
+  case compressedSRGBAlphaS3TCDXT5:
+    return s3tc && GLEW_EXT_texture_sRGB == GL_TRUE;
+  case compressedRedRGTC1:
+  case compressedSignedRedRGTC1:
+  case compressedRGRGTC2:
+  case compressedSignedRGRGTC2:
+    return GLEW_VERSION_3_0 == GL_TRUE ||
+           GLEW_ARB_texture_compression_rgtc == GL_TRUE;
+  case compressedRGBABPTCUnorm:
+  case compressedSRGBAlphaBPTCUnorm:
+  case compressedRGBBPTCSignedFloat:
+  case compressedRGBBPTCUnsignedFloat:
+    return GLEW_VERSION_4_2 == GL_TRUE ||
+           GLEW_ARB_texture_compression_bptc == GL_TRUE;
+  case compressedRGB8ETC2:
+  case compressedSRGB8ETC2:
+  case compressedRGB8PunchthroughAlpha1ETC2:
+  case compressedSRGB8PunchthroughAlpha1ETC2:
+  case compressedRGBA8ETC2EAC:
+  case compressedSRGB8Alpha8ETC2EAC:
+    return GLEW_VERSION_4_3 == GL_TRUE ||
+           GLEW_ARB_ES3_compatibility == GL_TRUE;
+  default:
+    return false;
+  }
+#endif
+}
+
+// Returns the internal format of a texture format, or std::nullopt if the
+// format is block-compressed and is not supported by the current context
+[[nodiscard]] std::optional<GLenum>
+getInternalFormat(abcg::TextureFormat format) {
+  using abcg::TextureFormat;
+  GLenum internalFormat{};
+  switch (format) {
+  case TextureFormat::RGBA8Unorm:
+    return GL_RGBA8;
+  case TextureFormat::RGBA8SRGB:
+    return GL_SRGB8_ALPHA8;
+  case TextureFormat::BC1RGBUnorm:
+    internalFormat = compressedRGBS3TCDXT1;
+    break;
+  case TextureFormat::BC1RGBSRGB:
+    internalFormat = compressedSRGBS3TCDXT1;
+    break;
+  case TextureFormat::BC1RGBAUnorm:
+    internalFormat = compressedRGBAS3TCDXT1;
+    break;
+  case TextureFormat::BC1RGBASRGB:
+    internalFormat = compressedSRGBAlphaS3TCDXT1;
+    break;
+  case TextureFormat::BC2Unorm:
+    internalFormat = compressedRGBAS3TCDXT3;
+    break;
+  case TextureFormat::BC2SRGB:
+    internalFormat = compressedSRGBAlphaS3TCDXT3;
+    break;
+  case TextureFormat::BC3Unorm:
+    internalFormat = compressedRGBAS3TCDXT5;
+    break;
+  case TextureFormat::BC3SRGB:
+    internalFormat = compressedSRGBAlphaS3TCDXT5;
+    break;
+  case TextureFormat::BC4Unorm:
+    internalFormat = compressedRedRGTC1;
+    break;
+  case TextureFormat::BC4Snorm:
+    internalFormat = compressedSignedRedRGTC1;
+    break;
+  case TextureFormat::BC5Unorm:
+    internalFormat = compressedRGRGTC2;
+    break;
+  case TextureFormat::BC5Snorm:
+    internalFormat = compressedSignedRGRGTC2;
+    break;
+  case TextureFormat::BC6HUfloat:
+    internalFormat = compressedRGBBPTCUnsignedFloat;
+    break;
+  case TextureFormat::BC6HSfloat:
+    internalFormat = compressedRGBBPTCSignedFloat;
+    break;
+  case TextureFormat::BC7Unorm:
+    internalFormat = compressedRGBABPTCUnorm;
+    break;
+  case TextureFormat::BC7SRGB:
+    internalFormat = compressedSRGBAlphaBPTCUnorm;
+    break;
+  case TextureFormat::ETC2RGB8Unorm:
+    internalFormat = compressedRGB8ETC2;
+    break;
+  case TextureFormat::ETC2RGB8SRGB:
+    internalFormat = compressedSRGB8ETC2;
+    break;
+  case TextureFormat::ETC2RGB8A1Unorm:
+    internalFormat = compressedRGB8PunchthroughAlpha1ETC2;
+    break;
+  case TextureFormat::ETC2RGB8A1SRGB:
+    internalFormat = compressedSRGB8PunchthroughAlpha1ETC2;
+    break;
+  case TextureFormat::ETC2RGBA8Unorm:
+    internalFormat = compressedRGBA8ETC2EAC;
+    break;
+  case TextureFormat::ETC2RGBA8SRGB:
+    internalFormat = compressedSRGB8Alpha8ETC2EAC;
+    break;
+  }
+  if (!isCompressedFormatSupported(internalFormat)) {
+    return std::nullopt;
+  }
+  return internalFormat;
+}
+
+// Specifies all levels of a 2D texture from a texture container whose format
+// is supported by the current context
+void texImageLevels(abcg::TextureContainer const &texture,
+                    abcg::OpenGLUploadRing *uploadRing) {
+  auto const internalFormat{*getInternalFormat(texture.format)};
+  auto const compressed{abcg::isCompressedFormat(texture.format)};
+
+  for (auto &&[index, level] : iter::enumerate(texture.levels)) {
+    auto const levelIndex{gsl::narrow<GLint>(index)};
+    auto const width{gsl::narrow<GLsizei>(level.width)};
+    auto const height{gsl::narrow<GLsizei>(level.height)};
+    unpackPixels(texture.getLevelData(index), uploadRing,
+                 [&](void const *pixels) {
+                   if (compressed) {
+                     glCompressedTexImage2D(
+                         GL_TEXTURE_2D, levelIndex, internalFormat, width,
+                         height, 0, gsl::narrow<GLsizei>(level.size), pixels);
+                   } else {
+                     glTexImage2D(GL_TEXTURE_2D, levelIndex,
+                                  gsl::narrow<GLint>(internalFormat), width,
+                                  height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                                  pixels);
+                   }
+                 });
+  }
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+                  gsl::narrow<GLint>(texture.levels.size() - 1));
+}
+} // namespace
+
 /**
  * @brief Creates an OpenGL 2D texture from an image loaded from a filesystem
  * path.
@@ -26,119 +255,247 @@
  * @throw abcg::RuntimeError if the image could not be loaded.
  *
  * @return ID of the texture, as generated by glGenTextures.
+ *
+ * @sa abcg::OpenGLTextureLoader for loading textures without stalling the
+ * rendering loop.
  */
 GLuint abcg::loadOpenGLTexture(OpenGLTextureCreateInfo const &createInfo) {
-  GLuint textureID{};
+  return uploadOpenGLTexture(decodeOpenGLTexture(createInfo),
+                             createInfo.generateMipmaps);
+}
 
-  if (SDL_Surface *const surface{IMG_Load(createInfo.path.data())}) {
-    // Enforce RGB/RGBA
-    GLenum internalFormat{};
-    GLenum format{};
-    SDL_Surface *formattedSurface{};
-    if (surface->format->BytesPerPixel == 3) {
-      formattedSurface =
-          SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGB24, 0);
-      internalFormat = createInfo.sRGBToLinear ? GL_SRGB8 : GL_RGB;
-      format = GL_RGB;
-    } else {
-      formattedSurface =
-          SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
-      internalFormat = createInfo.sRGBToLinear ? GL_SRGB8_ALPHA8 : GL_RGBA;
-      format = GL_RGBA;
-    }
-    SDL_FreeSurface(surface);
+/**
+ * @brief Creates an OpenGL cubemap texture from a set of images loaded from
+ * filesystem paths.
+ *
+ * @param createInfo Texture creation settings.
+ *
+ * @throw abcg::RuntimeError if any image could not be loaded.
+ *
+ * @return ID of the texture, as generated by glGenTextures.
+ *
+ * @sa abcg::OpenGLTextureLoader for loading cubemaps without stalling the
+ * rendering loop.
+ */
+GLuint abcg::loadOpenGLCubemap(OpenGLCubemapCreateInfo const &createInfo) {
+  std::array<OpenGLImage, 6> faces;
+  for (auto &&[index, face] : iter::enumerate(faces)) {
+    face = decodeOpenGLCubemapFace(createInfo, index);
+  }
+  return uploadOpenGLCubemap(faces, createInfo.generateMipmaps);
+}
 
-    // Flip upside down
-    if (createInfo.flipUpsideDown) {
-      flipVertically(*formattedSurface);
-    }
+/**
+ * @brief Loads an image from a filesystem path and prepares it for being
+ * uploaded to an OpenGL 2D texture.
+ *
+ * The image is converted to RGB or RGBA and optionally flipped upside down.
+ * KTX2 and DDS files are loaded with their mipmap levels and are kept in
+ * their texel format, which may be block-compressed. This function does not
+ * make OpenGL calls.
+ *
+ * @param createInfo Texture creation settings.
+ *
+ * @throw abcg::RuntimeError if the image could not be loaded.
+ *
+ * @return Decoded image.
+ */
+abcg::OpenGLImage
+abcg::decodeOpenGLTexture(OpenGLTextureCreateInfo const &createInfo) {
+  if (isTextureContainerFile(createInfo.path)) {
+    OpenGLImage image;
+    image.container = loadTextureContainer(createInfo.path);
+    return image;
+  }
+
+  // IMG_Load requires a null-terminated string
+  std::string const path{createInfo.path};
+  SDL_Surface *const surface{IMG_Load(path.c_str())};
+  if (surface == nullptr) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to load texture file {}", createInfo.path));
+  }
+
+  // Enforce RGB/RGBA
+  OpenGLImage image;
+  if (surface->format->BytesPerPixel == 3) {
+    image.surface.reset(
+        SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGB24, 0));
+    image.internalFormat = createInfo.sRGBToLinear ? GL_SRGB8 : GL_RGB;
+    image.format = GL_RGB;
+  } else {
+    image.surface.reset(
+        SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0));
+    image.internalFormat = createInfo.sRGBToLinear ? GL_SRGB8_ALPHA8 : GL_RGBA;
+    image.format = GL_RGBA;
+  }
+  SDL_FreeSurface(surface);
+
+  if (!image.surface) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to convert texture file {}", createInfo.path));
+  }
+
+  // Flip upside down
+  if (createInfo.flipUpsideDown) {
+    flipVertically(*image.surface);
+  }
 
-    // Generate the texture
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, gsl::narrow<GLint>(internalFormat),
-                 formattedSurface->w, formattedSurface->h, 0, format,
-                 GL_UNSIGNED_BYTE, formattedSurface->pixels);
+  return image;
+}
+
+/**
+ * @brief Loads one face of a cubemap from a filesystem path and prepares it
+ * for being uploaded to an OpenGL cubemap texture.
+ *
+ * The image is converted to RGB and, if required, flipped and assigned to the
+ * face of a right-handed system. This function does not make OpenGL calls.
+ *
+ * @param createInfo Texture creation settings.
+ * @param face Index of the face in `createInfo.paths`.
+ *
+ * @throw abcg::RuntimeError if the image could not be loaded.
+ *
+ * @return Decoded image.
+ */
+abcg::OpenGLImage
+abcg::decodeOpenGLCubemapFace(OpenGLCubemapCreateInfo const &createInfo,
+                              std::size_t face) {
+  auto const pathView{createInfo.paths.at(face)};
+
+  // Load the bitmap
+  std::string const path{pathView};
+  SDL_Surface *const surface{IMG_Load(path.c_str())};
+  if (surface == nullptr) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to load texture file {}", pathView));
+  }
 
-    SDL_FreeSurface(formattedSurface);
+  // Enforce RGB
+  OpenGLImage image;
+  image.surface.reset(
+      SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGB24, 0));
+  image.internalFormat = GL_RGB;
+  image.format = GL_RGB;
+  SDL_FreeSurface(surface);
 
-    // Set texture filtering
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  if (!image.surface) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to convert texture file {}", pathView));
+  }
 
-    // Generate the mipmap levels
-    if (createInfo.generateMipmaps) {
-      glGenerateMipmap(GL_TEXTURE_2D);
+  image.target = GL_TEXTURE_CUBE_MAP_POSITIVE_X + gsl::narrow<GLenum>(face);
 
-      // Override minifying filtering
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-                      GL_LINEAR_MIPMAP_LINEAR);
+  // LHS to RHS
+  if (createInfo.rightHandedSystem) {
+    if (image.target == GL_TEXTURE_CUBE_MAP_POSITIVE_Y ||
+        image.target == GL_TEXTURE_CUBE_MAP_NEGATIVE_Y) {
+      // Flip upside down
+      flipVertically(*image.surface);
+    } else {
+      flipHorizontally(*image.surface);
     }
 
-    // Set texture wrapping
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    // Swap -z and +z
+    if (image.target == GL_TEXTURE_CUBE_MAP_POSITIVE_Z)
+      image.target = GL_TEXTURE_CUBE_MAP_NEGATIVE_Z;
+    else if (image.target == GL_TEXTURE_CUBE_MAP_NEGATIVE_Z)
+      image.target = GL_TEXTURE_CUBE_MAP_POSITIVE_Z;
+  }
+
+  return image;
+}
+
+/**
+ * @brief Creates an OpenGL 2D texture from a decoded image.
+ *
+ * Images loaded from KTX2 and DDS files are uploaded level by level. Levels
+ * in block-compressed formats are uploaded without decompression if the
+ * format is supported by the context, and are transcoded to RGBA8 otherwise.
+ *
+ * @param image Image decoded with abcg::decodeOpenGLTexture.
+ * @param generateMipmaps Whether to generate mipmap levels. Mipmap levels are
+ * not generated for block-compressed images, nor for images that already
+ * contain mipmap levels.
+ * @param uploadRing Optional upload ring used to transfer the pixels. If it
+ * has not enough free space, the pixels are transferred from client memory.
+ * The caller is responsible for calling abcg::OpenGLUploadRing::fence.
+ *
+ * @throw abcg::RuntimeError if the image must be transcoded and its format
+ * cannot be transcoded.
+ *
+ * @return ID of the texture, as generated by glGenTextures.
+ */
+GLuint abcg::uploadOpenGLTexture(OpenGLImage const &image,
+                                 bool generateMipmaps,
+                                 OpenGLUploadRing *uploadRing) {
+  // Transcode block-compressed formats not supported by the context
+  std::optional<TextureContainer> transcoded;
+  if (image.container && !getInternalFormat(image.container->format)) {
+    transcoded = transcodeToRGBA8(*image.container);
+  }
+
+  // Generate the texture
+  GLuint textureID{};
+  glGenTextures(1, &textureID);
+  glBindTexture(GL_TEXTURE_2D, textureID);
+
+  auto hasMipmaps{false};
+  if (image.container) {
+    auto const &texture{transcoded ? *transcoded : *image.container};
+    texImageLevels(texture, uploadRing);
+    hasMipmaps = texture.levels.size() > 1;
+    generateMipmaps = generateMipmaps && !hasMipmaps &&
+                      !isCompressedFormat(texture.format);
   } else {
-    throw abcg::RuntimeError(
-        fmt::format("Failed to load texture file {}", createInfo.path));
+    texImage2D(GL_TEXTURE_2D, image, uploadRing);
   }
 
+  // Set texture filtering
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                  hasMipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  // Generate the mipmap levels
+  if (generateMipmaps) {
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    // Override minifying filtering
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    GL_LINEAR_MIPMAP_LINEAR);
+  }
+
+  // Set texture wrapping
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
   glBindTexture(GL_TEXTURE_2D, 0);
 
   return textureID;
 }
 
 /**
- * @brief Creates an OpenGL cubemap texture from a set of images loaded from
- * filesystem paths.
+ * @brief Creates an OpenGL cubemap texture from decoded images.
  *
- * @param createInfo Texture creation settings.
- *
- * @throw abcg::RuntimeError if any image could not be loaded.
+ * @param faces Images decoded with abcg::decodeOpenGLCubemapFace, one for
+ * each face of the cube.
+ * @param generateMipmaps Whether to generate mipmap levels.
+ * @param uploadRing Optional upload ring used to transfer the pixels. If it
+ * has not enough free space, the pixels are transferred from client memory.
+ * The caller is responsible for calling abcg::OpenGLUploadRing::fence.
  *
  * @return ID of the texture, as generated by glGenTextures.
  */
-GLuint abcg::loadOpenGLCubemap(OpenGLCubemapCreateInfo const &createInfo) {
+GLuint abcg::uploadOpenGLCubemap(std::span<OpenGLImage const> faces,
+                                 bool generateMipmaps,
+                                 OpenGLUploadRing *uploadRing) {
   GLuint textureID{};
   glGenTextures(1, &textureID);
   glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
 
-  for (auto &&[index, path] : iter::enumerate(createInfo.paths)) {
-    // Load the bitmap
-    if (SDL_Surface *const surface{IMG_Load(path.data())}) {
-      // Enforce RGB
-      SDL_Surface *const formattedSurface{
-          SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGB24, 0)};
-      SDL_FreeSurface(surface);
-
-      auto target{GL_TEXTURE_CUBE_MAP_POSITIVE_X + gsl::narrow<GLenum>(index)};
-
-      // LHS to RHS
-      if (createInfo.rightHandedSystem) {
-        if (target == GL_TEXTURE_CUBE_MAP_POSITIVE_Y ||
-            target == GL_TEXTURE_CUBE_MAP_NEGATIVE_Y) {
-          // Flip upside down
-          flipVertically(*formattedSurface);
-        } else {
-          flipHorizontally(*formattedSurface);
-        }
-
-        // Swap -z and +z
-        if (target == GL_TEXTURE_CUBE_MAP_POSITIVE_Z)
-          target = GL_TEXTURE_CUBE_MAP_NEGATIVE_Z;
-        else if (target == GL_TEXTURE_CUBE_MAP_NEGATIVE_Z)
-          target = GL_TEXTURE_CUBE_MAP_POSITIVE_Z;
-      }
-
-      // Create texture
-      glTexImage2D(target, 0, GL_RGB, formattedSurface->w, formattedSurface->h,
-                   0, GL_RGB, GL_UNSIGNED_BYTE, formattedSurface->pixels);
-
-      SDL_FreeSurface(formattedSurface);
-    } else {
-      throw abcg::RuntimeError(
-          fmt::format("Failed to load texture file {}", path));
-    }
+  // Create texture
+  for (auto const &face : faces) {
+    texImage2D(face.target, face, uploadRing);
   }
 
   // Set texture wrapping
@@ -151,7 +508,7 @@ GLuint abcg::loadOpenGLCubemap(OpenGLCubemapCreateInfo const &createInfo) {
   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 
   // Generate the mipmap levels
-  if (createInfo.generateMipmaps) {
+  if (generateMipmaps) {
     glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
 
     // Override minifying filtering
@@ -159,5 +516,24 @@ GLuint abcg::loadOpenGLCubemap(OpenGLCubemapCreateInfo const &createInfo) {
                     GL_LINEAR_MIPMAP_LINEAR);
   }
 
+  glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
   return textureID;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Returns the size of the pixel data.
+ *
+ * @return Size in bytes, including row padding and the data of all levels
+ * loaded from a texture container.
+ */
+std::size_t abcg::OpenGLImage::getSizeInBytes() const noexcept {
+  if (container) {
+    return container->data.size();
+  }
+  if (!surface) {
+    return 0;
+  }
+  return static_cast<std::size_t>(surface->pitch) *
+         static_cast<std::size_t>(surface->h);
+}
@@ -11,33 +11,55 @@
 #ifndef ABCG_OPENGL_IMAGE_HPP_
 #define ABCG_OPENGL_IMAGE_HPP_
 
+#include "abcgExternal.hpp"
 #include "abcgOpenGLExternal.hpp"
+#include "abcgOpenGLUploadRing.hpp"
+#include "abcgTextureContainer.hpp"
 
 #include <array>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string_view>
 
 namespace abcg {
 struct OpenGLTextureCreateInfo;
 struct OpenGLCubemapCreateInfo;
+struct OpenGLImage;
 
 [[nodiscard]] GLuint
 loadOpenGLTexture(OpenGLTextureCreateInfo const &createInfo);
 [[nodiscard]] GLuint
 loadOpenGLCubemap(OpenGLCubemapCreateInfo const &createInfo);
+
+[[nodiscard]] OpenGLImage
+decodeOpenGLTexture(OpenGLTextureCreateInfo const &createInfo);
+[[nodiscard]] OpenGLImage
+decodeOpenGLCubemapFace(OpenGLCubemapCreateInfo const &createInfo,
+                        std::size_t face);
+[[nodiscard]] GLuint
+uploadOpenGLTexture(OpenGLImage const &image, bool generateMipmaps,
+                    OpenGLUploadRing *uploadRing = nullptr);
+[[nodiscard]] GLuint
+uploadOpenGLCubemap(std::span<OpenGLImage const> faces, bool generateMipmaps,
+                    OpenGLUploadRing *uploadRing = nullptr);
 } // namespace abcg
 
 /**
  * @brief Configuration settings for creating a 2D texture for OpenGL.
  */
 struct abcg::OpenGLTextureCreateInfo {
-  /** @brief Path to the image file (PNG or JPEG). */
+  /** @brief Path to the image file (PNG, JPEG, KTX2 or DDS). */
   std::string_view path{};
-  /** @brief Whether to generate mipmap levels. */
+  /** @brief Whether to generate mipmap levels. Ignored for KTX2 and DDS files
+   * that already contain mipmap levels. */
   bool generateMipmaps{true};
-  /** @brief Whether to flip the image upside down. */
+  /** @brief Whether to flip the image upside down. Ignored for KTX2 and DDS
+   * files, which are uploaded as stored. */
   bool flipUpsideDown{true};
   /** @brief Whether to apply gamma decoding (expansion) to convert an image in
-   * sRGB space to linear space. */
+   * sRGB space to linear space. Ignored for KTX2 and DDS files, whose texel
+   * format tells if the image is in sRGB space. */
   bool sRGBToLinear{false};
 };
 
@@ -55,4 +77,29 @@ struct abcg::OpenGLCubemapCreateInfo {
   bool rightHandedSystem{true};
 };
 
+/**
+ * @brief Decoded image ready to be uploaded to an OpenGL texture.
+ *
+ * Objects of this type are created by abcg::decodeOpenGLTexture and
+ * abcg::decodeOpenGLCubemapFace, which do not make OpenGL calls and thus can
+ * be used from any thread.
+ */
+struct abcg::OpenGLImage {
+  /** @brief Pixel data, already converted and flipped. */
+  std::unique_ptr<SDL_Surface, void (*)(SDL_Surface *)> surface{
+      nullptr, SDL_FreeSurface};
+  /** @brief Mipmap levels loaded from a KTX2 or DDS file, used instead of
+   * `surface`. */
+  std::optional<TextureContainer> container;
+  /** @brief Texture target of the image (`GL_TEXTURE_2D` or a cubemap
+   * face). */
+  GLenum target{GL_TEXTURE_2D};
+  /** @brief Internal format of the texture. */
+  GLenum internalFormat{GL_RGBA};
+  /** @brief Format of the pixel data. */
+  GLenum format{GL_RGBA};
+
+  [[nodiscard]] std::size_t getSizeInBytes() const noexcept;
+};
+
 #endif
@@ -0,0 +1,136 @@
+/**
+ * @file abcgOpenGLMesh.cpp
+ * @brief Definition of abcg::OpenGLMesh members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLMesh.hpp"
+
+#include <gsl/gsl>
+
+/**
+ * @brief Creates the vertex and index buffers from a mesh file.
+ *
+ * The file is memory-mapped and its vertex and index data are passed to
+ * glBufferData as they are.
+ *
+ * @param path Path to the mesh file.
+ *
+ * @throw abcg::RuntimeError if the file could not be loaded.
+ */
+void abcg::OpenGLMesh::create(std::string_view path) {
+  destroy();
+
+  MeshFile file;
+  file.open(path);
+  m_header = file.getHeader();
+
+  auto const vertexData{file.getVertexData()};
+  glGenBuffers(1, &m_vertexBuffer);
+  glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+  glBufferData(GL_ARRAY_BUFFER, gsl::narrow<GLsizeiptr>(vertexData.size()),
+               vertexData.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  auto const indexData{file.getIndexData()};
+  glGenBuffers(1, &m_indexBuffer);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+               gsl::narrow<GLsizeiptr>(indexData.size()), indexData.data(),
+               GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+/**
+ * @brief Deletes the buffers.
+ */
+void abcg::OpenGLMesh::destroy() {
+  if (m_vertexBuffer != 0) {
+    glDeleteBuffers(1, &m_vertexBuffer);
+    m_vertexBuffer = 0;
+  }
+  if (m_indexBuffer != 0) {
+    glDeleteBuffers(1, &m_indexBuffer);
+    m_indexBuffer = 0;
+  }
+  m_header = {};
+}
+
+/**
+ * @brief Enables a vertex attribute array sourced from the vertex buffer.
+ *
+ * The vertex array object must be bound. Attributes the mesh does not have
+ * and negative locations are ignored.
+ *
+ * @param attribute Vertex attribute of the mesh.
+ * @param location Location of the attribute in the vertex shader.
+ */
+void abcg::OpenGLMesh::setupAttribute(MeshAttribute attribute,
+                                      GLint location) const {
+  auto const stream{MeshFile::getStream(m_header, attribute)};
+  if (!stream || location < 0) {
+    return;
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+  glEnableVertexAttribArray(gsl::narrow<GLuint>(location));
+  glVertexAttribPointer(gsl::narrow<GLuint>(location),
+                        gsl::narrow<GLint>(stream->components), GL_FLOAT,
+                        GL_FALSE, gsl::narrow<GLsizei>(stream->stride),
+                        reinterpret_cast<void *>(stream->offset)); // NOLINT
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/**
+ * @brief Binds the index buffer to `GL_ELEMENT_ARRAY_BUFFER`.
+ *
+ * If called while a vertex array object is bound, the binding is stored in
+ * the vertex array object.
+ */
+void abcg::OpenGLMesh::bindIndexBuffer() const {
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+}
+
+/**
+ * @brief Draws the triangles of the mesh.
+ *
+ * The vertex array object with the attributes and the index buffer of the
+ * mesh must be bound.
+ */
+void abcg::OpenGLMesh::draw() const {
+  glDrawElements(GL_TRIANGLES, gsl::narrow<GLsizei>(m_header.indexCount),
+                 m_header.indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+                 nullptr);
+}
+
+/**
+ * @brief Returns the header of the mesh file.
+ *
+ * @return Header with the number of vertices and indices, the vertex
+ * attributes and the bounding box of the mesh.
+ */
+abcg::MeshFileHeader const &abcg::OpenGLMesh::getHeader() const noexcept {
+  return m_header;
+}
+
+/**
+ * @brief Returns the vertex buffer object.
+ *
+ * @return ID of the buffer, as generated by glGenBuffers.
+ */
+GLuint abcg::OpenGLMesh::getVertexBuffer() const noexcept {
+  return m_vertexBuffer;
+}
+
+/**
+ * @brief Returns the index buffer object.
+ *
+ * @return ID of the buffer, as generated by glGenBuffers.
+ */
+GLuint abcg::OpenGLMesh::getIndexBuffer() const noexcept {
+  return m_indexBuffer;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file abcgOpenGLMesh.hpp
+ * @brief Header file of abcg::OpenGLMesh.
+ *
+ * Declaration of abcg::OpenGLMesh.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_MESH_HPP_
+#define ABCG_OPENGL_MESH_HPP_
+
+#include "abcgMesh.hpp"
+#include "abcgOpenGLExternal.hpp"
+
+#include <string_view>
+
+namespace abcg {
+class OpenGLMesh;
+} // namespace abcg
+
+/**
+ * @brief Vertex and index buffers of a mesh loaded from an ABCg mesh file.
+ *
+ * The buffers are filled directly from the memory-mapped file.
+ *
+ * @sa abcg::saveMesh for creating mesh files.
+ */
+class abcg::OpenGLMesh {
+public:
+  void create(std::string_view path);
+  void destroy();
+
+  void setupAttribute(MeshAttribute attribute, GLint location) const;
+  void bindIndexBuffer() const;
+  void draw() const;
+
+  [[nodiscard]] MeshFileHeader const &getHeader() const noexcept;
+  [[nodiscard]] GLuint getVertexBuffer() const noexcept;
+  [[nodiscard]] GLuint getIndexBuffer() const noexcept;
+
+private:
+  MeshFileHeader m_header{};
+  GLuint m_vertexBuffer{};
+  GLuint m_indexBuffer{};
+};
+
+#endif
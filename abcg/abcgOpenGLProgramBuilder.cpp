@@ -0,0 +1,298 @@
+/**
+ * @file abcgOpenGLProgramBuilder.cpp
+ * @brief Definition of abcg::OpenGLProgramBuilder members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLProgramBuilder.hpp"
+
+#include <cppitertools/itertools.hpp>
+
+#include <algorithm>
+#include <exception>
+
+#include "abcgException.hpp"
+
+namespace {
+#if defined(GL_COMPLETION_STATUS_KHR)
+constexpr GLenum completionStatus{GL_COMPLETION_STATUS_KHR};
+#else
+constexpr GLenum completionStatus{0x91B1};
+#endif
+
+[[nodiscard]] bool isShaderCompletionReady(GLuint shader) {
+  GLint status{GL_TRUE};
+  glGetShaderiv(shader, completionStatus, &status);
+  return status == GL_TRUE;
+}
+
+[[nodiscard]] bool isProgramCompletionReady(GLuint program) {
+  GLint status{GL_TRUE};
+  glGetProgramiv(program, completionStatus, &status);
+  return status == GL_TRUE;
+}
+} // namespace
+
+/**
+ * @brief Triggers the build of a program object and returns immediately.
+ *
+ * @param pathsOrSources Paths or source codes of the shaders to be compiled and
+ * linked to the program.
+ * @param onReady Optional function called from abcg::OpenGLProgramBuilder::poll
+ * when the build finishes. Its argument is the ID of the program object, or 0
+ * if the build has failed.
+ *
+ * @throw abcg::RuntimeError if a shader could not be read from file.
+ *
+ * @return Future that receives the ID of the program object. If the build
+ * fails, the future holds the abcg::RuntimeError describing the failure.
+ */
+std::future<GLuint> abcg::OpenGLProgramBuilder::build(
+    std::vector<ShaderSource> const &pathsOrSources,
+    std::function<void(GLuint)> const &onReady) {
+  auto &job{m_jobs.emplace_back()};
+  job.onReady = onReady;
+  auto future{job.promise.get_future()};
+  try {
+    job.shaders = triggerOpenGLShaderCompile(pathsOrSources);
+  } catch (...) {
+    m_jobs.pop_back();
+    throw;
+  }
+  return future;
+}
+
+/**
+ * @brief Triggers the build of a program object, compiling only the shaders
+ * that have changed, and returns immediately.
+ *
+ * `shaders` holds the shader objects of the last successful rebuild, one for
+ * each element of `pathsOrSources`. Only the shaders at `changedIndices`, and
+ * those that were never compiled, are compiled again. The shader objects of the
+ * other stages are linked to the new program as they are. If the program links
+ * successfully, the new shader objects replace the old ones in `shaders`, and
+ * the old ones are deleted.
+ *
+ * @param pathsOrSources Paths or source codes of the shaders to be compiled and
+ * linked to the program.
+ * @param changedIndices Indices of the elements of `pathsOrSources` that have
+ * changed since the last rebuild.
+ * @param shaders Shader objects kept between rebuilds. It must be empty before
+ * the first rebuild. The caller is responsible for deleting the shader objects
+ * it contains.
+ * @param onReady Optional function called from abcg::OpenGLProgramBuilder::poll
+ * when the build finishes. Its argument is the ID of the program object, or 0
+ * if the build has failed.
+ *
+ * @throw abcg::RuntimeError if a shader could not be read from file.
+ *
+ * @return Future that receives the ID of the program object. If the build
+ * fails, the future holds the abcg::RuntimeError describing the failure.
+ */
+std::future<GLuint> abcg::OpenGLProgramBuilder::rebuild(
+    std::vector<ShaderSource> const &pathsOrSources,
+    std::vector<std::size_t> const &changedIndices,
+    std::shared_ptr<std::vector<OpenGLShader>> const &shaders,
+    std::function<void(GLuint)> const &onReady) {
+  if (shaders->empty()) {
+    shaders->resize(pathsOrSources.size());
+  }
+
+  std::vector<ShaderSource> changedSources;
+  std::vector<std::size_t> shaderIndices;
+  for (auto &&[index, shader] : iter::enumerate(*shaders)) {
+    if (shader.shader == 0 || std::ranges::find(changedIndices, index) !=
+                                  changedIndices.end()) {
+      changedSources.push_back(pathsOrSources.at(index));
+      shaderIndices.push_back(index);
+    }
+  }
+
+  auto &job{m_jobs.emplace_back()};
+  job.onReady = onReady;
+  job.reusedShaders = shaders;
+  job.shaderIndices = std::move(shaderIndices);
+  auto future{job.promise.get_future()};
+  try {
+    job.shaders = triggerOpenGLShaderCompile(changedSources);
+  } catch (...) {
+    m_jobs.pop_back();
+    throw;
+  }
+  return future;
+}
+
+/**
+ * @brief Advances the pending builds.
+ *
+ * Builds that have finished are delivered to their futures and callbacks.
+ *
+ * This must be called from the thread that owns the OpenGL context.
+ */
+void abcg::OpenGLProgramBuilder::poll() {
+  if (m_jobs.empty()) {
+    return;
+  }
+
+  auto const parallelCompile{isParallelCompileSupported()};
+
+  // Finished jobs are removed only after all callbacks are called, as a
+  // callback may start new builds
+  auto const numJobs{m_jobs.size()};
+  for (std::size_t index{}; index < numJobs; ++index) {
+    // Without parallel compile, each status query may block. Limit it to one
+    // per call
+    if (advance(m_jobs[index], parallelCompile) && !parallelCompile) {
+      break;
+    }
+  }
+
+  std::erase_if(m_jobs, [](auto const &job) { return job.done; });
+}
+
+/**
+ * @brief Cancels all pending builds and releases their resources.
+ *
+ * The futures of the cancelled builds receive an abcg::RuntimeError. The
+ * callbacks are not called.
+ */
+void abcg::OpenGLProgramBuilder::destroy() {
+  for (auto &job : m_jobs) {
+    for (auto const &shader : job.shaders) {
+      glDeleteShader(shader.shader);
+    }
+    if (job.program != 0) {
+      glDeleteProgram(job.program);
+    }
+    job.promise.set_exception(std::make_exception_ptr(
+        abcg::RuntimeError("Program build was cancelled")));
+  }
+  m_jobs.clear();
+}
+
+/**
+ * @brief Returns the number of builds that have not finished yet.
+ *
+ * @return Number of pending builds.
+ */
+std::size_t abcg::OpenGLProgramBuilder::getPendingCount() const noexcept {
+  return m_jobs.size();
+}
+
+/**
+ * @brief Returns whether the driver supports querying the completion status
+ * of shaders and programs without blocking.
+ *
+ * @return `true` if `KHR_parallel_shader_compile` or
+ * `ARB_parallel_shader_compile` is available; `false` otherwise.
+ */
+bool abcg::OpenGLProgramBuilder::isParallelCompileSupported() {
+#if defined(__EMSCRIPTEN__)
+  return false;
+#else
+  return GLEW_KHR_parallel_shader_compile == GL_TRUE ||
+         GLEW_ARB_parallel_shader_compile == GL_TRUE;
+#endif
+}
+
+// Advances the build of a single job. Returns true if a compile or link status
+// was queried.
+bool abcg::OpenGLProgramBuilder::advance(Job &job, bool parallelCompile) {
+  if (job.done) {
+    return false;
+  }
+
+  // The callback may start new builds and thus invalidate the reference to
+  // the job. Hence, the job must not be accessed after the callback is called
+  auto const finish{[&job](GLuint program) {
+    job.done = true;
+    job.program = 0;
+    job.shaders.clear();
+    if (auto const onReady{std::move(job.onReady)}; onReady) {
+      onReady(program);
+    }
+  }};
+
+  GLuint program{};
+  try {
+    if (job.program == 0) {
+      // Compiling
+      if (parallelCompile &&
+          !std::ranges::all_of(job.shaders, [](auto const &shader) {
+            return isShaderCompletionReady(shader.shader);
+          })) {
+        return false;
+      }
+      checkOpenGLShaderCompile(job.shaders);
+      if (job.reusedShaders) {
+        job.program = linkReusedShaders(job);
+        return true;
+      }
+      job.program = triggerOpenGLShaderLink(job.shaders);
+      job.shaders.clear();
+      return true;
+    }
+
+    // Linking
+    if (parallelCompile && !isProgramCompletionReady(job.program)) {
+      return false;
+    }
+    checkOpenGLShaderLink(job.program);
+    if (job.reusedShaders) {
+      for (auto &&[index, shader] : iter::zip(job.shaderIndices, job.shaders)) {
+        auto &reusedShader{job.reusedShaders->at(index)};
+        glDeleteShader(reusedShader.shader);
+        reusedShader = shader;
+      }
+      job.shaders.clear();
+    }
+    program = job.program;
+    job.promise.set_value(program);
+  } catch (...) {
+    // The shaders and program objects are deleted by the check functions on
+    // failure, except for the shaders compiled by a rebuild, which are kept
+    // until the link status is known
+    if (job.reusedShaders && job.program != 0) {
+      for (auto const &shader : job.shaders) {
+        glDeleteShader(shader.shader);
+      }
+    }
+    job.promise.set_exception(std::current_exception());
+  }
+
+  finish(program);
+  return true;
+}
+
+// Links the shaders compiled by a rebuild together with the reused shaders of
+// the other stages. Unlike abcg::triggerOpenGLShaderLink, the shader objects
+// are not deleted, so that they can be reused by the next rebuild.
+GLuint abcg::OpenGLProgramBuilder::linkReusedShaders(Job &job) {
+  auto shaders{*job.reusedShaders};
+  for (auto &&[index, shader] : iter::zip(job.shaderIndices, job.shaders)) {
+    shaders.at(index) = shader;
+  }
+
+  auto const program{glCreateProgram()};
+  if (program == 0) {
+    for (auto const &shader : job.shaders) {
+      glDeleteShader(shader.shader);
+    }
+    job.shaders.clear();
+    throw abcg::RuntimeError("Failed to create program");
+  }
+
+  for (auto const &shader : shaders) {
+    glAttachShader(program, shader.shader);
+  }
+  glLinkProgram(program);
+  for (auto const &shader : shaders) {
+    glDetachShader(program, shader.shader);
+  }
+
+  return program;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file abcgOpenGLProgramBuilder.hpp
+ * @brief Header file of abcg::OpenGLProgramBuilder.
+ *
+ * Declaration of abcg::OpenGLProgramBuilder.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_PROGRAM_BUILDER_HPP_
+#define ABCG_OPENGL_PROGRAM_BUILDER_HPP_
+
+#include "abcgOpenGLShader.hpp"
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace abcg {
+class OpenGLProgramBuilder;
+} // namespace abcg
+
+/**
+ * @brief A class for building OpenGL programs without stalling the rendering
+ * loop.
+ *
+ * Each call to abcg::OpenGLProgramBuilder::build triggers the compilation of a
+ * group of shaders and returns immediately. The build is advanced by
+ * abcg::OpenGLProgramBuilder::poll, which is called once per frame by
+ * abcg::OpenGLWindow.
+ *
+ * If `KHR_parallel_shader_compile` (or `ARB_parallel_shader_compile`) is
+ * supported, the compile and link status are only queried after the driver
+ * reports completion through `GL_COMPLETION_STATUS_KHR`, so polling never
+ * blocks. Otherwise, at most one blocking compile or link check is performed
+ * per call to abcg::OpenGLProgramBuilder::poll.
+ *
+ * @sa abcg::OpenGLWindow::getProgramBuilder.
+ */
+class abcg::OpenGLProgramBuilder {
+public:
+  [[nodiscard]] std::future<GLuint>
+  build(std::vector<ShaderSource> const &pathsOrSources,
+        std::function<void(GLuint)> const &onReady = {});
+  [[nodiscard]] std::future<GLuint>
+  rebuild(std::vector<ShaderSource> const &pathsOrSources,
+          std::vector<std::size_t> const &changedIndices,
+          std::shared_ptr<std::vector<OpenGLShader>> const &shaders,
+          std::function<void(GLuint)> const &onReady = {});
+  void poll();
+  void destroy();
+
+  [[nodiscard]] std::size_t getPendingCount() const noexcept;
+
+  [[nodiscard]] static bool isParallelCompileSupported();
+
+private:
+  struct Job {
+    std::vector<OpenGLShader> shaders;
+    // Shaders kept between rebuilds, and the indices of the ones replaced by
+    // `shaders`. Null for jobs started with abcg::OpenGLProgramBuilder::build
+    std::shared_ptr<std::vector<OpenGLShader>> reusedShaders;
+    std::vector<std::size_t> shaderIndices;
+    GLuint program{};
+    std::promise<GLuint> promise;
+    std::function<void(GLuint)> onReady;
+    bool done{};
+  };
+
+  [[nodiscard]] static bool advance(Job &job, bool parallelCompile);
+  [[nodiscard]] static GLuint linkReusedShaders(Job &job);
+
+  std::vector<Job> m_jobs;
+};
+
+#endif
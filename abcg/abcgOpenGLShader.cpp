@@ -14,12 +14,17 @@
 #include <fmt/core.h>
 #include <gsl/gsl>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
-#include <sstream>
+#include <memory>
+#include <optional>
 #include <vector>
 
 #include "abcgException.hpp"
+#include "abcgUtil.hpp"
 
 namespace {
 void printShaderInfoLog(GLuint const shader, std::string_view prefix) {
@@ -76,23 +81,16 @@ void printProgramInfoLog(GLuint const program) {
   }
 }
 
-// If filenameOrText is a filename, returns the contents of the file (assumed
-// to be in text format). Otherwise, returns filenameOrText.
-[[nodiscard]] std::string toSource(std::string_view filenameOrText) {
-  static const std::size_t maxPathSize{260};
-  if (filenameOrText.size() > maxPathSize ||
-      !std::filesystem::exists(filenameOrText)) {
-    return filenameOrText.data();
-  }
-  std::stringstream source;
-  if (std::ifstream stream(filenameOrText.data()); stream) {
-    source << stream.rdbuf();
-    stream.close();
-  } else {
-    throw abcg::RuntimeError(
-        fmt::format("Failed to read file {}", filenameOrText));
-  }
-  return source.str();
+// Loads the sources of a group of shaders. The sources are shared with the
+// cache of abcg::loadShaderSource.
+[[nodiscard]] std::vector<std::shared_ptr<std::string const>>
+loadSources(std::vector<abcg::ShaderSource> const &pathsOrSources) {
+  std::vector<std::shared_ptr<std::string const>> sources;
+  sources.reserve(pathsOrSources.size());
+  for (auto const &pathOrSource : pathsOrSources) {
+    sources.push_back(abcg::loadShaderSource(pathOrSource.source));
+  }
+  return sources;
 }
 
 // Compiles a shader and returns immediately (i.e. don't wait until completion).
@@ -141,6 +139,215 @@ void deleteShaders(std::vector<abcg::OpenGLShader> const &shaderIDs) {
     throw abcg::RuntimeError("Unknown shader stage");
   }
 }
+
+// Directory of the program binary cache. An empty path disables the cache.
+std::filesystem::path &programCacheDirectory() {
+  static std::filesystem::path directory;
+  return directory;
+}
+
+// Header of the files stored in the program binary cache. The header is
+// followed by the serialized shader sources (see serializeSources) and by the
+// program binary.
+struct ProgramBinaryHeader {
+  std::array<char, 4> magic{'A', 'B', 'C', 'G'};
+  uint32_t version{2};
+  uint64_t key{};
+  uint64_t sourcesSize{};
+  uint32_t binaryFormat{};
+  uint32_t binaryLength{};
+};
+
+[[nodiscard]] std::string getGLString(GLenum name) {
+  auto const *string{glGetString(name)};
+  return string != nullptr ? reinterpret_cast<char const *>(string) : "";
+}
+
+[[nodiscard]] bool isProgramBinarySupported() {
+#if defined(__EMSCRIPTEN__)
+  return false;
+#else
+  GLint numFormats{};
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+  return numFormats > 0;
+#endif
+}
+
+#if !defined(__EMSCRIPTEN__)
+// Returns true if the driver accepts program binaries in the given format
+[[nodiscard]] bool isProgramBinaryFormatSupported(GLenum format) {
+  GLint numFormats{};
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+  if (numFormats <= 0) {
+    return false;
+  }
+  std::vector<GLint> formats(gsl::narrow<std::size_t>(numFormats));
+  glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+  return std::ranges::any_of(formats, [format](GLint supportedFormat) {
+    return static_cast<GLenum>(supportedFormat) == format;
+  });
+}
+#endif
+
+// Serializes the stages and sources of a group of shaders. The result is
+// hashed to create the cache key, and is stored in the cache file so that a
+// key collision is detected when the binary is loaded.
+[[nodiscard]] std::string serializeSources(
+    std::vector<abcg::ShaderSource> const &pathsOrSources,
+    std::vector<std::shared_ptr<std::string const>> const &sources) {
+  std::string serialized;
+  for (auto &&[pathOrSource, source] : iter::zip(pathsOrSources, sources)) {
+    serialized += fmt::format("{} {}\n", static_cast<int>(pathOrSource.stage),
+                              source->size());
+    serialized += *source;
+  }
+  return serialized;
+}
+
+// Returns the cache key of a program. The key depends on the shader sources
+// and stages, and on the OpenGL driver. It is computed with FNV-1a rather than
+// std::hash so that it is stable across runs and builds.
+[[nodiscard]] uint64_t computeProgramBinaryKey(std::string_view sources) {
+  abcg::FNV1aHash hash;
+  hash.update(getGLString(GL_VENDOR));
+  hash.update(getGLString(GL_RENDERER));
+  hash.update(getGLString(GL_VERSION));
+  hash.update(sources);
+  return hash.getValue();
+}
+
+// Returns the path of the cached program binary with the given key
+[[nodiscard]] std::filesystem::path getProgramBinaryPath(uint64_t key) {
+  return programCacheDirectory() / fmt::format("{:016x}.bin", key);
+}
+
+// Creates a program from a cached binary. Returns std::nullopt if the binary
+// is not found, was built from different sources, or is rejected by the
+// driver.
+[[nodiscard]] std::optional<GLuint>
+loadProgramBinary([[maybe_unused]] std::filesystem::path const &path,
+                  [[maybe_unused]] uint64_t key,
+                  [[maybe_unused]] std::string_view sources) {
+#if defined(__EMSCRIPTEN__)
+  return std::nullopt;
+#else
+  std::ifstream stream(path, std::ios::binary | std::ios::ate);
+  if (!stream) {
+    return std::nullopt;
+  }
+  auto const fileSize{static_cast<std::streamoff>(stream.tellg())};
+  stream.seekg(0);
+
+  ProgramBinaryHeader header{};
+  ProgramBinaryHeader const expected{.key = key,
+                                     .sourcesSize = sources.size()};
+  if (fileSize < static_cast<std::streamoff>(sizeof(header)) ||
+      !stream.read(reinterpret_cast<char *>(&header), // NOLINT
+                   sizeof(header)) ||
+      header.magic != expected.magic || header.version != expected.version ||
+      header.key != expected.key ||
+      header.sourcesSize != expected.sourcesSize || header.binaryLength == 0) {
+    return std::nullopt;
+  }
+
+  // The size of the file must match the sizes in the header exactly
+  auto const payloadSize{static_cast<uint64_t>(fileSize) - sizeof(header)};
+  if (payloadSize != header.sourcesSize + header.binaryLength) {
+    return std::nullopt;
+  }
+
+  std::string storedSources(gsl::narrow<std::size_t>(header.sourcesSize),
+                            '\0');
+  if (!stream.read(storedSources.data(),
+                   gsl::narrow<std::streamsize>(storedSources.size())) ||
+      storedSources != sources) {
+    return std::nullopt;
+  }
+
+  std::vector<char> binary(header.binaryLength);
+  if (!stream.read(binary.data(),
+                   gsl::narrow<std::streamsize>(binary.size()))) {
+    return std::nullopt;
+  }
+
+  // glProgramBinary raises GL_INVALID_ENUM for formats the driver no longer
+  // supports, e.g., after a driver update
+  if (!isProgramBinaryFormatSupported(header.binaryFormat)) {
+    return std::nullopt;
+  }
+
+  auto const program{glCreateProgram()};
+  if (program == 0) {
+    return std::nullopt;
+  }
+  glProgramBinary(program, header.binaryFormat, binary.data(),
+                  gsl::narrow<GLsizei>(binary.size()));
+
+  // The driver may reject binaries created by a different driver version. Any
+  // error raised by glProgramBinary is cleared so that it is not reported
+  // later as an error of an unrelated call.
+  GLint linkStatus{};
+  glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+  if (linkStatus == GL_FALSE) {
+    glDeleteProgram(program);
+    while (glGetError() != GL_NO_ERROR) {
+    }
+    return std::nullopt;
+  }
+
+  return program;
+#endif
+}
+
+// Writes the binary of a linked program to the cache. Failures are silently
+// ignored as the cache is only an optimization.
+void storeProgramBinary([[maybe_unused]] GLuint program,
+                        [[maybe_unused]] std::filesystem::path const &path,
+                        [[maybe_unused]] uint64_t key,
+                        [[maybe_unused]] std::string_view sources) {
+#if !defined(__EMSCRIPTEN__)
+  GLint binaryLength{};
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+  if (binaryLength <= 0) {
+    return;
+  }
+
+  std::vector<char> binary(gsl::narrow<std::size_t>(binaryLength));
+  GLenum binaryFormat{};
+  glGetProgramBinary(program, binaryLength, nullptr, &binaryFormat,
+                     binary.data());
+
+  std::error_code errorCode;
+  std::filesystem::create_directories(path.parent_path(), errorCode);
+  if (errorCode) {
+    return;
+  }
+
+  ProgramBinaryHeader const header{
+      .key = key,
+      .sourcesSize = sources.size(),
+      .binaryFormat = binaryFormat,
+      .binaryLength = gsl::narrow<uint32_t>(binary.size())};
+
+  auto const tempPath{abcg::getTemporaryPath(path)};
+  {
+    std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+    stream.write(reinterpret_cast<char const *>(&header), // NOLINT
+                 sizeof(header));
+    stream.write(sources.data(), gsl::narrow<std::streamsize>(sources.size()));
+    stream.write(binary.data(), gsl::narrow<std::streamsize>(binary.size()));
+    if (!stream) {
+      stream.close();
+      std::filesystem::remove(tempPath, errorCode);
+      return;
+    }
+  }
+  std::filesystem::rename(tempPath, path, errorCode);
+  if (errorCode) {
+    std::filesystem::remove(tempPath, errorCode);
+  }
+#endif
+}
 } // namespace
 
 /**
@@ -150,6 +357,12 @@ void deleteShaders(std::vector<abcg::OpenGLShader> const &shaderIDs) {
  * linked to the program.
  * @param throwOnError Whether to throw exceptions on compile/link errors.
  *
+ * If the program binary cache is enabled (see
+ * abcg::setOpenGLProgramCacheDirectory), the program is first restored from a
+ * binary previously retrieved with `glGetProgramBinary`. If there is no such
+ * binary, or if the driver rejects it, the program is built from the sources
+ * and its binary is stored in the cache.
+ *
  * @throw abcg::RuntimeError if the shader could not be read from file, or if
  * the program could not be created, or if the compilation of any shader has
  * failed, or if the linking has failed.
@@ -159,18 +372,26 @@ void deleteShaders(std::vector<abcg::OpenGLShader> const &shaderIDs) {
 GLuint
 abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
                           bool throwOnError) {
-  std::vector<ShaderSource> sources;
-  sources.reserve(pathsOrSources.size());
-  for (auto const &pathOrSource : pathsOrSources) {
-    sources.push_back(
-        {.source = toSource(pathOrSource.source), .stage = pathOrSource.stage});
+  auto const sources{loadSources(pathsOrSources)};
+
+  std::filesystem::path binaryPath;
+  std::string serializedSources;
+  uint64_t binaryKey{};
+  if (!programCacheDirectory().empty() && isProgramBinarySupported()) {
+    serializedSources = serializeSources(pathsOrSources, sources);
+    binaryKey = computeProgramBinaryKey(serializedSources);
+    binaryPath = getProgramBinaryPath(binaryKey);
+    if (auto const program{
+            loadProgramBinary(binaryPath, binaryKey, serializedSources)}) {
+      return *program;
+    }
   }
 
   std::vector<OpenGLShader> compiledShaders;
   compiledShaders.reserve(sources.size());
-  for (auto const &source : sources) {
+  for (auto &&[pathOrSource, source] : iter::zip(pathsOrSources, sources)) {
     compiledShaders.push_back(
-        compileHelper(source.source, abcgStageToOpenGLStage(source.stage)));
+        compileHelper(*source, abcgStageToOpenGLStage(pathOrSource.stage)));
   }
 
   if (!checkOpenGLShaderCompile(compiledShaders, throwOnError))
@@ -189,6 +410,13 @@ abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
     glAttachShader(shaderProgram, shader.shader);
   }
 
+#if !defined(__EMSCRIPTEN__)
+  if (!binaryPath.empty()) {
+    glProgramParameteri(shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                        GL_TRUE);
+  }
+#endif
+
   glLinkProgram(shaderProgram);
 
   for (auto const &shader : compiledShaders) {
@@ -209,6 +437,10 @@ abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
     return 0U;
   }
 
+  if (!binaryPath.empty()) {
+    storeProgramBinary(shaderProgram, binaryPath, binaryKey, serializedSources);
+  }
+
   return shaderProgram;
 }
 
@@ -237,18 +469,13 @@ abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
  */
 std::vector<abcg::OpenGLShader> abcg::triggerOpenGLShaderCompile(
     std::vector<ShaderSource> const &pathsOrSources) {
-  std::vector<ShaderSource> sources;
-  sources.reserve(pathsOrSources.size());
-  for (auto const &pathOrSource : pathsOrSources) {
-    sources.push_back(
-        {.source = toSource(pathOrSource.source), .stage = pathOrSource.stage});
-  }
+  auto const sources{loadSources(pathsOrSources)};
 
   std::vector<OpenGLShader> compiledShaders;
   compiledShaders.reserve(sources.size());
-  for (auto const &source : sources) {
+  for (auto &&[pathOrSource, source] : iter::zip(pathsOrSources, sources)) {
     compiledShaders.push_back(
-        compileHelper(source.source, abcgStageToOpenGLStage(source.stage)));
+        compileHelper(*source, abcgStageToOpenGLStage(pathOrSource.stage)));
   }
 
   return compiledShaders;
@@ -361,4 +588,29 @@ bool abcg::checkOpenGLShaderLink(GLuint shaderProgram, bool throwOnError) {
   }
 
   return true;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Sets the directory of the program binary cache used by
+ * abcg::createOpenGLProgram.
+ *
+ * Program binaries are keyed by the shader sources and stages, and by the
+ * vendor, renderer and version strings of the OpenGL driver. The cache is
+ * disabled by default, and is not available in WebGL.
+ *
+ * @param path Path of the cache directory. The directory is created on
+ * demand. An empty path disables the cache.
+ */
+void abcg::setOpenGLProgramCacheDirectory(std::filesystem::path const &path) {
+  programCacheDirectory() = path;
+}
+
+/**
+ * @brief Returns the directory of the program binary cache.
+ *
+ * @return Path of the cache directory, or an empty path if the cache is
+ * disabled.
+ */
+std::filesystem::path const &abcg::getOpenGLProgramCacheDirectory() {
+  return programCacheDirectory();
+}
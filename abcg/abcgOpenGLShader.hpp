@@ -14,6 +14,7 @@
 #include "abcgOpenGLExternal.hpp"
 #include "abcgShader.hpp"
 
+#include <filesystem>
 #include <vector>
 
 namespace abcg {
@@ -41,6 +42,8 @@ bool checkOpenGLShaderCompile(std::vector<OpenGLShader> const &shaders,
 GLuint triggerOpenGLShaderLink(std::vector<OpenGLShader> const &shaders,
                                bool throwOnError = true);
 bool checkOpenGLShaderLink(GLuint shaderProgram, bool throwOnError = true);
+void setOpenGLProgramCacheDirectory(std::filesystem::path const &path);
+[[nodiscard]] std::filesystem::path const &getOpenGLProgramCacheDirectory();
 } // namespace abcg
 
 #endif
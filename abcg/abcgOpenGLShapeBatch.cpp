@@ -0,0 +1,263 @@
+/**
+ * @file abcgOpenGLShapeBatch.cpp
+ * @brief Definition of abcg::OpenGLShapeBatch members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLShapeBatch.hpp"
+
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <cstddef>
+
+#include "abcgOpenGLShader.hpp"
+
+namespace {
+constexpr GLuint positionAttribute{0};
+constexpr GLuint transformAttribute{1};
+constexpr GLuint colorAttribute{2};
+
+// Number of copies of each instance drawn with wrap-around
+constexpr GLsizei wrapAroundCopies{9};
+
+static_assert(sizeof(abcg::ShapeInstance) == 8 * sizeof(float),
+              "Shape instances must be tightly packed");
+
+// The transform attribute reads the translation, rotation and scale as a vec4
+char const *const vertexShader{R"glsl(#version 300 es
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec4 inTransform;
+layout(location = 2) in vec4 inColor;
+
+uniform bool wrapAround;
+
+out vec4 fragColor;
+
+void main() {
+  vec2 offset = vec2(0.0);
+  if (wrapAround) {
+    int copy = gl_InstanceID % 9;
+    offset = vec2(float(copy % 3 - 1), float(copy / 3 - 1)) * 2.0;
+  }
+
+  float sinAngle = sin(inTransform.z);
+  float cosAngle = cos(inTransform.z);
+  vec2 rotated = vec2(inPosition.x * cosAngle - inPosition.y * sinAngle,
+                      inPosition.x * sinAngle + inPosition.y * cosAngle);
+
+  gl_Position = vec4(rotated * inTransform.w + inTransform.xy + offset, 0, 1);
+  fragColor = inColor;
+}
+)glsl"};
+
+char const *const fragmentShader{R"glsl(#version 300 es
+
+precision mediump float;
+
+in vec4 fragColor;
+
+out vec4 outColor;
+
+void main() { outColor = fragColor; }
+)glsl"};
+} // namespace
+
+/**
+ * @brief Destructor. Releases the OpenGL resources.
+ */
+abcg::OpenGLShapeBatch::~OpenGLShapeBatch() { destroy(); }
+
+/**
+ * @brief Creates the program, buffers and vertex array object of the batch.
+ *
+ * Any previous shapes and instances are discarded.
+ *
+ * @throw abcg::RuntimeError if the program could not be created.
+ */
+void abcg::OpenGLShapeBatch::create() {
+  destroy();
+
+  m_program = createOpenGLProgram(
+      {{.source = vertexShader, .stage = ShaderStage::Vertex},
+       {.source = fragmentShader, .stage = ShaderStage::Fragment}});
+  m_wrapAroundLoc = glGetUniformLocation(m_program, "wrapAround");
+
+  glGenBuffers(1, &m_vertexVBO);
+  glGenBuffers(1, &m_instanceVBO);
+  glGenVertexArrays(1, &m_VAO);
+
+  glBindVertexArray(m_VAO);
+
+  glBindBuffer(GL_ARRAY_BUFFER, m_vertexVBO);
+  glEnableVertexAttribArray(positionAttribute);
+  glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+  // The pointers of the instance attributes are set for each shape
+  glEnableVertexAttribArray(transformAttribute);
+  glEnableVertexAttribArray(colorAttribute);
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/**
+ * @brief Releases the OpenGL resources, and discards the shapes and
+ * instances.
+ */
+void abcg::OpenGLShapeBatch::destroy() {
+  if (m_program != 0) {
+    glDeleteProgram(m_program);
+    glDeleteBuffers(1, &m_vertexVBO);
+    glDeleteBuffers(1, &m_instanceVBO);
+    glDeleteVertexArrays(1, &m_VAO);
+  }
+  m_program = 0;
+  m_vertexVBO = 0;
+  m_instanceVBO = 0;
+  m_VAO = 0;
+
+  m_shapes.clear();
+  m_vertices.clear();
+  m_instances.clear();
+  m_instanceCapacity = 0;
+  m_verticesChanged = false;
+}
+
+/**
+ * @brief Adds the geometry of a shape to the batch.
+ *
+ * @param vertices Vertex positions of the shape, in model space.
+ * @param mode Primitive type used to draw the vertices, such as
+ * `GL_TRIANGLES` or `GL_TRIANGLE_FAN`.
+ *
+ * @return Index of the shape, to be used with
+ * abcg::OpenGLShapeBatch::addInstance.
+ */
+std::size_t abcg::OpenGLShapeBatch::addShape(
+    std::span<glm::vec2 const> vertices, GLenum mode) {
+  m_shapes.push_back({.mode = mode,
+                      .first = gsl::narrow<GLint>(m_vertices.size()),
+                      .count = gsl::narrow<GLsizei>(vertices.size()),
+                      .instances = {}});
+  m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
+  m_verticesChanged = true;
+  return m_shapes.size() - 1;
+}
+
+/**
+ * @brief Queues an instance of a shape to be drawn by the next call to
+ * abcg::OpenGLShapeBatch::paint.
+ *
+ * @param shape Index of the shape, as returned by
+ * abcg::OpenGLShapeBatch::addShape.
+ * @param instance Transformation and color of the instance.
+ */
+void abcg::OpenGLShapeBatch::addInstance(std::size_t shape,
+                                         ShapeInstance const &instance) {
+  m_shapes.at(shape).instances.push_back(instance);
+}
+
+/**
+ * @brief Draws the queued instances and clears the queue.
+ *
+ * The instances of each shape are drawn with a single instanced draw call.
+ * The current blending state is used.
+ *
+ * @param wrapAround Whether to draw each instance nine times, offset by -2,
+ * 0 and 2 in each axis.
+ */
+void abcg::OpenGLShapeBatch::paint(bool wrapAround) {
+  if (m_verticesChanged) {
+    uploadVertices();
+  }
+  uploadInstances();
+  if (m_instances.empty()) {
+    return;
+  }
+
+  glUseProgram(m_program);
+  glUniform1i(m_wrapAroundLoc, wrapAround ? 1 : 0);
+  glBindVertexArray(m_VAO);
+  glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+
+  auto const copies{wrapAround ? wrapAroundCopies : 1};
+  glVertexAttribDivisor(transformAttribute, gsl::narrow<GLuint>(copies));
+  glVertexAttribDivisor(colorAttribute, gsl::narrow<GLuint>(copies));
+
+  auto const stride{gsl::narrow<GLsizei>(sizeof(ShapeInstance))};
+  std::size_t firstInstance{};
+  for (auto &shape : m_shapes) {
+    if (shape.instances.empty()) {
+      continue;
+    }
+
+    auto const offset{firstInstance * sizeof(ShapeInstance)};
+    glVertexAttribPointer(transformAttribute, 4, GL_FLOAT, GL_FALSE, stride,
+                          reinterpret_cast<void *>(offset)); // NOLINT
+    glVertexAttribPointer(
+        colorAttribute, 4, GL_FLOAT, GL_FALSE, stride,
+        reinterpret_cast<void *>(offset + // NOLINT
+                                 offsetof(ShapeInstance, color)));
+    glDrawArraysInstanced(
+        shape.mode, shape.first, shape.count,
+        gsl::narrow<GLsizei>(shape.instances.size()) * copies);
+
+    firstInstance += shape.instances.size();
+    shape.instances.clear();
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+  glUseProgram(0);
+}
+
+/**
+ * @brief Returns the number of shapes of the batch.
+ *
+ * @return Number of shapes added with abcg::OpenGLShapeBatch::addShape.
+ */
+std::size_t abcg::OpenGLShapeBatch::getShapeCount() const noexcept {
+  return m_shapes.size();
+}
+
+// Uploads the geometry of all shapes to the vertex buffer
+void abcg::OpenGLShapeBatch::uploadVertices() {
+  glBindBuffer(GL_ARRAY_BUFFER, m_vertexVBO);
+  glBufferData(GL_ARRAY_BUFFER,
+               gsl::narrow<GLsizeiptr>(m_vertices.size() * sizeof(glm::vec2)),
+               m_vertices.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  m_verticesChanged = false;
+}
+
+// Gathers the queued instances in the order of the shapes and uploads them
+// to the instance buffer, which is orphaned to avoid waiting for the
+// previous draws
+void abcg::OpenGLShapeBatch::uploadInstances() {
+  m_instances.clear();
+  for (auto const &shape : m_shapes) {
+    m_instances.insert(m_instances.end(), shape.instances.begin(),
+                       shape.instances.end());
+  }
+  if (m_instances.empty()) {
+    return;
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+  m_instanceCapacity = std::max(m_instanceCapacity, m_instances.size());
+  glBufferData(
+      GL_ARRAY_BUFFER,
+      gsl::narrow<GLsizeiptr>(m_instanceCapacity * sizeof(ShapeInstance)),
+      nullptr, GL_STREAM_DRAW);
+  glBufferSubData(
+      GL_ARRAY_BUFFER, 0,
+      gsl::narrow<GLsizeiptr>(m_instances.size() * sizeof(ShapeInstance)),
+      m_instances.data());
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
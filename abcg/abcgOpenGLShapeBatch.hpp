@@ -0,0 +1,99 @@
+/**
+ * @file abcgOpenGLShapeBatch.hpp
+ * @brief Header file of abcg::OpenGLShapeBatch.
+ *
+ * Declaration of abcg::OpenGLShapeBatch.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_SHAPE_BATCH_HPP_
+#define ABCG_OPENGL_SHAPE_BATCH_HPP_
+
+#include "abcgExternal.hpp"
+#include "abcgOpenGLExternal.hpp"
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace abcg {
+struct ShapeInstance;
+class OpenGLShapeBatch;
+} // namespace abcg
+
+/**
+ * @brief Transformation and color of an instance of a 2D shape.
+ *
+ * Vertices of the shape are rotated, scaled and then translated, in
+ * normalized device coordinates.
+ */
+struct abcg::ShapeInstance {
+  /** @brief Translation. */
+  glm::vec2 translation{};
+  /** @brief Counterclockwise rotation angle in radians. */
+  float rotation{};
+  /** @brief Uniform scale factor. */
+  float scale{1.0f};
+  /** @brief RGBA color. */
+  glm::vec4 color{1.0f};
+};
+
+/**
+ * @brief Instanced renderer of 2D shapes.
+ *
+ * The geometry of all shapes is packed into a single vertex buffer. Instances
+ * queued with abcg::OpenGLShapeBatch::addInstance are uploaded to a single
+ * instance buffer and drawn with one instanced draw call per shape.
+ *
+ * Instances can also be drawn with wrap-around, as in a toroidal world that
+ * spans [-1, 1] in both axes. Each instance is then drawn nine times, offset
+ * by -2, 0 and 2 in each axis, still within the same draw call.
+ */
+class abcg::OpenGLShapeBatch {
+public:
+  OpenGLShapeBatch() = default;
+  OpenGLShapeBatch(OpenGLShapeBatch const &) = delete;
+  OpenGLShapeBatch(OpenGLShapeBatch &&) = delete;
+  OpenGLShapeBatch &operator=(OpenGLShapeBatch const &) = delete;
+  OpenGLShapeBatch &operator=(OpenGLShapeBatch &&) = delete;
+  ~OpenGLShapeBatch();
+
+  void create();
+  void destroy();
+
+  [[nodiscard]] std::size_t addShape(std::span<glm::vec2 const> vertices,
+                                     GLenum mode = GL_TRIANGLES);
+  void addInstance(std::size_t shape, ShapeInstance const &instance);
+  void paint(bool wrapAround = false);
+
+  [[nodiscard]] std::size_t getShapeCount() const noexcept;
+
+private:
+  struct Shape {
+    GLenum mode{};
+    GLint first{};
+    GLsizei count{};
+    std::vector<ShapeInstance> instances;
+  };
+
+  void uploadVertices();
+  void uploadInstances();
+
+  GLuint m_program{};
+  GLint m_wrapAroundLoc{};
+  GLuint m_VAO{};
+  GLuint m_vertexVBO{};
+  GLuint m_instanceVBO{};
+
+  std::vector<Shape> m_shapes;
+  std::vector<glm::vec2> m_vertices;
+  std::vector<ShapeInstance> m_instances;
+  std::size_t m_instanceCapacity{};
+  bool m_verticesChanged{};
+};
+
+#endif
@@ -0,0 +1,289 @@
+/**
+ * @file abcgOpenGLTextureLoader.cpp
+ * @brief Definition of abcg::OpenGLTextureLoader members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLTextureLoader.hpp"
+
+#include <cppitertools/itertools.hpp>
+
+#include <algorithm>
+
+#include "abcgException.hpp"
+
+/**
+ * @brief Destructor. Cancels the pending loads and stops the worker threads.
+ */
+abcg::OpenGLTextureLoader::~OpenGLTextureLoader() { destroy(); }
+
+/**
+ * @brief Triggers the loading of a 2D texture and returns immediately.
+ *
+ * @param createInfo Texture creation settings. The path is copied, so it does
+ * not need to outlive the call.
+ * @param onReady Optional function called from abcg::OpenGLTextureLoader::poll
+ * when the texture is uploaded. Its argument is the ID of the texture, or 0 if
+ * the image could not be loaded.
+ *
+ * @return Future that receives the ID of the texture. If the image could not
+ * be loaded, the future holds the abcg::RuntimeError describing the failure.
+ */
+std::future<GLuint>
+abcg::OpenGLTextureLoader::load(OpenGLTextureCreateInfo const &createInfo,
+                                std::function<void(GLuint)> const &onReady) {
+  auto const job{std::make_shared<Job>()};
+  job->paths.front() = createInfo.path;
+  job->textureCreateInfo = createInfo;
+  job->textureCreateInfo.path = job->paths.front();
+  job->images.resize(1);
+  job->onReady = onReady;
+  return enqueue(job);
+}
+
+/**
+ * @brief Triggers the loading of a cubemap texture and returns immediately.
+ *
+ * The faces are decoded in parallel.
+ *
+ * @param createInfo Texture creation settings. The paths are copied, so they
+ * do not need to outlive the call.
+ * @param onReady Optional function called from abcg::OpenGLTextureLoader::poll
+ * when the texture is uploaded. Its argument is the ID of the texture, or 0 if
+ * any image could not be loaded.
+ *
+ * @return Future that receives the ID of the texture. If any image could not
+ * be loaded, the future holds the abcg::RuntimeError describing the failure.
+ */
+std::future<GLuint> abcg::OpenGLTextureLoader::loadCubemap(
+    OpenGLCubemapCreateInfo const &createInfo,
+    std::function<void(GLuint)> const &onReady) {
+  auto const job{std::make_shared<Job>()};
+  job->cubemap = true;
+  job->cubemapCreateInfo = createInfo;
+  for (auto &&[path, view] :
+       iter::zip(job->paths, job->cubemapCreateInfo.paths)) {
+    path = view;
+    view = path;
+  }
+  job->images.resize(job->paths.size());
+  job->onReady = onReady;
+  return enqueue(job);
+}
+
+/**
+ * @brief Uploads the textures whose images have been decoded, within the
+ * upload budget.
+ *
+ * The uploaded textures are delivered to their futures and callbacks.
+ * Decoded textures that do not fit in the budget are uploaded in the next
+ * calls, in the order they were requested.
+ *
+ * This must be called from the thread that owns the OpenGL context.
+ */
+void abcg::OpenGLTextureLoader::poll() {
+  std::vector<std::shared_ptr<Job>> decodedJobs;
+  {
+    std::scoped_lock const lock{m_mutex};
+
+    // Take the decoded jobs in request order until the budget is spent. The
+    // first one is always taken, even if it alone exceeds the budget
+    std::size_t uploadSize{};
+    for (auto &job : m_jobs) {
+      if (job->remaining != 0) {
+        continue;
+      }
+      if (uploadSize > 0 && uploadSize + job->sizeInBytes > m_uploadBudget) {
+        break;
+      }
+      uploadSize += job->sizeInBytes;
+      decodedJobs.push_back(std::move(job));
+    }
+    std::erase(m_jobs, nullptr);
+  }
+
+  if (decodedJobs.empty()) {
+    return;
+  }
+
+  // The ring holds the uploads of a few frames in flight
+  if (m_uploadRing.getBuffer() == 0 && OpenGLUploadRing::isSupported()) {
+    m_uploadRing.create(3 * m_uploadBudget);
+  }
+  auto *const uploadRing{m_uploadRing.getBuffer() != 0 ? &m_uploadRing
+                                                       : nullptr};
+
+  // The lock is not held while uploading and calling back, as the callbacks
+  // may start new loads
+  for (auto const &job : decodedJobs) {
+    GLuint textureID{};
+    if (job->error) {
+      job->promise.set_exception(job->error);
+    } else {
+      textureID =
+          job->cubemap
+              ? uploadOpenGLCubemap(job->images,
+                                    job->cubemapCreateInfo.generateMipmaps,
+                                    uploadRing)
+              : uploadOpenGLTexture(job->images.front(),
+                                    job->textureCreateInfo.generateMipmaps,
+                                    uploadRing);
+      job->promise.set_value(textureID);
+    }
+    job->images.clear();
+    if (job->onReady) {
+      job->onReady(textureID);
+    }
+  }
+
+  if (uploadRing != nullptr) {
+    uploadRing->fence();
+  }
+}
+
+/**
+ * @brief Cancels all pending loads and stops the worker threads.
+ *
+ * The futures of the cancelled loads receive an abcg::RuntimeError. The
+ * callbacks are not called.
+ */
+void abcg::OpenGLTextureLoader::destroy() {
+  {
+    std::scoped_lock const lock{m_mutex};
+    m_stopping = true;
+    m_tasks.clear();
+  }
+  m_condition.notify_all();
+  for (auto &thread : m_threads) {
+    thread.join();
+  }
+  m_threads.clear();
+
+  std::scoped_lock const lock{m_mutex};
+  for (auto const &job : m_jobs) {
+    job->promise.set_exception(std::make_exception_ptr(
+        abcg::RuntimeError("Texture loading was cancelled")));
+  }
+  m_jobs.clear();
+  m_stopping = false;
+
+  m_uploadRing.destroy();
+}
+
+/**
+ * @brief Returns the number of textures that have not been uploaded yet.
+ *
+ * @return Number of pending loads.
+ */
+std::size_t abcg::OpenGLTextureLoader::getPendingCount() const {
+  std::scoped_lock const lock{m_mutex};
+  return m_jobs.size();
+}
+
+/**
+ * @brief Returns the maximum number of bytes uploaded per call to
+ * abcg::OpenGLTextureLoader::poll.
+ *
+ * @return Upload budget in bytes.
+ */
+std::size_t abcg::OpenGLTextureLoader::getUploadBudget() const noexcept {
+  return m_uploadBudget;
+}
+
+/**
+ * @brief Sets the maximum number of bytes uploaded per call to
+ * abcg::OpenGLTextureLoader::poll.
+ *
+ * The upload ring is resized to hold three times the budget. This must be
+ * called from the thread that owns the OpenGL context.
+ *
+ * @param bytesPerFrame Upload budget in bytes. The default is 8 MiB.
+ */
+void abcg::OpenGLTextureLoader::setUploadBudget(std::size_t bytesPerFrame) {
+  if (bytesPerFrame == m_uploadBudget) {
+    return;
+  }
+  m_uploadBudget = bytesPerFrame;
+  m_uploadRing.destroy();
+}
+
+// Queues one decoding task per image of the job. The worker threads are
+// started on the first call.
+std::future<GLuint>
+abcg::OpenGLTextureLoader::enqueue(std::shared_ptr<Job> const &job) {
+  auto future{job->promise.get_future()};
+  job->remaining = job->images.size();
+
+#if defined(__EMSCRIPTEN__)
+  for (auto const index : iter::range(job->images.size())) {
+    decode({.job = job, .index = index});
+  }
+  std::scoped_lock const lock{m_mutex};
+  m_jobs.push_back(job);
+#else
+  {
+    std::scoped_lock const lock{m_mutex};
+    m_jobs.push_back(job);
+    for (auto const index : iter::range(job->images.size())) {
+      m_tasks.push_back({.job = job, .index = index});
+    }
+
+    if (m_threads.empty()) {
+      // Leave one core for the rendering thread
+      auto const numThreads{std::max(2U, std::thread::hardware_concurrency()) -
+                            1U};
+      m_threads.reserve(numThreads);
+      for ([[maybe_unused]] auto const index : iter::range(numThreads)) {
+        m_threads.emplace_back(&OpenGLTextureLoader::run, this);
+      }
+    }
+  }
+  m_condition.notify_all();
+#endif
+
+  return future;
+}
+
+// Decodes a single image of a job
+void abcg::OpenGLTextureLoader::decode(Task const &task) {
+  auto &job{*task.job};
+  OpenGLImage image;
+  std::exception_ptr error;
+  try {
+    image = job.cubemap
+                ? decodeOpenGLCubemapFace(job.cubemapCreateInfo, task.index)
+                : decodeOpenGLTexture(job.textureCreateInfo);
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  std::scoped_lock const lock{m_mutex};
+  job.sizeInBytes += image.getSizeInBytes();
+  job.images.at(task.index) = std::move(image);
+  if (error && !job.error) {
+    job.error = error;
+  }
+  --job.remaining;
+}
+
+// Worker thread. Decodes images until the loader is destroyed.
+void abcg::OpenGLTextureLoader::run() {
+  while (true) {
+    Task task;
+    {
+      std::unique_lock lock{m_mutex};
+      m_condition.wait(lock,
+                       [this] { return m_stopping || !m_tasks.empty(); });
+      if (m_stopping) {
+        return;
+      }
+      task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+    }
+    decode(task);
+  }
+}
@@ -0,0 +1,121 @@
+/**
+ * @file abcgOpenGLTextureLoader.hpp
+ * @brief Header file of abcg::OpenGLTextureLoader.
+ *
+ * Declaration of abcg::OpenGLTextureLoader.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_TEXTURE_LOADER_HPP_
+#define ABCG_OPENGL_TEXTURE_LOADER_HPP_
+
+#include "abcgOpenGLImage.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace abcg {
+class OpenGLTextureLoader;
+} // namespace abcg
+
+/**
+ * @brief A class for loading OpenGL textures without stalling the rendering
+ * loop.
+ *
+ * Images are decoded, converted and flipped on a pool of worker threads. The
+ * faces of a cubemap are decoded in parallel. Only the upload to the texture
+ * object is performed on the thread that owns the OpenGL context, in
+ * abcg::OpenGLTextureLoader::poll, which is called once per frame by
+ * abcg::OpenGLWindow.
+ *
+ * The texture ID is delivered through a future and an optional callback, and
+ * is valid only after the upload:
+ * @code
+ * (void)getTextureLoader().load({.path = "maps/diffuse.png"},
+ *                               [this](GLuint texture) {
+ *                                 m_diffuseTexture = texture;
+ *                               });
+ * @endcode
+ *
+ * Pixels are transferred through an abcg::OpenGLUploadRing so that uploads
+ * overlap with rendering. To avoid hitches, each call to
+ * abcg::OpenGLTextureLoader::poll uploads at most the number of bytes set with
+ * abcg::OpenGLTextureLoader::setUploadBudget. At least one texture is uploaded
+ * per call, even if its size exceeds the budget.
+ *
+ * @remark In WebAssembly builds, images are decoded on the calling thread
+ * and uploaded from client memory on the next call to
+ * abcg::OpenGLTextureLoader::poll.
+ *
+ * @sa abcg::OpenGLWindow::getTextureLoader.
+ */
+class abcg::OpenGLTextureLoader {
+public:
+  OpenGLTextureLoader() = default;
+  OpenGLTextureLoader(OpenGLTextureLoader const &) = delete;
+  OpenGLTextureLoader(OpenGLTextureLoader &&) = delete;
+  OpenGLTextureLoader &operator=(OpenGLTextureLoader const &) = delete;
+  OpenGLTextureLoader &operator=(OpenGLTextureLoader &&) = delete;
+  ~OpenGLTextureLoader();
+
+  [[nodiscard]] std::future<GLuint>
+  load(OpenGLTextureCreateInfo const &createInfo,
+       std::function<void(GLuint)> const &onReady = {});
+  [[nodiscard]] std::future<GLuint>
+  loadCubemap(OpenGLCubemapCreateInfo const &createInfo,
+              std::function<void(GLuint)> const &onReady = {});
+  void poll();
+  void destroy();
+
+  [[nodiscard]] std::size_t getPendingCount() const;
+  [[nodiscard]] std::size_t getUploadBudget() const noexcept;
+  void setUploadBudget(std::size_t bytesPerFrame);
+
+private:
+  struct Job {
+    bool cubemap{};
+    // Storage for the paths referenced by the create info structures
+    std::array<std::string, 6> paths;
+    OpenGLTextureCreateInfo textureCreateInfo;
+    OpenGLCubemapCreateInfo cubemapCreateInfo;
+    std::vector<OpenGLImage> images;
+    std::size_t sizeInBytes{};
+    // Number of images not decoded yet, and the first decoding error
+    std::size_t remaining{};
+    std::exception_ptr error;
+    std::promise<GLuint> promise;
+    std::function<void(GLuint)> onReady;
+  };
+  struct Task {
+    std::shared_ptr<Job> job;
+    std::size_t index{};
+  };
+
+  std::future<GLuint> enqueue(std::shared_ptr<Job> const &job);
+  void decode(Task const &task);
+  void run();
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::deque<Task> m_tasks;
+  std::vector<std::shared_ptr<Job>> m_jobs;
+  std::vector<std::thread> m_threads;
+  bool m_stopping{};
+
+  // Accessed only from the thread that owns the OpenGL context
+  OpenGLUploadRing m_uploadRing;
+  std::size_t m_uploadBudget{8 * 1024 * 1024};
+};
+
+#endif
@@ -0,0 +1,248 @@
+/**
+ * @file abcgOpenGLUploadRing.cpp
+ * @brief Definition of abcg::OpenGLUploadRing members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLUploadRing.hpp"
+
+#include <gsl/gsl>
+
+#include <cstring>
+#include <tuple>
+#include <utility>
+
+#include "abcgException.hpp"
+
+namespace {
+// Alignment of the offsets returned by abcg::OpenGLUploadRing::write. Large
+// enough for any unpack alignment and for fast copies
+constexpr std::size_t writeAlignment{64};
+
+[[nodiscard]] constexpr std::size_t alignUp(std::size_t offset) {
+  return (offset + writeAlignment - 1) & ~(writeAlignment - 1);
+}
+} // namespace
+
+/**
+ * @brief Destructor. Releases the buffer object.
+ */
+abcg::OpenGLUploadRing::~OpenGLUploadRing() { destroy(); }
+
+/**
+ * @brief Creates the buffer object of the ring.
+ *
+ * Any previous buffer is destroyed.
+ *
+ * @param size Size of the ring in bytes.
+ *
+ * @throw abcg::RuntimeError if the ring is not supported or if the buffer
+ * could not be mapped.
+ */
+void abcg::OpenGLUploadRing::create(std::size_t size) {
+  destroy();
+
+  if (!isSupported()) {
+    throw abcg::RuntimeError("Upload ring is not supported");
+  }
+
+  m_size = size;
+  glGenBuffers(1, &m_buffer);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+#if !defined(__EMSCRIPTEN__)
+  if (isPersistentMappingSupported()) {
+    GLbitfield const flags{GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT |
+                           GL_MAP_COHERENT_BIT};
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, gsl::narrow<GLsizeiptr>(size),
+                    nullptr, flags);
+    m_mappedData = static_cast<std::byte *>(glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER, 0, gsl::narrow<GLsizeiptr>(size), flags));
+    if (m_mappedData == nullptr) {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      destroy();
+      throw abcg::RuntimeError("Failed to map upload ring");
+    }
+  } else
+#endif
+  {
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, gsl::narrow<GLsizeiptr>(size),
+                 nullptr, GL_STREAM_DRAW);
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+/**
+ * @brief Releases the buffer object and the pending fences.
+ */
+void abcg::OpenGLUploadRing::destroy() {
+  for (auto const &region : m_regions) {
+    glDeleteSync(region.fence);
+  }
+  m_regions.clear();
+
+  if (m_buffer != 0) {
+    if (m_mappedData != nullptr) {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &m_buffer);
+  }
+
+  m_buffer = 0;
+  m_mappedData = nullptr;
+  m_size = 0;
+  m_head = 0;
+  m_used = 0;
+  m_unfenced = 0;
+}
+
+/**
+ * @brief Copies data into the ring.
+ *
+ * @param data Data to be copied.
+ *
+ * @return Offset of the data in the buffer object, or `std::nullopt` if there
+ * is not enough free space until the GPU consumes earlier data.
+ */
+std::optional<std::size_t>
+abcg::OpenGLUploadRing::write(std::span<std::byte const> data) {
+  if (m_buffer == 0 || data.size() > m_size) {
+    return std::nullopt;
+  }
+
+  // Returns the offset of the write and the number of bytes it consumes,
+  // including padding and the unused space at the end of the buffer when
+  // wrapping around
+  auto const allocate{[this, size = data.size()] {
+    auto const offset{alignUp(m_head)};
+    if (offset + size > m_size) {
+      return std::pair{std::size_t{}, m_size - m_head + size};
+    }
+    return std::pair{offset, offset - m_head + size};
+  }};
+
+  auto [offset, consumed]{allocate()};
+  if (m_used + consumed > m_size) {
+    retire();
+    std::tie(offset, consumed) = allocate();
+    if (m_used + consumed > m_size) {
+      return std::nullopt;
+    }
+  }
+
+  if (m_mappedData != nullptr) {
+    std::memcpy(m_mappedData + offset, data.data(), data.size()); // NOLINT
+  } else {
+    // The GPU is not reading this range, as guaranteed by the fences
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+    auto *const mappedData{glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER, gsl::narrow<GLintptr>(offset),
+        gsl::narrow<GLsizeiptr>(data.size()),
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+            GL_MAP_UNSYNCHRONIZED_BIT)};
+    if (mappedData != nullptr) {
+      std::memcpy(mappedData, data.data(), data.size());
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (mappedData == nullptr) {
+      return std::nullopt;
+    }
+  }
+
+  m_head = offset + data.size();
+  m_used += consumed;
+  m_unfenced += consumed;
+  return offset;
+}
+
+/**
+ * @brief Inserts a fence that releases the data written since the last fence
+ * once the GPU has executed the commands issued so far.
+ */
+void abcg::OpenGLUploadRing::fence() {
+  if (m_unfenced == 0) {
+    return;
+  }
+  m_regions.push_back(
+      {.size = m_unfenced,
+       .fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)});
+  m_unfenced = 0;
+}
+
+/**
+ * @brief Returns the ID of the buffer object.
+ *
+ * @return ID of the buffer object, or 0 if the ring has not been created.
+ */
+GLuint abcg::OpenGLUploadRing::getBuffer() const noexcept { return m_buffer; }
+
+/**
+ * @brief Returns the size of the ring.
+ *
+ * @return Size of the ring in bytes.
+ */
+std::size_t abcg::OpenGLUploadRing::getSize() const noexcept { return m_size; }
+
+/**
+ * @brief Returns whether the buffer object is persistently mapped.
+ *
+ * @return `true` if data is written directly into the mapped buffer; `false`
+ * otherwise.
+ */
+bool abcg::OpenGLUploadRing::isPersistentlyMapped() const noexcept {
+  return m_mappedData != nullptr;
+}
+
+/**
+ * @brief Returns whether the upload ring can be created.
+ *
+ * @return `false` in WebAssembly builds, as WebGL cannot map buffers; `true`
+ * otherwise.
+ */
+bool abcg::OpenGLUploadRing::isSupported() {
+#if defined(__EMSCRIPTEN__)
+  return false;
+#else
+  return true;
+#endif
+}
+
+/**
+ * @brief Returns whether the buffer object can be persistently mapped.
+ *
+ * @return `true` if OpenGL 4.4 or `ARB_buffer_storage` is available; `false`
+ * otherwise.
+ */
+bool abcg::OpenGLUploadRing::isPersistentMappingSupported() {
+#if defined(__EMSCRIPTEN__)
+  return false;
+#else
+  return GLEW_VERSION_4_4 == GL_TRUE || GLEW_ARB_buffer_storage == GL_TRUE;
+#endif
+}
+
+// Releases the regions the GPU has finished reading
+void abcg::OpenGLUploadRing::retire() {
+  while (!m_regions.empty()) {
+    auto const &region{m_regions.front()};
+    if (auto const status{glClientWaitSync(region.fence, 0, 0)};
+        status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+      break;
+    }
+    glDeleteSync(region.fence);
+    m_used -= region.size;
+    m_regions.pop_front();
+  }
+
+  // Restart from the beginning when the ring is empty, which avoids wrapping
+  // around in the middle of a large write
+  if (m_used == 0) {
+    m_head = 0;
+  }
+}
@@ -0,0 +1,92 @@
+/**
+ * @file abcgOpenGLUploadRing.hpp
+ * @brief Header file of abcg::OpenGLUploadRing.
+ *
+ * Declaration of abcg::OpenGLUploadRing.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_UPLOAD_RING_HPP_
+#define ABCG_OPENGL_UPLOAD_RING_HPP_
+
+#include "abcgOpenGLExternal.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <span>
+
+namespace abcg {
+class OpenGLUploadRing;
+} // namespace abcg
+
+/**
+ * @brief A ring buffer of pixel unpack memory for streaming texture data to
+ * the GPU.
+ *
+ * The ring is a single pixel buffer object (PBO). Data written with
+ * abcg::OpenGLUploadRing::write is copied into the buffer, and the returned
+ * offset is used as the pixel pointer of `glTexImage2D` or `glTexSubImage2D`
+ * while the buffer is bound to `GL_PIXEL_UNPACK_BUFFER`. The transfer to the
+ * texture is then performed by the driver without stalling the application.
+ *
+ * If `ARB_buffer_storage` is available, the buffer is persistently mapped and
+ * data is written directly into GPU-visible memory. Otherwise, each write maps
+ * the written range with `GL_MAP_UNSYNCHRONIZED_BIT`.
+ *
+ * Space is reclaimed in the order it was written. Calling
+ * abcg::OpenGLUploadRing::fence after the commands that read the written data
+ * inserts a fence that releases that data once the GPU has consumed it.
+ *
+ * All member functions must be called from the thread that owns the OpenGL
+ * context.
+ *
+ * @remark The ring is not available in WebAssembly builds.
+ */
+class abcg::OpenGLUploadRing {
+public:
+  OpenGLUploadRing() = default;
+  OpenGLUploadRing(OpenGLUploadRing const &) = delete;
+  OpenGLUploadRing(OpenGLUploadRing &&) = delete;
+  OpenGLUploadRing &operator=(OpenGLUploadRing const &) = delete;
+  OpenGLUploadRing &operator=(OpenGLUploadRing &&) = delete;
+  ~OpenGLUploadRing();
+
+  void create(std::size_t size);
+  void destroy();
+
+  [[nodiscard]] std::optional<std::size_t>
+  write(std::span<std::byte const> data);
+  void fence();
+
+  [[nodiscard]] GLuint getBuffer() const noexcept;
+  [[nodiscard]] std::size_t getSize() const noexcept;
+  [[nodiscard]] bool isPersistentlyMapped() const noexcept;
+
+  [[nodiscard]] static bool isSupported();
+  [[nodiscard]] static bool isPersistentMappingSupported();
+
+private:
+  struct Region {
+    std::size_t size{};
+    GLsync fence{};
+  };
+
+  void retire();
+
+  GLuint m_buffer{};
+  std::byte *m_mappedData{};
+  std::size_t m_size{};
+  // Next write position, and number of bytes that cannot be overwritten yet
+  std::size_t m_head{};
+  std::size_t m_used{};
+  // Bytes written since the last fence, and fenced regions in flight
+  std::size_t m_unfenced{};
+  std::deque<Region> m_regions;
+};
+
+#endif
@@ -17,6 +17,7 @@
 
 #include "abcgEmbeddedFonts.hpp"
 #include "abcgException.hpp"
+#include "abcgShaderWatcher.hpp"
 #include "abcgWindow.hpp"
 
 /**
@@ -76,6 +77,86 @@ void abcg::OpenGLWindow::saveScreenshotPNG(std::string_view filename) const {
   }
 }
 
+/**
+ * @brief Access to the program builder of this window.
+ *
+ * The program builder can be used to create programs without stalling the
+ * rendering loop. Pending builds are advanced at the beginning of each frame,
+ * before abcg::OpenGLWindow::onUpdate.
+ *
+ * @return Reference to the abcg::OpenGLProgramBuilder of this window.
+ */
+abcg::OpenGLProgramBuilder &abcg::OpenGLWindow::getProgramBuilder() noexcept {
+  return m_programBuilder;
+}
+
+/**
+ * @brief Access to the texture loader of this window.
+ *
+ * The texture loader can be used to load textures without stalling the
+ * rendering loop. Decoded images are uploaded at the beginning of each frame,
+ * before abcg::OpenGLWindow::onUpdate. The worker threads of the loader are
+ * started on the first load.
+ *
+ * @return Reference to the abcg::OpenGLTextureLoader of this window.
+ */
+abcg::OpenGLTextureLoader &abcg::OpenGLWindow::getTextureLoader() {
+  if (!m_textureLoader) {
+    m_textureLoader = std::make_unique<OpenGLTextureLoader>();
+  }
+  return *m_textureLoader;
+}
+
+/**
+ * @brief Rebuilds a program whenever its shader files change.
+ *
+ * When any of the shader files, or any file they include, is modified, a new
+ * program is built with abcg::OpenGLProgramBuilder::rebuild. Only the changed
+ * shaders are compiled again; the shader objects of the other stages are kept
+ * from the previous rebuild and linked as they are. The first rebuild compiles
+ * all shaders. Only after the build succeeds is the old program deleted and
+ * `program` replaced with the new one.
+ * If the build fails, the error is printed and `program` is left untouched, so
+ * the last working program keeps being used.
+ *
+ * @param pathsOrSources Paths or source codes of the shaders of the program.
+ * @param program Program object to be replaced. It must outlive the watch.
+ *
+ * @return ID of the watched group, to be used with
+ * abcg::ShaderWatcher::unwatch.
+ */
+std::size_t
+abcg::OpenGLWindow::watchProgram(std::vector<ShaderSource> const &pathsOrSources,
+                                 GLuint &program) {
+  auto const shaders{m_watchedShaders.emplace_back(
+      std::make_shared<std::vector<OpenGLShader>>())};
+  return getShaderWatcher().watch(
+      pathsOrSources,
+      [this, pathsOrSources, shaders, &program](auto const &changedIndices) {
+        auto const future{std::make_shared<std::future<GLuint>>()};
+        auto const onReady{[&program, future](GLuint newProgram) {
+          if (newProgram == 0) {
+            try {
+              (void)future->get();
+            } catch (std::exception const &exception) {
+              fmt::print(stderr, "{}\nKeeping the previous program\n",
+                         exception.what());
+            }
+            return;
+          }
+          glDeleteProgram(program);
+          program = newProgram;
+        }};
+        try {
+          *future = m_programBuilder.rebuild(pathsOrSources, changedIndices,
+                                             shaders, onReady);
+        } catch (std::exception const &exception) {
+          fmt::print(stderr, "{}\nKeeping the previous program\n",
+                     exception.what());
+        }
+      });
+}
+
 /**
  * @brief Custom event handler.
  *
@@ -380,6 +461,15 @@ void abcg::OpenGLWindow::create() {
       "GLSL version...: {}\n",
       reinterpret_cast<char const *>(glGetString(GL_SHADING_LANGUAGE_VERSION)));
 
+#if !defined(__EMSCRIPTEN__)
+  // Let the driver use as many threads as it wants for compiling shaders
+  if (GLEW_KHR_parallel_shader_compile == GL_TRUE) {
+    glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+  } else if (GLEW_ARB_parallel_shader_compile == GL_TRUE) {
+    glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+  }
+#endif
+
   // Print out extensions
   // GLint numExtensions{};
   // glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
@@ -425,6 +515,12 @@ void abcg::OpenGLWindow::create() {
 }
 
 void abcg::OpenGLWindow::paint() {
+  // Deliver programs and textures that finished loading since the last frame
+  m_programBuilder.poll();
+  if (m_textureLoader) {
+    m_textureLoader->poll();
+  }
+
   onUpdate();
 
   if (m_hidden || m_minimized)
@@ -464,6 +560,15 @@ void abcg::OpenGLWindow::paint() {
 void abcg::OpenGLWindow::destroy() {
   onDestroy();
 
+  m_programBuilder.destroy();
+  m_textureLoader.reset();
+  for (auto const &shaders : m_watchedShaders) {
+    for (auto const &shader : *shaders) {
+      glDeleteShader(shader.shader);
+    }
+  }
+  m_watchedShaders.clear();
+
   if (ImGui::GetCurrentContext() != nullptr) {
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();
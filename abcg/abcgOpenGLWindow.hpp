@@ -13,10 +13,13 @@
 #ifndef ABCG_OPENGL_WINDOW_HPP_
 #define ABCG_OPENGL_WINDOW_HPP_
 
+#include <memory>
 #include <string>
 
 #include "abcgExternal.hpp"
 #include "abcgOpenGLFunction.hpp"
+#include "abcgOpenGLProgramBuilder.hpp"
+#include "abcgOpenGLTextureLoader.hpp"
 #include "abcgWindow.hpp"
 
 namespace abcg {
@@ -101,6 +104,10 @@ public:
   [[nodiscard]] OpenGLSettings const &getOpenGLSettings() const noexcept;
   void setOpenGLSettings(OpenGLSettings const &openGLSettings) noexcept;
   void saveScreenshotPNG(std::string_view filename) const;
+  [[nodiscard]] OpenGLProgramBuilder &getProgramBuilder() noexcept;
+  [[nodiscard]] OpenGLTextureLoader &getTextureLoader();
+  std::size_t watchProgram(std::vector<ShaderSource> const &pathsOrSources,
+                           GLuint &program);
 
 protected:
   virtual void onEvent(SDL_Event const &event);
@@ -121,6 +128,10 @@ private:
   OpenGLSettings m_openGLSettings;
   std::string m_GLSLVersion;
   SDL_GLContext m_GLContext{};
+  OpenGLProgramBuilder m_programBuilder;
+  std::unique_ptr<OpenGLTextureLoader> m_textureLoader;
+  // Shader objects kept between rebuilds of the watched programs
+  std::vector<std::shared_ptr<std::vector<OpenGLShader>>> m_watchedShaders;
   bool m_hidden{};
   bool m_minimized{};
 };
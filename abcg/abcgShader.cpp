@@ -0,0 +1,314 @@
+/**
+ * @file abcgShader.cpp
+ * @brief Definition of the shader source loader.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgShader.hpp"
+#include "abcgApplication.hpp"
+#include "abcgException.hpp"
+
+#include <fmt/core.h>
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+// A file of the include graph and the time it was last modified
+struct Dependency {
+  std::filesystem::path path;
+  std::filesystem::file_time_type lastWriteTime;
+};
+
+// Shader file with its #include directives expanded
+struct CachedSource {
+  std::shared_ptr<std::string const> source;
+  // The file itself followed by all files it includes, directly or not
+  std::vector<Dependency> dependencies;
+};
+
+struct SourceCache {
+  std::mutex mutex;
+  std::unordered_map<std::string, CachedSource> files;
+  // Inline source codes, keyed by the source code itself
+  std::unordered_map<std::string, CachedSource> inlineSources;
+};
+
+SourceCache &getSourceCache() {
+  static SourceCache cache;
+  return cache;
+}
+
+// Reads a whole file into a string sized up front
+[[nodiscard]] std::string readFile(std::filesystem::path const &path) {
+  std::ifstream stream(path, std::ios::binary | std::ios::ate);
+  if (!stream) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to read file {}", path.string()));
+  }
+
+  std::string contents(gsl::narrow<std::size_t>(stream.tellg()), '\0');
+  stream.seekg(0);
+  if (!stream.read(contents.data(),
+                   gsl::narrow<std::streamsize>(contents.size()))) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to read file {}", path.string()));
+  }
+  return contents;
+}
+
+// If line is an #include directive (#include "file" or #include <file>),
+// returns the name of the included file
+[[nodiscard]] std::optional<std::string_view>
+parseIncludeDirective(std::string_view line) {
+  auto const skipSpaces{[&line] {
+    line.remove_prefix(std::min(line.find_first_not_of(" \t"), line.size()));
+  }};
+
+  skipSpaces();
+  if (!line.starts_with('#')) {
+    return std::nullopt;
+  }
+  line.remove_prefix(1);
+  skipSpaces();
+  if (!line.starts_with("include")) {
+    return std::nullopt;
+  }
+  line.remove_prefix(std::string_view{"include"}.size());
+  skipSpaces();
+  if (line.empty() || (line.front() != '"' && line.front() != '<')) {
+    return std::nullopt;
+  }
+
+  auto const closing{line.front() == '"' ? '"' : '>'};
+  auto const end{line.find(closing, 1)};
+  if (end == std::string_view::npos) {
+    return std::nullopt;
+  }
+  return line.substr(1, end - 1);
+}
+
+[[nodiscard]] bool hasIncludeDirective(std::string_view text) {
+  while (!text.empty()) {
+    auto const lineEnd{text.find('\n')};
+    if (parseIncludeDirective(text.substr(0, lineEnd))) {
+      return true;
+    }
+    text.remove_prefix(lineEnd == std::string_view::npos ? text.size()
+                                                         : lineEnd + 1);
+  }
+  return false;
+}
+
+[[nodiscard]] bool isUpToDate(CachedSource const &cached) {
+  return std::ranges::all_of(cached.dependencies, [](auto const &dependency) {
+    std::error_code errorCode;
+    auto const lastWriteTime{
+        std::filesystem::last_write_time(dependency.path, errorCode)};
+    return !errorCode && lastWriteTime == dependency.lastWriteTime;
+  });
+}
+
+CachedSource const &loadFile(SourceCache &cache,
+                             std::filesystem::path const &path,
+                             std::vector<std::filesystem::path> &stack);
+
+// Replaces the #include directives of text with the contents of the included
+// files. Relative paths are resolved against baseDirectory. A #line directive
+// follows each included file so that the line numbers in compiler messages
+// still refer to the including text.
+void expandIncludes(SourceCache &cache, std::string_view text,
+                    std::filesystem::path const &baseDirectory,
+                    std::vector<std::filesystem::path> &stack,
+                    std::string &output,
+                    std::vector<Dependency> &dependencies) {
+  output.reserve(output.size() + text.size());
+
+  std::size_t lineNumber{};
+  while (!text.empty()) {
+    ++lineNumber;
+    auto const lineEnd{text.find('\n')};
+    auto const lineLength{lineEnd == std::string_view::npos ? text.size()
+                                                            : lineEnd + 1};
+    auto const line{text.substr(0, lineLength)};
+    text.remove_prefix(lineLength);
+
+    auto const includeName{parseIncludeDirective(line)};
+    if (!includeName) {
+      output.append(line);
+      continue;
+    }
+
+    auto const &included{
+        loadFile(cache, baseDirectory / *includeName, stack)};
+    output.append(*included.source);
+    if (!output.empty() && output.back() != '\n') {
+      output.push_back('\n');
+    }
+    // In GLSL 3.30 and later, and in GLSL ES 3.00, #line N sets the number of
+    // the next line to N
+    output.append(fmt::format("#line {}\n", lineNumber + 1));
+    for (auto const &dependency : included.dependencies) {
+      if (std::ranges::none_of(dependencies, [&](auto const &other) {
+            return other.path == dependency.path;
+          })) {
+        dependencies.push_back(dependency);
+      }
+    }
+  }
+}
+
+// Loads a shader file from the cache, (re)reading it and the files it includes
+// if they are not cached or have changed. The stack of files being loaded is
+// used to detect circular includes.
+CachedSource const &loadFile(SourceCache &cache,
+                             std::filesystem::path const &path,
+                             std::vector<std::filesystem::path> &stack) {
+  std::error_code errorCode;
+  auto const canonicalPath{std::filesystem::canonical(path, errorCode)};
+  if (errorCode) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to read file {}", path.string()));
+  }
+
+  if (std::ranges::find(stack, canonicalPath) != stack.end()) {
+    throw abcg::RuntimeError(
+        fmt::format("Circular #include of file {}", canonicalPath.string()));
+  }
+
+  auto const key{canonicalPath.string()};
+  if (auto const iter{cache.files.find(key)};
+      iter != cache.files.end() && isUpToDate(iter->second)) {
+    return iter->second;
+  }
+
+  auto const lastWriteTime{std::filesystem::last_write_time(canonicalPath)};
+  auto const contents{readFile(canonicalPath)};
+
+  std::string expanded;
+  std::vector<Dependency> dependencies{{canonicalPath, lastWriteTime}};
+  stack.push_back(canonicalPath);
+  expandIncludes(cache, contents, canonicalPath.parent_path(), stack,
+                 expanded, dependencies);
+  stack.pop_back();
+
+  auto &cached{cache.files[key]};
+  cached.source = std::make_shared<std::string const>(std::move(expanded));
+  cached.dependencies = std::move(dependencies);
+  return cached;
+}
+} // namespace
+
+/**
+ * @brief Loads the source code of a shader.
+ *
+ * If `pathOrSource` is the path of an existing file, the file is read and its
+ * `#include "file"` directives are replaced with the contents of the included
+ * files, resolved relative to the including file. Otherwise, `pathOrSource` is
+ * taken as the source code itself, and its `#include` directives are resolved
+ * relative to the assets path (see abcg::Application::getAssetsPath). Each
+ * included file is followed by a `#line` directive that restores the line
+ * numbering of the including source.
+ *
+ * Files are read once and cached together with their include graph. A file is
+ * read again only if it or any file it includes has been modified since it was
+ * cached. Inline source codes are cached as well, keyed by their contents, and
+ * are expanded again only if any file they include has been modified. Programs
+ * that use the same file or the same inline source code share the same source
+ * string.
+ *
+ * @param pathOrSource Path or source code of the shader.
+ *
+ * @throw abcg::RuntimeError if the file or any included file could not be
+ * read, or if there is a circular include.
+ *
+ * @return Shared pointer to the source code with includes expanded.
+ */
+std::shared_ptr<std::string const>
+abcg::loadShaderSource(std::string_view pathOrSource) {
+  static std::size_t const maxPathSize{260};
+
+  auto &cache{getSourceCache()};
+  std::scoped_lock const lock{cache.mutex};
+
+  std::vector<std::filesystem::path> stack;
+  if (std::error_code errorCode;
+      pathOrSource.size() <= maxPathSize &&
+      std::filesystem::is_regular_file(pathOrSource, errorCode)) {
+    return loadFile(cache, pathOrSource, stack).source;
+  }
+
+  std::string key{pathOrSource};
+  if (auto const iter{cache.inlineSources.find(key)};
+      iter != cache.inlineSources.end() && isUpToDate(iter->second)) {
+    return iter->second.source;
+  }
+
+  // Inline source code without #include directives is used as is
+  CachedSource cached;
+  if (!hasIncludeDirective(pathOrSource)) {
+    cached.source = std::make_shared<std::string const>(pathOrSource);
+  } else {
+    std::filesystem::path baseDirectory{abcg::Application::getAssetsPath()};
+    if (baseDirectory.empty()) {
+      baseDirectory = std::filesystem::current_path();
+    }
+
+    std::string expanded;
+    expandIncludes(cache, pathOrSource, baseDirectory, stack, expanded,
+                   cached.dependencies);
+    cached.source = std::make_shared<std::string const>(std::move(expanded));
+  }
+
+  auto const source{cached.source};
+  cache.inlineSources.insert_or_assign(std::move(key), std::move(cached));
+  return source;
+}
+
+/**
+ * @brief Returns the files a shader file depends on.
+ *
+ * @param path Path of a shader file loaded with abcg::loadShaderSource.
+ *
+ * @return Canonical paths of the file itself and all files it includes,
+ * directly or indirectly, or an empty container if the file is not in the
+ * cache.
+ */
+std::vector<std::filesystem::path>
+abcg::getShaderSourceDependencies(std::string_view path) {
+  auto &cache{getSourceCache()};
+  std::scoped_lock const lock{cache.mutex};
+
+  std::error_code errorCode;
+  auto const canonicalPath{std::filesystem::canonical(path, errorCode)};
+  if (errorCode) {
+    return {};
+  }
+
+  std::vector<std::filesystem::path> dependencies;
+  if (auto const iter{cache.files.find(canonicalPath.string())};
+      iter != cache.files.end()) {
+    dependencies.reserve(iter->second.dependencies.size());
+    for (auto const &dependency : iter->second.dependencies) {
+      dependencies.push_back(dependency.path);
+    }
+  }
+  return dependencies;
+}
+
+/**
+ * @brief Releases all shader sources cached by abcg::loadShaderSource.
+ */
+void abcg::clearShaderSourceCache() {
+  auto &cache{getSourceCache()};
+  std::scoped_lock const lock{cache.mutex};
+  cache.files.clear();
+  cache.inlineSources.clear();
+}
@@ -1,6 +1,7 @@
 /**
  * @file abcgShader.hpp
- * @brief Declaration of a structure for building shaders.
+ * @brief Declaration of a structure for building shaders and of the shader
+ * source loader.
  *
  * This file is part of ABCg (https://github.com/hbatagelo/abcg).
  *
@@ -11,12 +12,22 @@
 #ifndef ABCG_SHADER_HPP_
 #define ABCG_SHADER_HPP_
 
+#include <filesystem>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace abcg {
 struct ShaderSource;
 enum class ShaderStage;
+
+[[nodiscard]] std::shared_ptr<std::string const>
+loadShaderSource(std::string_view pathOrSource);
+[[nodiscard]] std::vector<std::filesystem::path>
+getShaderSourceDependencies(std::string_view path);
+void clearShaderSourceCache();
 } // namespace abcg
 
 /**
@@ -0,0 +1,306 @@
+/**
+ * @file abcgShaderWatcher.cpp
+ * @brief Definition of abcg::ShaderWatcher members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgShaderWatcher.hpp"
+
+#include <cppitertools/itertools.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <ranges>
+#include <tuple>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Interval between checks for changes, and between checks for the stop
+// request of the watcher thread
+constexpr std::chrono::milliseconds pollingInterval{100};
+} // namespace
+
+/**
+ * @brief Destructor. Stops the watcher thread.
+ */
+abcg::ShaderWatcher::~ShaderWatcher() { destroy(); }
+
+/**
+ * @brief Starts watching a group of shaders.
+ *
+ * The watcher thread is started on the first call.
+ *
+ * @param pathsOrSources Paths or source codes of the shaders. Source codes are
+ * not watched, but still count for the indices passed to `onChange`.
+ * @param onChange Function called from abcg::ShaderWatcher::dispatch when any
+ * of the shader files, or any file they include, is modified.
+ *
+ * @return ID of the group, to be used with abcg::ShaderWatcher::unwatch.
+ */
+std::size_t
+abcg::ShaderWatcher::watch(std::vector<ShaderSource> const &pathsOrSources,
+                           Callback const &onChange) {
+  Group group;
+  group.onChange = onChange;
+  group.paths.reserve(pathsOrSources.size());
+  for (auto const &pathOrSource : pathsOrSources) {
+    group.paths.push_back(pathOrSource.source);
+  }
+  updateDependencies(group);
+
+  std::scoped_lock const lock{m_mutex};
+  auto const id{m_nextID++};
+  for (auto const &dependencies : group.dependencies) {
+    m_files.insert(dependencies.begin(), dependencies.end());
+  }
+  m_groups.emplace(id, std::move(group));
+
+#if !defined(__EMSCRIPTEN__)
+  if (!m_running) {
+    m_running = true;
+    m_thread = std::thread(&ShaderWatcher::run, this);
+  }
+#endif
+
+  return id;
+}
+
+/**
+ * @brief Stops watching a group of shaders.
+ *
+ * Directories that no longer contain watched files are released by the watcher
+ * thread on its next iteration.
+ *
+ * @param id ID returned by abcg::ShaderWatcher::watch.
+ */
+void abcg::ShaderWatcher::unwatch(std::size_t id) {
+  std::scoped_lock const lock{m_mutex};
+  if (m_groups.erase(id) == 0) {
+    return;
+  }
+
+  m_files.clear();
+  for (auto const &group : m_groups | std::views::values) {
+    for (auto const &dependencies : group.dependencies) {
+      m_files.insert(dependencies.begin(), dependencies.end());
+    }
+  }
+}
+
+/**
+ * @brief Calls the functions of the groups whose files have changed since the
+ * last call.
+ *
+ * This must be called from the thread that owns the graphics context.
+ */
+void abcg::ShaderWatcher::dispatch() {
+  std::vector<std::tuple<std::size_t, std::vector<std::size_t>, Callback>>
+      pending;
+  {
+    std::scoped_lock const lock{m_mutex};
+    if (m_changedFiles.empty()) {
+      return;
+    }
+
+    auto const changedFiles{std::exchange(m_changedFiles, {})};
+    for (auto const &[id, group] : m_groups) {
+      std::vector<std::size_t> changedIndices;
+      for (auto &&[index, dependencies] : iter::enumerate(group.dependencies)) {
+        if (std::ranges::any_of(dependencies, [&](auto const &dependency) {
+              return changedFiles.contains(dependency);
+            })) {
+          changedIndices.push_back(index);
+        }
+      }
+      if (!changedIndices.empty()) {
+        pending.emplace_back(id, std::move(changedIndices), group.onChange);
+      }
+    }
+  }
+
+  // The lock is not held while calling back, as the callbacks may watch or
+  // unwatch groups
+  for (auto const &[id, changedIndices, onChange] : pending) {
+    onChange(changedIndices);
+
+    // The include graph may have changed
+    Group group;
+    {
+      std::scoped_lock const lock{m_mutex};
+      auto const iter{m_groups.find(id)};
+      if (iter == m_groups.end()) {
+        continue;
+      }
+      group.paths = iter->second.paths;
+    }
+    updateDependencies(group);
+    {
+      std::scoped_lock const lock{m_mutex};
+      if (auto const iter{m_groups.find(id)}; iter != m_groups.end()) {
+        for (auto const &dependencies : group.dependencies) {
+          m_files.insert(dependencies.begin(), dependencies.end());
+        }
+        iter->second.dependencies = std::move(group.dependencies);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Stops the watcher thread and forgets all groups.
+ */
+void abcg::ShaderWatcher::destroy() {
+  m_running = false;
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  std::scoped_lock const lock{m_mutex};
+  m_groups.clear();
+  m_files.clear();
+  m_changedFiles.clear();
+}
+
+// Finds the files each shader of the group depends on. Inline source codes and
+// files that cannot be read have no dependencies.
+void abcg::ShaderWatcher::updateDependencies(Group &group) {
+  static std::size_t const maxPathSize{260};
+
+  group.dependencies.clear();
+  group.dependencies.reserve(group.paths.size());
+  for (auto const &path : group.paths) {
+    auto &dependencies{group.dependencies.emplace_back()};
+    if (std::error_code errorCode;
+        path.size() > maxPathSize ||
+        !std::filesystem::is_regular_file(path, errorCode)) {
+      continue;
+    }
+    try {
+      // Makes sure the include graph of the file is up to date
+      [[maybe_unused]] auto const source{loadShaderSource(path)};
+      dependencies = getShaderSourceDependencies(path);
+    } catch (std::exception const &) {
+      // Watch at least the file itself, so that it is reported when fixed
+      dependencies = {std::filesystem::weakly_canonical(path)};
+    }
+  }
+}
+
+// Watcher thread. Changed files are added to m_changedFiles.
+void abcg::ShaderWatcher::run() {
+  std::map<std::filesystem::path, std::filesystem::file_time_type>
+      lastWriteTimes;
+
+#if defined(__linux__)
+  // Watch the parent directories instead of the files themselves, as editors
+  // often save a file by replacing it
+  auto const inotifyFD{inotify_init1(IN_NONBLOCK | IN_CLOEXEC)};
+  std::map<int, std::filesystem::path> watchedDirectories;
+#endif
+
+  while (m_running) {
+    std::set<std::filesystem::path> files;
+    {
+      std::scoped_lock const lock{m_mutex};
+      files = m_files;
+    }
+
+    std::set<std::filesystem::path> changedFiles;
+
+#if defined(__linux__)
+    if (inotifyFD >= 0) {
+      // Stop watching directories that no longer contain watched files, e.g.
+      // after abcg::ShaderWatcher::unwatch
+      std::erase_if(watchedDirectories, [&](auto const &entry) {
+        auto const &[watchDescriptor, directory]{entry};
+        if (std::ranges::any_of(files, [&](auto const &file) {
+              return file.parent_path() == directory;
+            })) {
+          return false;
+        }
+        inotify_rm_watch(inotifyFD, watchDescriptor);
+        return true;
+      });
+
+      for (auto const &file : files) {
+        auto const directory{file.parent_path()};
+        if (std::ranges::none_of(watchedDirectories, [&](auto const &entry) {
+              return entry.second == directory;
+            })) {
+          if (auto const watchDescriptor{inotify_add_watch(
+                  inotifyFD, directory.c_str(),
+                  IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE)};
+              watchDescriptor >= 0) {
+            watchedDirectories.emplace(watchDescriptor, directory);
+          }
+        }
+      }
+
+      pollfd pollFD{.fd = inotifyFD, .events = POLLIN, .revents = 0};
+      if (::poll(&pollFD, 1, static_cast<int>(pollingInterval.count())) <= 0) {
+        continue;
+      }
+
+      alignas(inotify_event) std::array<char, 4096> buffer{};
+      for (auto length{read(inotifyFD, buffer.data(), buffer.size())};
+           length > 0; length = read(inotifyFD, buffer.data(), buffer.size())) {
+        for (std::size_t offset{};
+             offset < static_cast<std::size_t>(length);) {
+          inotify_event const *event{
+              reinterpret_cast<inotify_event const *>( // NOLINT
+                  buffer.data() + offset)};            // NOLINT
+          offset += sizeof(inotify_event) + event->len;
+
+          auto const iter{watchedDirectories.find(event->wd)};
+          if (event->len == 0 || iter == watchedDirectories.end()) {
+            continue;
+          }
+          if (auto const path{iter->second / event->name};
+              files.contains(path)) {
+            changedFiles.insert(path);
+          }
+        }
+      }
+    } else
+#endif
+    {
+      // Fall back to polling the modification times
+      for (auto const &file : files) {
+        std::error_code errorCode;
+        auto const lastWriteTime{
+            std::filesystem::last_write_time(file, errorCode)};
+        if (errorCode) {
+          continue;
+        }
+        if (auto const [iter, inserted]{
+                lastWriteTimes.try_emplace(file, lastWriteTime)};
+            !inserted && iter->second != lastWriteTime) {
+          iter->second = lastWriteTime;
+          changedFiles.insert(file);
+        }
+      }
+      std::this_thread::sleep_for(pollingInterval);
+    }
+
+    if (!changedFiles.empty()) {
+      std::scoped_lock const lock{m_mutex};
+      m_changedFiles.merge(changedFiles);
+    }
+  }
+
+#if defined(__linux__)
+  if (inotifyFD >= 0) {
+    close(inotifyFD);
+  }
+#endif
+}
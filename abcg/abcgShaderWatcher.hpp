@@ -0,0 +1,102 @@
+/**
+ * @file abcgShaderWatcher.hpp
+ * @brief Header file of abcg::ShaderWatcher.
+ *
+ * Declaration of abcg::ShaderWatcher.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_SHADER_WATCHER_HPP_
+#define ABCG_SHADER_WATCHER_HPP_
+
+#include "abcgShader.hpp"
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace abcg {
+class ShaderWatcher;
+} // namespace abcg
+
+/**
+ * @brief A class for watching shader files for changes.
+ *
+ * Each call to abcg::ShaderWatcher::watch registers a group of shaders (e.g.,
+ * the stages of a program) and a function to be called when any of their files,
+ * or any file they include, is modified. Files are monitored on a background
+ * thread using inotify on Linux, or by polling their modification times on
+ * other platforms.
+ *
+ * Changes are only reported when abcg::ShaderWatcher::dispatch is called. The
+ * watcher owned by abcg::Window dispatches at the start of each frame, so
+ * handles can be swapped safely at the frame boundary.
+ *
+ * abcg::OpenGLWindow::watchProgram and abcg::VulkanWindow::watchPipeline use
+ * the watcher to recompile a program or pipeline and swap it in only if the
+ * build succeeds, so a shader with errors never replaces a working one:
+ * @code
+ * watchProgram({{.source = assetsPath + "scene.vert",
+ *                .stage = abcg::ShaderStage::Vertex},
+ *               {.source = assetsPath + "scene.frag",
+ *                .stage = abcg::ShaderStage::Fragment}},
+ *              m_program);
+ * @endcode
+ *
+ * This header is not included by abcg.hpp. Include it to call
+ * abcg::Window::getShaderWatcher directly.
+ *
+ * @remark The watcher is not available in WebAssembly builds.
+ */
+class abcg::ShaderWatcher {
+public:
+  /**
+   * @brief Function called when the shaders of a group have changed.
+   *
+   * The argument contains the indices of the changed shaders, in the order
+   * given to abcg::ShaderWatcher::watch.
+   */
+  using Callback = std::function<void(std::vector<std::size_t> const &)>;
+
+  ShaderWatcher() = default;
+  ShaderWatcher(ShaderWatcher const &) = delete;
+  ShaderWatcher(ShaderWatcher &&) = delete;
+  ShaderWatcher &operator=(ShaderWatcher const &) = delete;
+  ShaderWatcher &operator=(ShaderWatcher &&) = delete;
+  ~ShaderWatcher();
+
+  std::size_t watch(std::vector<ShaderSource> const &pathsOrSources,
+                    Callback const &onChange);
+  void unwatch(std::size_t id);
+  void dispatch();
+  void destroy();
+
+private:
+  struct Group {
+    std::vector<std::string> paths;
+    std::vector<std::vector<std::filesystem::path>> dependencies;
+    Callback onChange;
+  };
+
+  void updateDependencies(Group &group);
+  void run();
+
+  std::mutex m_mutex;
+  std::map<std::size_t, Group> m_groups;
+  std::size_t m_nextID{};
+  // Files being watched and files that have changed since the last dispatch
+  std::set<std::filesystem::path> m_files;
+  std::set<std::filesystem::path> m_changedFiles;
+
+  std::thread m_thread;
+  std::atomic<bool> m_running{};
+};
+
+#endif
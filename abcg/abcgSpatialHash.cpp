@@ -0,0 +1,125 @@
+/**
+ * @file abcgSpatialHash.cpp
+ * @brief Definition of abcg::SpatialHash2D members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgSpatialHash.hpp"
+
+#include <cppitertools/itertools.hpp>
+#include <gsl/gsl>
+
+#include <algorithm>
+
+#include "abcgException.hpp"
+
+/**
+ * @brief Sets the extent of the world and the size of the cells.
+ *
+ * The cells are resized so that a whole number of cells spans the world.
+ * Circles of the previous build are discarded.
+ *
+ * @param worldMin Minimum corner of the world.
+ * @param worldMax Maximum corner of the world.
+ * @param cellSize Approximate side length of the cells. For best
+ * performance, this should be about the diameter of the typical circle.
+ *
+ * @throw abcg::RuntimeError if the world is empty or the cell size is not
+ * positive.
+ */
+void abcg::SpatialHash2D::create(glm::vec2 const &worldMin,
+                                 glm::vec2 const &worldMax, float cellSize) {
+  if (glm::any(glm::lessThanEqual(worldMax, worldMin)) || cellSize <= 0.0f) {
+    throw abcg::RuntimeError("Invalid spatial hash dimensions");
+  }
+
+  m_worldMin = worldMin;
+  m_worldSize = worldMax - worldMin;
+  m_gridSize = glm::max(glm::ivec2{m_worldSize / cellSize}, glm::ivec2{1});
+  m_cellSize = m_worldSize / glm::vec2{m_gridSize};
+
+  m_positions.clear();
+  m_radii.clear();
+  m_maxRadius = 0.0f;
+  m_entries.clear();
+  auto const cellCount{gsl::narrow<std::size_t>(m_gridSize.x * m_gridSize.y)};
+  m_cellStarts.assign(cellCount + 1, 0);
+}
+
+/**
+ * @brief Builds the grid from a set of circles.
+ *
+ * @param positions Centers of the circles. Positions outside the world are
+ * wrapped around.
+ * @param radii Radii of the circles.
+ *
+ * @throw abcg::RuntimeError if the spans have different sizes.
+ */
+void abcg::SpatialHash2D::build(std::span<glm::vec2 const> positions,
+                                std::span<float const> radii) {
+  if (positions.size() != radii.size()) {
+    throw abcg::RuntimeError(
+        "Positions and radii must have the same number of elements");
+  }
+
+  m_positions.assign(positions.begin(), positions.end());
+  m_radii.assign(radii.begin(), radii.end());
+  m_maxRadius = radii.empty() ? 0.0f : std::ranges::max(radii);
+
+  // Counting sort of the circles by cell
+  std::vector<uint32_t> cellIndices(positions.size());
+  std::ranges::fill(m_cellStarts, 0);
+  for (auto &&[cellIndex, position] : iter::zip(cellIndices, positions)) {
+    auto const cell{glm::ivec2{(wrap(position) - m_worldMin) / m_cellSize}};
+    cellIndex = gsl::narrow_cast<uint32_t>(getCellIndex(cell));
+    ++m_cellStarts[cellIndex + 1];
+  }
+  for (auto const cellIndex : iter::range(m_cellStarts.size() - 1)) {
+    m_cellStarts[cellIndex + 1] += m_cellStarts[cellIndex];
+  }
+
+  m_entries.resize(positions.size());
+  auto cursors{m_cellStarts};
+  for (auto &&[index, cellIndex] : iter::enumerate(cellIndices)) {
+    m_entries[cursors[cellIndex]++] = gsl::narrow_cast<uint32_t>(index);
+  }
+}
+
+/**
+ * @brief Returns the shortest vector between two points of the world.
+ *
+ * @param from Start point.
+ * @param to End point.
+ *
+ * @return Vector from `from` to `to`, or to the nearest copy of `to` across
+ * the edges of the world.
+ */
+glm::vec2 abcg::SpatialHash2D::getDelta(glm::vec2 const &from,
+                                        glm::vec2 const &to) const noexcept {
+  auto const delta{to - from};
+  return delta - m_worldSize * glm::round(delta / m_worldSize);
+}
+
+/**
+ * @brief Wraps a point around the edges of the world.
+ *
+ * @param position Point to be wrapped.
+ *
+ * @return Point inside the world.
+ */
+glm::vec2
+abcg::SpatialHash2D::wrap(glm::vec2 const &position) const noexcept {
+  auto const local{position - m_worldMin};
+  return m_worldMin + local - m_worldSize * glm::floor(local / m_worldSize);
+}
+
+// Returns the index of a cell, wrapping the cell coordinates around the grid
+std::size_t
+abcg::SpatialHash2D::getCellIndex(glm::ivec2 const &cell) const noexcept {
+  auto const wrapped{(cell % m_gridSize + m_gridSize) % m_gridSize};
+  return gsl::narrow_cast<std::size_t>(wrapped.y * m_gridSize.x + wrapped.x);
+}
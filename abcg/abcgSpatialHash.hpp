@@ -0,0 +1,154 @@
+/**
+ * @file abcgSpatialHash.hpp
+ * @brief Header file of abcg::SpatialHash2D.
+ *
+ * Declaration of abcg::SpatialHash2D.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_SPATIAL_HASH_HPP_
+#define ABCG_SPATIAL_HASH_HPP_
+
+#include "abcgExternal.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace abcg {
+class SpatialHash2D;
+} // namespace abcg
+
+/**
+ * @brief Uniform grid for finding overlapping circles in a toroidal 2D world.
+ *
+ * The world is a rectangle whose opposite edges are connected, so that
+ * circles near one edge overlap circles near the opposite edge. Each circle
+ * is stored in the cell that contains its center. A query visits only the
+ * cells within the query radius plus the largest radius of the circles, and
+ * tests each candidate with the squared distance between the centers.
+ *
+ * The grid is rebuilt from scratch with abcg::SpatialHash2D::build, in time
+ * linear in the number of circles.
+ *
+ * Example:
+ * @code
+ * abcg::SpatialHash2D grid;
+ * grid.create({-1.0f, -1.0f}, {1.0f, 1.0f}, 0.25f);
+ * grid.build(positions, radii);
+ * grid.query(position, radius, [&](std::size_t index) {
+ *   // Circle at positions[index] overlaps the query circle
+ * });
+ * @endcode
+ */
+class abcg::SpatialHash2D {
+public:
+  void create(glm::vec2 const &worldMin, glm::vec2 const &worldMax,
+              float cellSize);
+  void build(std::span<glm::vec2 const> positions,
+             std::span<float const> radii);
+
+  template <typename Function>
+  void query(glm::vec2 const &position, float radius,
+             Function const &function) const;
+  template <typename Function> void forEachPair(Function const &function) const;
+
+  [[nodiscard]] glm::vec2 getDelta(glm::vec2 const &from,
+                                   glm::vec2 const &to) const noexcept;
+  [[nodiscard]] glm::vec2 wrap(glm::vec2 const &position) const noexcept;
+
+private:
+  [[nodiscard]] std::size_t getCellIndex(glm::ivec2 const &cell) const noexcept;
+
+  glm::vec2 m_worldMin{};
+  glm::vec2 m_worldSize{1.0f};
+  glm::vec2 m_cellSize{1.0f};
+  glm::ivec2 m_gridSize{1};
+
+  std::vector<glm::vec2> m_positions;
+  std::vector<float> m_radii;
+  float m_maxRadius{};
+
+  // Indices of the circles sorted by cell, and the index of the first circle
+  // of each cell, followed by the number of circles
+  std::vector<uint32_t> m_entries;
+  std::vector<uint32_t> m_cellStarts;
+};
+
+/**
+ * @brief Calls a function for each circle that overlaps a query circle.
+ *
+ * Circles overlap if the distance between their centers, measured across
+ * the edges of the world if shorter, is less than the sum of their radii.
+ *
+ * @tparam Function Type of the function.
+ *
+ * @param position Center of the query circle.
+ * @param radius Radius of the query circle.
+ * @param function Function called as `function(index)`, where `index` is the
+ * index of the overlapping circle in the spans passed to
+ * abcg::SpatialHash2D::build.
+ */
+template <typename Function>
+void abcg::SpatialHash2D::query(glm::vec2 const &position, float radius,
+                                Function const &function) const {
+  if (m_positions.empty()) {
+    return;
+  }
+
+  auto const center{wrap(position) - m_worldMin};
+  auto const reach{radius + m_maxRadius};
+  auto first{glm::ivec2{glm::floor((center - reach) / m_cellSize)}};
+  auto last{glm::ivec2{glm::floor((center + reach) / m_cellSize)}};
+
+  // Visit each cell at most once
+  for (auto const axis : {0, 1}) {
+    if (last[axis] - first[axis] + 1 >= m_gridSize[axis]) {
+      first[axis] = 0;
+      last[axis] = m_gridSize[axis] - 1;
+    }
+  }
+
+  for (auto y{first.y}; y <= last.y; ++y) {
+    for (auto x{first.x}; x <= last.x; ++x) {
+      auto const cellIndex{getCellIndex({x, y})};
+      for (auto entry{m_cellStarts[cellIndex]};
+           entry < m_cellStarts[cellIndex + 1]; ++entry) {
+        auto const index{m_entries[entry]};
+        auto const delta{getDelta(position, m_positions[index])};
+        auto const distance{radius + m_radii[index]};
+        if (glm::dot(delta, delta) < distance * distance) {
+          function(std::size_t{index});
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief Calls a function for each pair of overlapping circles.
+ *
+ * @tparam Function Type of the function.
+ *
+ * @param function Function called as `function(first, second)` once for each
+ * pair, where `first` and `second` are the indices of the circles, with
+ * `first < second`.
+ */
+template <typename Function>
+void abcg::SpatialHash2D::forEachPair(Function const &function) const {
+  for (std::size_t first{}; first < m_positions.size(); ++first) {
+    query(m_positions[first], m_radii[first],
+          [first, &function](std::size_t second) {
+            if (first < second) {
+              function(first, second);
+            }
+          });
+  }
+}
+
+#endif
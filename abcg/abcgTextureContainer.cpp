@@ -0,0 +1,1240 @@
+/**
+ * @file abcgTextureContainer.cpp
+ * @brief Definition of helper functions for loading KTX2 and DDS files.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgTextureContainer.hpp"
+
+#include <cppitertools/itertools.hpp>
+#include <fmt/core.h>
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+
+#include "abcgException.hpp"
+
+namespace {
+using Texel = std::array<uint8_t, 4>;
+using Block = std::array<Texel, 16>;
+
+// Levels are aligned to this number of bytes in abcg::TextureContainer::data
+constexpr std::size_t levelAlignment{16};
+
+// Reads a little-endian value from data at the given offset
+template <typename T>
+[[nodiscard]] T read(std::span<std::byte const> data, std::size_t offset) {
+  if (offset + sizeof(T) > data.size()) {
+    throw abcg::RuntimeError("Unexpected end of texture file");
+  }
+  T value{};
+  std::memcpy(&value, data.data() + offset, sizeof(T)); // NOLINT
+  return value;
+}
+
+// Maps a VkFormat value to a texture format
+[[nodiscard]] std::optional<abcg::TextureFormat>
+getFormatFromVkFormat(uint32_t vkFormat) {
+  using abcg::TextureFormat;
+  switch (vkFormat) {
+  case 37: // VK_FORMAT_R8G8B8A8_UNORM
+    return TextureFormat::RGBA8Unorm;
+  case 43: // VK_FORMAT_R8G8B8A8_SRGB
+    return TextureFormat::RGBA8SRGB;
+  case 131: // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+    return TextureFormat::BC1RGBUnorm;
+  case 132: // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+    return TextureFormat::BC1RGBSRGB;
+  case 133: // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+    return TextureFormat::BC1RGBAUnorm;
+  case 134: // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+    return TextureFormat::BC1RGBASRGB;
+  case 135: // VK_FORMAT_BC2_UNORM_BLOCK
+    return TextureFormat::BC2Unorm;
+  case 136: // VK_FORMAT_BC2_SRGB_BLOCK
+    return TextureFormat::BC2SRGB;
+  case 137: // VK_FORMAT_BC3_UNORM_BLOCK
+    return TextureFormat::BC3Unorm;
+  case 138: // VK_FORMAT_BC3_SRGB_BLOCK
+    return TextureFormat::BC3SRGB;
+  case 139: // VK_FORMAT_BC4_UNORM_BLOCK
+    return TextureFormat::BC4Unorm;
+  case 140: // VK_FORMAT_BC4_SNORM_BLOCK
+    return TextureFormat::BC4Snorm;
+  case 141: // VK_FORMAT_BC5_UNORM_BLOCK
+    return TextureFormat::BC5Unorm;
+  case 142: // VK_FORMAT_BC5_SNORM_BLOCK
+    return TextureFormat::BC5Snorm;
+  case 143: // VK_FORMAT_BC6H_UFLOAT_BLOCK
+    return TextureFormat::BC6HUfloat;
+  case 144: // VK_FORMAT_BC6H_SFLOAT_BLOCK
+    return TextureFormat::BC6HSfloat;
+  case 145: // VK_FORMAT_BC7_UNORM_BLOCK
+    return TextureFormat::BC7Unorm;
+  case 146: // VK_FORMAT_BC7_SRGB_BLOCK
+    return TextureFormat::BC7SRGB;
+  case 147: // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+    return TextureFormat::ETC2RGB8Unorm;
+  case 148: // VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK
+    return TextureFormat::ETC2RGB8SRGB;
+  case 149: // VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK
+    return TextureFormat::ETC2RGB8A1Unorm;
+  case 150: // VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK
+    return TextureFormat::ETC2RGB8A1SRGB;
+  case 151: // VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK
+    return TextureFormat::ETC2RGBA8Unorm;
+  case 152: // VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK
+    return TextureFormat::ETC2RGBA8SRGB;
+  default:
+    return std::nullopt;
+  }
+}
+
+// Maps a DXGI_FORMAT value to a texture format
+[[nodiscard]] std::optional<abcg::TextureFormat>
+getFormatFromDXGIFormat(uint32_t dxgiFormat) {
+  using abcg::TextureFormat;
+  switch (dxgiFormat) {
+  case 28: // DXGI_FORMAT_R8G8B8A8_UNORM
+    return TextureFormat::RGBA8Unorm;
+  case 29: // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+    return TextureFormat::RGBA8SRGB;
+  case 71: // DXGI_FORMAT_BC1_UNORM
+    return TextureFormat::BC1RGBAUnorm;
+  case 72: // DXGI_FORMAT_BC1_UNORM_SRGB
+    return TextureFormat::BC1RGBASRGB;
+  case 74: // DXGI_FORMAT_BC2_UNORM
+    return TextureFormat::BC2Unorm;
+  case 75: // DXGI_FORMAT_BC2_UNORM_SRGB
+    return TextureFormat::BC2SRGB;
+  case 77: // DXGI_FORMAT_BC3_UNORM
+    return TextureFormat::BC3Unorm;
+  case 78: // DXGI_FORMAT_BC3_UNORM_SRGB
+    return TextureFormat::BC3SRGB;
+  case 80: // DXGI_FORMAT_BC4_UNORM
+    return TextureFormat::BC4Unorm;
+  case 81: // DXGI_FORMAT_BC4_SNORM
+    return TextureFormat::BC4Snorm;
+  case 83: // DXGI_FORMAT_BC5_UNORM
+    return TextureFormat::BC5Unorm;
+  case 84: // DXGI_FORMAT_BC5_SNORM
+    return TextureFormat::BC5Snorm;
+  case 95: // DXGI_FORMAT_BC6H_UF16
+    return TextureFormat::BC6HUfloat;
+  case 96: // DXGI_FORMAT_BC6H_SF16
+    return TextureFormat::BC6HSfloat;
+  case 98: // DXGI_FORMAT_BC7_UNORM
+    return TextureFormat::BC7Unorm;
+  case 99: // DXGI_FORMAT_BC7_UNORM_SRGB
+    return TextureFormat::BC7SRGB;
+  default:
+    return std::nullopt;
+  }
+}
+
+// Maps a FourCC code of a legacy DDS file to a texture format
+[[nodiscard]] std::optional<abcg::TextureFormat>
+getFormatFromFourCC(std::string_view fourCC) {
+  using abcg::TextureFormat;
+  if (fourCC == "DXT1")
+    return TextureFormat::BC1RGBAUnorm;
+  if (fourCC == "DXT2" || fourCC == "DXT3")
+    return TextureFormat::BC2Unorm;
+  if (fourCC == "DXT4" || fourCC == "DXT5")
+    return TextureFormat::BC3Unorm;
+  if (fourCC == "ATI1" || fourCC == "BC4U")
+    return TextureFormat::BC4Unorm;
+  if (fourCC == "BC4S")
+    return TextureFormat::BC4Snorm;
+  if (fourCC == "ATI2" || fourCC == "BC5U")
+    return TextureFormat::BC5Unorm;
+  if (fourCC == "BC5S")
+    return TextureFormat::BC5Snorm;
+  return std::nullopt;
+}
+
+// Returns the size in bytes of an image of the given format and size
+[[nodiscard]] std::size_t getImageSize(abcg::TextureFormat format,
+                                       uint32_t width, uint32_t height) {
+  if (!abcg::isCompressedFormat(format)) {
+    return std::size_t{width} * height * abcg::getBlockSize(format);
+  }
+  return std::size_t{(width + 3) / 4} * ((height + 3) / 4) *
+         abcg::getBlockSize(format);
+}
+
+// Returns the number of levels of a full mipmap chain of an image of the given
+// size. Files with more levels would shift the size by 32 bits or more
+[[nodiscard]] uint32_t getMaxLevelCount(uint32_t width, uint32_t height) {
+  return gsl::narrow<uint32_t>(std::bit_width(std::max({width, height, 1U})));
+}
+
+// Appends a level to a texture container, copying its data from source
+void addLevel(abcg::TextureContainer &texture, uint32_t width, uint32_t height,
+              std::span<std::byte const> source) {
+  auto const size{getImageSize(texture.format, width, height)};
+  if (source.size() < size) {
+    throw abcg::RuntimeError("Unexpected end of texture file");
+  }
+  auto const offset{(texture.data.size() + levelAlignment - 1) /
+                    levelAlignment * levelAlignment};
+  texture.data.resize(offset + size);
+  std::copy_n(source.begin(), size,
+              std::next(texture.data.begin(),
+                        gsl::narrow<std::ptrdiff_t>(offset)));
+  texture.levels.push_back(
+      {.offset = offset, .size = size, .width = width, .height = height});
+}
+
+[[nodiscard]] abcg::TextureContainer
+parseKTX2(std::span<std::byte const> file, std::string_view path) {
+  // Header
+  auto const vkFormat{read<uint32_t>(file, 12)};
+  auto const width{read<uint32_t>(file, 20)};
+  auto const height{std::max(read<uint32_t>(file, 24), 1U)};
+  auto const depth{read<uint32_t>(file, 28)};
+  auto const layerCount{read<uint32_t>(file, 32)};
+  auto const faceCount{read<uint32_t>(file, 36)};
+  auto const levelCount{std::max(read<uint32_t>(file, 40), 1U)};
+  auto const supercompressionScheme{read<uint32_t>(file, 44)};
+
+  if (depth > 1 || layerCount > 1 || faceCount != 1) {
+    throw abcg::RuntimeError(
+        fmt::format("Only 2D textures are supported in {}", path));
+  }
+  if (supercompressionScheme != 0) {
+    throw abcg::RuntimeError(
+        fmt::format("Supercompressed texture files are not supported ({})",
+                    path));
+  }
+  auto const format{getFormatFromVkFormat(vkFormat)};
+  if (!format) {
+    throw abcg::RuntimeError(
+        fmt::format("Unsupported texture format {} in {}", vkFormat, path));
+  }
+  if (levelCount > getMaxLevelCount(width, height)) {
+    throw abcg::RuntimeError(
+        fmt::format("Invalid number of levels in {}", path));
+  }
+
+  // Level index, which follows the 80-byte header and the index of the data
+  // format descriptor, key/value data and supercompression global data
+  abcg::TextureContainer texture;
+  texture.format = *format;
+  for (auto const level : iter::range(levelCount)) {
+    auto const indexOffset{80 + std::size_t{level} * 24};
+    auto const byteOffset{read<uint64_t>(file, indexOffset)};
+    auto const byteLength{read<uint64_t>(file, indexOffset + 8)};
+    if (byteOffset > file.size() || byteLength > file.size() - byteOffset) {
+      throw abcg::RuntimeError(
+          fmt::format("Unexpected end of texture file {}", path));
+    }
+    addLevel(texture, std::max(width >> level, 1U),
+             std::max(height >> level, 1U),
+             file.subspan(gsl::narrow<std::size_t>(byteOffset),
+                          gsl::narrow<std::size_t>(byteLength)));
+  }
+  return texture;
+}
+
+[[nodiscard]] abcg::TextureContainer
+parseDDS(std::span<std::byte const> file, std::string_view path) {
+  constexpr std::size_t headerOffset{4};
+  constexpr uint32_t fourCCFlag{0x4};
+  constexpr uint32_t cubemapFlag{0x200};
+  constexpr uint32_t volumeFlag{0x200000};
+  constexpr uint32_t cubemapMiscFlag{0x4};
+
+  // DDS_HEADER
+  auto const height{read<uint32_t>(file, headerOffset + 8)};
+  auto const width{read<uint32_t>(file, headerOffset + 12)};
+  auto const levelCount{std::max(read<uint32_t>(file, headerOffset + 24), 1U)};
+  auto const pixelFormatFlags{read<uint32_t>(file, headerOffset + 76)};
+  std::string_view const fourCC{
+      reinterpret_cast<char const *>(file.data() + headerOffset + 80), // NOLINT
+      4};
+  auto const rgbBitCount{read<uint32_t>(file, headerOffset + 84)};
+  auto const redMask{read<uint32_t>(file, headerOffset + 88)};
+  auto const caps2{read<uint32_t>(file, headerOffset + 108)};
+
+  if ((caps2 & (cubemapFlag | volumeFlag)) != 0) {
+    throw abcg::RuntimeError(
+        fmt::format("Only 2D textures are supported in {}", path));
+  }
+
+  std::optional<abcg::TextureFormat> format;
+  auto dataOffset{headerOffset + 124};
+  if ((pixelFormatFlags & fourCCFlag) != 0 && fourCC == "DX10") {
+    // DDS_HEADER_DXT10
+    auto const dxgiFormat{read<uint32_t>(file, dataOffset)};
+    auto const miscFlag{read<uint32_t>(file, dataOffset + 8)};
+    auto const arraySize{read<uint32_t>(file, dataOffset + 12)};
+    if ((miscFlag & cubemapMiscFlag) != 0 || arraySize > 1) {
+      throw abcg::RuntimeError(
+          fmt::format("Only 2D textures are supported in {}", path));
+    }
+    format = getFormatFromDXGIFormat(dxgiFormat);
+    dataOffset += 20;
+  } else if ((pixelFormatFlags & fourCCFlag) != 0) {
+    format = getFormatFromFourCC(fourCC);
+  } else if (rgbBitCount == 32 && redMask == 0x000000FF) {
+    format = abcg::TextureFormat::RGBA8Unorm;
+  }
+  if (!format) {
+    throw abcg::RuntimeError(
+        fmt::format("Unsupported texture format in {}", path));
+  }
+  if (levelCount > getMaxLevelCount(width, height)) {
+    throw abcg::RuntimeError(
+        fmt::format("Invalid number of levels in {}", path));
+  }
+
+  abcg::TextureContainer texture;
+  texture.format = *format;
+  for (auto const level : iter::range(levelCount)) {
+    auto const levelWidth{std::max(width >> level, 1U)};
+    auto const levelHeight{std::max(height >> level, 1U)};
+    if (dataOffset > file.size()) {
+      throw abcg::RuntimeError(
+          fmt::format("Unexpected end of texture file {}", path));
+    }
+    addLevel(texture, levelWidth, levelHeight, file.subspan(dataOffset));
+    dataOffset += texture.levels.back().size;
+  }
+  return texture;
+}
+
+[[nodiscard]] Texel expand565(uint16_t color) {
+  auto const red{(color >> 11) & 31};
+  auto const green{(color >> 5) & 63};
+  auto const blue{color & 31};
+  return {gsl::narrow_cast<uint8_t>((red << 3) | (red >> 2)),
+          gsl::narrow_cast<uint8_t>((green << 2) | (green >> 4)),
+          gsl::narrow_cast<uint8_t>((blue << 3) | (blue >> 2)), 255};
+}
+
+// Decodes the color part of a BC1, BC2 or BC3 block. Blocks of BC2 and BC3
+// always use four colors
+void decodeBC1(std::byte const *data, Block &block, bool hasAlpha,
+               bool fourColors) {
+  std::span<std::byte const, 8> const bytes{data, 8};
+  auto const color0{read<uint16_t>(bytes, 0)};
+  auto const color1{read<uint16_t>(bytes, 2)};
+  auto const indices{read<uint32_t>(bytes, 4)};
+
+  std::array<Texel, 4> palette{expand565(color0), expand565(color1)};
+  auto const mix{[&](int weight0, int weight1, int divisor) {
+    Texel texel{};
+    for (auto const channel : iter::range(std::size_t{3})) {
+      texel.at(channel) = gsl::narrow_cast<uint8_t>(
+          (weight0 * palette[0].at(channel) +
+           weight1 * palette[1].at(channel)) /
+          divisor);
+    }
+    texel[3] = 255;
+    return texel;
+  }};
+  if (fourColors || color0 > color1) {
+    palette[2] = mix(2, 1, 3);
+    palette[3] = mix(1, 2, 3);
+  } else {
+    palette[2] = mix(1, 1, 2);
+    palette[3] = {0, 0, 0, gsl::narrow_cast<uint8_t>(hasAlpha ? 0 : 255)};
+  }
+
+  for (auto const index : iter::range(std::size_t{16})) {
+    auto const &color{palette.at((indices >> (2 * index)) & 3)};
+    std::copy_n(color.begin(), 3, block.at(index).begin());
+    if (!fourColors) {
+      block.at(index)[3] = color[3];
+    }
+  }
+}
+
+// Decodes a BC4 block into a channel of the texels. Signed values are mapped
+// to [0, 255]
+void decodeBC4(std::byte const *data, Block &block, std::size_t channel,
+               bool isSigned) {
+  std::span<std::byte const, 8> const bytes{data, 8};
+  auto const bits{read<uint64_t>(bytes, 0)};
+
+  std::array<int, 8> palette{};
+  if (isSigned) {
+    // -128 is an alias of -127
+    palette[0] = std::max(int{static_cast<int8_t>(bits & 0xFF)}, -127);
+    palette[1] = std::max(int{static_cast<int8_t>((bits >> 8) & 0xFF)}, -127);
+  } else {
+    palette[0] = static_cast<int>(bits & 0xFF);
+    palette[1] = static_cast<int>((bits >> 8) & 0xFF);
+  }
+  if (palette[0] > palette[1]) {
+    for (auto const index : iter::range(std::size_t{2}, std::size_t{8})) {
+      palette.at(index) =
+          (gsl::narrow_cast<int>(8 - index) * palette[0] +
+           gsl::narrow_cast<int>(index - 1) * palette[1]) /
+          7;
+    }
+  } else {
+    for (auto const index : iter::range(std::size_t{2}, std::size_t{6})) {
+      palette.at(index) =
+          (gsl::narrow_cast<int>(6 - index) * palette[0] +
+           gsl::narrow_cast<int>(index - 1) * palette[1]) /
+          5;
+    }
+    palette[6] = isSigned ? -127 : 0;
+    palette[7] = isSigned ? 127 : 255;
+  }
+
+  for (auto const index : iter::range(std::size_t{16})) {
+    auto const value{palette.at((bits >> (16 + 3 * index)) & 7)};
+    block.at(index).at(channel) = gsl::narrow_cast<uint8_t>(
+        isSigned ? ((value + 127) * 255 + 127) / 254 : value);
+  }
+}
+
+// Decodes the explicit alpha of a BC2 block
+void decodeBC2Alpha(std::byte const *data, Block &block) {
+  std::span<std::byte const, 8> const bytes{data, 8};
+  auto const bits{read<uint64_t>(bytes, 0)};
+  for (auto const index : iter::range(std::size_t{16})) {
+    block.at(index)[3] =
+        gsl::narrow_cast<uint8_t>(((bits >> (4 * index)) & 15) * 17);
+  }
+}
+
+// BC7 decoding, as specified by the Khronos Data Format Specification
+
+struct BC7Mode {
+  int numSubsets;
+  int partitionBits;
+  int rotationBits;
+  int indexSelectionBits;
+  int colorBits;
+  int alphaBits;
+  int endpointPBits;
+  int sharedPBits;
+  int indexBits;
+  int secondaryIndexBits;
+};
+
+constexpr std::array<BC7Mode, 8> bc7Modes{{{3, 4, 0, 0, 4, 0, 1, 0, 3, 0},
+                                           {2, 6, 0, 0, 6, 0, 0, 1, 3, 0},
+                                           {3, 6, 0, 0, 5, 0, 0, 0, 2, 0},
+                                           {2, 6, 0, 0, 7, 0, 1, 0, 2, 0},
+                                           {1, 0, 2, 1, 5, 6, 0, 0, 2, 3},
+                                           {1, 0, 2, 0, 7, 8, 0, 0, 2, 2},
+                                           {1, 0, 0, 0, 7, 7, 1, 0, 4, 0},
+                                           {2, 6, 0, 0, 5, 5, 1, 0, 2, 0}}};
+
+// Partitions of 2 subsets. Bit i is the subset of texel i
+constexpr std::array<uint16_t, 64> bc7Partitions2{
+    0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+    0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+    0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+    0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+    0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+    0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+    0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+    0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22};
+
+// Partitions of 3 subsets. Bits 2i and 2i+1 are the subset of texel i
+constexpr std::array<uint32_t, 64> bc7Partitions3{[] {
+  constexpr std::array<std::array<uint8_t, 16>, 64> subsets{{
+      {0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 1, 2, 2, 2, 2},
+      {0, 0, 0, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 2, 1},
+      {0, 0, 0, 0, 2, 0, 0, 1, 2, 2, 1, 1, 2, 2, 1, 1},
+      {0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 1, 0, 1, 1, 1},
+      {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2},
+      {0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 2, 2},
+      {0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1},
+      {0, 0, 1, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1},
+      {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2},
+      {0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2},
+      {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2},
+      {0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2},
+      {0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2},
+      {0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2},
+      {0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2, 1, 2, 2, 2},
+      {0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0, 2, 2, 2, 0},
+      {0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2},
+      {0, 1, 1, 1, 0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0},
+      {0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2},
+      {0, 0, 2, 2, 0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1},
+      {0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2, 0, 2, 2, 2},
+      {0, 0, 0, 1, 0, 0, 0, 1, 2, 2, 2, 1, 2, 2, 2, 1},
+      {0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2},
+      {0, 0, 0, 0, 1, 1, 0, 0, 2, 2, 1, 0, 2, 2, 1, 0},
+      {0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1, 0, 0, 0, 0},
+      {0, 0, 1, 2, 0, 0, 1, 2, 1, 1, 2, 2, 2, 2, 2, 2},
+      {0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1, 0, 1, 1, 0},
+      {0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1},
+      {0, 0, 2, 2, 1, 1, 0, 2, 1, 1, 0, 2, 0, 0, 2, 2},
+      {0, 1, 1, 0, 0, 1, 1, 0, 2, 0, 0, 2, 2, 2, 2, 2},
+      {0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1},
+      {0, 0, 0, 0, 2, 0, 0, 0, 2, 2, 1, 1, 2, 2, 2, 1},
+      {0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 2, 2, 2},
+      {0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 2, 0, 0, 1, 1},
+      {0, 0, 1, 1, 0, 0, 1, 2, 0, 0, 2, 2, 0, 2, 2, 2},
+      {0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0},
+      {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0},
+      {0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0},
+      {0, 1, 2, 0, 2, 0, 1, 2, 1, 2, 0, 1, 0, 1, 2, 0},
+      {0, 0, 1, 1, 2, 2, 0, 0, 1, 1, 2, 2, 0, 0, 1, 1},
+      {0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0, 1, 1},
+      {0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2},
+      {0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1},
+      {0, 0, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2, 1, 1, 2, 2},
+      {0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 1, 1},
+      {0, 2, 2, 0, 1, 2, 2, 1, 0, 2, 2, 0, 1, 2, 2, 1},
+      {0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 0, 1, 0, 1},
+      {0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1},
+      {0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2},
+      {0, 2, 2, 2, 0, 1, 1, 1, 0, 2, 2, 2, 0, 1, 1, 1},
+      {0, 0, 0, 2, 1, 1, 1, 2, 0, 0, 0, 2, 1, 1, 1, 2},
+      {0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2},
+      {0, 2, 2, 2, 0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2},
+      {0, 0, 0, 2, 1, 1, 1, 2, 1, 1, 1, 2, 0, 0, 0, 2},
+      {0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2},
+      {0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2},
+      {0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2, 2, 2, 2, 2},
+      {0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2},
+      {0, 0, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2},
+      {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2},
+      {0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 1},
+      {0, 2, 2, 2, 1, 2, 2, 2, 0, 2, 2, 2, 1, 2, 2, 2},
+      {0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2},
+      {0, 1, 1, 1, 2, 0, 1, 1, 2, 2, 0, 1, 2, 2, 2, 0},
+  }};
+  std::array<uint32_t, 64> partitions{};
+  for (std::size_t partition{}; partition < subsets.size(); ++partition) {
+    for (std::size_t texel{}; texel < 16; ++texel) {
+      partitions.at(partition) |= uint32_t{subsets.at(partition).at(texel)}
+                                  << (2 * texel);
+    }
+  }
+  return partitions;
+}()};
+
+// Anchor texels of the second subset of 2-subset partitions, and of the
+// second and third subsets of 3-subset partitions
+constexpr std::array<uint8_t, 64> bc7Anchors2{
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15, 2,  8,  2,  2,  8,  8,  15, 2,  8,  2,  2,  8,  8,  2,  2,
+    15, 15, 6,  8,  2,  8,  15, 15, 2,  8,  2,  2,  2,  15, 15, 6,
+    6,  2,  6,  8,  15, 15, 2,  2,  15, 15, 15, 15, 15, 2,  2,  15};
+constexpr std::array<uint8_t, 64> bc7Anchors3Second{
+    3,  3,  15, 15, 8,  3,  15, 15, 8,  8,  6,  6,  6,  5,  3,  3,
+    3,  3,  8,  15, 3,  3,  6,  10, 5,  8,  8,  6,  8,  5,  15, 15,
+    8,  15, 3,  5,  6,  10, 8,  15, 15, 3,  15, 5,  15, 15, 15, 15,
+    3,  15, 5,  5,  5,  8,  5,  10, 5,  10, 8,  13, 15, 12, 3,  3};
+constexpr std::array<uint8_t, 64> bc7Anchors3Third{
+    15, 8,  8,  3,  15, 15, 3,  8,  15, 15, 15, 15, 15, 15, 15, 8,
+    15, 8,  15, 3,  15, 8,  15, 8,  3,  15, 6,  10, 15, 15, 10, 8,
+    15, 3,  15, 10, 10, 8,  9,  10, 6,  15, 8,  15, 3,  6,  6,  8,
+    15, 3,  15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3,  15, 15, 8};
+
+// Interpolation weights of indices of 2, 3 and 4 bits
+constexpr std::array<uint8_t, 4> bc7Weights2{0, 21, 43, 64};
+constexpr std::array<uint8_t, 8> bc7Weights3{0, 9, 18, 27, 37, 46, 55, 64};
+constexpr std::array<uint8_t, 16> bc7Weights4{0,  4,  9,  13, 17, 21, 26, 30,
+                                              34, 38, 43, 47, 51, 55, 60, 64};
+
+// Reads bits of a 128-bit block, from the least significant bit
+class BitReader {
+public:
+  explicit BitReader(std::byte const *data) {
+    std::memcpy(m_bits.data(), data, sizeof(m_bits)); // NOLINT
+  }
+
+  [[nodiscard]] int read(int count) {
+    int value{};
+    for (auto const bit : iter::range(count)) {
+      auto const position{m_position++};
+      value |= gsl::narrow_cast<int>((m_bits.at(position / 64) >>
+                                      (position % 64)) &
+                                     1)
+               << bit;
+    }
+    return value;
+  }
+
+private:
+  std::array<uint64_t, 2> m_bits{};
+  std::size_t m_position{};
+};
+
+[[nodiscard]] int getBC7Subset(BC7Mode const &mode, int partition,
+                               std::size_t texel) {
+  switch (mode.numSubsets) {
+  case 2:
+    return (bc7Partitions2.at(gsl::narrow_cast<std::size_t>(partition)) >>
+            texel) &
+           1;
+  case 3:
+    return gsl::narrow_cast<int>(
+        (bc7Partitions3.at(gsl::narrow_cast<std::size_t>(partition)) >>
+         (2 * texel)) &
+        3);
+  default:
+    return 0;
+  }
+}
+
+[[nodiscard]] bool isBC7Anchor(BC7Mode const &mode, int partition,
+                               std::size_t texel) {
+  auto const index{gsl::narrow_cast<std::size_t>(partition)};
+  switch (mode.numSubsets) {
+  case 2:
+    return texel == 0 || texel == bc7Anchors2.at(index);
+  case 3:
+    return texel == 0 || texel == bc7Anchors3Second.at(index) ||
+           texel == bc7Anchors3Third.at(index);
+  default:
+    return texel == 0;
+  }
+}
+
+[[nodiscard]] uint8_t interpolateBC7(int endpoint0, int endpoint1,
+                                     int indexBits, int index) {
+  auto const position{gsl::narrow_cast<std::size_t>(index)};
+  auto const weight{indexBits == 2   ? bc7Weights2.at(position)
+                    : indexBits == 3 ? bc7Weights3.at(position)
+                                     : bc7Weights4.at(position)};
+  return gsl::narrow_cast<uint8_t>(
+      ((64 - weight) * endpoint0 + weight * endpoint1 + 32) >> 6);
+}
+
+void decodeBC7(std::byte const *data, Block &block) {
+  BitReader reader{data};
+
+  std::size_t modeIndex{};
+  while (modeIndex < bc7Modes.size() && reader.read(1) == 0) {
+    ++modeIndex;
+  }
+  if (modeIndex == bc7Modes.size()) {
+    // Reserved mode
+    block.fill({});
+    return;
+  }
+  auto const &mode{bc7Modes.at(modeIndex)};
+
+  auto const partition{reader.read(mode.partitionBits)};
+  auto const rotation{reader.read(mode.rotationBits)};
+  auto const indexSelection{reader.read(mode.indexSelectionBits)};
+
+  // Endpoints indexed by subset, endpoint and channel
+  std::array<std::array<std::array<int, 4>, 2>, 3> endpoints{};
+  auto const numSubsets{gsl::narrow_cast<std::size_t>(mode.numSubsets)};
+  for (auto const channel : iter::range(std::size_t{3})) {
+    for (auto const subset : iter::range(numSubsets)) {
+      for (auto &endpoint : endpoints.at(subset)) {
+        endpoint.at(channel) = reader.read(mode.colorBits);
+      }
+    }
+  }
+  if (mode.alphaBits > 0) {
+    for (auto const subset : iter::range(numSubsets)) {
+      for (auto &endpoint : endpoints.at(subset)) {
+        endpoint[3] = reader.read(mode.alphaBits);
+      }
+    }
+  }
+
+  // P-bits, appended to the endpoints as their least significant bits
+  std::array<std::array<int, 2>, 3> pBits{};
+  if (mode.endpointPBits > 0) {
+    for (auto const subset : iter::range(numSubsets)) {
+      for (auto &pBit : pBits.at(subset)) {
+        pBit = reader.read(1);
+      }
+    }
+  } else if (mode.sharedPBits > 0) {
+    for (auto const subset : iter::range(numSubsets)) {
+      pBits.at(subset).fill(reader.read(1));
+    }
+  }
+  auto const hasPBits{mode.endpointPBits > 0 || mode.sharedPBits > 0};
+
+  // Unquantize endpoints to 8 bits
+  auto const unquantize{[](int value, int bits) {
+    value <<= 8 - bits;
+    return value | (value >> bits);
+  }};
+  for (auto const subset : iter::range(numSubsets)) {
+    for (auto const endpointIndex : iter::range(std::size_t{2})) {
+      auto &endpoint{endpoints.at(subset).at(endpointIndex)};
+      auto const pBit{pBits.at(subset).at(endpointIndex)};
+      for (auto const channel : iter::range(std::size_t{4})) {
+        auto const bits{channel < 3 ? mode.colorBits : mode.alphaBits};
+        if (bits == 0) {
+          endpoint.at(channel) = 255;
+          continue;
+        }
+        auto value{endpoint.at(channel)};
+        auto numBits{bits};
+        if (hasPBits) {
+          value = (value << 1) | pBit;
+          ++numBits;
+        }
+        endpoint.at(channel) = unquantize(value, numBits);
+      }
+    }
+  }
+
+  // Primary and secondary indices. Anchor texels have one bit less
+  std::array<int, 16> indices{};
+  for (auto const texel : iter::range(std::size_t{16})) {
+    indices.at(texel) = reader.read(
+        mode.indexBits - (isBC7Anchor(mode, partition, texel) ? 1 : 0));
+  }
+  std::array<int, 16> secondaryIndices{};
+  if (mode.secondaryIndexBits > 0) {
+    for (auto const texel : iter::range(std::size_t{16})) {
+      secondaryIndices.at(texel) =
+          reader.read(mode.secondaryIndexBits - (texel == 0 ? 1 : 0));
+    }
+  }
+
+  for (auto const texel : iter::range(std::size_t{16})) {
+    auto const subset{
+        gsl::narrow_cast<std::size_t>(getBC7Subset(mode, partition, texel))};
+    auto const &endpoint0{endpoints.at(subset)[0]};
+    auto const &endpoint1{endpoints.at(subset)[1]};
+    auto &output{block.at(texel)};
+
+    auto colorBits{mode.indexBits};
+    auto colorIndex{indices.at(texel)};
+    auto alphaBits{mode.indexBits};
+    auto alphaIndex{indices.at(texel)};
+    if (mode.secondaryIndexBits > 0) {
+      alphaBits = mode.secondaryIndexBits;
+      alphaIndex = secondaryIndices.at(texel);
+      if (indexSelection != 0) {
+        std::swap(colorBits, alphaBits);
+        std::swap(colorIndex, alphaIndex);
+      }
+    }
+
+    for (auto const channel : iter::range(std::size_t{3})) {
+      output.at(channel) =
+          interpolateBC7(endpoint0.at(channel), endpoint1.at(channel),
+                         colorBits, colorIndex);
+    }
+    output[3] = interpolateBC7(endpoint0[3], endpoint1[3], alphaBits,
+                               alphaIndex);
+
+    if (rotation > 0) {
+      std::swap(output[3],
+                output.at(gsl::narrow_cast<std::size_t>(rotation - 1)));
+    }
+  }
+}
+
+// ETC2 decoding, as specified by the Khronos Data Format Specification
+
+constexpr std::array<std::array<int, 2>, 8> etc1Modifiers{
+    {{2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106},
+     {47, 183}}};
+
+constexpr std::array<int, 8> etc2Distances{3, 6, 11, 16, 23, 32, 41, 64};
+
+constexpr std::array<std::array<int, 8>, 16> eacModifiers{
+    {{-3, -6, -9, -15, 2, 5, 8, 14},
+     {-3, -7, -10, -13, 2, 6, 9, 12},
+     {-2, -5, -8, -13, 1, 4, 7, 12},
+     {-2, -4, -6, -13, 1, 3, 5, 12},
+     {-3, -6, -8, -12, 2, 5, 7, 11},
+     {-3, -7, -9, -11, 2, 6, 8, 10},
+     {-4, -7, -8, -11, 3, 6, 7, 10},
+     {-3, -5, -8, -11, 2, 4, 7, 10},
+     {-2, -6, -8, -10, 1, 5, 7, 9},
+     {-2, -5, -8, -10, 1, 4, 7, 9},
+     {-2, -4, -8, -10, 1, 3, 7, 9},
+     {-2, -5, -7, -10, 1, 4, 6, 9},
+     {-3, -4, -7, -10, 2, 3, 6, 9},
+     {-1, -2, -3, -10, 0, 1, 2, 9},
+     {-4, -6, -8, -9, 3, 5, 7, 8},
+     {-3, -5, -7, -9, 2, 4, 6, 8}}};
+
+[[nodiscard]] uint64_t readBigEndian64(std::byte const *data) {
+  uint64_t value{};
+  for (auto const index : iter::range(8)) {
+    value = (value << 8) |
+            std::to_integer<uint64_t>(data[index]); // NOLINT
+  }
+  return value;
+}
+
+[[nodiscard]] uint8_t clampToByte(int value) {
+  return gsl::narrow_cast<uint8_t>(std::clamp(value, 0, 255));
+}
+
+// Decodes the color part of an ETC2 block. If punchThrough is true, the block
+// is of the RGB8A1 format
+void decodeETC2(std::byte const *data, Block &block, bool punchThrough) {
+  auto const bits{readBigEndian64(data)};
+  auto const high{gsl::narrow_cast<uint32_t>(bits >> 32)};
+  auto const low{gsl::narrow_cast<uint32_t>(bits)};
+  auto const differential{(high & 2) != 0};
+  auto const flip{(high & 1) != 0};
+  // In the RGB8A1 format, the differential bit tells if the block is opaque
+  auto const opaque{!punchThrough || differential};
+
+  // Texels are indexed by column in the block
+  auto const getIndex{[low](std::size_t x, std::size_t y) {
+    auto const texel{x * 4 + y};
+    return gsl::narrow_cast<int>((((low >> (16 + texel)) & 1) << 1) |
+                                 ((low >> texel) & 1));
+  }};
+  auto const setTexel{[&block](std::size_t x, std::size_t y, int red,
+                               int green, int blue, bool transparent) {
+    block.at(y * 4 + x) = {clampToByte(red), clampToByte(green),
+                           clampToByte(blue),
+                           gsl::narrow_cast<uint8_t>(transparent ? 0 : 255)};
+  }};
+  auto const expand4{[](uint32_t value) {
+    return gsl::narrow_cast<int>((value << 4) | value);
+  }};
+  auto const expand5{[](uint32_t value) {
+    return gsl::narrow_cast<int>((value << 3) | (value >> 2));
+  }};
+
+  // Paints the texels of T and H modes
+  auto const paint{[&](std::array<std::array<int, 3>, 4> const &colors) {
+    for (auto const y : iter::range(std::size_t{4})) {
+      for (auto const x : iter::range(std::size_t{4})) {
+        auto const index{getIndex(x, y)};
+        auto const transparent{!opaque && index == 2};
+        auto const &color{colors.at(gsl::narrow_cast<std::size_t>(index))};
+        setTexel(x, y, transparent ? 0 : color[0], transparent ? 0 : color[1],
+                 transparent ? 0 : color[2], transparent);
+      }
+    }
+  }};
+
+  std::array<int, 3> base0{};
+  std::array<int, 3> base1{};
+  if (!differential && !punchThrough) {
+    // Individual mode
+    for (auto const channel : iter::range(std::size_t{3})) {
+      base0.at(channel) = expand4((high >> (28 - 8 * channel)) & 15);
+      base1.at(channel) = expand4((high >> (24 - 8 * channel)) & 15);
+    }
+  } else {
+    // Differential mode, unless a channel overflows
+    std::array<int, 3> overflow{};
+    for (auto const channel : iter::range(std::size_t{3})) {
+      auto const base{
+          gsl::narrow_cast<int>((high >> (27 - 8 * channel)) & 31)};
+      auto delta{gsl::narrow_cast<int>((high >> (24 - 8 * channel)) & 7)};
+      if (delta >= 4) {
+        delta -= 8;
+      }
+      overflow.at(channel) = base + delta < 0 || base + delta > 31 ? 1 : 0;
+      base0.at(channel) = expand5(gsl::narrow_cast<uint32_t>(base));
+      base1.at(channel) = expand5(gsl::narrow_cast<uint32_t>(
+          std::clamp(base + delta, 0, 31)));
+    }
+
+    if (overflow[0] != 0) {
+      // T mode
+      auto const red0{(((high >> 27) & 3) << 2) | ((high >> 24) & 3)};
+      std::array const color0{expand4(red0), expand4((high >> 20) & 15),
+                              expand4((high >> 16) & 15)};
+      std::array const color1{expand4((high >> 12) & 15),
+                              expand4((high >> 8) & 15),
+                              expand4((high >> 4) & 15)};
+      auto const distance{etc2Distances.at(((high >> 1) & 6) | (high & 1))};
+      std::array<std::array<int, 3>, 4> colors{color0, color1, color1,
+                                               color1};
+      for (auto const channel : iter::range(std::size_t{3})) {
+        colors[1].at(channel) += distance;
+        colors[3].at(channel) -= distance;
+      }
+      paint(colors);
+      return;
+    }
+
+    if (overflow[1] != 0) {
+      // H mode
+      auto const red0{(high >> 27) & 15};
+      auto const green0{(((high >> 24) & 7) << 1) | ((high >> 20) & 1)};
+      auto const blue0{(((high >> 19) & 1) << 3) | ((high >> 15) & 7)};
+      auto const red1{(high >> 11) & 15};
+      auto const green1{(high >> 7) & 15};
+      auto const blue1{(high >> 3) & 15};
+      auto const value0{(red0 << 8) | (green0 << 4) | blue0};
+      auto const value1{(red1 << 8) | (green1 << 4) | blue1};
+      auto const distance{etc2Distances.at(((high >> 2) & 1) << 2 |
+                                           (high & 1) << 1 |
+                                           (value0 >= value1 ? 1 : 0))};
+      std::array const color0{expand4(red0), expand4(green0), expand4(blue0)};
+      std::array const color1{expand4(red1), expand4(green1), expand4(blue1)};
+      std::array<std::array<int, 3>, 4> colors{color0, color0, color1,
+                                               color1};
+      for (auto const channel : iter::range(std::size_t{3})) {
+        colors[0].at(channel) += distance;
+        colors[1].at(channel) -= distance;
+        colors[2].at(channel) += distance;
+        colors[3].at(channel) -= distance;
+      }
+      paint(colors);
+      return;
+    }
+
+    if (overflow[2] != 0) {
+      // Planar mode
+      auto const expand6{[](uint32_t value) {
+        return gsl::narrow_cast<int>((value << 2) | (value >> 4));
+      }};
+      auto const expand7{[](uint32_t value) {
+        return gsl::narrow_cast<int>((value << 1) | (value >> 6));
+      }};
+      std::array const origin{
+          expand6((high >> 25) & 63),
+          expand7((((high >> 24) & 1) << 6) | ((high >> 17) & 63)),
+          expand6((((high >> 16) & 1) << 5) | (((high >> 11) & 3) << 3) |
+                  ((high >> 7) & 7))};
+      std::array const horizontal{
+          expand6((((high >> 2) & 31) << 1) | (high & 1)),
+          expand7((low >> 25) & 127), expand6((low >> 19) & 63)};
+      std::array const vertical{expand6((low >> 13) & 63),
+                                expand7((low >> 6) & 127),
+                                expand6(low & 63)};
+      for (auto const y : iter::range(4)) {
+        for (auto const x : iter::range(4)) {
+          std::array<int, 3> color{};
+          for (auto const channel : iter::range(std::size_t{3})) {
+            color.at(channel) =
+                (x * (horizontal.at(channel) - origin.at(channel)) +
+                 y * (vertical.at(channel) - origin.at(channel)) +
+                 4 * origin.at(channel) + 2) >>
+                2;
+          }
+          setTexel(gsl::narrow_cast<std::size_t>(x),
+                   gsl::narrow_cast<std::size_t>(y), color[0], color[1],
+                   color[2], false);
+        }
+      }
+      return;
+    }
+  }
+
+  // Individual and differential modes
+  std::array const tables{(high >> 5) & 7, (high >> 2) & 7};
+  for (auto const y : iter::range(std::size_t{4})) {
+    for (auto const x : iter::range(std::size_t{4})) {
+      auto const subblock{flip ? (y < 2 ? 0U : 1U) : (x < 2 ? 0U : 1U)};
+      auto const &base{subblock == 0 ? base0 : base1};
+      auto const &modifiers{etc1Modifiers.at(tables.at(subblock))};
+      auto const index{getIndex(x, y)};
+      auto modifier{(index & 1) != 0 ? modifiers[1] : modifiers[0]};
+      if ((index & 2) != 0) {
+        modifier = -modifier;
+      }
+      auto const transparent{!opaque && index == 2};
+      if (!opaque && (index & 1) == 0) {
+        modifier = 0;
+      }
+      setTexel(x, y, transparent ? 0 : base[0] + modifier,
+               transparent ? 0 : base[1] + modifier,
+               transparent ? 0 : base[2] + modifier, transparent);
+    }
+  }
+}
+
+// Decodes an EAC block into the alpha channel of the texels
+void decodeEACAlpha(std::byte const *data, Block &block) {
+  auto const bits{readBigEndian64(data)};
+  auto const base{gsl::narrow_cast<int>(bits >> 56)};
+  auto const multiplier{gsl::narrow_cast<int>((bits >> 52) & 15)};
+  auto const &modifiers{eacModifiers.at((bits >> 48) & 15)};
+  for (auto const x : iter::range(std::size_t{4})) {
+    for (auto const y : iter::range(std::size_t{4})) {
+      auto const texel{x * 4 + y};
+      auto const index{(bits >> (45 - 3 * texel)) & 7};
+      block.at(y * 4 + x)[3] =
+          clampToByte(base + modifiers.at(index) * multiplier);
+    }
+  }
+}
+
+// Decodes a block of the given format
+void decodeBlock(abcg::TextureFormat format, std::byte const *data,
+                 Block &block) {
+  using abcg::TextureFormat;
+  block.fill({0, 0, 0, 255});
+  switch (format) {
+  case TextureFormat::BC1RGBUnorm:
+  case TextureFormat::BC1RGBSRGB:
+    decodeBC1(data, block, false, false);
+    break;
+  case TextureFormat::BC1RGBAUnorm:
+  case TextureFormat::BC1RGBASRGB:
+    decodeBC1(data, block, true, false);
+    break;
+  case TextureFormat::BC2Unorm:
+  case TextureFormat::BC2SRGB:
+    decodeBC2Alpha(data, block);
+    decodeBC1(data + 8, block, false, true); // NOLINT
+    break;
+  case TextureFormat::BC3Unorm:
+  case TextureFormat::BC3SRGB:
+    decodeBC4(data, block, 3, false);
+    decodeBC1(data + 8, block, false, true); // NOLINT
+    break;
+  case TextureFormat::BC4Unorm:
+  case TextureFormat::BC4Snorm:
+    decodeBC4(data, block, 0, format == TextureFormat::BC4Snorm);
+    break;
+  case TextureFormat::BC5Unorm:
+  case TextureFormat::BC5Snorm:
+    decodeBC4(data, block, 0, format == TextureFormat::BC5Snorm);
+    decodeBC4(data + 8, block, 1, // NOLINT
+              format == TextureFormat::BC5Snorm);
+    break;
+  case TextureFormat::BC7Unorm:
+  case TextureFormat::BC7SRGB:
+    decodeBC7(data, block);
+    break;
+  case TextureFormat::ETC2RGB8Unorm:
+  case TextureFormat::ETC2RGB8SRGB:
+    decodeETC2(data, block, false);
+    break;
+  case TextureFormat::ETC2RGB8A1Unorm:
+  case TextureFormat::ETC2RGB8A1SRGB:
+    decodeETC2(data, block, true);
+    break;
+  case TextureFormat::ETC2RGBA8Unorm:
+  case TextureFormat::ETC2RGBA8SRGB:
+    decodeETC2(data + 8, block, false); // NOLINT
+    decodeEACAlpha(data, block);
+    break;
+  default:
+    throw abcg::RuntimeError("Texture format cannot be transcoded");
+  }
+}
+
+} // namespace
+
+/**
+ * @brief Returns whether a file is a texture container supported by
+ * abcg::loadTextureContainer.
+ *
+ * The file type is identified by its extension (`.ktx2` or `.dds`).
+ *
+ * @param path Path to the file.
+ *
+ * @return `true` if the file is a KTX2 or DDS file.
+ */
+bool abcg::isTextureContainerFile(std::string_view path) {
+  auto extension{std::filesystem::path{path}.extension().string()};
+  std::ranges::transform(extension, extension.begin(), [](unsigned char c) {
+    return gsl::narrow_cast<char>(std::tolower(c));
+  });
+  return extension == ".ktx2" || extension == ".dds";
+}
+
+/**
+ * @brief Loads a 2D texture with its mipmap levels from a KTX2 or DDS file.
+ *
+ * The texels are loaded as stored in the file, without decompression. KTX2
+ * files must not be supercompressed. Cubemaps, arrays and 3D textures are not
+ * supported.
+ *
+ * @param path Path to the file.
+ *
+ * @throw abcg::RuntimeError if the file could not be read, or if its content
+ * is not supported.
+ *
+ * @return Texture container with the levels stored in the file.
+ *
+ * @sa abcg::transcodeToRGBA8 for decompressing the texture if its format is
+ * not supported by the device.
+ */
+abcg::TextureContainer abcg::loadTextureContainer(std::string_view path) {
+  std::ifstream stream{std::filesystem::path{path}, std::ios::binary};
+  if (!stream) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to load texture file {}", path));
+  }
+  std::vector<std::byte> file(
+      gsl::narrow<std::size_t>(std::filesystem::file_size(path)));
+  stream.read(reinterpret_cast<char *>(file.data()), // NOLINT
+              gsl::narrow<std::streamsize>(file.size()));
+  if (!stream) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to read texture file {}", path));
+  }
+
+  constexpr std::array<uint8_t, 12> ktx2Identifier{
+      0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+  constexpr std::array<uint8_t, 4> ddsIdentifier{'D', 'D', 'S', ' '};
+  auto const startsWith{[&file](auto const &identifier) {
+    return file.size() >= identifier.size() &&
+           std::equal(identifier.begin(), identifier.end(), file.begin(),
+                      [](uint8_t lhs, std::byte rhs) {
+                        return lhs == std::to_integer<uint8_t>(rhs);
+                      });
+  }};
+
+  if (startsWith(ktx2Identifier)) {
+    return parseKTX2(file, path);
+  }
+  if (startsWith(ddsIdentifier)) {
+    return parseDDS(file, path);
+  }
+  throw abcg::RuntimeError(
+      fmt::format("Unknown texture container in {}", path));
+}
+
+/**
+ * @brief Decompresses a texture to 8-bit RGBA texels.
+ *
+ * This is the fallback for block-compressed formats that are not supported by
+ * the device. Color channels of sRGB formats are kept in sRGB space. Missing
+ * channels are set to 0, and missing alpha is set to 255. BC4 and BC5 signed
+ * values are mapped to [0, 255].
+ *
+ * @param texture Texture to be decompressed.
+ *
+ * @throw abcg::RuntimeError if the format cannot be decompressed (BC6H).
+ *
+ * @return Texture with format abcg::TextureFormat::RGBA8SRGB if the format of
+ * `texture` is sRGB, or abcg::TextureFormat::RGBA8Unorm otherwise.
+ */
+abcg::TextureContainer
+abcg::transcodeToRGBA8(TextureContainer const &texture) {
+  if (!isCompressedFormat(texture.format)) {
+    return texture;
+  }
+
+  auto const blockSize{getBlockSize(texture.format)};
+  TextureContainer result;
+  result.format = isSRGBFormat(texture.format) ? TextureFormat::RGBA8SRGB
+                                               : TextureFormat::RGBA8Unorm;
+  for (auto const level : iter::range(texture.levels.size())) {
+    auto const &source{texture.levels.at(level)};
+    auto const levelData{texture.getLevelData(level)};
+    std::vector<std::byte> texels(std::size_t{source.width} * source.height *
+                                  4);
+
+    auto const blocksPerRow{(source.width + 3) / 4};
+    auto const blocksPerColumn{(source.height + 3) / 4};
+    Block block{};
+    for (auto const blockY : iter::range(blocksPerColumn)) {
+      for (auto const blockX : iter::range(blocksPerRow)) {
+        decodeBlock(texture.format,
+                    levelData.data() + // NOLINT
+                        (std::size_t{blockY} * blocksPerRow + blockX) *
+                            blockSize,
+                    block);
+
+        // Copy the texels that are inside the level
+        for (auto const y :
+             iter::range(std::min(4U, source.height - blockY * 4))) {
+          for (auto const x :
+               iter::range(std::min(4U, source.width - blockX * 4))) {
+            auto const offset{((std::size_t{blockY} * 4 + y) * source.width +
+                               blockX * 4 + x) *
+                              4};
+            std::memcpy(texels.data() + offset, // NOLINT
+                        block.at(y * 4 + x).data(), 4);
+          }
+        }
+      }
+    }
+    addLevel(result, source.width, source.height, texels);
+  }
+  return result;
+}
+
+/**
+ * @brief Returns whether a texture format is block-compressed.
+ *
+ * @param format Texture format.
+ *
+ * @return `true` if the texels are encoded in blocks of 4x4 texels.
+ */
+bool abcg::isCompressedFormat(TextureFormat format) noexcept {
+  return format != TextureFormat::RGBA8Unorm &&
+         format != TextureFormat::RGBA8SRGB;
+}
+
+/**
+ * @brief Returns whether the color channels of a texture format are encoded
+ * in sRGB space.
+ *
+ * @param format Texture format.
+ *
+ * @return `true` if the format is sRGB.
+ */
+bool abcg::isSRGBFormat(TextureFormat format) noexcept {
+  switch (format) {
+  case TextureFormat::RGBA8SRGB:
+  case TextureFormat::BC1RGBSRGB:
+  case TextureFormat::BC1RGBASRGB:
+  case TextureFormat::BC2SRGB:
+  case TextureFormat::BC3SRGB:
+  case TextureFormat::BC7SRGB:
+  case TextureFormat::ETC2RGB8SRGB:
+  case TextureFormat::ETC2RGB8A1SRGB:
+  case TextureFormat::ETC2RGBA8SRGB:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/**
+ * @brief Returns the size of a block of texels.
+ *
+ * @param format Texture format.
+ *
+ * @return Size in bytes of a block of 4x4 texels if the format is
+ * block-compressed, or size in bytes of a texel otherwise.
+ */
+std::size_t abcg::getBlockSize(TextureFormat format) noexcept {
+  switch (format) {
+  case TextureFormat::RGBA8Unorm:
+  case TextureFormat::RGBA8SRGB:
+    return 4;
+  case TextureFormat::BC1RGBUnorm:
+  case TextureFormat::BC1RGBSRGB:
+  case TextureFormat::BC1RGBAUnorm:
+  case TextureFormat::BC1RGBASRGB:
+  case TextureFormat::BC4Unorm:
+  case TextureFormat::BC4Snorm:
+  case TextureFormat::ETC2RGB8Unorm:
+  case TextureFormat::ETC2RGB8SRGB:
+  case TextureFormat::ETC2RGB8A1Unorm:
+  case TextureFormat::ETC2RGB8A1SRGB:
+    return 8;
+  default:
+    return 16;
+  }
+}
+
+/**
+ * @brief Returns the data of a mipmap level.
+ *
+ * @param level Index of the level, where 0 is the base level.
+ *
+ * @return View of the data of the level.
+ */
+std::span<std::byte const>
+abcg::TextureContainer::getLevelData(std::size_t level) const {
+  auto const &info{levels.at(level)};
+  return std::span{data}.subspan(info.offset, info.size);
+}
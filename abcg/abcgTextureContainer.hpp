@@ -0,0 +1,99 @@
+/**
+ * @file abcgTextureContainer.hpp
+ * @brief Declaration of helper functions for loading KTX2 and DDS files.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_TEXTURE_CONTAINER_HPP_
+#define ABCG_TEXTURE_CONTAINER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace abcg {
+enum class TextureFormat;
+struct TextureContainer;
+
+[[nodiscard]] bool isTextureContainerFile(std::string_view path);
+[[nodiscard]] TextureContainer loadTextureContainer(std::string_view path);
+[[nodiscard]] TextureContainer
+transcodeToRGBA8(TextureContainer const &texture);
+
+[[nodiscard]] bool isCompressedFormat(TextureFormat format) noexcept;
+[[nodiscard]] bool isSRGBFormat(TextureFormat format) noexcept;
+[[nodiscard]] std::size_t getBlockSize(TextureFormat format) noexcept;
+} // namespace abcg
+
+/**
+ * @brief Texel formats of the images stored in a texture container.
+ *
+ * Block-compressed formats encode blocks of 4x4 texels.
+ */
+enum class abcg::TextureFormat {
+  RGBA8Unorm,
+  RGBA8SRGB,
+  BC1RGBUnorm,
+  BC1RGBSRGB,
+  BC1RGBAUnorm,
+  BC1RGBASRGB,
+  BC2Unorm,
+  BC2SRGB,
+  BC3Unorm,
+  BC3SRGB,
+  BC4Unorm,
+  BC4Snorm,
+  BC5Unorm,
+  BC5Snorm,
+  BC6HUfloat,
+  BC6HSfloat,
+  BC7Unorm,
+  BC7SRGB,
+  ETC2RGB8Unorm,
+  ETC2RGB8SRGB,
+  ETC2RGB8A1Unorm,
+  ETC2RGB8A1SRGB,
+  ETC2RGBA8Unorm,
+  ETC2RGBA8SRGB
+};
+
+/**
+ * @brief 2D texture with a chain of mipmap levels, as loaded from a KTX2 or
+ * DDS file.
+ *
+ * The data of the levels is stored contiguously, from the base level to the
+ * smallest level, each level starting at a multiple of 16 bytes.
+ *
+ * @sa abcg::loadTextureContainer.
+ */
+struct abcg::TextureContainer {
+  /** @brief Location and size of a mipmap level. */
+  struct Level {
+    /** @brief Offset of the level in abcg::TextureContainer::data. */
+    std::size_t offset{};
+    /** @brief Size of the level in bytes. */
+    std::size_t size{};
+    /** @brief Width of the level in texels. */
+    uint32_t width{};
+    /** @brief Height of the level in texels. */
+    uint32_t height{};
+  };
+
+  /** @brief Format of the texels. */
+  TextureFormat format{TextureFormat::RGBA8Unorm};
+  /** @brief Mipmap levels, starting from the base level. */
+  std::vector<Level> levels;
+  /** @brief Data of all levels. */
+  std::vector<std::byte> data;
+
+  [[nodiscard]] std::span<std::byte const>
+  getLevelData(std::size_t level) const;
+};
+
+#endif
@@ -10,6 +10,9 @@
 
 #include "abcgUtil.hpp"
 
+#include <cstdlib>
+#include <random>
+
 namespace {
 auto const codeBoldRed{"\033[1;31m"};
 auto const codeBoldYellow{"\033[1;33m"};
@@ -54,4 +57,84 @@ std::string abcg::toYellowString(std::string_view str) {
  */
 std::string abcg::toBlueString(std::string_view str) {
   return std::string{codeBoldBlue} + str.data() + std::string{codeReset};
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Returns the directory of the current user for application caches.
+ *
+ * The directory is `%LOCALAPPDATA%/abcg` on Windows, `~/Library/Caches/abcg`
+ * on macOS, and `$XDG_CACHE_HOME/abcg` or `~/.cache/abcg` on other systems.
+ * The directory is not created by this function.
+ *
+ * @return Path of the cache directory, or an empty path if it could not be
+ * determined (e.g., in WebAssembly builds).
+ */
+std::filesystem::path abcg::getUserCacheDirectory() {
+#if defined(__EMSCRIPTEN__)
+  return {};
+#else
+  auto const getPath{[](char const *name) {
+    auto const *const value{std::getenv(name)}; // NOLINT(concurrency-mt-unsafe)
+    return value != nullptr && *value != '\0' ? std::filesystem::path{value}
+                                               : std::filesystem::path{};
+  }};
+
+#if defined(_WIN32)
+  auto const base{getPath("LOCALAPPDATA")};
+#elif defined(__APPLE__)
+  auto const home{getPath("HOME")};
+  auto const base{home.empty() ? home : home / "Library" / "Caches"};
+#else
+  auto base{getPath("XDG_CACHE_HOME")};
+  if (auto const home{getPath("HOME")}; base.empty() && !home.empty()) {
+    base = home / ".cache";
+  }
+#endif
+  return base.empty() ? base : base / "abcg";
+#endif
+}
+
+/**
+ * @brief Returns a unique path for writing a file that replaces another one.
+ *
+ * The path is the given path followed by a random suffix, so that threads and
+ * processes writing the same file concurrently use different temporary files.
+ * The temporary file is meant to be renamed to `path` once fully written, so
+ * that a partially written file is never read back.
+ *
+ * @param path Path of the file to be replaced.
+ *
+ * @return Path of a temporary file in the same directory as `path`.
+ */
+std::filesystem::path
+abcg::getTemporaryPath(std::filesystem::path const &path) {
+  thread_local std::mt19937_64 engine{std::random_device{}()};
+  auto tempPath{path};
+  tempPath += "." + std::to_string(engine()) + ".tmp";
+  return tempPath;
+}
+
+/**
+ * @brief Updates the hash with a sequence of bytes.
+ *
+ * @param bytes Bytes to hash.
+ */
+void abcg::FNV1aHash::update(std::span<std::byte const> bytes) noexcept {
+  for (auto const byte : bytes) {
+    m_value = (m_value ^ std::to_integer<std::uint64_t>(byte)) * 0x100000001b3;
+  }
+}
+
+/**
+ * @brief Updates the hash with the characters of a string followed by its
+ * size.
+ *
+ * Hashing the size keeps consecutive strings from being ambiguous, e.g., "ab"
+ * followed by "c" is hashed differently from "a" followed by "bc".
+ *
+ * @param string String to hash.
+ */
+void abcg::FNV1aHash::update(std::string_view string) noexcept {
+  update(std::as_bytes(std::span{string}));
+  update(string.size());
+}
@@ -11,10 +11,16 @@
 #ifndef ABCG_UTIL_HPP_
 #define ABCG_UTIL_HPP_
 
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <functional>
+#include <span>
 #include <string>
+#include <type_traits>
 
 namespace abcg {
+class FNV1aHash;
 
 /**
  * @brief Creates a hash value from several values, combining them with a seed
@@ -73,6 +79,51 @@ std::string toRedString(std::string_view str);
 std::string toYellowString(std::string_view str);
 std::string toBlueString(std::string_view str);
 
+[[nodiscard]] std::filesystem::path getUserCacheDirectory();
+[[nodiscard]] std::filesystem::path
+getTemporaryPath(std::filesystem::path const &path);
+
 } // namespace abcg
 
+/**
+ * @brief 64-bit FNV-1a hash function.
+ *
+ * Unlike std::hash, the resulting value does not depend on the compiler,
+ * standard library or build, so it can be stored in files and compared across
+ * runs. It can be used as follows:
+ * @code
+ * abcg::FNV1aHash hash;
+ * hash.update(std::string_view{"Some text"});
+ * hash.update(42);
+ * auto const value{hash.getValue()};
+ * @endcode
+ */
+class abcg::FNV1aHash {
+public:
+  void update(std::span<std::byte const> bytes) noexcept;
+  void update(std::string_view string) noexcept;
+
+  /**
+   * @brief Updates the hash with the object representation of an arithmetic
+   * value.
+   *
+   * @tparam T Arithmetic type.
+   *
+   * @param value Value to hash.
+   */
+  template <typename T>
+  requires std::is_arithmetic_v<T>
+  void update(T value) noexcept { update(std::as_bytes(std::span{&value, 1})); }
+
+  /**
+   * @brief Returns the hash value of the data hashed so far.
+   *
+   * @return Hash value.
+   */
+  [[nodiscard]] std::uint64_t getValue() const noexcept { return m_value; }
+
+private:
+  std::uint64_t m_value{0xcbf29ce484222325};
+};
+
 #endif
\ No newline at end of file
@@ -16,10 +16,13 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 
 #include "abcg.hpp"
+#include "abcgVulkanAllocator.hpp"
 #include "abcgVulkanBuffer.hpp"
 #include "abcgVulkanImage.hpp"
+#include "abcgVulkanMesh.hpp"
 #include "abcgVulkanPipeline.hpp"
 #include "abcgVulkanShader.hpp"
+#include "abcgVulkanUploadQueue.hpp"
 #include "abcgVulkanWindow.hpp"
 
 #endif
@@ -0,0 +1,410 @@
+/**
+ * @file abcgVulkanAllocator.cpp
+ * @brief Definition of abcg::VulkanAllocator
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgVulkanAllocator.hpp"
+
+#include <cppitertools/itertools.hpp>
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <bit>
+#include <ranges>
+
+#include "abcgException.hpp"
+
+namespace {
+// Size of the smallest region handed out by the buddy allocator
+constexpr vk::DeviceSize minBuddySize{256};
+
+[[nodiscard]] constexpr vk::DeviceSize alignUp(vk::DeviceSize value,
+                                               vk::DeviceSize alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+/**
+ * @brief Initializes the allocator.
+ *
+ * @param device Logical device used to allocate memory.
+ * @param physicalDevice Physical device of `device`.
+ * @param blockSize Preferred size of the device memory objects, in bytes.
+ * It is rounded down to a power of two and limited to 1/8 of the smallest
+ * memory heap, so that small heaps are not exhausted by a few blocks.
+ */
+void abcg::VulkanAllocator::create(vk::Device const &device,
+                                   VulkanPhysicalDevice const &physicalDevice,
+                                   vk::DeviceSize blockSize) {
+  std::scoped_lock const lock{m_mutex};
+  m_device = device;
+  m_physicalDevice = physicalDevice;
+
+  auto const &vkPhysicalDevice{
+      static_cast<vk::PhysicalDevice>(m_physicalDevice)};
+  m_memoryProperties = vkPhysicalDevice.getMemoryProperties();
+  m_nonCoherentAtomSize = std::max(
+      vk::DeviceSize{1},
+      vkPhysicalDevice.getProperties().limits.nonCoherentAtomSize);
+
+  for (auto const index : iter::range(m_memoryProperties.memoryHeapCount)) {
+    blockSize =
+        std::min(blockSize, m_memoryProperties.memoryHeaps.at(index).size / 8);
+  }
+  m_blockSize = std::max(std::bit_floor(blockSize), minBuddySize);
+}
+
+/**
+ * @brief Releases all device memory objects.
+ *
+ * Regions still allocated become invalid.
+ */
+void abcg::VulkanAllocator::destroy() {
+  std::scoped_lock const lock{m_mutex};
+  for (auto const &[memory, block] : m_blocks) {
+    if (block.mappedData != nullptr) {
+      m_device.unmapMemory(memory);
+    }
+    m_device.freeMemory(memory);
+  }
+  m_blocks.clear();
+  m_pools.clear();
+  m_allocationCount = 0;
+}
+
+/**
+ * @brief Allocates a region of device memory.
+ *
+ * @param requirements Size, alignment and supported memory types of the
+ * resource.
+ * @param properties Required memory properties.
+ * @param lifetime Expected lifetime of the resource.
+ * @param linearResource Whether the resource is a buffer or an image with
+ * linear tiling (`true`), or an image with optimal tiling (`false`).
+ *
+ * @throw abcg::RuntimeError if there is no memory type with the required
+ * properties.
+ *
+ * @return Allocated region.
+ */
+abcg::VulkanAllocation
+abcg::VulkanAllocator::allocate(vk::MemoryRequirements const &requirements,
+                                vk::MemoryPropertyFlags properties,
+                                VulkanAllocationLifetime lifetime,
+                                bool linearResource) {
+  auto const memoryTypeIndex{m_physicalDevice.findMemoryType(
+      requirements.memoryTypeBits, properties)};
+  if (!memoryTypeIndex.has_value()) {
+    throw abcg::RuntimeError("Failed to find suitable memory type");
+  }
+
+  auto const flags{
+      m_memoryProperties.memoryTypes.at(*memoryTypeIndex).propertyFlags};
+  auto alignment{requirements.alignment};
+  if ((flags & vk::MemoryPropertyFlagBits::eHostVisible) &&
+      !(flags & vk::MemoryPropertyFlagBits::eHostCoherent)) {
+    // Allow flushing a region without touching its neighbors
+    alignment = std::max(alignment, m_nonCoherentAtomSize);
+  }
+
+  PoolKey const poolKey{.memoryTypeIndex = *memoryTypeIndex,
+                        .lifetime = lifetime,
+                        .linearResource = linearResource};
+
+  std::scoped_lock const lock{m_mutex};
+
+  auto const makeAllocation{[&](vk::DeviceMemory memory, Block &block,
+                                vk::DeviceSize offset) {
+    ++block.allocationCount;
+    block.bytesUsed += requirements.size;
+    ++m_allocationCount;
+    return VulkanAllocation{
+        .memory = memory,
+        .offset = offset,
+        .size = requirements.size,
+        .mappedData = block.mappedData == nullptr
+                          ? nullptr
+                          : block.mappedData + offset}; // NOLINT
+  }};
+
+  // Large resources get a memory object of their own
+  if (requirements.size > m_blockSize / 2) {
+    auto const [memory, block]{
+        createBlock(poolKey, BlockKind::Dedicated, requirements.size)};
+    return makeAllocation(memory, *block, 0);
+  }
+
+  auto &pool{m_pools[poolKey]};
+  for (auto const &memory : pool) {
+    auto &block{m_blocks.at(static_cast<VkDeviceMemory>(memory))};
+    if (auto const offset{
+            allocateFromBlock(block, requirements.size, alignment)}) {
+      return makeAllocation(memory, block, *offset);
+    }
+  }
+
+  auto const [memory, block]{createBlock(
+      poolKey,
+      lifetime == VulkanAllocationLifetime::Transient ? BlockKind::Linear
+                                                      : BlockKind::Buddy,
+      m_blockSize)};
+  auto const offset{allocateFromBlock(*block, requirements.size, alignment)};
+  Expects(offset.has_value());
+  return makeAllocation(memory, *block, *offset);
+}
+
+/**
+ * @brief Allocates and binds device memory for a buffer.
+ *
+ * @param buffer Buffer object.
+ * @param properties Required memory properties.
+ * @param lifetime Expected lifetime of the buffer.
+ *
+ * @return Allocated region.
+ */
+abcg::VulkanAllocation
+abcg::VulkanAllocator::allocate(vk::Buffer const &buffer,
+                                vk::MemoryPropertyFlags properties,
+                                VulkanAllocationLifetime lifetime) {
+  auto const allocation{
+      allocate(m_device.getBufferMemoryRequirements(buffer), properties,
+               lifetime, true)};
+  m_device.bindBufferMemory(buffer, allocation.memory, allocation.offset);
+  return allocation;
+}
+
+/**
+ * @brief Allocates and binds device memory for an image with optimal tiling.
+ *
+ * @param image Image object.
+ * @param properties Required memory properties.
+ * @param lifetime Expected lifetime of the image.
+ *
+ * @return Allocated region.
+ */
+abcg::VulkanAllocation
+abcg::VulkanAllocator::allocate(vk::Image const &image,
+                                vk::MemoryPropertyFlags properties,
+                                VulkanAllocationLifetime lifetime) {
+  auto const allocation{allocate(m_device.getImageMemoryRequirements(image),
+                                 properties, lifetime, false)};
+  m_device.bindImageMemory(image, allocation.memory, allocation.offset);
+  return allocation;
+}
+
+/**
+ * @brief Releases a region allocated with abcg::VulkanAllocator::allocate.
+ *
+ * Dedicated memory objects are released immediately. Blocks are released when
+ * they become empty, except for the first block of each pool.
+ *
+ * @param allocation Region to be released. Does nothing if the memory object
+ * is null.
+ */
+void abcg::VulkanAllocator::free(VulkanAllocation const &allocation) {
+  if (!allocation.memory) {
+    return;
+  }
+
+  std::scoped_lock const lock{m_mutex};
+  auto const iter{
+      m_blocks.find(static_cast<VkDeviceMemory>(allocation.memory))};
+  if (iter == m_blocks.end()) {
+    return;
+  }
+
+  auto &block{iter->second};
+  --block.allocationCount;
+  block.bytesUsed -= allocation.size;
+  --m_allocationCount;
+
+  if (block.kind != BlockKind::Dedicated) {
+    freeFromBlock(block, allocation.offset);
+  }
+
+  if (block.allocationCount == 0 &&
+      (block.kind == BlockKind::Dedicated ||
+       m_pools[block.poolKey].front() != allocation.memory)) {
+    destroyBlock(allocation.memory);
+  }
+}
+
+/**
+ * @brief Makes host writes to a region visible to the device.
+ *
+ * This is only needed for memory types without
+ * vk::MemoryPropertyFlagBits::eHostCoherent, and does nothing otherwise.
+ *
+ * @param allocation Region written by the host.
+ * @param offset Offset of the written range within the region.
+ * @param size Size of the written range, or `VK_WHOLE_SIZE` for the rest of
+ * the region.
+ */
+void abcg::VulkanAllocator::flush(VulkanAllocation const &allocation,
+                                  vk::DeviceSize offset,
+                                  vk::DeviceSize size) const {
+  std::scoped_lock const lock{m_mutex};
+  auto const iter{
+      m_blocks.find(static_cast<VkDeviceMemory>(allocation.memory))};
+  if (iter == m_blocks.end() || iter->second.coherent ||
+      iter->second.mappedData == nullptr) {
+    return;
+  }
+
+  if (size == VK_WHOLE_SIZE) {
+    size = allocation.size - offset;
+  }
+  auto const begin{(allocation.offset + offset) / m_nonCoherentAtomSize *
+                   m_nonCoherentAtomSize};
+  auto const end{std::min(
+      alignUp(allocation.offset + offset + size, m_nonCoherentAtomSize),
+      iter->second.size)};
+  m_device.flushMappedMemoryRanges(
+      {{.memory = allocation.memory, .offset = begin, .size = end - begin}});
+}
+
+/**
+ * @brief Returns memory usage statistics.
+ *
+ * @return Number of blocks and allocations, and bytes reserved and used.
+ */
+abcg::VulkanAllocatorStats abcg::VulkanAllocator::getStats() const {
+  std::scoped_lock const lock{m_mutex};
+  VulkanAllocatorStats stats{.blockCount = m_blocks.size(),
+                             .allocationCount = m_allocationCount};
+  for (auto const &block : m_blocks | std::views::values) {
+    stats.bytesReserved += block.size;
+    stats.bytesUsed += block.bytesUsed;
+  }
+  return stats;
+}
+
+// Returns the offset of a new region in the block, or std::nullopt if the
+// block has not enough free space
+std::optional<vk::DeviceSize>
+abcg::VulkanAllocator::allocateFromBlock(Block &block, vk::DeviceSize size,
+                                         vk::DeviceSize alignment) const {
+  if (block.kind == BlockKind::Linear) {
+    auto const offset{alignUp(block.head, alignment)};
+    if (offset + size > block.size) {
+      return std::nullopt;
+    }
+    block.head = offset + size;
+    return offset;
+  }
+
+  // Buddy regions are aligned to their own size, as the block is aligned to
+  // any resource alignment
+  auto const regionSize{
+      std::bit_ceil(std::max({size, alignment, minBuddySize}))};
+  if (regionSize > block.size) {
+    return std::nullopt;
+  }
+  auto const order{gsl::narrow<std::size_t>(std::countr_zero(block.size) -
+                                            std::countr_zero(regionSize))};
+
+  // Find the smallest free region that fits, and split it down to the
+  // required order
+  auto freeOrder{order};
+  while (block.freeLists.at(freeOrder).empty()) {
+    if (freeOrder == 0) {
+      return std::nullopt;
+    }
+    --freeOrder;
+  }
+  auto &freeList{block.freeLists.at(freeOrder)};
+  auto const offset{*freeList.begin()};
+  freeList.erase(freeList.begin());
+  for (; freeOrder < order; ++freeOrder) {
+    block.freeLists.at(freeOrder + 1).insert(offset +
+                                             (block.size >> (freeOrder + 1)));
+  }
+
+  block.allocatedOrders.emplace(offset, order);
+  return offset;
+}
+
+// Returns a region to the block, merging free buddies
+void abcg::VulkanAllocator::freeFromBlock(Block &block,
+                                          vk::DeviceSize offset) const {
+  if (block.kind == BlockKind::Linear) {
+    // The whole block is recycled once all of its regions are freed
+    if (block.allocationCount == 0) {
+      block.head = 0;
+    }
+    return;
+  }
+
+  auto const iter{block.allocatedOrders.find(offset)};
+  if (iter == block.allocatedOrders.end()) {
+    return;
+  }
+  auto order{iter->second};
+  block.allocatedOrders.erase(iter);
+
+  while (order > 0) {
+    auto const buddy{offset ^ (block.size >> order)};
+    auto &freeList{block.freeLists.at(order)};
+    if (freeList.erase(buddy) == 0) {
+      break;
+    }
+    offset = std::min(offset, buddy);
+    --order;
+  }
+  block.freeLists.at(order).insert(offset);
+}
+
+std::pair<vk::DeviceMemory, abcg::VulkanAllocator::Block *>
+abcg::VulkanAllocator::createBlock(PoolKey const &poolKey, BlockKind kind,
+                                   vk::DeviceSize size) {
+  auto const memory{m_device.allocateMemory(
+      {.allocationSize = size, .memoryTypeIndex = poolKey.memoryTypeIndex})};
+
+  Block block;
+  block.kind = kind;
+  block.poolKey = poolKey;
+  block.size = size;
+  auto const flags{
+      m_memoryProperties.memoryTypes.at(poolKey.memoryTypeIndex).propertyFlags};
+  block.coherent = static_cast<bool>(flags &
+                                     vk::MemoryPropertyFlagBits::eHostCoherent);
+  if (flags & vk::MemoryPropertyFlagBits::eHostVisible) {
+    block.mappedData = static_cast<std::byte *>(
+        m_device.mapMemory(memory, vk::DeviceSize{0}, VK_WHOLE_SIZE));
+  }
+  if (kind == BlockKind::Buddy) {
+    block.freeLists.resize(gsl::narrow<std::size_t>(
+        std::countr_zero(size) - std::countr_zero(minBuddySize) + 1));
+    block.freeLists.front().insert(0);
+  }
+
+  auto &inserted{
+      m_blocks.emplace(static_cast<VkDeviceMemory>(memory), std::move(block))
+          .first->second};
+  if (kind != BlockKind::Dedicated) {
+    m_pools[poolKey].push_back(memory);
+  }
+  return {memory, &inserted};
+}
+
+void abcg::VulkanAllocator::destroyBlock(vk::DeviceMemory memory) {
+  auto const iter{m_blocks.find(static_cast<VkDeviceMemory>(memory))};
+  if (iter == m_blocks.end()) {
+    return;
+  }
+
+  if (iter->second.mappedData != nullptr) {
+    m_device.unmapMemory(memory);
+  }
+  m_device.freeMemory(memory);
+
+  if (iter->second.kind != BlockKind::Dedicated) {
+    std::erase(m_pools[iter->second.poolKey], memory);
+  }
+  m_blocks.erase(iter);
+}
@@ -0,0 +1,178 @@
+/**
+ * @file abcgVulkanAllocator.hpp
+ * @brief Header file of abcg::VulkanAllocator
+ *
+ * Declaration of abcg::VulkanAllocator
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_VULKAN_ALLOCATOR_HPP_
+#define ABCG_VULKAN_ALLOCATOR_HPP_
+
+#include "abcgVulkanPhysicalDevice.hpp"
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+namespace abcg {
+enum class VulkanAllocationLifetime;
+struct VulkanAllocation;
+struct VulkanAllocatorStats;
+class VulkanAllocator;
+} // namespace abcg
+
+/**
+ * @brief Enumeration of expected lifetimes of a device memory allocation.
+ *
+ * @sa abcg::VulkanAllocator::allocate.
+ */
+enum class abcg::VulkanAllocationLifetime {
+  /** @brief Long-lived resource, such as a mesh or texture.
+   *
+   * Allocated from blocks managed by a buddy allocator, so that freed memory
+   * can be reused by resources of different sizes.
+   */
+  Persistent,
+  /** @brief Short-lived resource, such as a staging buffer.
+   *
+   * Allocated linearly from blocks that are recycled as soon as all of their
+   * allocations are freed.
+   */
+  Transient
+};
+
+/**
+ * @brief Region of device memory returned by abcg::VulkanAllocator::allocate.
+ */
+struct abcg::VulkanAllocation {
+  /** @brief Device memory object that contains the region. */
+  vk::DeviceMemory memory;
+  /** @brief Offset of the region within the memory object. */
+  vk::DeviceSize offset{};
+  /** @brief Size of the region in bytes. */
+  vk::DeviceSize size{};
+  /** @brief Pointer to the beginning of the region, if the memory is host
+   * visible; `nullptr` otherwise. The memory is persistently mapped. */
+  void *mappedData{};
+};
+
+/**
+ * @brief Memory usage statistics of abcg::VulkanAllocator.
+ */
+struct abcg::VulkanAllocatorStats {
+  /** @brief Number of device memory objects allocated with vkAllocateMemory.
+   */
+  std::size_t blockCount{};
+  /** @brief Number of live allocations. */
+  std::size_t allocationCount{};
+  /** @brief Total size of the device memory objects, in bytes. */
+  vk::DeviceSize bytesReserved{};
+  /** @brief Total size of the live allocations, in bytes. */
+  vk::DeviceSize bytesUsed{};
+};
+
+/**
+ * @brief A class for sub-allocating Vulkan device memory.
+ *
+ * Device memory is allocated in large blocks, one set per memory type, from
+ * which regions are handed out to buffers and images. This keeps the number
+ * of vkAllocateMemory calls small and well below
+ * `maxMemoryAllocationCount`.
+ *
+ * Buffers and images are placed in separate blocks, so regions never need
+ * padding to satisfy `bufferImageGranularity`. Resources larger than half a
+ * block get a dedicated memory object. Blocks of host-visible memory types
+ * are persistently mapped.
+ *
+ * The allocator is owned by abcg::VulkanDevice and is used by
+ * abcg::VulkanBuffer and abcg::VulkanImage. All member functions are
+ * thread-safe.
+ *
+ * @sa abcg::VulkanDevice::getAllocator.
+ */
+class abcg::VulkanAllocator {
+public:
+  VulkanAllocator() = default;
+  VulkanAllocator(VulkanAllocator const &) = delete;
+  VulkanAllocator(VulkanAllocator &&) = delete;
+  VulkanAllocator &operator=(VulkanAllocator const &) = delete;
+  VulkanAllocator &operator=(VulkanAllocator &&) = delete;
+  ~VulkanAllocator() = default;
+
+  void create(vk::Device const &device,
+              VulkanPhysicalDevice const &physicalDevice,
+              vk::DeviceSize blockSize = 64UL * 1024UL * 1024UL);
+  void destroy();
+
+  [[nodiscard]] VulkanAllocation
+  allocate(vk::MemoryRequirements const &requirements,
+           vk::MemoryPropertyFlags properties,
+           VulkanAllocationLifetime lifetime, bool linearResource);
+  [[nodiscard]] VulkanAllocation
+  allocate(vk::Buffer const &buffer, vk::MemoryPropertyFlags properties,
+           VulkanAllocationLifetime lifetime =
+               VulkanAllocationLifetime::Persistent);
+  [[nodiscard]] VulkanAllocation
+  allocate(vk::Image const &image, vk::MemoryPropertyFlags properties,
+           VulkanAllocationLifetime lifetime =
+               VulkanAllocationLifetime::Persistent);
+  void free(VulkanAllocation const &allocation);
+  void flush(VulkanAllocation const &allocation, vk::DeviceSize offset = 0,
+             vk::DeviceSize size = VK_WHOLE_SIZE) const;
+
+  [[nodiscard]] VulkanAllocatorStats getStats() const;
+
+private:
+  enum class BlockKind { Buddy, Linear, Dedicated };
+
+  // Blocks are grouped in pools of the same memory type, lifetime and
+  // resource tiling
+  struct PoolKey {
+    uint32_t memoryTypeIndex{};
+    VulkanAllocationLifetime lifetime{};
+    bool linearResource{};
+    auto operator<=>(PoolKey const &) const = default;
+  };
+
+  struct Block {
+    BlockKind kind{};
+    PoolKey poolKey;
+    vk::DeviceSize size{};
+    std::byte *mappedData{};
+    bool coherent{};
+    std::size_t allocationCount{};
+    vk::DeviceSize bytesUsed{};
+    // Buddy allocator: free offsets per order (order 0 is the whole block),
+    // and order of each allocated offset
+    std::vector<std::set<vk::DeviceSize>> freeLists;
+    std::unordered_map<vk::DeviceSize, std::size_t> allocatedOrders;
+    // Linear allocator: offset of the next allocation
+    vk::DeviceSize head{};
+  };
+
+  [[nodiscard]] std::optional<vk::DeviceSize>
+  allocateFromBlock(Block &block, vk::DeviceSize size,
+                    vk::DeviceSize alignment) const;
+  void freeFromBlock(Block &block, vk::DeviceSize offset) const;
+  std::pair<vk::DeviceMemory, Block *>
+  createBlock(PoolKey const &poolKey, BlockKind kind, vk::DeviceSize size);
+  void destroyBlock(vk::DeviceMemory memory);
+
+  mutable std::mutex m_mutex;
+  vk::Device m_device;
+  VulkanPhysicalDevice m_physicalDevice;
+  vk::PhysicalDeviceMemoryProperties m_memoryProperties;
+  vk::DeviceSize m_nonCoherentAtomSize{1};
+  vk::DeviceSize m_blockSize{};
+  std::unordered_map<VkDeviceMemory, Block> m_blocks;
+  std::map<PoolKey, std::vector<vk::DeviceMemory>> m_pools;
+  std::size_t m_allocationCount{};
+};
+
+#endif
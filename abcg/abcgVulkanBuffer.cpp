@@ -19,74 +19,96 @@
 void abcg::VulkanBuffer::create(VulkanDevice const &device,
                                 VulkanBufferCreateInfo const &createInfo) {
   m_device = static_cast<vk::Device>(device);
-
-  if (createInfo.properties & vk::MemoryPropertyFlagBits::eHostVisible) {
-    std::tie(m_buffer, m_deviceMemory) = createBuffer(
-        device, createInfo.size, createInfo.usage, createInfo.properties);
-
+  m_allocator = &device.getAllocator();
+  m_uploadQueue = &device.getUploadQueue();
+  m_sharingMode = createInfo.sharingMode;
+
+  auto usage{createInfo.usage};
+  auto properties{createInfo.properties};
+  if (!(properties & vk::MemoryPropertyFlagBits::eHostVisible)) {
+    // Data is copied to device local memory through the upload queue
+    properties |= vk::MemoryPropertyFlagBits::eDeviceLocal;
     if (createInfo.data.has_value()) {
-      loadData(createInfo.data.value(), createInfo.size);
+      usage |= vk::BufferUsageFlagBits::eTransferDst;
     }
-  } else if (createInfo.data.has_value()) {
-    // Use a staging buffer for mapping, and a device local buffer as the final
-    // destination
-    auto [stagingBuffer, stagingBufferMemory]{createBuffer(
-        device, createInfo.size, vk::BufferUsageFlagBits::eTransferSrc,
-        vk::MemoryPropertyFlagBits::eHostVisible |
-            vk::MemoryPropertyFlagBits::eHostCoherent)};
-
-    // Copy data to mapped staging buffer
-    // Transfer of data to the GPU will happen in the background before the next
-    // call to vkQueueSubmit
-    void *data{m_device.mapMemory(stagingBufferMemory, vk::DeviceSize{0},
-                                  createInfo.size)};
-    memcpy(data, createInfo.data->get(), createInfo.size);
-    m_device.unmapMemory(stagingBufferMemory);
-
-    // Create buffer in device local memory
-    std::tie(m_buffer, m_deviceMemory) =
-        createBuffer(device, createInfo.size,
-                     createInfo.usage | vk::BufferUsageFlagBits::eTransferDst,
-                     vk::MemoryPropertyFlagBits::eDeviceLocal);
-
-    // Copy from staging buffer to device local buffer
-    device.withCommandBuffer(
-        [this, &stagingBuffer, &createInfo](const auto &commandBuffer) {
-          commandBuffer.copyBuffer(stagingBuffer, m_buffer,
-                                   {{.size = createInfo.size}});
-        },
-        vk::QueueFlagBits::eTransfer);
-
-    // Release staging buffer
-    m_device.destroyBuffer(stagingBuffer);
-    m_device.freeMemory(stagingBufferMemory);
+  }
+
+  std::tie(m_buffer, m_allocation) =
+      createBuffer(device, createInfo.size, usage, properties,
+                   createInfo.lifetime, createInfo.sharingMode);
+
+  if (!createInfo.data.has_value()) {
+    return;
+  }
+  if (m_allocation.mappedData != nullptr) {
+    loadData(createInfo.data.value(), createInfo.size);
+    return;
+  }
+
+  // The initial upload is recorded on the transfer queue, which may run
+  // concurrently with rendering. The buffer is then handed over to the
+  // graphics queue family
+  m_uploadQueue->upload(m_buffer,
+                        {static_cast<std::byte const *>(createInfo.data->get()),
+                         gsl::narrow<std::size_t>(createInfo.size)});
+  if (m_sharingMode == vk::SharingMode::eExclusive) {
+    m_uploadQueue->transferOwnership(m_buffer);
   }
 }
 
 void abcg::VulkanBuffer::destroy() {
   m_device.destroyBuffer(m_buffer);
-  m_device.freeMemory(m_deviceMemory);
+  if (m_allocator != nullptr) {
+    m_allocator->free(m_allocation);
+  }
+  m_allocation = {};
 }
 
 /**
  * @brief Loads data to the buffer.
  *
+ * If the buffer memory is host visible, the data is copied directly to the
+ * buffer. Otherwise, the data is copied to staging memory and the transfer is
+ * recorded into the upload queue of the device. In this case, the buffer must
+ * have been created with vk::BufferUsageFlagBits::eTransferDst or with initial
+ * data.
+ *
  * @param data Pointer to the beginning of the data.
  * @param size Size of the data fo the copied, in bytes.
  * @param offset Offset from the beginning of the buffer memory.
  */
 void abcg::VulkanBuffer::loadData(gsl::not_null<void const *> data,
                                   vk::DeviceSize size, vk::DeviceSize offset) {
+  if (m_allocation.mappedData == nullptr) {
+    // Transfer of data to the GPU will happen on the transfer queue when the
+    // upload queue is submitted, before the commands of the next frame. The
+    // buffer may still be in use by the graphics queue, so it is acquired for
+    // the transfer queue and then handed back
+    m_uploadQueue->acquireOwnership(m_buffer, m_sharingMode);
+    m_uploadQueue->upload(m_buffer,
+                          {static_cast<std::byte const *>(data.get()),
+                           gsl::narrow<std::size_t>(size)},
+                          offset);
+    if (m_sharingMode == vk::SharingMode::eExclusive) {
+      m_uploadQueue->transferOwnership(m_buffer);
+    }
+    return;
+  }
+
   // Transfer of data to the GPU will happen in the background before the next
   // call to vkQueueSubmit
-  auto *mappedData{m_device.mapMemory(m_deviceMemory, offset, size)};
-  memcpy(mappedData, data, size);
-  m_device.unmapMemory(m_deviceMemory);
+  memcpy(static_cast<std::byte *>(m_allocation.mappedData) + offset, // NOLINT
+         data, size);
+  m_allocator->flush(m_allocation, offset, size);
 }
 
-std::pair<vk::Buffer, vk::DeviceMemory> abcg::VulkanBuffer::createBuffer(
-    VulkanDevice const &device, vk::DeviceSize size, vk::BufferUsageFlags usage,
-    vk::MemoryPropertyFlags properties) const {
+std::pair<vk::Buffer, abcg::VulkanAllocation>
+abcg::VulkanBuffer::createBuffer(VulkanDevice const &device,
+                                 vk::DeviceSize size,
+                                 vk::BufferUsageFlags usage,
+                                 vk::MemoryPropertyFlags properties,
+                                 VulkanAllocationLifetime lifetime,
+                                 vk::SharingMode sharingMode) const {
   auto const &physicalDevice{device.getPhysicalDevice()};
   auto const &queuesFamilies{physicalDevice.getQueuesFamilies()};
 
@@ -97,37 +119,23 @@ std::pair<vk::Buffer, vk::DeviceMemory> abcg::VulkanBuffer::createBuffer(
 
   std::vector const queueFamilyIndices(indices.begin(), indices.end());
 
-  auto const separateTransferQueue{
-      queuesFamilies.graphics.value_or(VK_QUEUE_FAMILY_IGNORED) !=
-      queuesFamilies.transfer.value_or(VK_QUEUE_FAMILY_IGNORED)};
+  // Concurrent sharing requires at least two distinct queue families
+  if (queueFamilyIndices.size() < 2) {
+    sharingMode = vk::SharingMode::eExclusive;
+  }
 
   // Create buffer object
   auto buffer{m_device.createBuffer(
       {.size = size,
        .usage = usage,
-       .sharingMode = separateTransferQueue ? vk::SharingMode::eConcurrent
-                                            : vk::SharingMode::eExclusive,
+       .sharingMode = sharingMode,
        .queueFamilyIndexCount =
            gsl::narrow<uint32_t>(queueFamilyIndices.size()),
        .pQueueFamilyIndices = queueFamilyIndices.data()})};
 
-  // Get memory requirements
-  auto const memoryRequirements{m_device.getBufferMemoryRequirements(buffer)};
-
-  // Allocate buffer memory
-  auto const memoryType{physicalDevice.findMemoryType(
-      memoryRequirements.memoryTypeBits, properties)};
-  if (!memoryType.has_value()) {
-    throw abcg::RuntimeError("Failed to find suitable memory type");
-  }
-  auto bufferMemory{
-      m_device.allocateMemory({.allocationSize = memoryRequirements.size,
-                               .memoryTypeIndex = memoryType.value()})};
-
-  // Associate buffer memory to buffer
-  m_device.bindBufferMemory(buffer, bufferMemory, 0);
-
-  return {buffer, bufferMemory};
+  // Sub-allocate buffer memory and associate it to the buffer
+  return {buffer,
+          device.getAllocator().allocate(buffer, properties, lifetime)};
 }
 
 /**
@@ -144,5 +152,18 @@ abcg::VulkanBuffer::operator vk::Buffer const &() const noexcept {
  * @return Device memory object.
  */
 vk::DeviceMemory const &abcg::VulkanBuffer::getDeviceMemory() const noexcept {
-  return m_deviceMemory;
+  return m_allocation.memory;
+}
+
+/**
+ * @brief Returns the region of device memory associated with the buffer.
+ *
+ * The buffer is bound at the offset of the region within the device memory
+ * object.
+ *
+ * @return Allocated region.
+ */
+abcg::VulkanAllocation const &
+abcg::VulkanBuffer::getAllocation() const noexcept {
+  return m_allocation;
 }
\ No newline at end of file
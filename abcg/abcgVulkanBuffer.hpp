@@ -30,13 +30,22 @@ struct abcg::VulkanBufferCreateInfo {
   vk::BufferUsageFlags usage{};
   vk::MemoryPropertyFlags properties{};
   std::optional<gsl::not_null<void const *>> data{};
+  VulkanAllocationLifetime lifetime{VulkanAllocationLifetime::Persistent};
+  /** @brief Whether the buffer is owned by the graphics queue family
+   * (vk::SharingMode::eExclusive, default), or shared by all queue families of
+   * the device (vk::SharingMode::eConcurrent). Exclusive buffers are faster to
+   * access, and are handed over to the graphics queue family after each
+   * upload. */
+  vk::SharingMode sharingMode{vk::SharingMode::eExclusive};
 };
 
 /**
  * @brief A class for representing a Vulkan buffer.
  *
  * This class provides helper functions for creating and managing vk::Buffer
- * objects.
+ * objects. Memory is sub-allocated from the allocator of the device.
+ *
+ * @sa abcg::VulkanDevice::getAllocator.
  */
 class abcg::VulkanBuffer {
 public:
@@ -49,15 +58,20 @@ public:
   explicit operator vk::Buffer const &() const noexcept;
 
   [[nodiscard]] vk::DeviceMemory const &getDeviceMemory() const noexcept;
+  [[nodiscard]] VulkanAllocation const &getAllocation() const noexcept;
 
 private:
-  [[nodiscard]] std::pair<vk::Buffer, vk::DeviceMemory>
+  [[nodiscard]] std::pair<vk::Buffer, VulkanAllocation>
   createBuffer(VulkanDevice const &device, vk::DeviceSize size,
-               vk::BufferUsageFlags usage,
-               vk::MemoryPropertyFlags properties) const;
+               vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties,
+               VulkanAllocationLifetime lifetime,
+               vk::SharingMode sharingMode) const;
 
   vk::Buffer m_buffer;
-  vk::DeviceMemory m_deviceMemory;
+  VulkanAllocation m_allocation;
+  VulkanAllocator *m_allocator{};
+  VulkanUploadQueue *m_uploadQueue{};
+  vk::SharingMode m_sharingMode{};
   vk::Device m_device;
 };
 
@@ -9,14 +9,55 @@
  */
 
 #include "abcgVulkanDevice.hpp"
+#include "abcgUtil.hpp"
 
+#include <fmt/core.h>
 #include <gsl/gsl>
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <set>
 
-void abcg::VulkanDevice::create(VulkanPhysicalDevice const &physicalDevice,
-                                std::vector<char const *> const &extensions) {
+namespace {
+// Returns true if the header of the pipeline cache data is compatible with the
+// given physical device properties.
+[[nodiscard]] bool
+isPipelineCacheCompatible(std::vector<char> const &data,
+                          vk::PhysicalDeviceProperties const &properties) {
+  VkPipelineCacheHeaderVersionOne header{};
+  if (data.size() < sizeof(header)) {
+    return false;
+  }
+  std::memcpy(&header, data.data(), sizeof(header));
+
+  return header.headerSize >= sizeof(header) &&
+         header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         header.vendorID == properties.vendorID &&
+         header.deviceID == properties.deviceID &&
+         std::ranges::equal(header.pipelineCacheUUID,
+                            properties.pipelineCacheUUID);
+}
+} // namespace
+
+/**
+ * @brief Creates the logical device, its queues and command pools, the
+ * pipeline cache, the device memory allocator, and the upload queue.
+ *
+ * @param physicalDevice Physical device.
+ * @param extensions Device extensions to be enabled.
+ * @param pipelineCachePath Path of the file used to persist the pipeline cache
+ * across runs. If the file exists and is compatible with the physical device,
+ * the pipeline cache is initialized with its contents. The file is written
+ * back in abcg::VulkanDevice::destroy. If empty, the pipeline cache is not
+ * persisted.
+ */
+void abcg::VulkanDevice::create(
+    VulkanPhysicalDevice const &physicalDevice,
+    std::vector<char const *> const &extensions,
+    std::filesystem::path const &pipelineCachePath) {
   m_physicalDevice = physicalDevice;
+  m_pipelineCachePath = pipelineCachePath;
   auto const &queuesFamilies{m_physicalDevice.getQueuesFamilies()};
   auto const graphicsQueueFamily{queuesFamilies.graphics.value_or(0)};
   auto const presentQueueFamily{queuesFamilies.present.value_or(0)};
@@ -66,9 +107,33 @@ void abcg::VulkanDevice::create(VulkanPhysicalDevice const &physicalDevice,
   }
 
   createCommandPools();
+  createPipelineCache();
+
+  m_allocator = std::make_shared<VulkanAllocator>();
+  m_allocator->create(m_device, m_physicalDevice);
+
+  m_uploadQueue = std::make_shared<VulkanUploadQueue>();
+  m_uploadQueue->create(m_device, m_physicalDevice, m_queues.transfer,
+                        m_queues.graphics, *m_allocator);
 }
 
+/**
+ * @brief Releases the resources of the device.
+ *
+ * The pipeline cache is saved to disk before being destroyed. Pending uploads
+ * are waited for, and device memory still held by the allocator is released.
+ */
 void abcg::VulkanDevice::destroy() {
+  if (m_uploadQueue) {
+    m_uploadQueue->destroy();
+    m_uploadQueue.reset();
+  }
+  if (m_allocator) {
+    m_allocator->destroy();
+    m_allocator.reset();
+  }
+  savePipelineCache();
+  destroyPipelineCache();
   destroyCommandPools();
   m_device.destroy();
 }
@@ -109,10 +174,49 @@ abcg::VulkanDevice::getCommandPools() const noexcept {
   return m_commandPools;
 }
 
+/**
+ * @brief Returns the pipeline cache owned by this device.
+ *
+ * This is used by default by abcg::VulkanPipeline::create.
+ *
+ * @return Pipeline cache.
+ */
+vk::PipelineCache const &abcg::VulkanDevice::getPipelineCache() const noexcept {
+  return m_pipelineCache;
+}
+
+/**
+ * @brief Returns the device memory allocator owned by this device.
+ *
+ * This is used by abcg::VulkanBuffer and abcg::VulkanImage to sub-allocate
+ * device memory.
+ *
+ * @return Device memory allocator.
+ */
+abcg::VulkanAllocator &abcg::VulkanDevice::getAllocator() const noexcept {
+  return *m_allocator;
+}
+
+/**
+ * @brief Returns the upload queue owned by this device.
+ *
+ * This is used by abcg::VulkanBuffer and abcg::VulkanImage to upload data
+ * without waiting for the queue to be idle. It is submitted by
+ * abcg::VulkanSwapchain::render before the commands of each frame.
+ *
+ * @return Upload queue.
+ */
+abcg::VulkanUploadQueue &abcg::VulkanDevice::getUploadQueue() const noexcept {
+  return *m_uploadQueue;
+}
+
 /**
  * @brief Allocates and creates a command buffer to be immediately submitted and
  * released.
  *
+ * This waits for the queue to be idle. Uploads should rather be recorded with
+ * abcg::VulkanUploadQueue, which batches them without blocking.
+ *
  * @param fun Function to be called between the begin and end calls of the
  * command buffer.
  * @param queueFlag Which command pool queue will be used. The graphics queue
@@ -213,3 +317,69 @@ void abcg::VulkanDevice::destroyCommandPools() {
 
   m_device.destroyCommandPool(m_commandPools.graphics);
 }
+
+void abcg::VulkanDevice::createPipelineCache() {
+  // Read initial data from disk, if available and compatible
+  std::vector<char> initialData;
+  if (!m_pipelineCachePath.empty()) {
+    if (std::ifstream stream(m_pipelineCachePath,
+                             std::ios::binary | std::ios::ate);
+        stream) {
+      initialData.resize(gsl::narrow<std::size_t>(stream.tellg()));
+      stream.seekg(0);
+      if (!stream.read(initialData.data(),
+                       gsl::narrow<std::streamsize>(initialData.size()))) {
+        initialData.clear();
+      }
+    }
+
+    auto const properties{
+        static_cast<vk::PhysicalDevice>(m_physicalDevice).getProperties()};
+    if (!initialData.empty() &&
+        !isPipelineCacheCompatible(initialData, properties)) {
+      fmt::print("Discarding incompatible pipeline cache {}\n",
+                 m_pipelineCachePath.string());
+      initialData.clear();
+    }
+  }
+
+  m_pipelineCache =
+      m_device.createPipelineCache({.initialDataSize = initialData.size(),
+                                    .pInitialData = initialData.data()});
+}
+
+void abcg::VulkanDevice::savePipelineCache() const {
+  if (!m_pipelineCache || m_pipelineCachePath.empty()) {
+    return;
+  }
+
+  auto const data{m_device.getPipelineCacheData(m_pipelineCache)};
+  if (data.empty()) {
+    return;
+  }
+
+  // Write to a temporary file first so that a partially written cache is never
+  // read back. Failures are not fatal since the cache is only an optimization.
+  std::error_code errorCode;
+  std::filesystem::create_directories(m_pipelineCachePath.parent_path(),
+                                      errorCode);
+  auto const tempPath{abcg::getTemporaryPath(m_pipelineCachePath)};
+  {
+    std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+    if (!stream.write(reinterpret_cast<char const *>(data.data()), // NOLINT
+                      gsl::narrow<std::streamsize>(data.size()))) {
+      fmt::print("Failed to write pipeline cache {}\n",
+                 m_pipelineCachePath.string());
+      return;
+    }
+  }
+  std::filesystem::rename(tempPath, m_pipelineCachePath, errorCode);
+  if (errorCode) {
+    std::filesystem::remove(tempPath, errorCode);
+  }
+}
+
+void abcg::VulkanDevice::destroyPipelineCache() {
+  m_device.destroyPipelineCache(m_pipelineCache);
+  m_pipelineCache = nullptr;
+}
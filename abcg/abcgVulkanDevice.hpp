@@ -13,9 +13,13 @@
 #ifndef ABCG_VULKAN_DEVICE_HPP_
 #define ABCG_VULKAN_DEVICE_HPP_
 
+#include "abcgVulkanAllocator.hpp"
 #include "abcgVulkanPhysicalDevice.hpp"
+#include "abcgVulkanUploadQueue.hpp"
 
+#include <filesystem>
 #include <functional>
+#include <memory>
 
 namespace abcg {
 struct VulkanCommandPools;
@@ -50,12 +54,14 @@ struct abcg::VulkanQueues {
  * resources.
  *
  * This class creates and manages the Vulkan logical device, queues, descriptor
- * pool, and command pools.
+ * pool, command pools, pipeline cache, device memory allocator, and upload
+ * queue.
  */
 class abcg::VulkanDevice {
 public:
   void create(VulkanPhysicalDevice const &physicalDevice,
-              std::vector<char const *> const &extensions = {});
+              std::vector<char const *> const &extensions = {},
+              std::filesystem::path const &pipelineCachePath = {});
   void destroy();
 
   explicit operator vk::Device const &() const noexcept;
@@ -63,6 +69,9 @@ public:
   [[nodiscard]] VulkanPhysicalDevice const &getPhysicalDevice() const noexcept;
   [[nodiscard]] VulkanQueues const &getQueues() const noexcept;
   [[nodiscard]] VulkanCommandPools const &getCommandPools() const noexcept;
+  [[nodiscard]] vk::PipelineCache const &getPipelineCache() const noexcept;
+  [[nodiscard]] VulkanAllocator &getAllocator() const noexcept;
+  [[nodiscard]] VulkanUploadQueue &getUploadQueue() const noexcept;
 
   void withCommandBuffer(
       std::function<void(vk::CommandBuffer const &commandBuffer)> const &fun,
@@ -73,10 +82,19 @@ private:
   void createCommandPools();
   void destroyCommandPools();
 
+  void createPipelineCache();
+  void savePipelineCache() const;
+  void destroyPipelineCache();
+
   vk::Device m_device;
   VulkanPhysicalDevice m_physicalDevice;
   VulkanCommandPools m_commandPools;
   VulkanQueues m_queues;
+  vk::PipelineCache m_pipelineCache;
+  std::filesystem::path m_pipelineCachePath;
+  // Shared by copies of this object
+  std::shared_ptr<VulkanAllocator> m_allocator;
+  std::shared_ptr<VulkanUploadQueue> m_uploadQueue;
 };
 
 #endif
\ No newline at end of file
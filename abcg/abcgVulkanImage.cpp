@@ -9,18 +9,85 @@
  */
 
 #include "abcgVulkanImage.hpp"
-#include "abcgVulkanBuffer.hpp"
 
 #include <SDL_image.h>
 #include <cppitertools/itertools.hpp>
 #include <fmt/core.h>
 #include <gsl/gsl>
 
+#include <optional>
+
 #include "abcgException.hpp"
+#include "abcgImage.hpp"
+
+namespace {
+// Returns the Vulkan format of a texture format
+[[nodiscard]] vk::Format getVulkanFormat(abcg::TextureFormat format) {
+  using abcg::TextureFormat;
+  switch (format) {
+  case TextureFormat::RGBA8Unorm:
+    return vk::Format::eR8G8B8A8Unorm;
+  case TextureFormat::RGBA8SRGB:
+    return vk::Format::eR8G8B8A8Srgb;
+  case TextureFormat::BC1RGBUnorm:
+    return vk::Format::eBc1RgbUnormBlock;
+  case TextureFormat::BC1RGBSRGB:
+    return vk::Format::eBc1RgbSrgbBlock;
+  case TextureFormat::BC1RGBAUnorm:
+    return vk::Format::eBc1RgbaUnormBlock;
+  case TextureFormat::BC1RGBASRGB:
+    return vk::Format::eBc1RgbaSrgbBlock;
+  case TextureFormat::BC2Unorm:
+    return vk::Format::eBc2UnormBlock;
+  case TextureFormat::BC2SRGB:
+    return vk::Format::eBc2SrgbBlock;
+  case TextureFormat::BC3Unorm:
+    return vk::Format::eBc3UnormBlock;
+  case TextureFormat::BC3SRGB:
+    return vk::Format::eBc3SrgbBlock;
+  case TextureFormat::BC4Unorm:
+    return vk::Format::eBc4UnormBlock;
+  case TextureFormat::BC4Snorm:
+    return vk::Format::eBc4SnormBlock;
+  case TextureFormat::BC5Unorm:
+    return vk::Format::eBc5UnormBlock;
+  case TextureFormat::BC5Snorm:
+    return vk::Format::eBc5SnormBlock;
+  case TextureFormat::BC6HUfloat:
+    return vk::Format::eBc6HUfloatBlock;
+  case TextureFormat::BC6HSfloat:
+    return vk::Format::eBc6HSfloatBlock;
+  case TextureFormat::BC7Unorm:
+    return vk::Format::eBc7UnormBlock;
+  case TextureFormat::BC7SRGB:
+    return vk::Format::eBc7SrgbBlock;
+  case TextureFormat::ETC2RGB8Unorm:
+    return vk::Format::eEtc2R8G8B8UnormBlock;
+  case TextureFormat::ETC2RGB8SRGB:
+    return vk::Format::eEtc2R8G8B8SrgbBlock;
+  case TextureFormat::ETC2RGB8A1Unorm:
+    return vk::Format::eEtc2R8G8B8A1UnormBlock;
+  case TextureFormat::ETC2RGB8A1SRGB:
+    return vk::Format::eEtc2R8G8B8A1SrgbBlock;
+  case TextureFormat::ETC2RGBA8Unorm:
+    return vk::Format::eEtc2R8G8B8A8UnormBlock;
+  case TextureFormat::ETC2RGBA8SRGB:
+    return vk::Format::eEtc2R8G8B8A8SrgbBlock;
+  }
+  return vk::Format::eUndefined;
+}
+} // namespace
 
 void abcg::VulkanImage::create(VulkanDevice const &device,
                                std::string_view path, bool generateMipmaps) {
   m_device = static_cast<vk::Device>(device);
+  m_allocator = &device.getAllocator();
+
+  // KTX2 and DDS files are uploaded with the mipmap levels they contain
+  if (isTextureContainerFile(path)) {
+    create(device, loadTextureContainer(path));
+    return;
+  }
 
   // Load the bitmap
   if (SDL_Surface *const surface{IMG_Load(path.data())}) {
@@ -40,22 +107,23 @@ void abcg::VulkanImage::create(VulkanDevice const &device,
                     1;
     }
 
-    // Create staging buffer
-    abcg::VulkanBuffer stagingBuffer{};
-    stagingBuffer.create(
-        device, {.size = imageSize,
-                 .usage = vk::BufferUsageFlagBits::eTransferSrc,
-                 .properties = vk::MemoryPropertyFlagBits::eHostVisible |
-                               vk::MemoryPropertyFlagBits::eHostCoherent,
-                 .data = formattedSurface->pixels});
-
-    SDL_FreeSurface(formattedSurface);
-
     // TODO: Look for other formats if RGBA8 is not supported
     auto const imageFormat{vk::Format::eR8G8B8A8Srgb};
 
+    // Mipmap levels are generated on the device by blitting each level to the
+    // next one if the format supports linear filtering. Otherwise, they are
+    // generated on the host and uploaded along with the base level
+    vk::FormatProperties const formatProperties{
+        static_cast<vk::PhysicalDevice>(device.getPhysicalDevice())
+            .getFormatProperties(imageFormat)};
+    auto const blitMipmaps{
+        m_mipLevels > 1 &&
+        static_cast<bool>(
+            formatProperties.optimalTilingFeatures &
+            vk::FormatFeatureFlagBits::eSampledImageFilterLinear)};
+
     // Create image buffer
-    std::tie(m_image, m_deviceMemory) = createImage(
+    std::tie(m_image, m_allocation) = createImage(
         device,
         {.imageType = vk::ImageType::e2D,
          .format = imageFormat,
@@ -64,7 +132,7 @@ void abcg::VulkanImage::create(VulkanDevice const &device,
          .arrayLayers = 1,
          .samples = vk::SampleCountFlagBits::e1,
          .tiling = vk::ImageTiling::eOptimal,
-         .usage = (m_mipLevels > 1 // Required for blit ops
+         .usage = (blitMipmaps // Required for blit ops
                        ? vk::ImageUsageFlagBits::eTransferSrc
                        : vk::ImageUsageFlagBits::eTransferDst) |
                   vk::ImageUsageFlagBits::eTransferDst |
@@ -76,94 +144,138 @@ void abcg::VulkanImage::create(VulkanDevice const &device,
                           vk::ImageLayout::eTransferDstOptimal,
                           {.aspectMask = vk::ImageAspectFlagBits::eColor,
                            .levelCount = m_mipLevels,
-                           .layerCount = 1});
-
-    vk::BufferImageCopy const region{
-        .imageSubresource = {.aspectMask = vk::ImageAspectFlagBits::eColor,
-                             .layerCount = 1},
-        .imageExtent = {texWidth, texHeight, 1}};
-
-    // Execute the layout transition
-    device.withCommandBuffer(
-        [&stagingBuffer, this,
-         &region](vk::CommandBuffer const &commandBuffer) {
-          commandBuffer.copyBufferToImage(
-              static_cast<vk::Buffer>(stagingBuffer), m_image,
-              vk::ImageLayout::eTransferDstOptimal, region);
-        },
-        vk::QueueFlagBits::eTransfer);
-
-    // Generate the mipmap levels
-    if (m_mipLevels > 1) {
-      // Transitioned to vk::ImageLayout::eShaderReadOnlyOptimal while
-      // generating the mipmaps
-      createMipmaps(device, m_image, imageFormat, texWidth, texHeight,
-                    m_mipLevels);
+                           .layerCount = 1},
+                          vk::QueueFlagBits::eTransfer);
+
+    // Copy the pixels to staging memory, and record the copy to the image.
+    // The copy is submitted with the next batch of the upload queue, without
+    // waiting for the queue
+    std::span<std::byte const> const pixels{
+        static_cast<std::byte const *>(formattedSurface->pixels),
+        gsl::narrow<std::size_t>(imageSize)};
+    if (m_mipLevels > 1 && !blitMipmaps) {
+      auto const [levels, regions]{createMipmapsOnHost(
+          pixels, texWidth, texHeight, m_mipLevels)};
+      device.getUploadQueue().upload(m_image, levels, regions);
     } else {
-      transitionImageLayout(device, vk::ImageLayout::eTransferDstOptimal,
-                            vk::ImageLayout::eReadOnlyOptimal,
-                            {.aspectMask = vk::ImageAspectFlagBits::eColor,
-                             .levelCount = m_mipLevels,
-                             .layerCount = 1});
+      vk::BufferImageCopy const region{
+          .imageSubresource = {.aspectMask = vk::ImageAspectFlagBits::eColor,
+                               .layerCount = 1},
+          .imageExtent = {texWidth, texHeight, 1}};
+      device.getUploadQueue().upload(m_image, pixels, {&region, 1});
     }
 
-    stagingBuffer.destroy();
+    SDL_FreeSurface(formattedSurface);
 
-    // Create image view
-    m_imageView = m_device.createImageView(
-        {.image = m_image,
-         .viewType = vk::ImageViewType::e2D,
-         .format = imageFormat,
-         .subresourceRange = {.aspectMask = vk::ImageAspectFlagBits::eColor,
-                              .levelCount = 1,
-                              .layerCount = 1}});
-
-    // Create sampler
-    vk::SamplerCreateInfo samplerCreateInfo{
-        .magFilter = vk::Filter::eLinear,
-        .minFilter = vk::Filter::eLinear,
-        .mipmapMode = vk::SamplerMipmapMode::eLinear,
-        .addressModeU = vk::SamplerAddressMode::eRepeat,
-        .addressModeV = vk::SamplerAddressMode::eRepeat,
-        .addressModeW = vk::SamplerAddressMode::eRepeat,
-        .mipLodBias = 0.0f,
-        .anisotropyEnable = VK_TRUE,
-        .maxAnisotropy =
-            static_cast<vk::PhysicalDevice>(device.getPhysicalDevice())
-                .getProperties()
-                .limits.maxSamplerAnisotropy,
-        .compareEnable = VK_FALSE,
-        .compareOp = vk::CompareOp::eAlways,
-        .minLod = 0.0f,
-        .maxLod = 0.0f,
-        .borderColor = vk::BorderColor::eIntOpaqueBlack,
-        .unnormalizedCoordinates = VK_FALSE};
-
-    if (m_mipLevels > 1) {
-      samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
-      samplerCreateInfo.maxLod = gsl::narrow<float>(m_mipLevels);
-      // samplerCreateInfo.minLod = gsl::narrow<float>(m_mipLevels >> 1);
+    // Hand the image over to the graphics queue family, which samples it and
+    // generates the mipmap levels
+    auto const finalLayout{blitMipmaps
+                               ? vk::ImageLayout::eTransferDstOptimal
+                               : vk::ImageLayout::eShaderReadOnlyOptimal};
+    device.getUploadQueue().transferOwnership(
+        m_image,
+        {.aspectMask = vk::ImageAspectFlagBits::eColor,
+         .levelCount = m_mipLevels,
+         .layerCount = 1},
+        vk::ImageLayout::eTransferDstOptimal, finalLayout);
+
+    // Generate the mipmap levels
+    if (blitMipmaps) {
+      // Transitioned to vk::ImageLayout::eShaderReadOnlyOptimal while
+      // generating the mipmaps
+      createMipmaps(device, m_image, texWidth, texHeight, m_mipLevels);
     }
-    m_sampler = m_device.createSampler(samplerCreateInfo);
 
-    // Create descriptor info
-    m_descriptorImageInfo = {.sampler = m_sampler,
-                             .imageView = m_imageView,
-                             .imageLayout =
-                                 vk::ImageLayout::eShaderReadOnlyOptimal};
+    // Create image view, sampler and descriptor info
+    createSampledView(device, imageFormat);
   } else {
     throw abcg::RuntimeError(
         fmt::format("Failed to load texture file {}", path));
   }
 }
 
+// Creates the image from the levels of a texture container. Levels in
+// block-compressed formats are uploaded as they are if the format can be
+// sampled by the device, and are transcoded to RGBA8 otherwise
+void abcg::VulkanImage::create(VulkanDevice const &device,
+                               TextureContainer const &container) {
+  auto const isSupported{[&device](vk::Format format) {
+    auto const formatProperties{
+        static_cast<vk::PhysicalDevice>(device.getPhysicalDevice())
+            .getFormatProperties(format)};
+    return static_cast<bool>(formatProperties.optimalTilingFeatures &
+                             vk::FormatFeatureFlagBits::eSampledImage);
+  }};
+
+  std::optional<TextureContainer> transcoded;
+  auto imageFormat{getVulkanFormat(container.format)};
+  if (!isSupported(imageFormat)) {
+    transcoded = transcodeToRGBA8(container);
+    imageFormat = getVulkanFormat(transcoded->format);
+  }
+  auto const &texture{transcoded ? *transcoded : container};
+  if (texture.levels.empty()) {
+    throw abcg::RuntimeError("Texture file has no image");
+  }
+
+  m_mipLevels = gsl::narrow<uint32_t>(texture.levels.size());
+  auto const &baseLevel{texture.levels.front()};
+
+  // Create image buffer
+  std::tie(m_image, m_allocation) = createImage(
+      device,
+      {.imageType = vk::ImageType::e2D,
+       .format = imageFormat,
+       .extent = {.width = baseLevel.width,
+                  .height = baseLevel.height,
+                  .depth = 1},
+       .mipLevels = m_mipLevels,
+       .arrayLayers = 1,
+       .samples = vk::SampleCountFlagBits::e1,
+       .tiling = vk::ImageTiling::eOptimal,
+       .usage = vk::ImageUsageFlagBits::eTransferDst |
+                vk::ImageUsageFlagBits::eSampled,
+       .initialLayout = vk::ImageLayout::eUndefined},
+      vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+  vk::ImageSubresourceRange const subresourceRange{
+      .aspectMask = vk::ImageAspectFlagBits::eColor,
+      .levelCount = m_mipLevels,
+      .layerCount = 1};
+  transitionImageLayout(device, vk::ImageLayout::eUndefined,
+                        vk::ImageLayout::eTransferDstOptimal, subresourceRange,
+                        vk::QueueFlagBits::eTransfer);
+
+  // Copy all levels in a single upload. The levels of the container are
+  // aligned to 16 bytes, which is a multiple of the size of the texel blocks
+  std::vector<vk::BufferImageCopy> regions;
+  regions.reserve(texture.levels.size());
+  for (auto &&[mipLevel, level] : iter::enumerate(texture.levels)) {
+    regions.push_back(
+        {.bufferOffset = level.offset,
+         .imageSubresource = {.aspectMask = vk::ImageAspectFlagBits::eColor,
+                              .mipLevel = gsl::narrow<uint32_t>(mipLevel),
+                              .layerCount = 1},
+         .imageExtent = {level.width, level.height, 1}});
+  }
+  device.getUploadQueue().upload(m_image, texture.data, regions);
+
+  // Hand the image over to the graphics queue family
+  device.getUploadQueue().transferOwnership(
+      m_image, subresourceRange, vk::ImageLayout::eTransferDstOptimal,
+      vk::ImageLayout::eShaderReadOnlyOptimal);
+
+  createSampledView(device, imageFormat);
+}
+
 void abcg::VulkanImage::create(VulkanDevice const &device,
                                VulkanImageCreateInfo const &createInfo) {
   m_device = static_cast<vk::Device>(device);
+  m_allocator = &device.getAllocator();
 
   // Create image only if createInfo.viewInfo.image is undefined
   if (!createInfo.viewInfo.image) {
-    std::tie(m_image, m_deviceMemory) =
+    std::tie(m_image, m_allocation) =
         createImage(device, createInfo.info, createInfo.properties);
   }
 
@@ -185,9 +297,10 @@ void abcg::VulkanImage::destroy() {
   if (m_image) {
     m_device.destroyImage(m_image);
   }
-  if (m_deviceMemory) {
-    m_device.freeMemory(m_deviceMemory);
+  if (m_allocator != nullptr) {
+    m_allocator->free(m_allocation);
   }
+  m_allocation = {};
 }
 
 /**
@@ -204,7 +317,20 @@ abcg::VulkanImage::operator vk::Image const &() const noexcept {
  * @return Device memory object.
  */
 vk::DeviceMemory const &abcg::VulkanImage::getDeviceMemory() const noexcept {
-  return m_deviceMemory;
+  return m_allocation.memory;
+}
+
+/**
+ * @brief Returns the region of device memory associated with this image.
+ *
+ * The image is bound at the offset of the region within the device memory
+ * object.
+ *
+ * @return Allocated region.
+ */
+abcg::VulkanAllocation const &
+abcg::VulkanImage::getAllocation() const noexcept {
+  return m_allocation;
 }
 
 /**
@@ -230,8 +356,10 @@ abcg::VulkanImage::getDescriptorImageInfo() const noexcept {
 /**
  * @brief Returns the number of mipmap levels generated for this image.
  *
- * If the image is created with `generateMipmaps = false`, the number of
- * mipmap levels is always 1. Otherwise, it is computed as \f$\lfloor
+ * If the image is loaded from a KTX2 or DDS file, this is the number of
+ * levels stored in the file. If the image is created with `generateMipmaps =
+ * false`, the number of mipmap levels is always 1. Otherwise, it is computed
+ * as \f$\lfloor
  * \log_2(\max(w, h)) \rfloor + 1\f$, where \f$w\f$ and \f$h\f$ are the
  * texture width and height.
  *
@@ -241,36 +369,79 @@ uint32_t abcg::VulkanImage::getMipLevels() const noexcept {
   return m_mipLevels;
 }
 
-std::pair<vk::Image, vk::DeviceMemory>
+// Creates the view of all mipmap levels, the sampler and the descriptor
+// information of a sampled image
+void abcg::VulkanImage::createSampledView(VulkanDevice const &device,
+                                          vk::Format format) {
+  // Create image view
+  m_imageView = m_device.createImageView(
+      {.image = m_image,
+       .viewType = vk::ImageViewType::e2D,
+       .format = format,
+       .subresourceRange = {.aspectMask = vk::ImageAspectFlagBits::eColor,
+                            .levelCount = m_mipLevels,
+                            .layerCount = 1}});
+
+  // Create sampler
+  vk::SamplerCreateInfo samplerCreateInfo{
+      .magFilter = vk::Filter::eLinear,
+      .minFilter = vk::Filter::eLinear,
+      .mipmapMode = vk::SamplerMipmapMode::eLinear,
+      .addressModeU = vk::SamplerAddressMode::eRepeat,
+      .addressModeV = vk::SamplerAddressMode::eRepeat,
+      .addressModeW = vk::SamplerAddressMode::eRepeat,
+      .mipLodBias = 0.0f,
+      .anisotropyEnable = VK_TRUE,
+      .maxAnisotropy =
+          static_cast<vk::PhysicalDevice>(device.getPhysicalDevice())
+              .getProperties()
+              .limits.maxSamplerAnisotropy,
+      .compareEnable = VK_FALSE,
+      .compareOp = vk::CompareOp::eAlways,
+      .minLod = 0.0f,
+      .maxLod = 0.0f,
+      .borderColor = vk::BorderColor::eIntOpaqueBlack,
+      .unnormalizedCoordinates = VK_FALSE};
+
+  if (m_mipLevels > 1) {
+    samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
+    samplerCreateInfo.maxLod = gsl::narrow<float>(m_mipLevels);
+    // samplerCreateInfo.minLod = gsl::narrow<float>(m_mipLevels >> 1);
+  }
+  m_sampler = m_device.createSampler(samplerCreateInfo);
+
+  // Create descriptor info
+  m_descriptorImageInfo = {.sampler = m_sampler,
+                           .imageView = m_imageView,
+                           .imageLayout =
+                               vk::ImageLayout::eShaderReadOnlyOptimal};
+}
+
+std::pair<vk::Image, abcg::VulkanAllocation>
 abcg::VulkanImage::createImage(VulkanDevice const &device,
                                vk::ImageCreateInfo const &imageInfo,
                                vk::MemoryPropertyFlags properties) const {
   // Create image object
   auto image{m_device.createImage(imageInfo)};
 
-  // Get memory requirements
-  auto const memoryRequirements{m_device.getImageMemoryRequirements(image)};
-
-  // Allocate image memory
-  auto const memoryType{device.getPhysicalDevice().findMemoryType(
-      memoryRequirements.memoryTypeBits, properties)};
-  if (!memoryType.has_value()) {
-    throw abcg::RuntimeError("Failed to find suitable memory type");
+  // Sub-allocate image memory and associate it to the image
+  auto &allocator{device.getAllocator()};
+  if (imageInfo.tiling == vk::ImageTiling::eOptimal) {
+    return {image, allocator.allocate(image, properties)};
   }
-  auto imageMemory{
-      m_device.allocateMemory({.allocationSize = memoryRequirements.size,
-                               .memoryTypeIndex = memoryType.value()})};
-
-  // Associate image memory to image
-  m_device.bindImageMemory(image, imageMemory, 0);
 
-  return {image, imageMemory};
+  // Images with linear tiling are placed together with buffers
+  auto const allocation{allocator.allocate(
+      m_device.getImageMemoryRequirements(image), properties,
+      VulkanAllocationLifetime::Persistent, true)};
+  m_device.bindImageMemory(image, allocation.memory, allocation.offset);
+  return {image, allocation};
 }
 
 void abcg::VulkanImage::transitionImageLayout(
     VulkanDevice const &device, vk::ImageLayout oldImageLayout,
-    vk::ImageLayout newImageLayout,
-    vk::ImageSubresourceRange subresourceRange) const {
+    vk::ImageLayout newImageLayout, vk::ImageSubresourceRange subresourceRange,
+    vk::QueueFlagBits queueFlag) const {
 
   // Gets the corresponding access mask for a given image layout
   auto accessMask{[](vk::ImageLayout layout) {
@@ -324,33 +495,22 @@ void abcg::VulkanImage::transitionImageLayout(
   auto srcStageMask{stageMask(oldImageLayout)};
   auto destStageMask{stageMask(newImageLayout)};
 
-  // Execute the layout transition
-  device.withCommandBuffer(
+  // Record the layout transition into the current upload batch
+  device.getUploadQueue().record(
       [&](const auto &commandBuffer) {
         commandBuffer.pipelineBarrier(srcStageMask, destStageMask,
                                       vk::DependencyFlags(), nullptr, nullptr,
                                       imageMemoryBarrier);
       },
-      vk::QueueFlagBits::eTransfer);
+      queueFlag);
 }
 
+// Records the blits that generate the mipmap levels of an image from its base
+// level. The image format must support linear filtering
 void abcg::VulkanImage::createMipmaps(VulkanDevice const &device,
-                                      vk::Image image, vk::Format imageFormat,
-                                      uint32_t texWidth, uint32_t texHeight,
-                                      uint32_t mipLevels) {
-  // Check if image format supports linear blitting
-  vk::FormatProperties const formatProperties{
-      static_cast<vk::PhysicalDevice>(device.getPhysicalDevice())
-          .getFormatProperties(imageFormat)};
-
-  if (!(formatProperties.optimalTilingFeatures &
-        vk::FormatFeatureFlagBits::eSampledImageFilterLinear)) {
-    // TODO: generate mip maps in software
-    throw abcg::RuntimeError(
-        "Texture image format does not support linear blitting");
-  }
-
-  device.withCommandBuffer(
+                                      vk::Image image, uint32_t texWidth,
+                                      uint32_t texHeight, uint32_t mipLevels) {
+  device.getUploadQueue().record(
       [&](vk::CommandBuffer const &commandBuffer) {
         vk::ImageMemoryBarrier barrier{
             .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
@@ -425,3 +585,46 @@ void abcg::VulkanImage::createMipmaps(VulkanDevice const &device,
       },
       vk::QueueFlagBits::eGraphics);
 }
+
+// Returns the texels of all mipmap levels of an sRGB RGBA8 image, and the
+// regions of the levels for abcg::VulkanUploadQueue::upload. Levels are
+// aligned to 16 bytes in the returned data
+std::pair<std::vector<std::byte>, std::vector<vk::BufferImageCopy>>
+abcg::VulkanImage::createMipmapsOnHost(std::span<std::byte const> pixels,
+                                       uint32_t texWidth, uint32_t texHeight,
+                                       uint32_t mipLevels) {
+  std::vector<vk::BufferImageCopy> regions;
+  regions.reserve(mipLevels);
+  vk::DeviceSize size{};
+  for (auto const mipLevel : iter::range(mipLevels)) {
+    auto const width{std::max(texWidth >> mipLevel, 1U)};
+    auto const height{std::max(texHeight >> mipLevel, 1U)};
+    regions.push_back(
+        {.bufferOffset = size,
+         .imageSubresource = {.aspectMask = vk::ImageAspectFlagBits::eColor,
+                              .mipLevel = mipLevel,
+                              .layerCount = 1},
+         .imageExtent = {width, height, 1}});
+    size += (vk::DeviceSize{width} * height * 4 + 15) & ~vk::DeviceSize{15};
+  }
+
+  std::vector<std::byte> levels(gsl::narrow<std::size_t>(size));
+  std::copy(pixels.begin(), pixels.end(), levels.begin());
+
+  for (auto const mipLevel : iter::range(1U, mipLevels)) {
+    auto const &source{regions.at(mipLevel - 1)};
+    auto const &destination{regions.at(mipLevel)};
+    auto const sourceSize{gsl::narrow<std::size_t>(
+        vk::DeviceSize{source.imageExtent.width} * source.imageExtent.height *
+        4)};
+    auto const destinationSize{gsl::narrow<std::size_t>(
+        vk::DeviceSize{destination.imageExtent.width} *
+        destination.imageExtent.height * 4)};
+    abcg::downsampleRGBA(
+        {levels.data() + source.bufferOffset, sourceSize},
+        source.imageExtent.width, source.imageExtent.height,
+        {levels.data() + destination.bufferOffset, destinationSize});
+  }
+
+  return {std::move(levels), std::move(regions)};
+}
@@ -13,9 +13,12 @@
 #ifndef ABCG_VULKAN_IMAGE_HPP_
 #define ABCG_VULKAN_IMAGE_HPP_
 
+#include "abcgTextureContainer.hpp"
 #include "abcgVulkanDevice.hpp"
 
 #include <gsl/pointers>
+#include <span>
+#include <vector>
 
 namespace abcg {
 struct VulkanImageCreateInfo;
@@ -35,7 +38,9 @@ struct abcg::VulkanImageCreateInfo {
  * @brief A class for representing a Vulkan image.
  *
  * This class provides helper functions for creating and managing vk::Image
- * objects.
+ * objects. Memory is sub-allocated from the allocator of the device.
+ *
+ * @sa abcg::VulkanDevice::getAllocator.
  */
 class abcg::VulkanImage {
 public:
@@ -48,13 +53,17 @@ public:
   explicit operator vk::Image const &() const noexcept;
 
   [[nodiscard]] vk::DeviceMemory const &getDeviceMemory() const noexcept;
+  [[nodiscard]] VulkanAllocation const &getAllocation() const noexcept;
   [[nodiscard]] vk::ImageView const &getView() const noexcept;
   [[nodiscard]] vk::DescriptorImageInfo const &
   getDescriptorImageInfo() const noexcept;
   [[nodiscard]] uint32_t getMipLevels() const noexcept;
 
 private:
-  [[nodiscard]] std::pair<vk::Image, vk::DeviceMemory>
+  void create(VulkanDevice const &device, TextureContainer const &container);
+  void createSampledView(VulkanDevice const &device, vk::Format format);
+
+  [[nodiscard]] std::pair<vk::Image, VulkanAllocation>
   createImage(VulkanDevice const &device, vk::ImageCreateInfo const &imageInfo,
               vk::MemoryPropertyFlags properties) const;
   void transitionImageLayout(VulkanDevice const &device,
@@ -63,14 +72,21 @@ private:
                              vk::ImageSubresourceRange subresourceRange = {
                                  .aspectMask = vk::ImageAspectFlagBits::eColor,
                                  .levelCount = 1,
-                                 .layerCount = 1}) const;
+                                 .layerCount = 1},
+                             vk::QueueFlagBits queueFlag =
+                                 vk::QueueFlagBits::eGraphics) const;
 
   static void createMipmaps(VulkanDevice const &device, vk::Image image,
-                            vk::Format imageFormat, uint32_t texWidth,
-                            uint32_t texHeight, uint32_t mipLevels);
+                            uint32_t texWidth, uint32_t texHeight,
+                            uint32_t mipLevels);
+  [[nodiscard]] static std::pair<std::vector<std::byte>,
+                                 std::vector<vk::BufferImageCopy>>
+  createMipmapsOnHost(std::span<std::byte const> pixels, uint32_t texWidth,
+                      uint32_t texHeight, uint32_t mipLevels);
 
   vk::Image m_image;
-  vk::DeviceMemory m_deviceMemory;
+  VulkanAllocation m_allocation;
+  VulkanAllocator *m_allocator{};
   vk::ImageView m_imageView;
   vk::Sampler m_sampler;
   vk::DescriptorImageInfo m_descriptorImageInfo;
@@ -0,0 +1,193 @@
+/**
+ * @file abcgVulkanMesh.cpp
+ * @brief Definition of abcg::VulkanMesh
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgVulkanMesh.hpp"
+
+#include <cppitertools/itertools.hpp>
+#include <fmt/core.h>
+#include <gsl/gsl>
+
+#include "abcgException.hpp"
+
+namespace {
+constexpr std::array meshAttributes{
+    abcg::MeshAttribute::Position, abcg::MeshAttribute::Normal,
+    abcg::MeshAttribute::TexCoord, abcg::MeshAttribute::Color};
+} // namespace
+
+/**
+ * @brief Creates the vertex and index buffers from a mesh file.
+ *
+ * The file is memory-mapped, and its vertex and index data are copied as they
+ * are to the staging memory of the upload queue of the device.
+ *
+ * @param device Vulkan device.
+ * @param path Path to the mesh file.
+ *
+ * @throw abcg::RuntimeError if the file could not be loaded, or if the mesh
+ * is empty.
+ */
+void abcg::VulkanMesh::create(VulkanDevice const &device,
+                              std::string_view path) {
+  MeshFile file;
+  file.open(path);
+  m_header = file.getHeader();
+
+  auto const vertexData{file.getVertexData()};
+  auto const indexData{file.getIndexData()};
+  if (vertexData.empty() || indexData.empty()) {
+    throw abcg::RuntimeError(fmt::format("Empty mesh file {}", path));
+  }
+
+  m_vertexBuffer.create(device,
+                        {.size = vertexData.size(),
+                         .usage = vk::BufferUsageFlagBits::eVertexBuffer,
+                         .data = vertexData.data()});
+  m_indexBuffer.create(device, {.size = indexData.size(),
+                                .usage = vk::BufferUsageFlagBits::eIndexBuffer,
+                                .data = indexData.data()});
+}
+
+/**
+ * @brief Destroys the buffers.
+ */
+void abcg::VulkanMesh::destroy() {
+  m_vertexBuffer.destroy();
+  m_indexBuffer.destroy();
+  m_header = {};
+}
+
+/**
+ * @brief Binds the vertex and index buffers to a command buffer.
+ *
+ * Interleaved vertices are bound to binding 0. De-interleaved streams are
+ * bound to consecutive bindings starting at 0, in the order of the
+ * abcg::MeshAttribute enumerators.
+ *
+ * @param commandBuffer Command buffer in the recording state.
+ */
+void abcg::VulkanMesh::bind(vk::CommandBuffer const &commandBuffer) const {
+  auto const streams{getStreams()};
+  std::vector<vk::Buffer> buffers(streams.size(),
+                                  static_cast<vk::Buffer>(m_vertexBuffer));
+  std::vector<vk::DeviceSize> offsets;
+  offsets.reserve(streams.size());
+  for (auto const &stream : streams) {
+    offsets.push_back(stream.offset);
+  }
+  commandBuffer.bindVertexBuffers(0, buffers, offsets);
+  commandBuffer.bindIndexBuffer(static_cast<vk::Buffer>(m_indexBuffer), 0,
+                                m_header.indexSize == 2
+                                    ? vk::IndexType::eUint16
+                                    : vk::IndexType::eUint32);
+}
+
+/**
+ * @brief Records the draw of the triangles of the mesh.
+ *
+ * @param commandBuffer Command buffer in the recording state, to which the
+ * buffers of the mesh are bound.
+ * @param instanceCount Number of instances to draw.
+ */
+void abcg::VulkanMesh::draw(vk::CommandBuffer const &commandBuffer,
+                            uint32_t instanceCount) const {
+  commandBuffer.drawIndexed(m_header.indexCount, instanceCount, 0, 0, 0);
+}
+
+/**
+ * @brief Returns the vertex input binding descriptions of the mesh.
+ *
+ * @return One binding for interleaved vertices, or one binding per vertex
+ * attribute for de-interleaved streams.
+ *
+ * @sa abcg::VulkanMesh::bind.
+ */
+std::vector<vk::VertexInputBindingDescription>
+abcg::VulkanMesh::getBindingDescriptions() const {
+  std::vector<vk::VertexInputBindingDescription> descriptions;
+  for (auto &&[binding, stream] : iter::enumerate(getStreams())) {
+    descriptions.push_back(
+        {.binding = gsl::narrow<uint32_t>(binding),
+         .stride = gsl::narrow<uint32_t>(stream.stride),
+         .inputRate = vk::VertexInputRate::eVertex});
+  }
+  return descriptions;
+}
+
+/**
+ * @brief Returns the vertex input attribute description of an attribute of
+ * the mesh.
+ *
+ * @param attribute Vertex attribute.
+ * @param location Location of the attribute in the vertex shader.
+ *
+ * @return Attribute description, or `std::nullopt` if the mesh does not have
+ * the attribute.
+ */
+std::optional<vk::VertexInputAttributeDescription>
+abcg::VulkanMesh::getAttributeDescription(MeshAttribute attribute,
+                                          uint32_t location) const {
+  auto const stream{MeshFile::getStream(m_header, attribute)};
+  if (!stream) {
+    return std::nullopt;
+  }
+
+  // Binding of the stream of the attribute, if not interleaved
+  uint32_t binding{};
+  if (m_header.interleaved == 0) {
+    for (auto const current : meshAttributes) {
+      if (current == attribute) {
+        break;
+      }
+      if (MeshFile::getStream(m_header, current)) {
+        ++binding;
+      }
+    }
+  }
+
+  constexpr std::array formats{vk::Format::eR32Sfloat,
+                               vk::Format::eR32G32Sfloat,
+                               vk::Format::eR32G32B32Sfloat,
+                               vk::Format::eR32G32B32A32Sfloat};
+  return vk::VertexInputAttributeDescription{
+      .location = location,
+      .binding = binding,
+      .format = formats.at(stream->components - 1),
+      .offset = m_header.interleaved != 0
+                    ? gsl::narrow<uint32_t>(stream->offset)
+                    : 0U};
+}
+
+/**
+ * @brief Returns the header of the mesh file.
+ *
+ * @return Header with the number of vertices and indices, the vertex
+ * attributes and the bounding box of the mesh.
+ */
+abcg::MeshFileHeader const &abcg::VulkanMesh::getHeader() const noexcept {
+  return m_header;
+}
+
+// Returns the streams to be bound as vertex buffers: a single stream at
+// offset 0 if the attributes are interleaved, or one stream per attribute
+std::vector<abcg::MeshStream> abcg::VulkanMesh::getStreams() const {
+  std::vector<MeshStream> streams;
+  for (auto const attribute : meshAttributes) {
+    if (auto const stream{MeshFile::getStream(m_header, attribute)}) {
+      if (m_header.interleaved != 0) {
+        MeshStream vertices{*stream};
+        vertices.offset = 0;
+        return {vertices};
+      }
+      streams.push_back(*stream);
+    }
+  }
+  return streams;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file abcgVulkanMesh.hpp
+ * @brief Header file of abcg::VulkanMesh
+ *
+ * Declaration of abcg::VulkanMesh
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_VULKAN_MESH_HPP_
+#define ABCG_VULKAN_MESH_HPP_
+
+#include "abcgMesh.hpp"
+#include "abcgVulkanBuffer.hpp"
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace abcg {
+class VulkanMesh;
+} // namespace abcg
+
+/**
+ * @brief A class for representing the vertex and index buffers of a mesh
+ * loaded from an ABCg mesh file.
+ *
+ * The buffers are device local. Their data is copied from the memory-mapped
+ * file to staging memory of the upload queue of the device.
+ *
+ * @sa abcg::saveMesh for creating mesh files.
+ */
+class abcg::VulkanMesh {
+public:
+  void create(VulkanDevice const &device, std::string_view path);
+  void destroy();
+
+  void bind(vk::CommandBuffer const &commandBuffer) const;
+  void draw(vk::CommandBuffer const &commandBuffer,
+            uint32_t instanceCount = 1) const;
+
+  [[nodiscard]] std::vector<vk::VertexInputBindingDescription>
+  getBindingDescriptions() const;
+  [[nodiscard]] std::optional<vk::VertexInputAttributeDescription>
+  getAttributeDescription(MeshAttribute attribute, uint32_t location) const;
+
+  [[nodiscard]] MeshFileHeader const &getHeader() const noexcept;
+
+private:
+  [[nodiscard]] std::vector<MeshStream> getStreams() const;
+
+  MeshFileHeader m_header{};
+  VulkanBuffer m_vertexBuffer;
+  VulkanBuffer m_indexBuffer;
+};
+
+#endif
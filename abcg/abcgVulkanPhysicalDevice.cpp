@@ -11,6 +11,7 @@
 #include "abcgVulkanPhysicalDevice.hpp"
 
 #include <cppitertools/itertools.hpp>
+#include <fmt/core.h>
 #include <gsl/gsl>
 #include <set>
 #include <span>
@@ -40,6 +41,12 @@ void abcg::VulkanPhysicalDevice::create(
     }
   }
 
+  if (useSeparateTransferQueue &&
+      m_queuesFamilies.transfer == m_queuesFamilies.graphics) {
+    fmt::print("No separate transfer queue family found; uploads will use the "
+               "graphics queue\n");
+  }
+
   m_sampleCount = std::min(sampleCount, getMaxUsableSampleCount());
 }
 
@@ -166,6 +173,7 @@ void abcg::VulkanPhysicalDevice::checkQueueFamily(
 
 void abcg::VulkanPhysicalDevice::findQueueFamilies(
     bool useSeparateTransferQueue) {
+  m_queuesFamilies = {};
   uint32_t queueFamilyIndex{};
   for (auto const &properties : m_physicalDevice.getQueueFamilyProperties()) {
     checkQueueFamily(properties, queueFamilyIndex, useSeparateTransferQueue);
@@ -178,7 +186,8 @@ void abcg::VulkanPhysicalDevice::findQueueFamilies(
         "Device does not have a graphics or present queue");
   }
   if (useSeparateTransferQueue && !m_queuesFamilies.transfer.has_value()) {
-    throw abcg::RuntimeError("Device does not have a separate transfer queue");
+    // Fall back to the graphics queue family, which always supports transfers
+    m_queuesFamilies.transfer = m_queuesFamilies.graphics;
   }
 }
 
@@ -120,8 +120,13 @@ void abcg::VulkanPipeline::create(VulkanSwapchain const &swapchain,
       // .basePipelineIndex = -1
   };
 
-  auto result{m_device.createGraphicsPipeline(createInfo.pipelineCache,
-                                              pipelineCreateInfo)};
+  // Use the pipeline cache of the device unless one is given
+  auto const pipelineCache{createInfo.pipelineCache
+                               ? createInfo.pipelineCache
+                               : swapchain.getDevice().getPipelineCache()};
+
+  auto result{
+      m_device.createGraphicsPipeline(pipelineCache, pipelineCreateInfo)};
   m_pipeline = result.value;
 }
 
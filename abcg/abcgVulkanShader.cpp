@@ -10,14 +10,25 @@
 
 #include "abcgVulkanShader.hpp"
 #include "abcgException.hpp"
+#include "abcgUtil.hpp"
 
 #include <glslang/SPIRV/GlslangToSpv.h>
 
+#include <cppitertools/itertools.hpp>
 #include <fmt/core.h>
 #include <gsl/gsl>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <exception>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
 
 namespace {
 TBuiltInResource InitResources() {
@@ -234,35 +245,211 @@ abcgStageToVulkanStage(abcg::ShaderStage stage) {
   }
 }
 
-// If filenameOrText is a filename, returns the contents of the file (assumed
-// to be in text format). Otherwise, returns filenameOrText.
-[[nodiscard]] std::string toSource(std::string_view filenameOrText) {
-  static const std::size_t maxPathSize{260};
-  if (filenameOrText.size() > maxPathSize ||
-      !std::filesystem::exists(filenameOrText)) {
-    return filenameOrText.data();
+// GLSL version and messages used by glslang when parsing shaders
+constexpr int defaultGLSLVersion{100};
+constexpr auto glslangMessages{
+    static_cast<EShMessages>(EShMsgSpvRules | EShMsgVulkanRules)};
+
+constexpr uint32_t SPIRVMagicNumber{0x07230203};
+
+// State of the on-disk SPIR-V cache. An empty directory disables the cache,
+// which is the default.
+struct SPIRVCache {
+  std::mutex mutex;
+  std::filesystem::path directory;
+  std::atomic<std::size_t> hits{};
+  std::atomic<std::size_t> misses{};
+};
+
+SPIRVCache &getSPIRVCache() {
+  static SPIRVCache cache;
+  return cache;
+}
+
+[[nodiscard]] std::filesystem::path getSPIRVCacheDirectory() {
+  auto &cache{getSPIRVCache()};
+  std::scoped_lock const lock{cache.mutex};
+  return cache.directory;
+}
+
+// Returns the cache key of a shader. The key depends on everything that
+// affects the SPIR-V code generated by glslang.
+[[nodiscard]] uint64_t
+computeSPIRVCacheKey(abcg::ShaderSource const &source,
+                     TBuiltInResource const &resources) {
+  auto const version{glslang::GetVersion()};
+  std::string_view const flavor{version.flavor != nullptr ? version.flavor
+                                                          : ""};
+
+  abcg::FNV1aHash hash;
+  hash.update(std::string_view{source.source});
+  hash.update(static_cast<int>(source.stage));
+  hash.update(version.major);
+  hash.update(version.minor);
+  hash.update(version.patch);
+  hash.update(flavor);
+  hash.update(defaultGLSLVersion);
+  hash.update(static_cast<int>(glslangMessages));
+
+  // The members before TBuiltInResource::limits are all ints, so they can be
+  // hashed as a contiguous range of bytes. TLimits may contain padding and is
+  // hashed member by member.
+  hash.update(std::as_bytes(std::span{&resources, 1})
+                  .first(offsetof(TBuiltInResource, limits)));
+  auto const &limits{resources.limits};
+  for (auto const limit :
+       {limits.nonInductiveForLoops, limits.whileLoops, limits.doWhileLoops,
+        limits.generalUniformIndexing,
+        limits.generalAttributeMatrixVectorIndexing,
+        limits.generalVaryingIndexing, limits.generalSamplerIndexing,
+        limits.generalVariableIndexing,
+        limits.generalConstantMatrixVectorIndexing}) {
+    hash.update(limit ? 1 : 0);
+  }
+  return hash.getValue();
+}
+
+// Header of the files stored in the SPIR-V cache. It is followed by the
+// shader source and then by the SPIR-V code.
+struct SPIRVCacheHeader {
+  std::array<char, 4> magic{'A', 'B', 'S', 'V'};
+  uint32_t version{1};
+  uint64_t key{};
+  uint64_t sourceSize{};
+  uint64_t codeSize{};
+};
+
+// Reads SPIR-V code from the cache. Returns std::nullopt if the file does not
+// exist, or if it was not created from the given key and shader source. As
+// the whole source is compared, a hash collision or a file created from
+// another shader is never loaded.
+[[nodiscard]] std::optional<std::vector<uint32_t>>
+loadCachedSPIRV(std::filesystem::path const &path, uint64_t key,
+                std::string_view source) {
+  std::ifstream stream(path, std::ios::binary | std::ios::ate);
+  if (!stream) {
+    return std::nullopt;
+  }
+  auto const fileSize{static_cast<std::streamoff>(stream.tellg())};
+  stream.seekg(0);
+
+  SPIRVCacheHeader header{};
+  SPIRVCacheHeader const expected{
+      .key = key, .sourceSize = source.size(), .codeSize = {}};
+  if (fileSize < static_cast<std::streamoff>(sizeof(header)) ||
+      !stream.read(reinterpret_cast<char *>(&header), // NOLINT
+                   sizeof(header)) ||
+      header.magic != expected.magic || header.version != expected.version ||
+      header.key != expected.key || header.sourceSize != expected.sourceSize ||
+      header.codeSize == 0) {
+    return std::nullopt;
+  }
+
+  // The size of the file must match the sizes in the header exactly
+  auto const payloadSize{static_cast<uint64_t>(fileSize) - sizeof(header)};
+  if (header.codeSize > payloadSize / sizeof(uint32_t) ||
+      payloadSize != header.sourceSize + header.codeSize * sizeof(uint32_t)) {
+    return std::nullopt;
+  }
+
+  std::string storedSource(gsl::narrow<std::size_t>(header.sourceSize), '\0');
+  if (!stream.read(storedSource.data(),
+                   gsl::narrow<std::streamsize>(storedSource.size())) ||
+      storedSource != source) {
+    return std::nullopt;
+  }
+
+  std::vector<uint32_t> code(gsl::narrow<std::size_t>(header.codeSize));
+  if (!stream.read(reinterpret_cast<char *>(code.data()), // NOLINT
+                   gsl::narrow<std::streamsize>(code.size() *
+                                                sizeof(uint32_t))) ||
+      code.front() != SPIRVMagicNumber) {
+    return std::nullopt;
   }
-  std::stringstream source;
-  if (std::ifstream stream(filenameOrText.data()); stream) {
-    source << stream.rdbuf();
-    stream.close();
+
+  return code;
+}
+
+// Writes SPIR-V code to the cache. The file is first written to a temporary
+// file and then renamed so that a partially written file is never read back.
+// Failures are silently ignored as the cache is only an optimization.
+void storeCachedSPIRV(std::filesystem::path const &path, uint64_t key,
+                      std::string_view source,
+                      std::vector<uint32_t> const &code) {
+  std::error_code errorCode;
+  std::filesystem::create_directories(path.parent_path(), errorCode);
+  if (errorCode) {
+    return;
+  }
+
+  auto const tempPath{abcg::getTemporaryPath(path)};
+
+  {
+    std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+      return;
+    }
+    SPIRVCacheHeader const header{
+        .key = key, .sourceSize = source.size(), .codeSize = code.size()};
+    stream.write(reinterpret_cast<char const *>(&header), // NOLINT
+                 sizeof(header));
+    stream.write(source.data(), gsl::narrow<std::streamsize>(source.size()));
+    stream.write(reinterpret_cast<char const *>(code.data()), // NOLINT
+                 gsl::narrow<std::streamsize>(code.size() * sizeof(uint32_t)));
+    if (!stream) {
+      stream.close();
+      std::filesystem::remove(tempPath, errorCode);
+      return;
+    }
+  }
+
+  std::filesystem::rename(tempPath, path, errorCode);
+  if (errorCode) {
+    std::filesystem::remove(tempPath, errorCode);
+  }
+}
+
+// Looks up the SPIR-V code of a shader in the cache and updates the hit/miss
+// counters. On return, cachePath contains the path of the cache file, or an
+// empty path if the cache is disabled, and key contains the cache key.
+[[nodiscard]] std::optional<std::vector<uint32_t>>
+findCachedSPIRV(abcg::ShaderSource const &source,
+                std::filesystem::path &cachePath, uint64_t &key) {
+  auto &cache{getSPIRVCache()};
+  cachePath.clear();
+  key = 0;
+
+  std::optional<std::vector<uint32_t>> code;
+  if (auto const cacheDirectory{getSPIRVCacheDirectory()};
+      !cacheDirectory.empty()) {
+    key = computeSPIRVCacheKey(source, InitResources());
+    cachePath = cacheDirectory / fmt::format("{:016x}.spv", key);
+    code = loadCachedSPIRV(cachePath, key, source.source);
+  }
+
+  if (code) {
+    ++cache.hits;
   } else {
-    throw abcg::RuntimeError(
-        fmt::format("Failed to read file {}", filenameOrText));
+    ++cache.misses;
   }
-  return source.str();
+  return code;
 }
 } // namespace
 
-// Compiles the given GLSL shader source into Vulkan SPIR-V.
-std::vector<uint32_t> GLSLtoSPV(abcg::ShaderSource shaderSource) {
-  // Prints out log info for compiling and linking
-  auto printLog{[](glslang::TShader &shader, std::string_view name) {
-    if (std::string const log{shader.getInfoLog()}; !log.empty()) {
-      fmt::print("Shader information log ({} shader):\n{}\n", name, log);
+// Compiles the given GLSL shader source into Vulkan SPIR-V. The information
+// logs of glslang are appended to log, which is left for the caller to print
+// so that the logs of concurrent compilations do not interleave.
+std::vector<uint32_t> GLSLtoSPV(abcg::ShaderSource const &shaderSource,
+                                std::string &log) {
+  // Appends the log info for compiling and linking
+  auto appendLog{[&log](glslang::TShader &shader, std::string_view name) {
+    if (std::string const info{shader.getInfoLog()}; !info.empty()) {
+      log += fmt::format("Shader information log ({} shader):\n{}\n", name,
+                         info);
     }
-    if (std::string const log{shader.getInfoDebugLog()}; !log.empty()) {
-      fmt::print("Shader information debug log ({} shader):\n{}\n", name, log);
+    if (std::string const info{shader.getInfoDebugLog()}; !info.empty()) {
+      log += fmt::format("Shader information debug log ({} shader):\n{}\n",
+                         name, info);
     }
   }};
 
@@ -272,15 +459,13 @@ std::vector<uint32_t> GLSLtoSPV(abcg::ShaderSource shaderSource) {
   shader.setStrings(&data, 1);
 
   // Enable SPIR-V and Vulkan rules when parsing GLSL
-  auto messages{gsl::narrow<EShMessages>(EShMsgSpvRules |
-                                         EShMsgVulkanRules /* |
-                         EShMsgEnhanced*/)};
+  auto const messages{glslangMessages};
 
   // Compiles
   TBuiltInResource const resources{InitResources()};
-  if (!shader.parse(&resources, 100, false, messages)) {
+  if (!shader.parse(&resources, defaultGLSLVersion, false, messages)) {
     auto const *shaderStage{glslangStageToText(stage)};
-    printLog(shader, shaderStage);
+    appendLog(shader, shaderStage);
     throw abcg::RuntimeError(
         fmt::format("Failed to compile {} shader", shaderStage));
   }
@@ -290,7 +475,7 @@ std::vector<uint32_t> GLSLtoSPV(abcg::ShaderSource shaderSource) {
   program.addShader(&shader);
   if (!program.link(messages)) {
     auto const *shaderStage{glslangStageToText(stage)};
-    printLog(shader, shaderStage);
+    appendLog(shader, shaderStage);
     throw abcg::RuntimeError(
         fmt::format("Failed to link {} shader", shaderStage));
   }
@@ -308,23 +493,53 @@ std::vector<uint32_t> GLSLtoSPV(abcg::ShaderSource shaderSource) {
  * @param pathOrSource Path or source code of the GLSL shader to be compiled to
  * SPIR-V.
  *
+ * If the SPIR-V cache is enabled (see abcg::VulkanShader::setCacheDirectory)
+ * and the SPIR-V code of the shader is found there, it is loaded from the
+ * cache and glslang is not invoked. Otherwise, the shader is compiled and the
+ * resulting code is written to the cache.
+ *
  * @throw abcg::RuntimeError if the shader could not be read from file or has
  * failed to compile.
  */
 void abcg::VulkanShader::create(VulkanDevice const &device,
                                 ShaderSource const &pathOrSource) {
-  m_device = static_cast<vk::Device>(device);
-
-  ShaderSource const source{.source = toSource(pathOrSource.source),
+  ShaderSource const source{.source = *loadShaderSource(pathOrSource.source),
                             .stage = pathOrSource.stage};
 
-  glslang::InitializeProcess();
-  std::vector<uint32_t> shader{GLSLtoSPV(source)};
-  m_stage = abcgStageToVulkanStage(source.stage);
-  glslang::FinalizeProcess();
+  std::filesystem::path cachePath;
+  uint64_t key{};
+  auto code{findCachedSPIRV(source, cachePath, key)};
+  if (!code) {
+    glslang::InitializeProcess();
+    auto const finalize{gsl::finally([] { glslang::FinalizeProcess(); })};
+    std::string log;
+    try {
+      code = GLSLtoSPV(source, log);
+    } catch (...) {
+      fmt::print("{}", log);
+      throw;
+    }
+    if (!cachePath.empty()) {
+      storeCachedSPIRV(cachePath, key, source.source, *code);
+    }
+  }
 
+  create(device, source.stage, *code);
+}
+
+/**
+ * @brief Creates the shader module from SPIR-V code.
+ *
+ * @param device Vulkan device to be used to create the shader module.
+ * @param stage Shader stage.
+ * @param code SPIR-V code of the shader.
+ */
+void abcg::VulkanShader::create(VulkanDevice const &device, ShaderStage stage,
+                                std::span<uint32_t const> code) {
+  m_device = static_cast<vk::Device>(device);
+  m_stage = abcgStageToVulkanStage(stage);
   m_module = m_device.createShaderModule(
-      {.codeSize = shader.size() * sizeof(uint32_t), .pCode = shader.data()});
+      {.codeSize = code.size_bytes(), .pCode = code.data()});
 }
 
 /**
@@ -354,4 +569,175 @@ vk::ShaderStageFlagBits const &abcg::VulkanShader::getStage() const noexcept {
  */
 vk::ShaderModule const &abcg::VulkanShader::getModule() const noexcept {
   return m_module;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Sets the directory of the on-disk SPIR-V cache.
+ *
+ * The cache is disabled by default. Each file stores the shader source along
+ * with its SPIR-V code, and is only loaded if the source matches. As the
+ * loaded code is not otherwise validated, the directory should not be
+ * writable by other users, e.g., a subdirectory of
+ * abcg::getUserCacheDirectory.
+ *
+ * @param path Path of the cache directory. The directory is created on
+ * demand. An empty path disables the cache.
+ */
+void abcg::VulkanShader::setCacheDirectory(std::filesystem::path const &path) {
+  auto &cache{getSPIRVCache()};
+  std::scoped_lock const lock{cache.mutex};
+  cache.directory = path;
+}
+
+/**
+ * @brief Returns the directory of the on-disk SPIR-V cache.
+ *
+ * @return Path of the cache directory, or an empty path if the cache is
+ * disabled.
+ */
+std::filesystem::path abcg::VulkanShader::getCacheDirectory() {
+  return getSPIRVCacheDirectory();
+}
+
+/**
+ * @brief Returns the number of cache hits and misses since the start of the
+ * application.
+ *
+ * @return Cache counters.
+ */
+abcg::VulkanShaderCacheStats abcg::VulkanShader::getCacheStats() noexcept {
+  auto const &cache{getSPIRVCache()};
+  return {.hits = cache.hits, .misses = cache.misses};
+}
+
+/**
+ * @brief Compiles a group of GLSL shaders to SPIR-V.
+ *
+ * glslang is initialized only once and the shaders that are not found in the
+ * SPIR-V cache are compiled concurrently on a pool of threads.
+ *
+ * @param pathsOrSources Paths or source codes of the GLSL shaders to be
+ * compiled to SPIR-V.
+ *
+ * @throw abcg::RuntimeError if any shader could not be read from file or has
+ * failed to compile.
+ *
+ * @return SPIR-V code of the shaders in the same order as `pathsOrSources`.
+ *
+ * @sa abcg::compileVulkanShaders.
+ */
+std::vector<std::vector<uint32_t>> abcg::compileVulkanShadersToSPIRV(
+    std::span<ShaderSource const> pathsOrSources) {
+  auto const numShaders{pathsOrSources.size()};
+
+  std::vector<ShaderSource> sources;
+  sources.reserve(numShaders);
+  for (auto const &pathOrSource : pathsOrSources) {
+    sources.push_back({.source = *loadShaderSource(pathOrSource.source),
+                       .stage = pathOrSource.stage});
+  }
+
+  std::vector<std::vector<uint32_t>> codes(numShaders);
+  std::vector<std::filesystem::path> cachePaths(numShaders);
+  std::vector<uint64_t> cacheKeys(numShaders);
+  std::vector<std::size_t> pendingIndices;
+  for (auto const index : iter::range(numShaders)) {
+    if (auto code{findCachedSPIRV(sources[index], cachePaths[index],
+                                  cacheKeys[index])}) {
+      codes[index] = std::move(*code);
+    } else {
+      pendingIndices.push_back(index);
+    }
+  }
+
+  if (!pendingIndices.empty()) {
+    std::vector<std::exception_ptr> errors(numShaders);
+    std::vector<std::string> logs(numShaders);
+    std::atomic<std::size_t> nextJob{};
+
+    // Each worker fetches the next pending shader until there is none left
+    auto const worker{[&] {
+      for (auto job{nextJob++}; job < pendingIndices.size(); job = nextJob++) {
+        auto const index{pendingIndices[job]};
+        try {
+          codes[index] = GLSLtoSPV(sources[index], logs[index]);
+          if (!cachePaths[index].empty()) {
+            storeCachedSPIRV(cachePaths[index], cacheKeys[index],
+                             sources[index].source, codes[index]);
+          }
+        } catch (...) {
+          errors[index] = std::current_exception();
+        }
+      }
+    }};
+
+    auto const numThreads{std::min<std::size_t>(
+        pendingIndices.size(),
+        std::max(1U, std::thread::hardware_concurrency()))};
+
+    glslang::InitializeProcess();
+    {
+      // glslang is finalized only after all workers have been joined, even
+      // if a thread could not be created
+      auto const finalize{gsl::finally([] { glslang::FinalizeProcess(); })};
+
+      // The calling thread is also used as a worker. The threads are joined
+      // when the vector goes out of scope
+      std::vector<std::jthread> threads;
+      threads.reserve(numThreads - 1);
+      for ([[maybe_unused]] auto const _ : iter::range(numThreads - 1)) {
+        threads.emplace_back(worker);
+      }
+      worker();
+    }
+
+    // Print the logs in the order of the shaders
+    for (auto const &log : logs) {
+      fmt::print("{}", log);
+    }
+
+    for (auto const &error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+  return codes;
+}
+
+/**
+ * @brief Compiles a group of GLSL shaders to SPIR-V and creates their modules.
+ *
+ * This is equivalent to calling abcg::VulkanShader::create for each shader, but
+ * the shaders are compiled with abcg::compileVulkanShadersToSPIRV.
+ *
+ * @param device Vulkan device to be used to create the shader modules.
+ * @param pathsOrSources Paths or source codes of the GLSL shaders to be
+ * compiled to SPIR-V.
+ *
+ * @throw abcg::RuntimeError if any shader could not be read from file or has
+ * failed to compile. In this case, no shader module is created.
+ *
+ * @return Shaders in the same order as `pathsOrSources`.
+ */
+std::vector<abcg::VulkanShader>
+abcg::compileVulkanShaders(VulkanDevice const &device,
+                           std::span<ShaderSource const> pathsOrSources) {
+  auto const codes{compileVulkanShadersToSPIRV(pathsOrSources)};
+
+  std::vector<VulkanShader> shaders(codes.size());
+  try {
+    for (auto &&[shader, pathOrSource, code] :
+         iter::zip(shaders, pathsOrSources, codes)) {
+      shader.create(device, pathOrSource.stage, code);
+    }
+  } catch (...) {
+    for (auto &shader : shaders) {
+      shader.destroy();
+    }
+    throw;
+  }
+
+  return shaders;
+}
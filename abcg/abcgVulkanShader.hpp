@@ -11,31 +11,65 @@
 #ifndef ABCG_VULKAN_SHADER_HPP_
 #define ABCG_VULKAN_SHADER_HPP_
 
+#include <filesystem>
+#include <span>
+#include <vector>
+
 #include "abcgShader.hpp"
 #include "abcgVulkanDevice.hpp"
 
 namespace abcg {
 class VulkanShader;
+struct VulkanShaderCacheStats;
 } // namespace abcg
 
+/**
+ * @brief Counters of the on-disk SPIR-V cache used by abcg::VulkanShader.
+ */
+struct abcg::VulkanShaderCacheStats {
+  /** @brief Number of shaders whose SPIR-V code was loaded from the cache. */
+  std::size_t hits{};
+  /** @brief Number of shaders that had to be compiled with glslang. */
+  std::size_t misses{};
+};
+
 /**
  * @brief A class for representing a Vulkan shader.
  *
  * This class compiles a GLSL shader into a Vulkan SPIR-V shader and creates the
  * corresponding vk::ShaderModule.
+ *
+ * The resulting SPIR-V code can be stored in an opt-in on-disk cache (see
+ * abcg::VulkanShader::setCacheDirectory) keyed by a stable hash of the shader
+ * source, stage, glslang version and resource limits. On subsequent runs, the
+ * code is loaded directly from the cache and glslang is not invoked.
  */
 class abcg::VulkanShader {
 public:
   void create(VulkanDevice const &device, ShaderSource const &pathOrSource);
+  void create(VulkanDevice const &device, ShaderStage stage,
+              std::span<uint32_t const> code);
   void destroy();
 
   [[nodiscard]] vk::ShaderStageFlagBits const &getStage() const noexcept;
   [[nodiscard]] vk::ShaderModule const &getModule() const noexcept;
 
+  static void setCacheDirectory(std::filesystem::path const &path);
+  [[nodiscard]] static std::filesystem::path getCacheDirectory();
+  [[nodiscard]] static VulkanShaderCacheStats getCacheStats() noexcept;
+
 private:
   vk::ShaderStageFlagBits m_stage{};
   vk::ShaderModule m_module;
   vk::Device m_device;
 };
 
+namespace abcg {
+[[nodiscard]] std::vector<std::vector<uint32_t>>
+compileVulkanShadersToSPIRV(std::span<ShaderSource const> pathsOrSources);
+[[nodiscard]] std::vector<VulkanShader>
+compileVulkanShaders(VulkanDevice const &device,
+                     std::span<ShaderSource const> pathsOrSources);
+} // namespace abcg
+
 #endif
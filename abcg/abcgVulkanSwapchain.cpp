@@ -130,16 +130,23 @@ void abcg::VulkanSwapchain::render(
     std::function<void(VulkanFrame const &)> const &fun) {
   auto const &device{static_cast<vk::Device>(m_device)};
 
-  // Get current set of semaphores
-  auto [presentCompleteSemaphore,
-        renderCompleteSemaphore]{m_frameSemaphores.at(m_currentSemaphore)};
+  auto &frame{m_frames.at(m_currentFrame)};
+  auto const &presentCompleteSemaphore{
+      m_presentCompleteSemaphores.at(m_currentFrame)};
+
+  // Wait until the commands previously submitted by this frame in flight have
+  // finished executing
+  while (vk::Result::eTimeout ==
+         device.waitForFences(frame.fence, VK_TRUE,
+                              std::numeric_limits<uint64_t>::max()))
+    ;
 
   // Acquire an image from the swapchain
   vk::Result result{};
   try {
     result = device.acquireNextImageKHR(
         m_swapchainKHR, std::numeric_limits<uint64_t>::max(),
-        presentCompleteSemaphore, vk::Fence{}, &m_currentFrame);
+        presentCompleteSemaphore, vk::Fence{}, &m_currentImage);
   } catch (vk::OutOfDateKHRError const &) {
     result = vk::Result::eErrorOutOfDateKHR;
   }
@@ -149,16 +156,25 @@ void abcg::VulkanSwapchain::render(
     return;
   }
 
-  auto const &frame{m_frames.at(m_currentFrame)};
+  auto &image{m_images.at(m_currentImage)};
+
+  // The acquired image may still be in use by another frame in flight if
+  // images are acquired out of order or if there are more frames in flight
+  // than swapchain images
+  if (image.fence && image.fence != frame.fence) {
+    while (vk::Result::eTimeout ==
+           device.waitForFences(image.fence, VK_TRUE,
+                                std::numeric_limits<uint64_t>::max()))
+      ;
+  }
+  image.fence = frame.fence;
 
-  // Wait until command buffer for acquired image has finished executing
-  while (vk::Result::eTimeout ==
-         device.waitForFences(frame.fence, VK_TRUE,
-                              std::numeric_limits<uint64_t>::max()))
-    ;
   device.resetFences(frame.fence);
   device.resetCommandPool(frame.commandPool);
 
+  frame.imageIndex = m_currentImage;
+  frame.framebufferMain = image.framebufferMain;
+
   // Main pass
   fun(frame);
 
@@ -187,7 +203,10 @@ void abcg::VulkanSwapchain::render(
   std::array waitStages{vk::PipelineStageFlags{
       vk::PipelineStageFlagBits::eColorAttachmentOutput}};
   std::array commandBuffers{frame.commandBuffer, frame.commandBufferUI};
-  std::array signalSemaphores{renderCompleteSemaphore};
+  std::array signalSemaphores{image.renderComplete};
+
+  // Submit pending uploads first, as they may be used by this frame
+  m_device.getUploadQueue().submit();
 
   // Submit command buffer
   m_device.getQueues().graphics.submit(
@@ -206,8 +225,7 @@ void abcg::VulkanSwapchain::present() {
     return;
 
   // Set semaphores to wait
-  auto &frameSemaphore{m_frameSemaphores.at(m_currentSemaphore)};
-  std::array waitSemaphores{frameSemaphore.renderComplete};
+  std::array waitSemaphores{m_images.at(m_currentImage).renderComplete};
 
   // Set swapchains
   std::array swapchains{m_swapchainKHR};
@@ -219,7 +237,7 @@ void abcg::VulkanSwapchain::present() {
         .pWaitSemaphores = waitSemaphores.data(),
         .swapchainCount = gsl::narrow<uint32_t>(swapchains.size()),
         .pSwapchains = swapchains.data(),
-        .pImageIndices = &m_currentFrame // Index of in-flight frame
+        .pImageIndices = &m_currentImage // Index of acquired image
     });
   } catch (vk::OutOfDateKHRError const &) {
     result = vk::Result::eErrorOutOfDateKHR;
@@ -230,9 +248,9 @@ void abcg::VulkanSwapchain::present() {
     return;
   }
 
-  // Use the next set of semaphores
-  m_currentSemaphore =
-      (m_currentSemaphore + 1) % gsl::narrow<uint32_t>(m_frames.size());
+  // Use the next frame in flight
+  m_currentFrame =
+      (m_currentFrame + 1) % gsl::narrow<uint32_t>(m_frames.size());
 }
 
 bool abcg::VulkanSwapchain::checkRebuild(VulkanSettings const &settings,
@@ -354,7 +372,7 @@ bool abcg::VulkanSwapchain::checkRebuild(VulkanSettings const &settings,
 
   createRenderPasses(settings);
 
-  createFrames();
+  createFrames(settings);
 
   if (settings.depthBufferSize > 0 || settings.stencilBufferSize > 0) {
     createDepthResources(settings);
@@ -391,7 +409,9 @@ abcg::VulkanDevice const &abcg::VulkanSwapchain::getDevice() const noexcept {
 /**
  * @brief Returns the in-flight frames.
  *
- * @return Container of in-flight frames.
+ * @return Container of in-flight frames. Its size is given by
+ * abcg::VulkanSettings::framesInFlight and does not depend on the number of
+ * swapchain images.
  */
 std::vector<abcg::VulkanFrame> const &
 abcg::VulkanSwapchain::getFrames() const noexcept {
@@ -445,20 +465,25 @@ abcg::VulkanImage const &abcg::VulkanSwapchain::getDepthImage() const noexcept {
   return m_depthImage;
 }
 
-void abcg::VulkanSwapchain::createFrames() {
+void abcg::VulkanSwapchain::createFrames(VulkanSettings const &settings) {
   auto const swapchainImages{
       static_cast<vk::Device>(m_device).getSwapchainImagesKHR(m_swapchainKHR)};
 
-  // Create image views
+  // Frames in flight
   m_currentFrame = 0;
-  m_frames.resize(swapchainImages.size());
-  m_currentSemaphore = 0;
-  m_frameSemaphores.resize(swapchainImages.size());
-
-  for (auto &&[frame, image, index] :
-       iter::zip(m_frames, swapchainImages, iter::range(m_frames.size()))) {
+  m_frames.resize(
+      gsl::narrow<std::size_t>(std::max(settings.framesInFlight, 1)));
+  m_presentCompleteSemaphores.resize(m_frames.size());
+  for (auto &&[frame, index] :
+       iter::zip(m_frames, iter::range(m_frames.size()))) {
     frame.index = gsl::narrow<uint32_t>(index);
-    frame.colorImage.create(
+  }
+
+  // Create image views
+  m_currentImage = 0;
+  m_images.resize(swapchainImages.size());
+  for (auto &&[swapchainImage, image] : iter::zip(m_images, swapchainImages)) {
+    swapchainImage.colorImage.create(
         m_device,
         {.viewInfo = {
              .image = image,
@@ -476,17 +501,21 @@ void abcg::VulkanSwapchain::destroyFrames() {
   for (auto &frame : m_frames) {
     device.destroyCommandPool(frame.commandPool);
     device.destroyFence(frame.fence);
-    frame.colorImage.destroy();
-    device.destroyFramebuffer(frame.framebufferMain);
   }
 
-  for (auto &frameSemaphore : m_frameSemaphores) {
-    device.destroySemaphore(frameSemaphore.presentComplete);
-    device.destroySemaphore(frameSemaphore.renderComplete);
+  for (auto &semaphore : m_presentCompleteSemaphores) {
+    device.destroySemaphore(semaphore);
+  }
+
+  for (auto &image : m_images) {
+    image.colorImage.destroy();
+    device.destroyFramebuffer(image.framebufferMain);
+    device.destroySemaphore(image.renderComplete);
   }
 
   m_frames.clear();
-  m_frameSemaphores.clear();
+  m_presentCompleteSemaphores.clear();
+  m_images.clear();
 }
 
 // TODO:
@@ -793,8 +822,9 @@ void abcg::VulkanSwapchain::createFramebuffers(VulkanSettings const &settings) {
   }
   auto const graphicsQueueFamily{queuesFamilies.graphics.value()};
 
-  for (auto &frame : m_frames) {
-    // Each frame has its own transient graphics command pool
+  for (auto &&[frame, presentCompleteSemaphore] :
+       iter::zip(m_frames, m_presentCompleteSemaphores)) {
+    // Each frame in flight has its own transient graphics command pool
     frame.commandPool = device.createCommandPool(
         {.flags = vk::CommandPoolCreateFlagBits::eTransient,
          .queueFamilyIndex = graphicsQueueFamily});
@@ -819,6 +849,11 @@ void abcg::VulkanSwapchain::createFramebuffers(VulkanSettings const &settings) {
     frame.fence =
         device.createFence({.flags = vk::FenceCreateFlagBits::eSignaled});
 
+    // Create semaphore
+    presentCompleteSemaphore = device.createSemaphore({});
+  }
+
+  for (auto &image : m_images) {
     // Set attachments
     std::vector<vk::ImageView> attachments{};
     if (sampleCount > vk::SampleCountFlagBits::e1) {
@@ -829,29 +864,26 @@ void abcg::VulkanSwapchain::createFramebuffers(VulkanSettings const &settings) {
       if (settings.depthBufferSize > 0 || settings.stencilBufferSize > 0) {
         attachments.push_back(m_depthImage.getView());
       }
-      attachments.push_back(frame.colorImage.getView());
+      attachments.push_back(image.colorImage.getView());
     } else {
       // 0: Color buffer
       // 1: Depth buffer (optional)
-      attachments.push_back(frame.colorImage.getView());
+      attachments.push_back(image.colorImage.getView());
       if (settings.depthBufferSize > 0 || settings.stencilBufferSize > 0) {
         attachments.push_back(m_depthImage.getView());
       }
     }
 
     // Create framebuffers
-    frame.framebufferMain = device.createFramebuffer(
+    image.framebufferMain = device.createFramebuffer(
         {.renderPass = m_renderPassMain,
          .attachmentCount = gsl::narrow<uint32_t>(attachments.size()),
          .pAttachments = attachments.data(),
          .width = m_swapchainExtent.width,
          .height = m_swapchainExtent.height,
          .layers = 1});
-  }
 
-  // Create semaphores
-  for (auto &frameSemaphore : m_frameSemaphores) {
-    frameSemaphore.presentComplete = device.createSemaphore({});
-    frameSemaphore.renderComplete = device.createSemaphore({});
+    // Create semaphore
+    image.renderComplete = device.createSemaphore({});
   }
 }
@@ -30,14 +30,20 @@ class VulkanWindow;
 /**
  * @brief Data needed by a rendering frame.
  *
+ * The command pool, command buffers and fence belong to one of the frames in
+ * flight and are reused every abcg::VulkanSettings::framesInFlight frames,
+ * regardless of the number of swapchain images. The framebuffer is the one of
+ * the swapchain image acquired for the frame.
  */
 struct abcg::VulkanFrame {
+  /** @brief Index of the frame in flight. */
   uint32_t index{};
+  /** @brief Index of the acquired swapchain image. */
+  uint32_t imageIndex{};
   vk::CommandPool commandPool;
   vk::CommandBuffer commandBuffer;
   vk::CommandBuffer commandBufferUI;
   vk::Fence fence;
-  VulkanImage colorImage;
   vk::Framebuffer framebufferMain;
 };
 
@@ -68,7 +74,7 @@ public:
   [[nodiscard]] VulkanImage const &getDepthImage() const noexcept;
 
 private:
-  void createFrames();
+  void createFrames(VulkanSettings const &settings);
   void destroyFrames();
 
   [[nodiscard]] vk::Format getDepthFormat(VulkanSettings const &settings);
@@ -90,18 +96,25 @@ private:
   vk::Extent2D m_swapchainExtent;
   bool m_swapChainRebuild{};
 
-  // Data for swapchain synchronization
-  struct FrameSemaphores {
-    vk::Semaphore presentComplete;
+  // Data of each swapchain image
+  struct SwapchainImage {
+    VulkanImage colorImage;
+    vk::Framebuffer framebufferMain;
+    // Signaled when the frame rendered to this image can be presented
     vk::Semaphore renderComplete;
+    // Fence of the frame in flight that last rendered to this image
+    vk::Fence fence;
   };
 
+  // Frames in flight, indexed by m_currentFrame
   uint32_t m_currentFrame{};
   std::vector<VulkanFrame> m_frames;
-  // Current set of swapchain wait semaphores we're using (needs to be distinct
-  // from per frame data)
-  uint32_t m_currentSemaphore{};
-  std::vector<FrameSemaphores> m_frameSemaphores;
+  // Signaled when the image acquired by each frame in flight is available
+  std::vector<vk::Semaphore> m_presentCompleteSemaphores;
+
+  // Swapchain images, indexed by m_currentImage
+  uint32_t m_currentImage{};
+  std::vector<SwapchainImage> m_images;
 
   VulkanImage m_depthImage;
   VulkanImage m_MSAAImage;
@@ -0,0 +1,716 @@
+/**
+ * @file abcgVulkanUploadQueue.cpp
+ * @brief Definition of abcg::VulkanUploadQueue
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgVulkanUploadQueue.hpp"
+
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+
+namespace {
+[[nodiscard]] constexpr vk::DeviceSize alignUp(vk::DeviceSize value,
+                                               vk::DeviceSize alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+/**
+ * @brief Creates the command pools and the staging ring.
+ *
+ * @param device Logical device.
+ * @param physicalDevice Physical device of `device`.
+ * @param transferQueue Queue used for copies. If null, `graphicsQueue` is
+ * used.
+ * @param graphicsQueue Queue that consumes the uploaded resources.
+ * @param allocator Allocator of the staging memory.
+ * @param stagingSize Size of the staging ring, in bytes.
+ */
+void abcg::VulkanUploadQueue::create(vk::Device const &device,
+                                     VulkanPhysicalDevice const &physicalDevice,
+                                     vk::Queue const &transferQueue,
+                                     vk::Queue const &graphicsQueue,
+                                     VulkanAllocator &allocator,
+                                     vk::DeviceSize stagingSize) {
+  m_device = device;
+  m_allocator = &allocator;
+
+  auto const &queuesFamilies{physicalDevice.getQueuesFamilies()};
+  m_graphicsQueueFamily = queuesFamilies.graphics.value_or(0);
+  m_graphicsQueue = graphicsQueue;
+  if (transferQueue && queuesFamilies.transfer.has_value()) {
+    m_transferQueueFamily = queuesFamilies.transfer.value();
+    m_transferQueue = transferQueue;
+  } else {
+    m_transferQueueFamily = m_graphicsQueueFamily;
+    m_transferQueue = graphicsQueue;
+  }
+
+  m_transferCommandPool = m_device.createCommandPool(
+      {.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+       .queueFamilyIndex = m_transferQueueFamily});
+  if (hasSeparateTransferQueue()) {
+    m_graphicsCommandPool = m_device.createCommandPool(
+        {.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+         .queueFamilyIndex = m_graphicsQueueFamily});
+  }
+
+  // The staging ring is read by both queues if copies are also recorded on
+  // the graphics queue
+  m_stagingSize = stagingSize;
+  std::array const queueFamilies{m_transferQueueFamily,
+                                 m_graphicsQueueFamily};
+  m_stagingBuffer = m_device.createBuffer(
+      {.size = m_stagingSize,
+       .usage = vk::BufferUsageFlagBits::eTransferSrc,
+       .sharingMode = hasSeparateTransferQueue() ? vk::SharingMode::eConcurrent
+                                                 : vk::SharingMode::eExclusive,
+       .queueFamilyIndexCount =
+           hasSeparateTransferQueue()
+               ? gsl::narrow<uint32_t>(queueFamilies.size())
+               : 0U,
+       .pQueueFamilyIndices = queueFamilies.data()});
+  m_stagingAllocation = m_allocator->allocate(
+      m_stagingBuffer, vk::MemoryPropertyFlagBits::eHostVisible |
+                           vk::MemoryPropertyFlagBits::eHostCoherent);
+  m_stagingHead = 0;
+  m_stagingUsed = 0;
+}
+
+/**
+ * @brief Waits for all batches to complete and releases the resources.
+ */
+void abcg::VulkanUploadQueue::destroy() {
+  if (!m_device) {
+    return;
+  }
+
+  waitIdle();
+
+  for (auto const &batch : m_freeBatches) {
+    m_device.destroyFence(batch.fence);
+    if (batch.semaphore) {
+      m_device.destroySemaphore(batch.semaphore);
+    }
+    if (batch.releaseSemaphore) {
+      m_device.destroySemaphore(batch.releaseSemaphore);
+    }
+  }
+  m_freeBatches.clear();
+
+  // Command buffers are freed with their pools
+  m_device.destroyCommandPool(m_transferCommandPool);
+  if (m_graphicsCommandPool) {
+    m_device.destroyCommandPool(m_graphicsCommandPool);
+  }
+  m_transferCommandPool = vk::CommandPool{};
+  m_graphicsCommandPool = vk::CommandPool{};
+
+  m_device.destroyBuffer(m_stagingBuffer);
+  m_allocator->free(m_stagingAllocation);
+  m_stagingBuffer = vk::Buffer{};
+  m_stagingAllocation = {};
+
+  m_device = vk::Device{};
+}
+
+/**
+ * @brief Uploads data to a buffer.
+ *
+ * The data is copied to staging memory before returning.
+ *
+ * @param buffer Destination buffer. It must have been created with
+ * vk::BufferUsageFlagBits::eTransferDst.
+ * @param data Data to be uploaded.
+ * @param offset Offset of the destination range within the buffer.
+ * @param queueFlag Queue that records the copy:
+ * vk::QueueFlagBits::eTransfer (default) for buffers owned by the transfer
+ * queue family, such as newly created buffers, or vk::QueueFlagBits::eGraphics
+ * for buffers already owned by the graphics queue family. Copies recorded on
+ * the graphics queue wait for the commands previously submitted to it, so
+ * buffers still read by frames in flight can be safely overwritten. Copies
+ * recorded on a separate transfer queue are not synchronized with rendering,
+ * so buffers in use by the graphics queue must be acquired beforehand with
+ * abcg::VulkanUploadQueue::acquireOwnership.
+ *
+ * @return Ticket of the batch that contains the copy.
+ */
+uint64_t abcg::VulkanUploadQueue::upload(vk::Buffer const &buffer,
+                                         std::span<std::byte const> data,
+                                         vk::DeviceSize offset,
+                                         vk::QueueFlagBits queueFlag) {
+  if (data.empty()) {
+    return m_nextTicket - 1;
+  }
+
+  auto const [stagingBuffer, stagingOffset]{stage(data, 4)};
+  auto const &batch{getCurrentBatch()};
+  getCommandBuffer(batch, queueFlag)
+      .copyBuffer(stagingBuffer, buffer,
+                  {{.srcOffset = stagingOffset,
+                    .dstOffset = offset,
+                    .size = data.size()}});
+  return batch.ticket;
+}
+
+/**
+ * @brief Uploads data to regions of an image.
+ *
+ * The data is copied to staging memory before returning. The image must be in
+ * the vk::ImageLayout::eTransferDstOptimal layout when the copy is executed,
+ * which can be done by recording a layout transition with
+ * abcg::VulkanUploadQueue::record beforehand.
+ *
+ * @param image Destination image.
+ * @param data Data to be uploaded.
+ * @param regions Regions of the image. Their buffer offsets are relative to
+ * the beginning of `data`.
+ * @param alignment Alignment of the data in the staging memory. It must be a
+ * multiple of 4 and of the texel block size of the image format.
+ * @param queueFlag Queue that records the copy. See the overload for buffers.
+ *
+ * @return Ticket of the batch that contains the copy.
+ */
+uint64_t
+abcg::VulkanUploadQueue::upload(vk::Image const &image,
+                                std::span<std::byte const> data,
+                                std::span<vk::BufferImageCopy const> regions,
+                                vk::DeviceSize alignment,
+                                vk::QueueFlagBits queueFlag) {
+  if (data.empty() || regions.empty()) {
+    return m_nextTicket - 1;
+  }
+
+  auto const [stagingBuffer, stagingOffset]{stage(data, alignment)};
+  std::vector<vk::BufferImageCopy> copies(regions.begin(), regions.end());
+  for (auto &copy : copies) {
+    copy.bufferOffset += stagingOffset;
+  }
+
+  auto const &batch{getCurrentBatch()};
+  getCommandBuffer(batch, queueFlag)
+      .copyBufferToImage(stagingBuffer, image,
+                         vk::ImageLayout::eTransferDstOptimal, copies);
+  return batch.ticket;
+}
+
+/**
+ * @brief Hands a buffer over from the graphics queue family to the transfer
+ * queue family, so that it can be updated on the transfer queue while in use
+ * by the graphics queue.
+ *
+ * The transfer commands of the batch wait for the commands previously
+ * submitted to the graphics queue, which may still read the buffer. For
+ * buffers created with vk::SharingMode::eExclusive, a release barrier is
+ * recorded on the graphics queue and the matching acquire barrier on the
+ * transfer queue, and the buffer is handed back to the graphics queue family
+ * when the batch is submitted. It must not be used by commands recorded with
+ * vk::QueueFlagBits::eGraphics in the same batch.
+ *
+ * This does nothing if both queues belong to the same family, as the copies
+ * are then recorded on the graphics queue.
+ *
+ * @param buffer Buffer to be updated.
+ * @param sharingMode Sharing mode of the buffer.
+ *
+ * @return Ticket of the batch that contains the barriers.
+ */
+uint64_t abcg::VulkanUploadQueue::acquireOwnership(vk::Buffer const &buffer,
+                                                   vk::SharingMode sharingMode) {
+  if (!hasSeparateTransferQueue()) {
+    return m_nextTicket - 1;
+  }
+
+  auto &batch{getCurrentBatch()};
+  if (std::ranges::find(batch.ownedBuffers, buffer) !=
+      batch.ownedBuffers.end()) {
+    return batch.ticket;
+  }
+
+  if (!batch.hasRelease) {
+    if (!batch.releaseCommandBuffer) {
+      batch.releaseCommandBuffer =
+          m_device
+              .allocateCommandBuffers(
+                  {.commandPool = m_graphicsCommandPool,
+                   .level = vk::CommandBufferLevel::ePrimary,
+                   .commandBufferCount = 1})
+              .front();
+      batch.releaseSemaphore = m_device.createSemaphore({});
+    }
+    batch.releaseCommandBuffer.begin(
+        {.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+    batch.hasRelease = true;
+  }
+
+  if (sharingMode == vk::SharingMode::eConcurrent) {
+    // The semaphore signaled by the release commands is enough
+    return batch.ticket;
+  }
+
+  vk::BufferMemoryBarrier barrier{
+      .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+      .srcQueueFamilyIndex = m_graphicsQueueFamily,
+      .dstQueueFamilyIndex = m_transferQueueFamily,
+      .buffer = buffer,
+      .size = VK_WHOLE_SIZE};
+  batch.releaseCommandBuffer.pipelineBarrier(
+      vk::PipelineStageFlagBits::eAllCommands,
+      vk::PipelineStageFlagBits::eBottomOfPipe, vk::DependencyFlags{}, nullptr,
+      barrier, nullptr);
+
+  barrier.srcAccessMask = vk::AccessFlags{};
+  barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+  batch.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                                      vk::PipelineStageFlagBits::eTransfer,
+                                      vk::DependencyFlags{}, nullptr, barrier,
+                                      nullptr);
+  batch.ownedBuffers.push_back(buffer);
+  return batch.ticket;
+}
+
+/**
+ * @brief Hands a buffer over from the transfer queue family to the graphics
+ * queue family.
+ *
+ * This is needed after uploading to a buffer created with
+ * vk::SharingMode::eExclusive, and does nothing if both queues belong to the
+ * same family. The release barrier on the transfer queue and the matching
+ * acquire barrier on the graphics queue are recorded when the batch is
+ * submitted, so that several uploads to the same buffer share them. The buffer
+ * must not be used by commands recorded with vk::QueueFlagBits::eGraphics in
+ * the same batch.
+ *
+ * @param buffer Buffer whose copies were recorded on the transfer queue.
+ *
+ * @return Ticket of the batch that contains the barriers.
+ */
+uint64_t abcg::VulkanUploadQueue::transferOwnership(vk::Buffer const &buffer) {
+  if (!hasSeparateTransferQueue()) {
+    return m_nextTicket - 1;
+  }
+
+  auto &batch{getCurrentBatch()};
+  if (std::ranges::find(batch.ownedBuffers, buffer) ==
+      batch.ownedBuffers.end()) {
+    batch.ownedBuffers.push_back(buffer);
+  }
+  return batch.ticket;
+}
+
+/**
+ * @brief Hands an image over from the transfer queue family to the graphics
+ * queue family, optionally changing its layout.
+ *
+ * Records a release barrier on the transfer queue and the matching acquire
+ * barrier on the graphics queue. If both queues belong to the same family,
+ * only the layout transition is recorded.
+ *
+ * @param image Image whose copies were recorded on the transfer queue.
+ * @param subresourceRange Subresources to be handed over.
+ * @param oldLayout Layout of the subresources after the copies.
+ * @param newLayout Layout of the subresources on the graphics queue.
+ *
+ * @return Ticket of the batch that contains the barriers.
+ */
+uint64_t abcg::VulkanUploadQueue::transferOwnership(
+    vk::Image const &image, vk::ImageSubresourceRange const &subresourceRange,
+    vk::ImageLayout oldLayout, vk::ImageLayout newLayout) {
+  auto const &batch{getCurrentBatch()};
+  vk::ImageMemoryBarrier barrier{
+      .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+      .dstAccessMask =
+          vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite,
+      .oldLayout = oldLayout,
+      .newLayout = newLayout,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .image = image,
+      .subresourceRange = subresourceRange};
+
+  if (!hasSeparateTransferQueue()) {
+    if (oldLayout != newLayout) {
+      batch.commandBuffer.pipelineBarrier(
+          vk::PipelineStageFlagBits::eTransfer,
+          vk::PipelineStageFlagBits::eAllCommands, vk::DependencyFlags{},
+          nullptr, nullptr, barrier);
+    }
+    return batch.ticket;
+  }
+
+  // The layout transition is performed once, by the release and acquire pair
+  barrier.srcQueueFamilyIndex = m_transferQueueFamily;
+  barrier.dstQueueFamilyIndex = m_graphicsQueueFamily;
+  barrier.dstAccessMask = vk::AccessFlags{};
+  batch.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                      vk::PipelineStageFlagBits::eBottomOfPipe,
+                                      vk::DependencyFlags{}, nullptr, nullptr,
+                                      barrier);
+
+  barrier.srcAccessMask = vk::AccessFlags{};
+  barrier.dstAccessMask =
+      vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite;
+  batch.graphicsCommandBuffer.pipelineBarrier(
+      vk::PipelineStageFlagBits::eAllCommands,
+      vk::PipelineStageFlagBits::eAllCommands, vk::DependencyFlags{}, nullptr,
+      nullptr, barrier);
+  return batch.ticket;
+}
+
+/**
+ * @brief Records commands into the current batch.
+ *
+ * @param fun Function to be called with the command buffer of the batch.
+ * @param queueFlag Capability required by the commands:
+ * vk::QueueFlagBits::eTransfer (default) for commands that are executed
+ * together with the copies, or vk::QueueFlagBits::eGraphics for commands
+ * that are executed on the graphics queue after the copies.
+ *
+ * @return Ticket of the batch that contains the commands.
+ */
+uint64_t abcg::VulkanUploadQueue::record(
+    std::function<void(vk::CommandBuffer const &)> const &fun,
+    vk::QueueFlagBits queueFlag) {
+  auto const &batch{getCurrentBatch()};
+  fun(getCommandBuffer(batch, queueFlag));
+  return batch.ticket;
+}
+
+/**
+ * @brief Submits the current batch, if any, and releases the resources of
+ * completed batches.
+ *
+ * This does not wait for the batch to complete.
+ *
+ * @return Ticket of the last submitted batch.
+ */
+uint64_t abcg::VulkanUploadQueue::submit() {
+  if (m_currentBatch.has_value()) {
+    submitCurrentBatch();
+  }
+  retire(false);
+  return m_nextTicket - 1;
+}
+
+/**
+ * @brief Checks whether a batch has completed, without blocking.
+ *
+ * @param ticket Ticket returned by abcg::VulkanUploadQueue::upload or
+ * abcg::VulkanUploadQueue::record.
+ *
+ * @return `true` if the commands of the batch have finished executing.
+ */
+bool abcg::VulkanUploadQueue::isComplete(uint64_t ticket) {
+  retire(false);
+  return ticket <= m_completedTicket;
+}
+
+/**
+ * @brief Waits for a batch to complete.
+ *
+ * The batch is submitted first if it is still being recorded.
+ *
+ * @param ticket Ticket returned by abcg::VulkanUploadQueue::upload or
+ * abcg::VulkanUploadQueue::record.
+ */
+void abcg::VulkanUploadQueue::wait(uint64_t ticket) {
+  if (m_currentBatch.has_value() && ticket >= m_currentBatch->ticket) {
+    submitCurrentBatch();
+  }
+  while (ticket > m_completedTicket && !m_submittedBatches.empty()) {
+    retire(true);
+  }
+}
+
+/**
+ * @brief Submits the current batch, if any, and waits for all batches to
+ * complete.
+ */
+void abcg::VulkanUploadQueue::waitIdle() { wait(m_nextTicket - 1); }
+
+/**
+ * @brief Returns the size of the staging ring.
+ *
+ * Uploads larger than this size are staged in transient buffers.
+ *
+ * @return Size in bytes.
+ */
+vk::DeviceSize abcg::VulkanUploadQueue::getStagingSize() const noexcept {
+  return m_stagingSize;
+}
+
+/**
+ * @brief Returns whether the transfer queue belongs to a queue family other
+ * than the graphics queue family.
+ *
+ * @return `true` if copies are executed concurrently with rendering and
+ * exclusive resources need ownership transfers.
+ */
+bool abcg::VulkanUploadQueue::hasSeparateTransferQueue() const noexcept {
+  return m_transferQueueFamily != m_graphicsQueueFamily;
+}
+
+// Returns the batch being recorded, starting a new one if needed. Command
+// buffers, fences and semaphores of completed batches are reused. The commands
+// of the batch that run on the graphics queue start with a memory barrier, as
+// they may overwrite resources still read by the frames in flight submitted
+// before them (write-after-read), or written by them (write-after-write).
+abcg::VulkanUploadQueue::Batch &abcg::VulkanUploadQueue::getCurrentBatch() {
+  if (m_currentBatch.has_value()) {
+    return *m_currentBatch;
+  }
+
+  Batch batch;
+  if (!m_freeBatches.empty()) {
+    batch = std::move(m_freeBatches.back());
+    m_freeBatches.pop_back();
+  } else {
+    batch.commandBuffer =
+        m_device
+            .allocateCommandBuffers({.commandPool = m_transferCommandPool,
+                                     .level = vk::CommandBufferLevel::ePrimary,
+                                     .commandBufferCount = 1})
+            .front();
+    if (hasSeparateTransferQueue()) {
+      batch.graphicsCommandBuffer =
+          m_device
+              .allocateCommandBuffers(
+                  {.commandPool = m_graphicsCommandPool,
+                   .level = vk::CommandBufferLevel::ePrimary,
+                   .commandBufferCount = 1})
+              .front();
+      batch.semaphore = m_device.createSemaphore({});
+    }
+    batch.fence = m_device.createFence({});
+  }
+
+  batch.ticket = m_nextTicket++;
+  batch.commandBuffer.begin(
+      {.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+  if (batch.graphicsCommandBuffer) {
+    batch.graphicsCommandBuffer.begin(
+        {.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+  }
+
+  vk::MemoryBarrier const memoryBarrier{
+      .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+      .dstAccessMask =
+          vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite};
+  getCommandBuffer(batch, vk::QueueFlagBits::eGraphics)
+      .pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands,
+                       vk::PipelineStageFlagBits::eAllCommands,
+                       vk::DependencyFlags{}, memoryBarrier, nullptr, nullptr);
+
+  return m_currentBatch.emplace(std::move(batch));
+}
+
+// Returns the command buffer of the batch that records commands for the given
+// queue
+vk::CommandBuffer const &
+abcg::VulkanUploadQueue::getCommandBuffer(Batch const &batch,
+                                          vk::QueueFlagBits queueFlag) const {
+  return queueFlag == vk::QueueFlagBits::eGraphics && hasSeparateTransferQueue()
+             ? batch.graphicsCommandBuffer
+             : batch.commandBuffer;
+}
+
+// Copies data to staging memory and returns the staging buffer and the offset
+// of the data within it. If the ring is full, the current batch is submitted
+// and the oldest batches are waited for until there is enough space.
+std::pair<vk::Buffer, vk::DeviceSize>
+abcg::VulkanUploadQueue::stage(std::span<std::byte const> data,
+                               vk::DeviceSize alignment) {
+  if (data.size() > m_stagingSize) {
+    auto const buffer{m_device.createBuffer(
+        {.size = data.size(),
+         .usage = vk::BufferUsageFlagBits::eTransferSrc,
+         .sharingMode = vk::SharingMode::eExclusive})};
+    auto const allocation{
+        m_allocator->allocate(buffer,
+                              vk::MemoryPropertyFlagBits::eHostVisible |
+                                  vk::MemoryPropertyFlagBits::eHostCoherent,
+                              VulkanAllocationLifetime::Transient)};
+    std::memcpy(allocation.mappedData, data.data(), data.size());
+    m_allocator->flush(allocation);
+    getCurrentBatch().transientBuffers.emplace_back(buffer, allocation);
+    return {buffer, 0};
+  }
+
+  auto reservation{reserve(data.size(), alignment)};
+  if (!reservation.has_value()) {
+    if (m_currentBatch.has_value()) {
+      submitCurrentBatch();
+    }
+    while (!(reservation = reserve(data.size(), alignment)).has_value()) {
+      retire(true);
+    }
+  }
+
+  auto const [offset, used]{reservation.value()};
+  std::memcpy(static_cast<std::byte *>(m_stagingAllocation.mappedData) +
+                  offset, // NOLINT
+              data.data(), data.size());
+  m_allocator->flush(m_stagingAllocation, offset, data.size());
+  getCurrentBatch().stagingUsed += used;
+  return {m_stagingBuffer, offset};
+}
+
+// Reserves a range of the staging ring. Returns the offset of the range and
+// the number of bytes consumed from the ring, including padding, or
+// std::nullopt if the ring has not enough free space
+std::optional<std::pair<vk::DeviceSize, vk::DeviceSize>>
+abcg::VulkanUploadQueue::reserve(vk::DeviceSize size,
+                                 vk::DeviceSize alignment) {
+  if (m_stagingUsed == 0) {
+    m_stagingHead = 0;
+  }
+
+  auto offset{alignUp(m_stagingHead, alignment)};
+  if (offset + size > m_stagingSize) {
+    // Wrap around, skipping the end of the ring
+    offset = 0;
+  }
+  auto const used{(offset == 0 && m_stagingHead > 0
+                       ? m_stagingSize - m_stagingHead
+                       : offset - m_stagingHead) +
+                  size};
+  if (m_stagingUsed + used > m_stagingSize) {
+    return std::nullopt;
+  }
+
+  m_stagingHead = offset + size;
+  m_stagingUsed += used;
+  return std::pair{offset, used};
+}
+
+// Ends the command buffers of the current batch and submits them. Buffers
+// owned by the transfer queue family are handed back to the graphics queue
+// family, and the batch ends with a memory barrier that makes its writes
+// visible to the commands submitted after it.
+void abcg::VulkanUploadQueue::submitCurrentBatch() {
+  auto batch{std::move(m_currentBatch.value())};
+  m_currentBatch.reset();
+
+  vk::MemoryBarrier const memoryBarrier{
+      .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+      .dstAccessMask =
+          vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite};
+
+  if (hasSeparateTransferQueue()) {
+    if (batch.hasRelease) {
+      batch.releaseCommandBuffer.end();
+      m_graphicsQueue.submit({{.commandBufferCount = 1,
+                               .pCommandBuffers = &batch.releaseCommandBuffer,
+                               .signalSemaphoreCount = 1,
+                               .pSignalSemaphores = &batch.releaseSemaphore}},
+                             vk::Fence{});
+    }
+
+    if (!batch.ownedBuffers.empty()) {
+      std::vector<vk::BufferMemoryBarrier> barriers;
+      barriers.reserve(batch.ownedBuffers.size());
+      for (auto const &buffer : batch.ownedBuffers) {
+        barriers.push_back(
+            {.srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+             .srcQueueFamilyIndex = m_transferQueueFamily,
+             .dstQueueFamilyIndex = m_graphicsQueueFamily,
+             .buffer = buffer,
+             .size = VK_WHOLE_SIZE});
+      }
+      batch.commandBuffer.pipelineBarrier(
+          vk::PipelineStageFlagBits::eTransfer,
+          vk::PipelineStageFlagBits::eBottomOfPipe, vk::DependencyFlags{},
+          nullptr, barriers, nullptr);
+
+      for (auto &barrier : barriers) {
+        barrier.srcAccessMask = vk::AccessFlags{};
+        barrier.dstAccessMask =
+            vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite;
+      }
+      batch.graphicsCommandBuffer.pipelineBarrier(
+          vk::PipelineStageFlagBits::eAllCommands,
+          vk::PipelineStageFlagBits::eAllCommands, vk::DependencyFlags{},
+          nullptr, barriers, nullptr);
+    }
+
+    batch.commandBuffer.end();
+    vk::PipelineStageFlags const releaseWaitStage{
+        vk::PipelineStageFlagBits::eTransfer};
+    m_transferQueue.submit(
+        {{.waitSemaphoreCount = batch.hasRelease ? 1U : 0U,
+          .pWaitSemaphores = &batch.releaseSemaphore,
+          .pWaitDstStageMask = &releaseWaitStage,
+          .commandBufferCount = 1,
+          .pCommandBuffers = &batch.commandBuffer,
+          .signalSemaphoreCount = 1,
+          .pSignalSemaphores = &batch.semaphore}},
+        vk::Fence{});
+    batch.hasRelease = false;
+    batch.ownedBuffers.clear();
+
+    batch.graphicsCommandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eAllCommands,
+        vk::PipelineStageFlagBits::eAllCommands, vk::DependencyFlags{},
+        memoryBarrier, nullptr, nullptr);
+    batch.graphicsCommandBuffer.end();
+    vk::PipelineStageFlags const waitStage{
+        vk::PipelineStageFlagBits::eAllCommands};
+    m_graphicsQueue.submit({{.waitSemaphoreCount = 1,
+                             .pWaitSemaphores = &batch.semaphore,
+                             .pWaitDstStageMask = &waitStage,
+                             .commandBufferCount = 1,
+                             .pCommandBuffers = &batch.graphicsCommandBuffer}},
+                           batch.fence);
+  } else {
+    // The transfer queue is the graphics queue, so submission order is enough
+    batch.commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eAllCommands,
+        vk::PipelineStageFlagBits::eAllCommands, vk::DependencyFlags{},
+        memoryBarrier, nullptr, nullptr);
+    batch.commandBuffer.end();
+    m_transferQueue.submit({{.commandBufferCount = 1,
+                             .pCommandBuffers = &batch.commandBuffer}},
+                           batch.fence);
+  }
+
+  m_submittedBatches.push_back(std::move(batch));
+}
+
+// Releases the staging memory of completed batches, in submission order. If
+// waitOldest is true, waits for the oldest submitted batch first.
+void abcg::VulkanUploadQueue::retire(bool waitOldest) {
+  while (!m_submittedBatches.empty()) {
+    auto &batch{m_submittedBatches.front()};
+    if (waitOldest) {
+      while (vk::Result::eTimeout ==
+             m_device.waitForFences(batch.fence, VK_TRUE,
+                                    std::numeric_limits<uint64_t>::max()))
+        ;
+      waitOldest = false;
+    } else if (m_device.getFenceStatus(batch.fence) != vk::Result::eSuccess) {
+      break;
+    }
+
+    m_device.resetFences(batch.fence);
+    m_stagingUsed -= batch.stagingUsed;
+    batch.stagingUsed = 0;
+    for (auto const &[buffer, allocation] : batch.transientBuffers) {
+      m_device.destroyBuffer(buffer);
+      m_allocator->free(allocation);
+    }
+    batch.transientBuffers.clear();
+    m_completedTicket = batch.ticket;
+
+    m_freeBatches.push_back(std::move(batch));
+    m_submittedBatches.pop_front();
+  }
+}
@@ -0,0 +1,163 @@
+/**
+ * @file abcgVulkanUploadQueue.hpp
+ * @brief Header file of abcg::VulkanUploadQueue
+ *
+ * Declaration of abcg::VulkanUploadQueue
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_VULKAN_UPLOAD_QUEUE_HPP_
+#define ABCG_VULKAN_UPLOAD_QUEUE_HPP_
+
+#include "abcgVulkanAllocator.hpp"
+
+#include <deque>
+#include <functional>
+#include <span>
+
+namespace abcg {
+class VulkanUploadQueue;
+} // namespace abcg
+
+/**
+ * @brief A class for batching uploads of buffer and image data to the GPU.
+ *
+ * Data passed to abcg::VulkanUploadQueue::upload is copied into a persistently
+ * mapped staging ring, and the copy to the destination resource is recorded
+ * into the command buffer of the current batch. Many uploads are thus
+ * submitted at once, and the caller never waits for the queue to be idle.
+ *
+ * Each batch is identified by a ticket. A batch is submitted by
+ * abcg::VulkanUploadQueue::submit, or when the staging ring is full, and its
+ * completion is tracked with a fence. Staging space is reclaimed when the
+ * batch completes. Data larger than the ring is staged in a transient buffer
+ * that is released with the batch.
+ *
+ * Copies are recorded on the transfer queue. Commands that require a graphics
+ * queue, such as blits and layout transitions for sampling, can be recorded
+ * into the same batch with vk::QueueFlagBits::eGraphics. If the transfer queue
+ * belongs to a separate queue family, these commands are submitted to the
+ * graphics queue after the transfer commands, synchronized with a semaphore,
+ * so that streaming overlaps with rendering. Resources created with
+ * vk::SharingMode::eExclusive must then be handed over to the graphics queue
+ * family with abcg::VulkanUploadQueue::transferOwnership once uploaded.
+ * Buffers already in use by the graphics queue are acquired for the transfer
+ * queue with abcg::VulkanUploadQueue::acquireOwnership before being updated.
+ *
+ * The upload queue owned by abcg::VulkanDevice is submitted by
+ * abcg::VulkanSwapchain::render before the commands of each frame, so that
+ * resources uploaded while recording a frame can be used by that frame. On the
+ * graphics queue, the batch begins with a memory barrier that waits for the
+ * previously submitted frames, which may still read the resources being
+ * overwritten, and ends with a memory barrier that makes the copies visible to
+ * all subsequent commands.
+ *
+ * All member functions must be called from the thread that submits the
+ * rendering commands, as they may submit batches to the queues.
+ *
+ * @sa abcg::VulkanDevice::getUploadQueue.
+ */
+class abcg::VulkanUploadQueue {
+public:
+  VulkanUploadQueue() = default;
+  VulkanUploadQueue(VulkanUploadQueue const &) = delete;
+  VulkanUploadQueue(VulkanUploadQueue &&) = delete;
+  VulkanUploadQueue &operator=(VulkanUploadQueue const &) = delete;
+  VulkanUploadQueue &operator=(VulkanUploadQueue &&) = delete;
+  ~VulkanUploadQueue() = default;
+
+  void create(vk::Device const &device,
+              VulkanPhysicalDevice const &physicalDevice,
+              vk::Queue const &transferQueue, vk::Queue const &graphicsQueue,
+              VulkanAllocator &allocator,
+              vk::DeviceSize stagingSize = 32UL * 1024UL * 1024UL);
+  void destroy();
+
+  uint64_t upload(vk::Buffer const &buffer, std::span<std::byte const> data,
+                  vk::DeviceSize offset = 0,
+                  vk::QueueFlagBits queueFlag = vk::QueueFlagBits::eTransfer);
+  uint64_t upload(vk::Image const &image, std::span<std::byte const> data,
+                  std::span<vk::BufferImageCopy const> regions,
+                  vk::DeviceSize alignment = 16,
+                  vk::QueueFlagBits queueFlag = vk::QueueFlagBits::eTransfer);
+  uint64_t acquireOwnership(
+      vk::Buffer const &buffer,
+      vk::SharingMode sharingMode = vk::SharingMode::eExclusive);
+  uint64_t transferOwnership(vk::Buffer const &buffer);
+  uint64_t transferOwnership(vk::Image const &image,
+                             vk::ImageSubresourceRange const &subresourceRange,
+                             vk::ImageLayout oldLayout,
+                             vk::ImageLayout newLayout);
+  uint64_t
+  record(std::function<void(vk::CommandBuffer const &)> const &fun,
+         vk::QueueFlagBits queueFlag = vk::QueueFlagBits::eTransfer);
+
+  uint64_t submit();
+  [[nodiscard]] bool isComplete(uint64_t ticket);
+  void wait(uint64_t ticket);
+  void waitIdle();
+
+  [[nodiscard]] vk::DeviceSize getStagingSize() const noexcept;
+  [[nodiscard]] bool hasSeparateTransferQueue() const noexcept;
+
+private:
+  struct Batch {
+    uint64_t ticket{};
+    vk::CommandBuffer commandBuffer;
+    // Only used if the transfer queue belongs to a separate queue family
+    vk::CommandBuffer graphicsCommandBuffer;
+    vk::Semaphore semaphore;
+    // Only used if buffers in use by the graphics queue are updated on the
+    // transfer queue. Submitted to the graphics queue before the transfer
+    // commands, which wait for the semaphore
+    vk::CommandBuffer releaseCommandBuffer;
+    vk::Semaphore releaseSemaphore;
+    bool hasRelease{};
+    // Exclusive buffers owned by the transfer queue family until the batch is
+    // submitted
+    std::vector<vk::Buffer> ownedBuffers;
+    vk::Fence fence;
+    // Bytes of the staging ring used by the batch, including padding
+    vk::DeviceSize stagingUsed{};
+    // Staging buffers of data that did not fit in the ring
+    std::vector<std::pair<vk::Buffer, VulkanAllocation>> transientBuffers;
+  };
+
+  Batch &getCurrentBatch();
+  [[nodiscard]] vk::CommandBuffer const &
+  getCommandBuffer(Batch const &batch, vk::QueueFlagBits queueFlag) const;
+  [[nodiscard]] std::pair<vk::Buffer, vk::DeviceSize>
+  stage(std::span<std::byte const> data, vk::DeviceSize alignment);
+  [[nodiscard]] std::optional<std::pair<vk::DeviceSize, vk::DeviceSize>>
+  reserve(vk::DeviceSize size, vk::DeviceSize alignment);
+  void submitCurrentBatch();
+  void retire(bool waitOldest);
+
+  vk::Device m_device;
+  VulkanAllocator *m_allocator{};
+  vk::Queue m_transferQueue;
+  vk::Queue m_graphicsQueue;
+  uint32_t m_transferQueueFamily{};
+  uint32_t m_graphicsQueueFamily{};
+  vk::CommandPool m_transferCommandPool;
+  vk::CommandPool m_graphicsCommandPool;
+
+  // Staging ring
+  vk::Buffer m_stagingBuffer;
+  VulkanAllocation m_stagingAllocation;
+  vk::DeviceSize m_stagingSize{};
+  vk::DeviceSize m_stagingHead{};
+  vk::DeviceSize m_stagingUsed{};
+
+  std::optional<Batch> m_currentBatch;
+  std::deque<Batch> m_submittedBatches;
+  std::vector<Batch> m_freeBatches;
+  uint64_t m_nextTicket{1};
+  uint64_t m_completedTicket{};
+};
+
+#endif
@@ -12,12 +12,20 @@
 
 #include <SDL_vulkan.h>
 #include <algorithm>
+#include <cppitertools/itertools.hpp>
+#include <filesystem>
 #include <gsl/gsl>
 #include <imgui_impl_sdl2.h>
 #include <imgui_impl_vulkan.h>
+#include <memory>
+#include <numeric>
+#include <thread>
 
+#include "abcgApplication.hpp"
 #include "abcgEmbeddedFonts.hpp"
 #include "abcgException.hpp"
+#include "abcgShaderWatcher.hpp"
+#include "abcgUtil.hpp"
 #include "abcgVulkanError.hpp"
 #include "abcgVulkanInstance.hpp"
 #include "abcgWindow.hpp"
@@ -57,6 +65,41 @@ getRequiredExtensions(gsl::not_null<SDL_Window *> window) {
 }
 
 void checkVkResultSingleArg(VkResult retCode) { abcg::checkVkResult(retCode); }
+
+// Returns the path of the file used to persist the pipeline cache. By default,
+// the file is stored in the user's cache directory, in a subdirectory named
+// after the executable, and its name is the pipeline cache UUID of the device.
+// This keeps apart the caches of different users, different applications, and
+// different devices or driver versions.
+[[nodiscard]] std::filesystem::path
+getPipelineCachePath(abcg::VulkanSettings const &settings,
+                     abcg::VulkanPhysicalDevice const &physicalDevice) {
+  if (!settings.persistentPipelineCache) {
+    return {};
+  }
+  if (!settings.pipelineCachePath.empty()) {
+    return settings.pipelineCachePath;
+  }
+
+  auto const cacheDirectory{abcg::getUserCacheDirectory()};
+  if (cacheDirectory.empty()) {
+    return {};
+  }
+
+  auto const properties{
+      static_cast<vk::PhysicalDevice>(physicalDevice).getProperties()};
+  std::string uuid;
+  for (auto const byte : properties.pipelineCacheUUID) {
+    uuid += fmt::format("{:02x}", byte);
+  }
+
+  abcg::FNV1aHash hash;
+  hash.update(abcg::Application::getExecutablePath());
+
+  return cacheDirectory / "pipelines" /
+         fmt::format("{:016x}", hash.getValue()) /
+         fmt::format("{}.bin", uuid);
+}
 } // namespace
 
 /**
@@ -110,6 +153,81 @@ abcg::VulkanSwapchain const &abcg::VulkanWindow::getSwapchain() const noexcept {
   return m_swapchain;
 }
 
+/**
+ * @brief Recreates a pipeline whenever its shader files change.
+ *
+ * When any of the shader files, or any file they include, is modified, the
+ * changed shaders are compiled again and a new pipeline is created from them,
+ * from the SPIR-V code of the unchanged shaders kept from the previous
+ * rebuild, and from `createInfo`. The first rebuild compiles all shaders. Only
+ * after both steps succeed is the old pipeline destroyed and replaced with the
+ * new one. If either step fails, the error is printed and `pipeline` is left
+ * untouched, so the last working pipeline keeps being used.
+ *
+ * @param pathsOrSources Paths or source codes of the shaders of the pipeline.
+ * @param createInfo Creation info of the pipeline. Its shaders are ignored.
+ * @param pipeline Pipeline to be replaced. It must outlive the watch.
+ *
+ * @return ID of the watched group, to be used with
+ * abcg::ShaderWatcher::unwatch.
+ */
+std::size_t abcg::VulkanWindow::watchPipeline(
+    std::vector<ShaderSource> const &pathsOrSources,
+    VulkanPipelineCreateInfo const &createInfo, VulkanPipeline &pipeline) {
+  auto info{createInfo};
+  info.shaders.clear();
+  // SPIR-V code of the shaders used by the last pipeline created by the watch
+  auto const codes{std::make_shared<std::vector<std::vector<uint32_t>>>()};
+  return getShaderWatcher().watch(
+      pathsOrSources, [this, pathsOrSources, info = std::move(info), codes,
+                       &pipeline](auto const &changedIndices) {
+        auto newCodes{*codes};
+        std::vector<std::size_t> indices;
+        if (newCodes.empty()) {
+          newCodes.resize(pathsOrSources.size());
+          indices.resize(pathsOrSources.size());
+          std::iota(indices.begin(), indices.end(), std::size_t{});
+        } else {
+          indices = changedIndices;
+        }
+
+        VulkanPipeline newPipeline;
+        try {
+          std::vector<ShaderSource> changedSources;
+          changedSources.reserve(indices.size());
+          for (auto const index : indices) {
+            changedSources.push_back(pathsOrSources.at(index));
+          }
+          auto compiledCodes{compileVulkanShadersToSPIRV(changedSources)};
+          for (auto &&[index, code] : iter::zip(indices, compiledCodes)) {
+            newCodes.at(index) = std::move(code);
+          }
+
+          auto newInfo{info};
+          // Shader modules are no longer needed once the pipeline is created
+          auto const destroyShaders{gsl::finally([&newInfo] {
+            for (auto &shader : newInfo.shaders) {
+              shader.destroy();
+            }
+          })};
+          for (auto &&[pathOrSource, code] :
+               iter::zip(pathsOrSources, newCodes)) {
+            newInfo.shaders.emplace_back().create(m_device, pathOrSource.stage,
+                                                  code);
+          }
+          newPipeline.create(m_swapchain, newInfo);
+        } catch (std::exception const &exception) {
+          fmt::print(stderr, "{}\nKeeping the previous pipeline\n",
+                     exception.what());
+          return;
+        }
+        *codes = std::move(newCodes);
+        // Waits for the frames in flight that may still use the old pipeline
+        pipeline.destroy();
+        pipeline = newPipeline;
+      });
+}
+
 /**
  * @brief Custom event handler.
  *
@@ -239,6 +357,127 @@ void abcg::VulkanWindow::onUpdate() {}
  */
 void abcg::VulkanWindow::onDestroy() {}
 
+/**
+ * @brief Records commands of the main render pass in parallel.
+ *
+ * Splits the range [0, `count`) into contiguous subranges, one per thread,
+ * and calls `fun` on each thread with a secondary command buffer and the
+ * first and last (exclusive) indices of its subrange. The secondary command
+ * buffers are then executed in order into the primary command buffer of the
+ * frame, so the result is the same as if the whole range were recorded
+ * serially.
+ *
+ * This function must be called from abcg::VulkanWindow::onPaint, while the
+ * main render pass is active in `frame.commandBuffer`, and the render pass
+ * must have been begun with vk::SubpassContents::eSecondaryCommandBuffers.
+ * The secondary command buffers inherit the render pass and framebuffer, but
+ * not the bound pipeline, descriptor sets or dynamic states, which must be
+ * set by `fun`.
+ *
+ * The worker threads are created with the window and wait for work between
+ * calls. Each thread allocates command buffers from its own command pool, one
+ * for each frame in flight, so `fun` must not record into other command
+ * buffers. The calling thread is also used for recording. If `fun` throws, the
+ * exception is rethrown after all threads have finished.
+ *
+ * @param frame Frame in flight passed to abcg::VulkanWindow::onPaint.
+ * @param count Number of items to record.
+ * @param fun Function that records the items in [first, last) into the given
+ * secondary command buffer.
+ *
+ * @sa abcg::VulkanSettings::recordingThreads.
+ */
+void abcg::VulkanWindow::recordParallel(
+    VulkanFrame const &frame, std::size_t count,
+    std::function<void(vk::CommandBuffer const &, std::size_t, std::size_t)>
+        const &fun) {
+  if (count == 0)
+    return;
+
+  auto const &device{static_cast<vk::Device>(m_device)};
+
+  auto &pool{*m_recordingThreads};
+  auto const maxRanges{std::min(count, pool.threads.size() + 1)};
+  auto const rangeSize{(count + maxRanges - 1) / maxRanges};
+  auto const numThreads{(count + rangeSize - 1) / rangeSize};
+
+  // Create the command pools of this frame in flight for any new thread
+  if (m_secondaryCommandPools.size() <= frame.index) {
+    m_secondaryCommandPools.resize(frame.index + 1);
+  }
+  auto &threadPools{m_secondaryCommandPools.at(frame.index)};
+  auto const graphicsQueueFamily{
+      m_physicalDevice.getQueuesFamilies().graphics.value()};
+  while (threadPools.size() < numThreads) {
+    threadPools.push_back({.commandPool = device.createCommandPool(
+                               {.flags =
+                                    vk::CommandPoolCreateFlagBits::eTransient,
+                                .queueFamilyIndex = graphicsQueueFamily})});
+  }
+
+  // Get an unused secondary command buffer from each pool
+  std::vector<vk::CommandBuffer> commandBuffers(numThreads);
+  for (auto &&[commandBuffer, threadPool] :
+       iter::zip(commandBuffers, threadPools)) {
+    if (threadPool.numUsed == threadPool.commandBuffers.size()) {
+      threadPool.commandBuffers.push_back(
+          device
+              .allocateCommandBuffers(
+                  {.commandPool = threadPool.commandPool,
+                   .level = vk::CommandBufferLevel::eSecondary,
+                   .commandBufferCount = 1})
+              .front());
+    }
+    commandBuffer = threadPool.commandBuffers.at(threadPool.numUsed++);
+  }
+
+  vk::CommandBufferInheritanceInfo const inheritanceInfo{
+      .renderPass = m_swapchain.getMainRenderPass(),
+      .subpass = 0,
+      .framebuffer = frame.framebufferMain};
+
+  std::vector<std::exception_ptr> errors(numThreads);
+  std::function<void(std::size_t)> const record{[&](std::size_t index) {
+    try {
+      auto const &commandBuffer{commandBuffers[index]};
+      commandBuffer.begin(
+          {.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit |
+                    vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+           .pInheritanceInfo = &inheritanceInfo});
+      auto const first{index * rangeSize};
+      fun(commandBuffer, first, std::min(first + rangeSize, count));
+      commandBuffer.end();
+    } catch (...) {
+      errors[index] = std::current_exception();
+    }
+  }};
+
+  {
+    std::scoped_lock const lock{pool.mutex};
+    pool.record = &record;
+    pool.numRanges = numThreads;
+    pool.numPending = numThreads - 1;
+    ++pool.generation;
+  }
+  pool.start.notify_all();
+
+  // The calling thread records the first range
+  record(0);
+  {
+    std::unique_lock lock{pool.mutex};
+    pool.finish.wait(lock, [&pool] { return pool.numPending == 0; });
+    pool.record = nullptr;
+  }
+
+  for (auto const &error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  frame.commandBuffer.executeCommands(commandBuffers);
+}
+
 void abcg::VulkanWindow::handleEvent(SDL_Event const &event) {
   if (event.window.windowID != abcg::Window::getSDLWindowID())
     return;
@@ -299,10 +538,11 @@ void abcg::VulkanWindow::create() {
 
   // Select physical device
   m_physicalDevice.create(m_instance, m_surface, m_deviceExtensions,
-                          sampleCount);
+                          sampleCount, m_vulkanSettings.separateTransferQueue);
 
   // Create logical device
-  m_device.create(m_physicalDevice, m_deviceExtensions);
+  m_device.create(m_physicalDevice, m_deviceExtensions,
+                  getPipelineCachePath(m_vulkanSettings, m_physicalDevice));
 
   // Create swapchain
   m_swapchain.create(m_device, m_vulkanSettings, getWindowSize());
@@ -352,11 +592,12 @@ void abcg::VulkanWindow::create() {
       .Device = static_cast<vk::Device>(m_device),
       .QueueFamily = m_physicalDevice.getQueuesFamilies().graphics.value_or(0),
       .Queue = m_device.getQueues().graphics,
-      .PipelineCache = VK_NULL_HANDLE,
+      .PipelineCache = m_device.getPipelineCache(),
       .DescriptorPool = m_UIdescriptorPool,
       .Subpass = 0,
       .MinImageCount = 2,
-      .ImageCount = gsl::narrow<uint32_t>(m_swapchain.getFrames().size()),
+      .ImageCount = std::max(
+          2U, gsl::narrow<uint32_t>(m_swapchain.getFrames().size())),
       .MSAASamples =
           static_cast<VkSampleCountFlagBits>(m_physicalDevice.getSampleCount()),
       .Allocator = nullptr,
@@ -393,6 +634,8 @@ void abcg::VulkanWindow::create() {
     ImGui_ImplVulkan_DestroyFontUploadObjects();
   }
 
+  createRecordingThreads();
+
   onCreate();
 
   onResize();
@@ -419,11 +662,18 @@ void abcg::VulkanWindow::paint() {
 
   ImGui::Render();
 
-  m_swapchain.render([this](auto const &frame) { onPaint(frame); });
+  m_swapchain.render([this](auto const &frame) {
+    resetSecondaryCommandPools(frame);
+    onPaint(frame);
+  });
   m_swapchain.present();
 }
 
 void abcg::VulkanWindow::destroy() {
+  // Stop and join the worker threads
+  m_recordingThreads.reset();
+
+  m_device.getUploadQueue().waitIdle();
   static_cast<vk::Device>(m_device).waitIdle();
 
   onDestroy();
@@ -433,6 +683,7 @@ void abcg::VulkanWindow::destroy() {
   ImGui::DestroyContext();
 
   static_cast<vk::Device>(m_device).destroyDescriptorPool(m_UIdescriptorPool);
+  destroySecondaryCommandPools();
   m_swapchain.destroy();
   m_device.destroy();
   m_physicalDevice.destroy();
@@ -440,6 +691,80 @@ void abcg::VulkanWindow::destroy() {
   m_instance.destroy();
 }
 
+// Called after the fence of the frame in flight has been signaled, so that the
+// secondary command buffers recorded for this frame can be reused
+void abcg::VulkanWindow::resetSecondaryCommandPools(VulkanFrame const &frame) {
+  if (frame.index >= m_secondaryCommandPools.size())
+    return;
+
+  auto const &device{static_cast<vk::Device>(m_device)};
+  for (auto &threadPool : m_secondaryCommandPools.at(frame.index)) {
+    device.resetCommandPool(threadPool.commandPool);
+    threadPool.numUsed = 0;
+  }
+}
+
+// Starts the worker threads of recordParallel. The calling thread also records,
+// so one thread less than the maximum is started
+void abcg::VulkanWindow::createRecordingThreads() {
+  auto const maxThreads{
+      m_vulkanSettings.recordingThreads > 0
+          ? gsl::narrow<std::size_t>(m_vulkanSettings.recordingThreads)
+          : std::size_t{std::max(1U, std::thread::hardware_concurrency())}};
+
+  m_recordingThreads = std::make_unique<RecordingThreads>();
+  m_recordingThreads->threads.reserve(maxThreads - 1);
+  for (auto const index : iter::range(maxThreads - 1)) {
+    m_recordingThreads->threads.emplace_back(
+        [this, index](std::stop_token const &stopToken) {
+          runRecordingThread(stopToken, index);
+        });
+  }
+}
+
+// Loop of a worker thread of recordParallel. Waits for each call, records the
+// range of the worker if there is one, and returns when a stop is requested
+void abcg::VulkanWindow::runRecordingThread(std::stop_token const &stopToken,
+                                            std::size_t index) {
+  auto &pool{*m_recordingThreads};
+  std::size_t generation{};
+  while (true) {
+    std::function<void(std::size_t)> const *record{};
+    {
+      std::unique_lock lock{pool.mutex};
+      if (!pool.start.wait(lock, stopToken, [&pool, generation] {
+            return pool.generation != generation;
+          })) {
+        return;
+      }
+      generation = pool.generation;
+      if (index + 1 >= pool.numRanges) {
+        continue;
+      }
+      record = pool.record;
+    }
+
+    // Exceptions are caught by the function
+    (*record)(index + 1);
+
+    {
+      std::scoped_lock const lock{pool.mutex};
+      --pool.numPending;
+    }
+    pool.finish.notify_one();
+  }
+}
+
+void abcg::VulkanWindow::destroySecondaryCommandPools() {
+  auto const &device{static_cast<vk::Device>(m_device)};
+  for (auto &threadPools : m_secondaryCommandPools) {
+    for (auto &threadPool : threadPools) {
+      device.destroyCommandPool(threadPool.commandPool);
+    }
+  }
+  m_secondaryCommandPools.clear();
+}
+
 glm::ivec2 abcg::VulkanWindow::getWindowSize() const {
   glm::ivec2 size{};
 
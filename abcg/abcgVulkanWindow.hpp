@@ -16,9 +16,14 @@
 #include "abcgVulkanDevice.hpp"
 #include "abcgVulkanInstance.hpp"
 #include "abcgVulkanPhysicalDevice.hpp"
+#include "abcgVulkanPipeline.hpp"
 #include "abcgVulkanSwapchain.hpp"
 #include "abcgWindow.hpp"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 namespace abcg {
 class VulkanWindow;
 struct VulkanSettings;
@@ -57,6 +62,52 @@ struct abcg::VulkanSettings {
    * comes first.
    */
   bool vSync{false};
+
+  /** @brief Number of frames that can be recorded while previous frames are
+   * still being executed by the device.
+   *
+   * Each frame in flight has its own command pool, command buffers and fence,
+   * independently of the number of swapchain images. Larger values increase
+   * the overlap between the CPU and the GPU at the cost of latency. Values
+   * smaller than 1 are treated as 1.
+   */
+  int framesInFlight{2};
+
+  /** @brief Maximum number of threads used by
+   * abcg::VulkanWindow::recordParallel.
+   *
+   * If zero, the number of hardware threads is used. The threads are
+   * created with the window and reused every frame.
+   */
+  int recordingThreads{0};
+
+  /** @brief Whether to persist the pipeline cache across runs.
+   *
+   * If `true`, the pipeline cache owned by abcg::VulkanDevice is loaded from
+   * disk at startup and written back when the window is destroyed.
+   *
+   * @sa abcg::VulkanSettings::pipelineCachePath.
+   */
+  bool persistentPipelineCache{true};
+
+  /** @brief Path of the pipeline cache file.
+   *
+   * If empty, the file is stored in the user's cache directory (see
+   * abcg::getUserCacheDirectory), under a subdirectory named after a hash of
+   * the executable path, with a name derived from the pipeline cache UUID of
+   * the physical device.
+   */
+  std::string pipelineCachePath{};
+
+  /** @brief Whether to upload resources on a queue family dedicated to
+   * transfers, if the device has one.
+   *
+   * If `true`, uploads recorded with abcg::VulkanUploadQueue are executed
+   * concurrently with rendering, and exclusive resources are handed over to
+   * the graphics queue family with ownership transfer barriers. Otherwise,
+   * uploads are executed on the graphics queue.
+   */
+  bool separateTransferQueue{true};
 };
 
 /**
@@ -84,6 +135,9 @@ public:
   [[nodiscard]] VulkanPhysicalDevice const &getPhysicalDevice() const noexcept;
   [[nodiscard]] VulkanDevice const &getDevice() const noexcept;
   [[nodiscard]] VulkanSwapchain const &getSwapchain() const noexcept;
+  std::size_t watchPipeline(std::vector<ShaderSource> const &pathsOrSources,
+                            VulkanPipelineCreateInfo const &createInfo,
+                            VulkanPipeline &pipeline);
 
 protected:
   virtual void onEvent(SDL_Event const &event);
@@ -94,6 +148,11 @@ protected:
   virtual void onUpdate();
   virtual void onDestroy();
 
+  void recordParallel(
+      VulkanFrame const &frame, std::size_t count,
+      std::function<void(vk::CommandBuffer const &, std::size_t, std::size_t)>
+          const &fun);
+
 private:
   void handleEvent(SDL_Event const &event) final;
   void create() final;
@@ -101,6 +160,37 @@ private:
   void destroy() final;
   [[nodiscard]] glm::ivec2 getWindowSize() const final;
 
+  // Command pool of a recording thread for a frame in flight
+  struct SecondaryCommandPool {
+    vk::CommandPool commandPool;
+    std::vector<vk::CommandBuffer> commandBuffers;
+    // Number of command buffers recorded since the pool was reset
+    std::size_t numUsed{};
+  };
+
+  void resetSecondaryCommandPools(VulkanFrame const &frame);
+  void destroySecondaryCommandPools();
+
+  // Worker threads of recordParallel. The calling thread records the first
+  // range, and worker i records range i + 1
+  struct RecordingThreads {
+    std::mutex mutex;
+    std::condition_variable_any start;
+    std::condition_variable finish;
+    // Records a range given its index. Valid while a call is in progress
+    std::function<void(std::size_t)> const *record{};
+    std::size_t numRanges{};
+    // Incremented at each call to wake up the workers
+    std::size_t generation{};
+    std::size_t numPending{};
+    // Declared last so that the threads are joined first
+    std::vector<std::jthread> threads;
+  };
+
+  void createRecordingThreads();
+  void runRecordingThread(std::stop_token const &stopToken,
+                          std::size_t index);
+
   VulkanSettings m_vulkanSettings;
   std::vector<char const *> m_deviceExtensions{VK_KHR_SWAPCHAIN_EXTENSION_NAME};
   std::vector<char const *> m_layers {
@@ -117,6 +207,10 @@ private:
   vk::DescriptorPool m_UIdescriptorPool;
   bool m_hidden{};
   bool m_minimized{};
+
+  // Secondary command pools indexed by frame in flight and thread
+  std::vector<std::vector<SecondaryCommandPool>> m_secondaryCommandPools;
+  std::unique_ptr<RecordingThreads> m_recordingThreads;
 };
 
 #endif
@@ -14,6 +14,8 @@
 
 #include <imgui_impl_sdl2.h>
 
+#include "abcgShaderWatcher.hpp"
+
 namespace {
 ImVec4 ColorAlpha(ImVec4 const &color, float const alpha) {
   return {color.x, color.y, color.z, alpha};
@@ -155,6 +157,30 @@ abcg::fullscreenchangeCallback(int eventType,
 }
 #endif
 
+/**
+ * @brief Default constructor.
+ *
+ * Defined here, where abcg::ShaderWatcher is a complete type, so that classes
+ * derived from abcg::Window can be constructed without including
+ * abcgShaderWatcher.hpp.
+ */
+abcg::Window::Window() = default;
+
+/**
+ * @brief Default move constructor.
+ */
+abcg::Window::Window(Window &&) noexcept = default;
+
+/**
+ * @brief Default move assignment.
+ */
+abcg::Window &abcg::Window::operator=(Window &&) noexcept = default;
+
+/**
+ * @brief Default destructor.
+ */
+abcg::Window::~Window() = default;
+
 /**
  * @brief Returns the time that have passed since the last frame.
  *
@@ -209,6 +235,21 @@ void abcg::Window::setWindowSettings(WindowSettings const &windowSettings) {
   m_windowSettings = windowSettings;
 }
 
+/**
+ * @brief Returns the shader watcher of the window.
+ *
+ * The watcher is created on the first call. Changes to the watched shaders are
+ * dispatched at the start of each frame, before the window is painted.
+ *
+ * @return Reference to the abcg::ShaderWatcher of this window.
+ */
+abcg::ShaderWatcher &abcg::Window::getShaderWatcher() {
+  if (!m_shaderWatcher) {
+    m_shaderWatcher = std::make_unique<ShaderWatcher>();
+  }
+  return *m_shaderWatcher;
+}
+
 /**
  * @brief Returns the SDL window previously created with
  * abcg::Window::createOpenGLWindow or abcg::Window::createVulkanWindow.
@@ -398,6 +439,11 @@ void abcg::Window::templatePaint() {
     m_lastDeltaTime = 0.0;
   }
 
+  // Report shader changes at the frame boundary
+  if (m_shaderWatcher) {
+    m_shaderWatcher->dispatch();
+  }
+
   paint();
 }
 
@@ -407,6 +453,8 @@ void abcg::Window::templateDestroy() {
 
   destroy();
 
+  m_shaderWatcher.reset();
+
   SDL_DestroyWindow(m_window);
   m_window = nullptr;
   m_windowID = 0;
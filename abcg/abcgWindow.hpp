@@ -13,6 +13,7 @@
 #ifndef ABCG_WINDOW_HPP_
 #define ABCG_WINDOW_HPP_
 
+#include <memory>
 #include <string>
 
 #include "abcgExternal.hpp"
@@ -25,6 +26,7 @@
 namespace abcg {
 struct WindowSettings;
 class Application;
+class ShaderWatcher;
 class Window;
 int resizingEventWatcher(void *data, SDL_Event *event);
 #if defined(__EMSCRIPTEN__)
@@ -85,27 +87,16 @@ struct abcg::WindowSettings {
  */
 class abcg::Window {
 public:
-  /**
-   * @brief Default constructor.
-   */
-  Window() = default;
+  Window();
   Window(Window const &) = delete;
-  /**
-   * @brief Default move constructor.
-   */
-  Window(Window &&) = default;
+  Window(Window &&) noexcept;
   Window &operator=(Window const &) = delete;
-  /**
-   * @brief Default move assignment.
-   */
-  Window &operator=(Window &&) = default;
-  /**
-   * @brief Default destructor.
-   */
-  virtual ~Window() = default;
+  Window &operator=(Window &&) noexcept;
+  virtual ~Window();
 
   [[nodiscard]] WindowSettings const &getWindowSettings() const noexcept;
   void setWindowSettings(WindowSettings const &windowSettings);
+  [[nodiscard]] ShaderWatcher &getShaderWatcher();
 
 protected:
   /**
@@ -178,6 +169,10 @@ private:
 
   bool m_enableResizingEventWatcher{true};
 
+  // Created on first use. Only forward declared so that the headers of the
+  // watcher are not included by every application
+  std::unique_ptr<ShaderWatcher> m_shaderWatcher;
+
   friend Application;
   friend int resizingEventWatcher(void *data, SDL_Event *event);
 #if defined(__EMSCRIPTEN__)
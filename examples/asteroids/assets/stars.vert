@@ -5,11 +5,18 @@ layout(location = 1) in vec3 inColor;
 
 uniform vec2 translation;
 uniform float pointSize;
+uniform bool wrapAround;
 
 out vec4 fragColor;
 
 void main() {
   gl_PointSize = pointSize;
-  gl_Position = vec4(inPosition.xy + translation, 0, 1);
+  vec2 position = inPosition.xy + translation;
+  if (wrapAround) {
+    // Wrap around the screen, so that each layer is drawn only once
+    position = mod(position + 1.0, 2.0) - 1.0;
+  }
+
+  gl_Position = vec4(position, 0, 1);
   fragColor = vec4(inColor, 1);
 }
\ No newline at end of file
@@ -2,20 +2,12 @@
 
 #include <glm/gtx/rotate_vector.hpp>
 
-void Bullets::create(GLuint program) {
-  destroy();
-
-  m_program = program;
+#include <utility>
 
-  // Get location of uniforms in the program
-  m_colorLoc = abcg::glGetUniformLocation(m_program, "color");
-  m_rotationLoc = abcg::glGetUniformLocation(m_program, "rotation");
-  m_scaleLoc = abcg::glGetUniformLocation(m_program, "scale");
-  m_translationLoc = abcg::glGetUniformLocation(m_program, "translation");
+void Bullets::create() {
+  destroy();
 
-  // Get location of attributes in the program
-  auto const positionAttribute{
-      abcg::glGetAttribLocation(m_program, "inPosition")};
+  m_shapeBatch.create();
 
   m_bullets.clear();
 
@@ -28,53 +20,25 @@ void Bullets::create(GLuint program) {
   }
   positions.push_back(positions.at(1));
 
-  // Generate VBO of positions
-  abcg::glGenBuffers(1, &m_VBO);
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-  abcg::glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec2),
-                     positions.data(), GL_STATIC_DRAW);
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-  // Create VAO
-  abcg::glGenVertexArrays(1, &m_VAO);
-
-  // Bind vertex attributes to current VAO
-  abcg::glBindVertexArray(m_VAO);
-
-  abcg::glEnableVertexAttribArray(positionAttribute);
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-  abcg::glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0,
-                              nullptr);
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-  // End of binding to current VAO
-  abcg::glBindVertexArray(0);
+  m_shape = m_shapeBatch.addShape(positions, GL_TRIANGLE_FAN);
 }
 
 void Bullets::paint() {
-  abcg::glUseProgram(m_program);
-
-  abcg::glBindVertexArray(m_VAO);
-  abcg::glUniform4f(m_colorLoc, 1, 1, 1, 1);
-  abcg::glUniform1f(m_rotationLoc, 0);
-  abcg::glUniform1f(m_scaleLoc, m_scale);
-
-  for (auto const &bullet : m_bullets) {
-    abcg::glUniform2f(m_translationLoc, bullet.m_translation.x,
-                      bullet.m_translation.y);
-
-    abcg::glDrawArrays(GL_TRIANGLE_FAN, 0, 12);
+  auto const &bullets{std::as_const(m_bullets)}; // Shortcut
+  for (auto const index : iter::range(bullets.getSize())) {
+    glm::vec2 const translation{bullets.get<TranslationX>()[index],
+                                bullets.get<TranslationY>()[index]};
+    m_shapeBatch.addInstance(m_shape, {.translation = translation,
+                                       .rotation = 0.0f,
+                                       .scale = m_scale,
+                                       .color = glm::vec4{1.0f}});
   }
 
-  abcg::glBindVertexArray(0);
-
-  abcg::glUseProgram(0);
+  // Draw all bullets in a single call
+  m_shapeBatch.paint();
 }
 
-void Bullets::destroy() {
-  abcg::glDeleteBuffers(1, &m_VBO);
-  abcg::glDeleteVertexArrays(1, &m_VAO);
-}
+void Bullets::destroy() { m_shapeBatch.destroy(); }
 
 void Bullets::update(Ship &ship, const GameData &gameData, float deltaTime) {
   // Create a pair of bullets
@@ -90,34 +54,31 @@ void Bullets::update(Ship &ship, const GameData &gameData, float deltaTime) {
       auto const cannonOffset{(11.0f / 15.5f) * ship.m_scale};
       auto const bulletSpeed{2.0f};
 
-      Bullet bullet{.m_dead = false,
-                    .m_translation = ship.m_translation + right * cannonOffset,
-                    .m_velocity = ship.m_velocity + forward * bulletSpeed};
-      m_bullets.push_back(bullet);
-
-      bullet.m_translation = ship.m_translation - right * cannonOffset;
-      m_bullets.push_back(bullet);
+      auto const velocity{ship.m_velocity + forward * bulletSpeed};
+      for (auto const side : {1.0f, -1.0f}) {
+        auto const translation{ship.m_translation +
+                               side * right * cannonOffset};
+        (void)m_bullets.add(translation.x, translation.y, velocity.x,
+                            velocity.y);
+      }
 
       // Moves ship in the opposite direction
       ship.m_velocity -= forward * 0.1f;
     }
   }
 
-  for (auto &bullet : m_bullets) {
-    bullet.m_translation -= ship.m_velocity * deltaTime;
-    bullet.m_translation += bullet.m_velocity * deltaTime;
-
-    // Kill bullet if it goes off screen
-    if (bullet.m_translation.x < -1.1f)
-      bullet.m_dead = true;
-    if (bullet.m_translation.x > +1.1f)
-      bullet.m_dead = true;
-    if (bullet.m_translation.y < -1.1f)
-      bullet.m_dead = true;
-    if (bullet.m_translation.y > +1.1f)
-      bullet.m_dead = true;
+  // Move relative to the ship
+  abcg::integrate(m_bullets.get<TranslationX>(), m_bullets.get<VelocityX>(),
+                  deltaTime, -ship.m_velocity.x);
+  abcg::integrate(m_bullets.get<TranslationY>(), m_bullets.get<VelocityY>(),
+                  deltaTime, -ship.m_velocity.y);
+
+  // Remove bullets that went off screen. Indices are visited in decreasing
+  // order, so that each removal moves an already visited bullet.
+  for (auto index{m_bullets.getSize()}; index-- > 0;) {
+    if (std::abs(m_bullets.get<TranslationX>()[index]) > 1.1f ||
+        std::abs(m_bullets.get<TranslationY>()[index]) > 1.1f) {
+      m_bullets.remove(index);
+    }
   }
-
-  // Remove dead bullets
-  m_bullets.remove_if([](auto const &p) { return p.m_dead; });
 }
\ No newline at end of file
@@ -1,10 +1,23 @@
 #include "window.hpp"
 
+#include <algorithm>
+#include <span>
+#include <string_view>
+
 int main(int argc, char **argv) {
   try {
     abcg::Application app(argc, argv);
 
     Window window;
+
+    // Run with --benchmark-stars to time the wrap modes of the star layers
+    auto const arguments{std::span{argv, gsl::narrow<std::size_t>(argc)}};
+    if (std::ranges::any_of(arguments, [](char const *argument) {
+          return std::string_view{argument} == "--benchmark-stars";
+        })) {
+      window.enableStarBenchmark();
+    }
+
     window.setOpenGLSettings({.samples = 4});
     window.setWindowSettings({
         .width = 600,
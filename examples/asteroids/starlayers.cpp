@@ -15,6 +15,7 @@ void StarLayers::create(GLuint program, int quantity) {
   // Get location of uniforms in the program
   m_pointSizeLoc = abcg::glGetUniformLocation(m_program, "pointSize");
   m_translationLoc = abcg::glGetUniformLocation(m_program, "translation");
+  m_wrapAroundLoc = abcg::glGetUniformLocation(m_program, "wrapAround");
 
   // Get location of attributes in the program
   auto const positionAttribute{
@@ -67,16 +68,26 @@ void StarLayers::paint() {
   abcg::glEnable(GL_BLEND);
   abcg::glBlendFunc(GL_ONE, GL_ONE);
 
+  auto const modulo{m_wrapMode == WrapMode::Modulo};
+  abcg::glUniform1i(m_wrapAroundLoc, modulo ? 1 : 0);
+
   for (auto const &layer : m_starLayers) {
     abcg::glBindVertexArray(layer.m_VAO);
     abcg::glUniform1f(m_pointSizeLoc, layer.m_pointSize);
 
-    for (auto const i : {-2, 0, 2}) {
-      for (auto const j : {-2, 0, 2}) {
-        abcg::glUniform2f(m_translationLoc, layer.m_translation.x + j,
-                          layer.m_translation.y + i);
-
-        abcg::glDrawArrays(GL_POINTS, 0, layer.m_quantity);
+    if (modulo) {
+      // The vertex shader wraps the translated positions around the screen
+      abcg::glUniform2f(m_translationLoc, layer.m_translation.x,
+                        layer.m_translation.y);
+      abcg::glDrawArrays(GL_POINTS, 0, layer.m_quantity);
+    } else {
+      for (auto const i : {-2, 0, 2}) {
+        for (auto const j : {-2, 0, 2}) {
+          abcg::glUniform2f(m_translationLoc, layer.m_translation.x + j,
+                            layer.m_translation.y + i);
+
+          abcg::glDrawArrays(GL_POINTS, 0, layer.m_quantity);
+        }
       }
     }
 
@@ -95,6 +106,14 @@ void StarLayers::destroy() {
   }
 }
 
+int StarLayers::getStarCount() const noexcept {
+  auto count{0};
+  for (auto const &layer : m_starLayers) {
+    count += layer.m_quantity;
+  }
+  return count;
+}
+
 void StarLayers::update(const Ship &ship, float deltaTime) {
   for (auto &&[index, layer] : iter::enumerate(m_starLayers)) {
     auto const layerSpeedScale{1.0f / (index + 2.0f)};
@@ -11,15 +11,27 @@
 
 class StarLayers {
 public:
+  // How the layers are repeated across the edges of the screen
+  enum class WrapMode {
+    Replicate, // Draw each layer nine times, offset by -2, 0 and 2
+    Modulo     // Draw each layer once, wrapping positions in the shader
+  };
+
   void create(GLuint program, int quantity);
   void paint();
   void destroy();
   void update(const Ship &ship, float deltaTime);
 
+  void setWrapMode(WrapMode mode) noexcept { m_wrapMode = mode; }
+  [[nodiscard]] int getStarCount() const noexcept;
+
 private:
   GLuint m_program{};
   GLint m_pointSizeLoc{};
   GLint m_translationLoc{};
+  GLint m_wrapAroundLoc{};
+
+  WrapMode m_wrapMode{WrapMode::Modulo};
 
   struct StarLayer {
     GLuint m_VAO{};
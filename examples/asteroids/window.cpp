@@ -81,20 +81,59 @@ void Window::onCreate() {
   abcg::glEnable(GL_PROGRAM_POINT_SIZE);
 #endif
 
+  // Broad phase for collisions in the wrap-around world
+  m_spatialHash.create({-1.0f, -1.0f}, {1.0f, 1.0f}, 0.25f);
+
   // Start pseudo-random number generator
   m_randomEngine.seed(
       std::chrono::steady_clock::now().time_since_epoch().count());
 
+  if (m_starBenchmark) {
+    benchmarkStarLayers();
+  }
+
   restart();
 }
 
+// Prints the average time to draw the star layers with each wrap mode
+void Window::benchmarkStarLayers() {
+  auto const frames{100};
+
+  auto const measure{[&](StarLayers &starLayers, StarLayers::WrapMode mode) {
+    starLayers.setWrapMode(mode);
+
+    // Warm up, then wait for the GPU to finish all frames
+    starLayers.paint();
+    abcg::glFinish();
+    abcg::Timer timer;
+    for ([[maybe_unused]] auto _ : iter::range(frames)) {
+      abcg::glClear(GL_COLOR_BUFFER_BIT);
+      starLayers.paint();
+    }
+    abcg::glFinish();
+    return timer.elapsed() * 1000.0 / frames;
+  }};
+
+  fmt::print("{:>10} {:>12} {:>12}\n", "Stars", "Replicate", "Modulo");
+  for (auto const starCount : {100'000, 1'000'000}) {
+    // Layers hold 1 to 5 times the base quantity, 15 times in total
+    StarLayers starLayers;
+    starLayers.create(m_starsProgram, starCount / 15);
+    auto const replicate{measure(starLayers, StarLayers::WrapMode::Replicate)};
+    auto const modulo{measure(starLayers, StarLayers::WrapMode::Modulo)};
+    fmt::print("{:>10} {:>9.3f} ms {:>9.3f} ms\n", starLayers.getStarCount(),
+               replicate, modulo);
+    starLayers.destroy();
+  }
+}
+
 void Window::restart() {
   m_gameData.m_state = State::Playing;
 
   m_starLayers.create(m_starsProgram, 25);
   m_ship.create(m_objectsProgram);
-  m_asteroids.create(m_objectsProgram, 3);
-  m_bullets.create(m_objectsProgram);
+  m_asteroids.create(3);
+  m_bullets.create();
 }
 
 void Window::onUpdate() {
@@ -171,59 +210,66 @@ void Window::onDestroy() {
 }
 
 void Window::checkCollisions() {
+  auto &asteroids{m_asteroids.m_asteroids}; // Shortcut
+  auto &bullets{m_bullets.m_bullets};       // Shortcut
+
+  // Index the bounding circles of the asteroids
+  std::vector<glm::vec2> positions;
+  std::vector<float> radii;
+  for (auto const index : iter::range(asteroids.getSize())) {
+    positions.emplace_back(asteroids.get<Asteroids::TranslationX>()[index],
+                           asteroids.get<Asteroids::TranslationY>()[index]);
+    radii.push_back(asteroids.get<Asteroids::Scale>()[index] * 0.85f);
+  }
+  m_spatialHash.build(positions, radii);
+
   // Check collision between ship and asteroids
-  for (auto const &asteroid : m_asteroids.m_asteroids) {
-    auto const asteroidTranslation{asteroid.m_translation};
-    auto const distance{
-        glm::distance(m_ship.m_translation, asteroidTranslation)};
-
-    if (distance < m_ship.m_scale * 0.9f + asteroid.m_scale * 0.85f) {
-      m_gameData.m_state = State::GameOver;
-      m_restartWaitTimer.restart();
+  m_spatialHash.query(m_ship.m_translation, m_ship.m_scale * 0.9f,
+                      [&](std::size_t) {
+                        m_gameData.m_state = State::GameOver;
+                        m_restartWaitTimer.restart();
+                      });
+
+  // Check collision between bullets and asteroids. Indices are visited in
+  // decreasing order, so that each removal moves an already visited bullet.
+  std::vector<uint8_t> hit(asteroids.getSize());
+  for (auto index{bullets.getSize()}; index-- > 0;) {
+    glm::vec2 const translation{bullets.get<Bullets::TranslationX>()[index],
+                                bullets.get<Bullets::TranslationY>()[index]};
+    auto dead{false};
+    m_spatialHash.query(translation, m_bullets.m_scale,
+                        [&](std::size_t asteroid) {
+                          hit[asteroid] = 1;
+                          dead = true;
+                        });
+    if (dead) {
+      bullets.remove(index);
     }
   }
 
-  // Check collision between bullets and asteroids
-  for (auto &bullet : m_bullets.m_bullets) {
-    if (bullet.m_dead)
+  // Break asteroids marked as hit, in decreasing order of index as above.
+  // New asteroids are appended after the visited range.
+  for (auto index{hit.size()}; index-- > 0;) {
+    if (hit[index] == 0)
       continue;
 
-    for (auto &asteroid : m_asteroids.m_asteroids) {
-      for (auto const i : {-2, 0, 2}) {
-        for (auto const j : {-2, 0, 2}) {
-          auto const asteroidTranslation{asteroid.m_translation +
-                                         glm::vec2(i, j)};
-          auto const distance{
-              glm::distance(bullet.m_translation, asteroidTranslation)};
-
-          if (distance < m_bullets.m_scale + asteroid.m_scale * 0.85f) {
-            asteroid.m_hit = true;
-            bullet.m_dead = true;
-          }
-        }
+    auto const translation{positions[index]};
+    auto const scale{asteroids.get<Asteroids::Scale>()[index]};
+    if (scale > 0.10f) {
+      std::uniform_real_distribution randomDist{-1.0f, 1.0f};
+      for ([[maybe_unused]] auto _ : iter::range(3)) {
+        glm::vec2 const offset{randomDist(m_randomEngine),
+                               randomDist(m_randomEngine)};
+        auto const newScale{scale * 0.5f};
+        m_asteroids.addAsteroid(translation + offset * newScale, newScale);
       }
     }
-
-    // Break asteroids marked as hit
-    for (auto const &asteroid : m_asteroids.m_asteroids) {
-      if (asteroid.m_hit && asteroid.m_scale > 0.10f) {
-        std::uniform_real_distribution randomDist{-1.0f, 1.0f};
-        std::generate_n(std::back_inserter(m_asteroids.m_asteroids), 3, [&]() {
-          glm::vec2 const offset{randomDist(m_randomEngine),
-                                 randomDist(m_randomEngine)};
-          auto const newScale{asteroid.m_scale * 0.5f};
-          return m_asteroids.makeAsteroid(
-              asteroid.m_translation + offset * newScale, newScale);
-        });
-      }
-    }
-
-    m_asteroids.m_asteroids.remove_if([](auto const &a) { return a.m_hit; });
+    asteroids.remove(index);
   }
 }
 
 void Window::checkWinCondition() {
-  if (m_asteroids.m_asteroids.empty()) {
+  if (m_asteroids.m_asteroids.isEmpty()) {
     m_gameData.m_state = State::Win;
     m_restartWaitTimer.restart();
   }
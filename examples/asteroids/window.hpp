@@ -11,6 +11,9 @@
 #include "starlayers.hpp"
 
 class Window : public abcg::OpenGLWindow {
+public:
+  void enableStarBenchmark() noexcept { m_starBenchmark = true; }
+
 protected:
   void onEvent(SDL_Event const &event) override;
   void onCreate() override;
@@ -33,12 +36,17 @@ private:
   Ship m_ship;
   StarLayers m_starLayers;
 
+  abcg::SpatialHash2D m_spatialHash;
+
   abcg::Timer m_restartWaitTimer;
 
   ImFont *m_font{};
 
   std::default_random_engine m_randomEngine;
 
+  bool m_starBenchmark{};
+
+  void benchmarkStarLayers();
   void restart();
   void checkCollisions();
   void checkWinCondition();
@@ -1,8 +1,6 @@
 #ifndef BULLETS_HPP_
 #define BULLETS_HPP_
 
-#include <list>
-
 #include "abcgOpenGL.hpp"
 
 #include "gamedata.hpp"
@@ -12,30 +10,26 @@ class OpenGLWindow;
 
 class Bullets {
 public:
-  void create(GLuint program);
+  void create();
   void paint();
   void destroy();
   void update(Ship &ship, const GameData &gameData, float deltaTime);
 
-  struct Bullet {
-    bool m_dead{};
-    glm::vec2 m_translation{};
-    glm::vec2 m_velocity{};
+  // Columns of m_bullets
+  enum Attribute : std::size_t {
+    TranslationX,
+    TranslationY,
+    VelocityX,
+    VelocityY
   };
 
-  std::list<Bullet> m_bullets;
+  abcg::EntityPool<float, float, float, float> m_bullets;
 
   float m_scale{0.015f};
 
 private:
-  GLuint m_program{};
-  GLint m_colorLoc{};
-  GLint m_rotationLoc{};
-  GLint m_translationLoc{};
-  GLint m_scaleLoc{};
-
-  GLuint m_VAO{};
-  GLuint m_VBO{};
+  abcg::OpenGLShapeBatch m_shapeBatch;
+  std::size_t m_shape{};
 };
 
 #endif
\ No newline at end of file
@@ -47,6 +47,9 @@ void Window::onCreate() {
   abcg::glEnable(GL_PROGRAM_POINT_SIZE);
 #endif
 
+  // Broad phase for collisions in the wrap-around world
+  m_spatialHash.create({-1.0f, -1.0f}, {1.0f, 1.0f}, 0.25f);
+
   // Start pseudo-random number generator
   m_randomEngine.seed(
       std::chrono::steady_clock::now().time_since_epoch().count());
@@ -58,8 +61,8 @@ void Window::restart() {
   m_gameData.m_state = State::Playing;
 
   m_ship.create(m_objectsProgram);
-  m_asteroids.create(m_objectsProgram, 3);
-  m_bullets.create(m_objectsProgram);
+  m_asteroids.create(3);
+  m_bullets.create();
 }
 
 void Window::onUpdate() {
@@ -135,59 +138,66 @@ void Window::onDestroy() {
 }
 
 void Window::checkCollisions() {
+  auto &asteroids{m_asteroids.m_asteroids}; // Shortcut
+  auto &bullets{m_bullets.m_bullets};       // Shortcut
+
+  // Index the bounding circles of the asteroids
+  std::vector<glm::vec2> positions;
+  std::vector<float> radii;
+  for (auto const index : iter::range(asteroids.getSize())) {
+    positions.emplace_back(asteroids.get<Asteroids::TranslationX>()[index],
+                           asteroids.get<Asteroids::TranslationY>()[index]);
+    radii.push_back(asteroids.get<Asteroids::Scale>()[index] * 0.85f);
+  }
+  m_spatialHash.build(positions, radii);
+
   // Check collision between ship and asteroids
-  for (auto const &asteroid : m_asteroids.m_asteroids) {
-    auto const asteroidTranslation{asteroid.m_translation};
-    auto const distance{
-        glm::distance(m_ship.m_translation, asteroidTranslation)};
-
-    if (distance < m_ship.m_scale * 0.9f + asteroid.m_scale * 0.85f) {
-      m_gameData.m_state = State::GameOver;
-      m_restartWaitTimer.restart();
+  m_spatialHash.query(m_ship.m_translation, m_ship.m_scale * 0.9f,
+                      [&](std::size_t) {
+                        m_gameData.m_state = State::GameOver;
+                        m_restartWaitTimer.restart();
+                      });
+
+  // Check collision between bullets and asteroids. Indices are visited in
+  // decreasing order, so that each removal moves an already visited bullet.
+  std::vector<uint8_t> hit(asteroids.getSize());
+  for (auto index{bullets.getSize()}; index-- > 0;) {
+    glm::vec2 const translation{bullets.get<Bullets::TranslationX>()[index],
+                                bullets.get<Bullets::TranslationY>()[index]};
+    auto dead{false};
+    m_spatialHash.query(translation, m_bullets.m_scale,
+                        [&](std::size_t asteroid) {
+                          hit[asteroid] = 1;
+                          dead = true;
+                        });
+    if (dead) {
+      bullets.remove(index);
     }
   }
 
-  // Check collision between bullets and asteroids
-  for (auto &bullet : m_bullets.m_bullets) {
-    if (bullet.m_dead)
+  // Break asteroids marked as hit, in decreasing order of index as above.
+  // New asteroids are appended after the visited range.
+  for (auto index{hit.size()}; index-- > 0;) {
+    if (hit[index] == 0)
       continue;
 
-    for (auto &asteroid : m_asteroids.m_asteroids) {
-      for (auto const i : {-2, 0, 2}) {
-        for (auto const j : {-2, 0, 2}) {
-          auto const asteroidTranslation{asteroid.m_translation +
-                                         glm::vec2(i, j)};
-          auto const distance{
-              glm::distance(bullet.m_translation, asteroidTranslation)};
-
-          if (distance < m_bullets.m_scale + asteroid.m_scale * 0.85f) {
-            asteroid.m_hit = true;
-            bullet.m_dead = true;
-          }
-        }
+    auto const translation{positions[index]};
+    auto const scale{asteroids.get<Asteroids::Scale>()[index]};
+    if (scale > 0.10f) {
+      std::uniform_real_distribution randomDist{-1.0f, 1.0f};
+      for ([[maybe_unused]] auto _ : iter::range(3)) {
+        glm::vec2 const offset{randomDist(m_randomEngine),
+                               randomDist(m_randomEngine)};
+        auto const newScale{scale * 0.5f};
+        m_asteroids.addAsteroid(translation + offset * newScale, newScale);
       }
     }
-
-    // Break asteroids marked as hit
-    for (auto const &asteroid : m_asteroids.m_asteroids) {
-      if (asteroid.m_hit && asteroid.m_scale > 0.10f) {
-        std::uniform_real_distribution randomDist{-1.0f, 1.0f};
-        std::generate_n(std::back_inserter(m_asteroids.m_asteroids), 3, [&]() {
-          glm::vec2 const offset{randomDist(m_randomEngine),
-                                 randomDist(m_randomEngine)};
-          auto const newScale{asteroid.m_scale * 0.5f};
-          return m_asteroids.makeAsteroid(
-              asteroid.m_translation + offset * newScale, newScale);
-        });
-      }
-    }
-
-    m_asteroids.m_asteroids.remove_if([](auto const &a) { return a.m_hit; });
+    asteroids.remove(index);
   }
 }
 
 void Window::checkWinCondition() {
-  if (m_asteroids.m_asteroids.empty()) {
+  if (m_asteroids.m_asteroids.isEmpty()) {
     m_gameData.m_state = State::Win;
     m_restartWaitTimer.restart();
   }
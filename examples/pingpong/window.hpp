@@ -30,6 +30,8 @@ private:
   Bullets m_bullets;
   Ship m_ship;
 
+  abcg::SpatialHash2D m_spatialHash;
+
   abcg::Timer m_restartWaitTimer;
 
   ImFont *m_font{};
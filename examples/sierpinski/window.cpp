@@ -4,9 +4,42 @@ void Window::onCreate() {
   auto const *vertexShader{R"gl(#version 300 es
     layout(location = 0) in vec2 inPosition;
 
-    void main() { 
+    void main() {
       gl_PointSize = 2.0;
-      gl_Position = vec4(inPosition, 0, 1); 
+      gl_Position = vec4(inPosition, 0, 1);
+    }
+  )gl"};
+
+  // Computes the next point of each sequence on the GPU. The new position is
+  // both drawn and captured by transform feedback for the next frame
+  auto const *feedbackVertexShader{R"gl(#version 300 es
+    layout(location = 0) in vec2 inPosition;
+
+    uniform uint seed;
+
+    out vec2 outPosition;
+
+    // Integer hash (lowbias32 by Chris Wellons)
+    uint hash(uint x) {
+      x ^= x >> 16u;
+      x *= 0x7feb352du;
+      x ^= x >> 15u;
+      x *= 0x846ca68bu;
+      x ^= x >> 16u;
+      return x;
+    }
+
+    void main() {
+      // Randomly pick a triangle vertex, with a different choice for each
+      // sequence and frame
+      uint index = hash(uint(gl_VertexID) ^ hash(seed)) % 3u;
+      vec2 vertex = index == 0u ? vec2(0, 1)
+                                : (index == 1u ? vec2(-1, -1) : vec2(1, -1));
+
+      outPosition = (inPosition + vertex) / 2.0;
+
+      gl_PointSize = 2.0;
+      gl_Position = vec4(outPosition, 0, 1);
     }
   )gl"};
 
@@ -23,6 +56,30 @@ void Window::onCreate() {
       {{.source = vertexShader, .stage = abcg::ShaderStage::Vertex},
        {.source = fragmentShader, .stage = abcg::ShaderStage::Fragment}});
 
+  // Create shader program of the transform feedback generator. The captured
+  // output must be declared before linking, so the program is linked here
+  auto const shaders{abcg::triggerOpenGLShaderCompile(
+      {{.source = feedbackVertexShader, .stage = abcg::ShaderStage::Vertex},
+       {.source = fragmentShader, .stage = abcg::ShaderStage::Fragment}})};
+  abcg::checkOpenGLShaderCompile(shaders);
+
+  m_feedbackProgram = abcg::glCreateProgram();
+  for (auto const &shader : shaders) {
+    abcg::glAttachShader(m_feedbackProgram, shader.shader);
+  }
+  std::array<GLchar const *, 1> const varyings{"outPosition"};
+  abcg::glTransformFeedbackVaryings(m_feedbackProgram,
+                                    gsl::narrow<GLsizei>(varyings.size()),
+                                    varyings.data(), GL_INTERLEAVED_ATTRIBS);
+  abcg::glLinkProgram(m_feedbackProgram);
+  for (auto const &shader : shaders) {
+    abcg::glDetachShader(m_feedbackProgram, shader.shader);
+    abcg::glDeleteShader(shader.shader);
+  }
+  abcg::checkOpenGLShaderLink(m_feedbackProgram);
+
+  m_seedLoc = abcg::glGetUniformLocation(m_feedbackProgram, "seed");
+
   // Clear window
   abcg::glClearColor(0, 0, 0, 1);
   abcg::glClear(GL_COLOR_BUFFER_BIT);
@@ -45,38 +102,22 @@ void Window::onCreate() {
   std::discrete_distribution<int> intDistribution({30, 50, 20});
   m_P.x = intDistribution(m_randomEngine);
   m_P.y = intDistribution(m_randomEngine);
-}
 
-void Window::onPaint() {
-  // Create OpenGL buffers for drawing the point at m_P
+  // Create OpenGL buffers once. They are reused in every frame
   setupModel();
+}
 
+void Window::onPaint() {
   // Set the viewport
   abcg::glViewport(0, 0, m_viewportSize.x, m_viewportSize.y);
 
-  // Start using the shader program
-  abcg::glUseProgram(m_program);
-  // Start using VAO
-  abcg::glBindVertexArray(m_VAO);
-
-  // Draw a single point
-  abcg::glDrawArrays(GL_POINTS, 0, 1);
-
-  // End using VAO
-  abcg::glBindVertexArray(0);
-  // End using the shader program
-  abcg::glUseProgram(0);
-
-  // Randomly pick the index of a triangle vertex
-  std::uniform_int_distribution<int> intDistribution(0, m_points.size() - 1);
-  auto const index{intDistribution(m_randomEngine)};
-
-  // The new position is the midpoint between the current position and the
-  // chosen vertex position
-  m_P = (m_P + m_points.at(index)) / 2.0f;
-
-  // Print coordinates to console
-  fmt::print("({:+.2f}, {:+.2f})\n", m_P.x, m_P.y);
+  auto const pointCount{gsl::narrow<std::size_t>(m_pointsPerFrame)};
+  if (m_generator == Generator::CPU) {
+    paintBatch(pointCount);
+  } else {
+    paintFeedback(pointCount);
+  }
+  m_totalPointCount += pointCount;
 }
 
 void Window::onPaintUI() {
@@ -84,12 +125,41 @@ void Window::onPaintUI() {
 
   {
     ImGui::SetNextWindowPos(ImVec2(5, 81));
-    ImGui::Begin(" ", nullptr, ImGuiWindowFlags_NoDecoration);
+    ImGui::Begin(" ", nullptr,
+                 ImGuiWindowFlags_NoDecoration |
+                     ImGuiWindowFlags_AlwaysAutoResize);
 
     if (ImGui::Button("Clear window", ImVec2(150, 30))) {
       abcg::glClear(GL_COLOR_BUFFER_BIT);
     }
 
+    ImGui::PushItemWidth(150);
+
+    // Where the points are generated
+    std::array generators{"CPU", "Transform feedback"};
+    auto const currentIndex{static_cast<std::size_t>(m_generator)};
+    if (ImGui::BeginCombo("Generator", generators.at(currentIndex))) {
+      for (auto index{0U}; index < generators.size(); ++index) {
+        bool const isSelected{currentIndex == index};
+        if (ImGui::Selectable(generators.at(index), isSelected))
+          m_generator = static_cast<Generator>(index);
+
+        if (isSelected)
+          ImGui::SetItemDefaultFocus();
+      }
+      ImGui::EndCombo();
+    }
+
+    // Number of iterations of the chaos game per frame
+    ImGui::SliderInt("Points/frame", &m_pointsPerFrame, 1, 1 << 22, "%d",
+                     ImGuiSliderFlags_Logarithmic |
+                         ImGuiSliderFlags_AlwaysClamp);
+
+    ImGui::PopItemWidth();
+
+    ImGui::TextUnformatted(
+        fmt::format("{} points drawn", m_totalPointCount).c_str());
+
     ImGui::End();
   }
 }
@@ -101,25 +171,19 @@ void Window::onResize(glm::ivec2 const &size) {
 }
 
 void Window::onDestroy() {
-  // Release shader program, VBO and VAO
+  // Release shader programs, VBOs and VAOs
   abcg::glDeleteProgram(m_program);
+  abcg::glDeleteProgram(m_feedbackProgram);
   abcg::glDeleteBuffers(1, &m_VBOVertices);
   abcg::glDeleteVertexArrays(1, &m_VAO);
+  abcg::glDeleteBuffers(2, m_feedbackVBOs.data());
+  abcg::glDeleteVertexArrays(2, m_feedbackVAOs.data());
 }
 
 void Window::setupModel() {
-  // Release previous VBO and VAO
-  abcg::glDeleteBuffers(1, &m_VBOVertices);
-  abcg::glDeleteVertexArrays(1, &m_VAO);
-
-  // Generate a new VBO and get the associated ID
+  // Generate a new VBO and get the associated ID. Its data store is
+  // allocated when the first batch of points is uploaded
   abcg::glGenBuffers(1, &m_VBOVertices);
-  // Bind VBO in order to use it
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBOVertices);
-  // Upload data to VBO
-  abcg::glBufferData(GL_ARRAY_BUFFER, sizeof(m_P), &m_P, GL_STATIC_DRAW);
-  // Unbinding the VBO is allowed (data can be released now)
-  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
 
   // Get location of attributes in the program
   auto const positionAttribute{
@@ -140,3 +204,115 @@ void Window::setupModel() {
   // End of binding to current VAO
   abcg::glBindVertexArray(0);
 }
+
+void Window::setupFeedbackModel(std::size_t pointCount) {
+  // Release previous VBOs and VAOs
+  abcg::glDeleteBuffers(2, m_feedbackVBOs.data());
+  abcg::glDeleteVertexArrays(2, m_feedbackVAOs.data());
+
+  // Start each sequence at a vertex of the triangle, which already belongs
+  // to the Sierpinski triangle
+  std::vector<glm::vec2> positions(pointCount);
+  for (auto &&[index, position] : iter::enumerate(positions)) {
+    position = m_points.at(index % m_points.size());
+  }
+
+  abcg::glGenBuffers(2, m_feedbackVBOs.data());
+  abcg::glGenVertexArrays(2, m_feedbackVAOs.data());
+
+  for (auto &&[VAO, VBO] : iter::zip(m_feedbackVAOs, m_feedbackVBOs)) {
+    // Upload the initial positions to both buffers
+    abcg::glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    abcg::glBufferData(
+        GL_ARRAY_BUFFER,
+        gsl::narrow<GLsizeiptr>(positions.size() * sizeof(glm::vec2)),
+        positions.data(), GL_STREAM_COPY);
+
+    // Bind vertex attributes to current VAO
+    abcg::glBindVertexArray(VAO);
+    abcg::glEnableVertexAttribArray(0);
+    abcg::glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    abcg::glBindVertexArray(0);
+  }
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  m_feedbackSource = 0;
+  m_feedbackPointCount = pointCount;
+}
+
+// Generates a batch of points on the CPU, uploads them to the reused VBO and
+// draws them with a single call
+void Window::paintBatch(std::size_t pointCount) {
+  // Each random number in [0, 3^20) gives 20 random vertex indices, one per
+  // base-3 digit
+  std::uniform_int_distribution<uint32_t> digitsDistribution(0, 3486784400);
+
+  m_batch.resize(pointCount);
+  std::size_t index{};
+  while (index < pointCount) {
+    auto digits{digitsDistribution(m_randomEngine)};
+    for (auto const end{std::min(index + 20, pointCount)}; index < end;
+         ++index) {
+      // The new position is the midpoint between the current position and
+      // the chosen vertex position
+      m_P = (m_P + m_points[digits % 3]) / 2.0f;
+      m_batch[index] = m_P;
+      digits /= 3;
+    }
+  }
+
+  // Orphan the data store of the VBO so that the upload does not wait for
+  // the previous draw. The store only grows, so it is reallocated by the
+  // driver rather than resized
+  m_batchCapacity = std::max(m_batchCapacity, pointCount);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBOVertices);
+  abcg::glBufferData(
+      GL_ARRAY_BUFFER,
+      gsl::narrow<GLsizeiptr>(m_batchCapacity * sizeof(glm::vec2)), nullptr,
+      GL_STREAM_DRAW);
+  abcg::glBufferSubData(
+      GL_ARRAY_BUFFER, 0,
+      gsl::narrow<GLsizeiptr>(pointCount * sizeof(glm::vec2)),
+      m_batch.data());
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  // Start using the shader program
+  abcg::glUseProgram(m_program);
+  // Start using VAO
+  abcg::glBindVertexArray(m_VAO);
+
+  // Draw the whole batch
+  abcg::glDrawArrays(GL_POINTS, 0, gsl::narrow<GLsizei>(pointCount));
+
+  // End using VAO
+  abcg::glBindVertexArray(0);
+  // End using the shader program
+  abcg::glUseProgram(0);
+}
+
+// Advances one sequence of points per vertex on the GPU. The positions are
+// read from one buffer and the next positions are drawn and captured into the
+// other buffer, so no data is transferred from the CPU
+void Window::paintFeedback(std::size_t pointCount) {
+  if (pointCount != m_feedbackPointCount) {
+    setupFeedbackModel(pointCount);
+  }
+  auto const target{1 - m_feedbackSource};
+
+  abcg::glUseProgram(m_feedbackProgram);
+  abcg::glUniform1ui(m_seedLoc, gsl::narrow_cast<GLuint>(m_randomEngine()));
+
+  abcg::glBindVertexArray(m_feedbackVAOs.at(m_feedbackSource));
+  abcg::glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0,
+                         m_feedbackVBOs.at(target));
+
+  abcg::glBeginTransformFeedback(GL_POINTS);
+  abcg::glDrawArrays(GL_POINTS, 0, gsl::narrow<GLsizei>(pointCount));
+  abcg::glEndTransformFeedback();
+
+  abcg::glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+  abcg::glBindVertexArray(0);
+  abcg::glUseProgram(0);
+
+  m_feedbackSource = target;
+}
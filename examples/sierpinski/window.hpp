@@ -14,17 +14,38 @@ protected:
   void onDestroy() override;
 
 private:
+  // Where the points of the chaos game are generated
+  enum class Generator { CPU, TransformFeedback };
+
   glm::ivec2 m_viewportSize{};
 
   GLuint m_VAO{};
   GLuint m_VBOVertices{};
   GLuint m_program{};
 
-  std::default_random_engine m_randomEngine;
+  // Ping-pong buffers of the transform feedback generator. Each frame reads
+  // the positions from one buffer and writes the next positions to the other
+  std::array<GLuint, 2> m_feedbackVAOs{};
+  std::array<GLuint, 2> m_feedbackVBOs{};
+  std::size_t m_feedbackSource{};
+  GLuint m_feedbackProgram{};
+  GLint m_seedLoc{};
+
+  std::mt19937 m_randomEngine;
   std::array<glm::vec2, 3> const m_points{{{0, 1}, {-1, -1}, {1, -1}}};
   glm::vec2 m_P{};
 
+  Generator m_generator{Generator::CPU};
+  int m_pointsPerFrame{1};
+  std::vector<glm::vec2> m_batch;
+  std::size_t m_batchCapacity{};
+  std::size_t m_feedbackPointCount{};
+  uint64_t m_totalPointCount{};
+
   void setupModel();
+  void setupFeedbackModel(std::size_t pointCount);
+  void paintBatch(std::size_t pointCount);
+  void paintFeedback(std::size_t pointCount);
 };
 
-#endif
\ No newline at end of file
+#endif
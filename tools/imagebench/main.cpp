@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <random>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <cppitertools/itertools.hpp>
+
+#include "abcg.hpp"
+#include "abcgImage.hpp"
+
+namespace {
+// Scalar baseline of abcg::flipHorizontally. Reverses the pixels of each row
+// one pixel at a time through a temporary row
+void scalarFlipHorizontally(SDL_Surface &surface) {
+  auto const bytesPerPixel{gsl::narrow<long>(surface.format->BytesPerPixel)};
+  auto const widthInBytes{
+      gsl::narrow<std::size_t>(surface.w * surface.format->BytesPerPixel)};
+  auto const height{gsl::narrow<std::size_t>(surface.h)};
+  std::span const pixels{static_cast<std::byte *>(surface.pixels),
+                         widthInBytes * height};
+  std::vector<std::byte> pixelRow(widthInBytes);
+
+  for (auto const rowIndex : iter::range(height)) {
+    auto const row{pixels.subspan(widthInBytes * rowIndex, widthInBytes)};
+    auto source{row.end()};
+    auto destination{pixelRow.begin()};
+    for ([[maybe_unused]] auto const pixelIndex : iter::range(surface.w)) {
+      source -= bytesPerPixel;
+      destination = std::copy(source, source + bytesPerPixel, destination);
+    }
+    std::ranges::copy(pixelRow, row.begin());
+  }
+}
+
+// Scalar baseline of abcg::flipVertically. Swaps the top and bottom rows
+// through a temporary row
+void scalarFlipVertically(SDL_Surface &surface) {
+  auto const widthInBytes{
+      gsl::narrow<std::size_t>(surface.w * surface.format->BytesPerPixel)};
+  auto const height{gsl::narrow<std::size_t>(surface.h)};
+  std::span const pixels{static_cast<std::byte *>(surface.pixels),
+                         widthInBytes * height};
+  std::vector<std::byte> pixelRow(widthInBytes);
+
+  for (auto const rowIndex : iter::range(height / 2)) {
+    auto const top{pixels.subspan(widthInBytes * rowIndex, widthInBytes)};
+    auto const bottom{
+        pixels.subspan(widthInBytes * (height - rowIndex - 1), widthInBytes)};
+    std::ranges::copy(top, pixelRow.begin());
+    std::ranges::copy(bottom, top.begin());
+    std::ranges::copy(pixelRow, bottom.begin());
+  }
+}
+} // namespace
+
+// Measures the throughput of abcg::flipHorizontally and abcg::flipVertically
+// on RGB and RGBA images of common sizes, and compares it with the scalar
+// loops they replaced
+int main(int argc, char **argv) {
+  std::span const args{argv, gsl::narrow<std::size_t>(argc)};
+  auto const iterations{args.size() == 2 ? std::atoi(args[1]) : 10};
+  if (args.size() > 2 || iterations <= 0) {
+    fmt::print(stderr, "Usage: {} [iterations]\n", args[0]);
+    return -1;
+  }
+
+  struct Format {
+    std::string_view name;
+    Uint32 format;
+  };
+  std::array const formats{Format{"RGB", SDL_PIXELFORMAT_RGB24},
+                           Format{"RGBA", SDL_PIXELFORMAT_RGBA32}};
+  std::array const sizes{glm::ivec2{1920, 1080}, glm::ivec2{3840, 2160},
+                         glm::ivec2{7680, 4320}};
+
+  std::default_random_engine randomEngine;
+  std::uniform_int_distribution<int> distribution(0, 255);
+
+  for (auto const &[format, size] : iter::product(formats, sizes)) {
+    auto *const surface{SDL_CreateRGBSurfaceWithFormat(0, size.x, size.y, 0,
+                                                       format.format)};
+    if (surface == nullptr) {
+      fmt::print(stderr, "{}\n", SDL_GetError());
+      return -1;
+    }
+    auto const sizeInBytes{gsl::narrow<std::size_t>(surface->pitch) *
+                           gsl::narrow<std::size_t>(surface->h)};
+    std::span const pixels{static_cast<Uint8 *>(surface->pixels), sizeInBytes};
+    for (auto &pixel : pixels) {
+      pixel = gsl::narrow_cast<Uint8>(distribution(randomEngine));
+    }
+
+    // Returns the throughput of a function, in GB/s
+    auto const measure{[&](auto const &function) {
+      function(*surface);
+      abcg::Timer timer;
+      for ([[maybe_unused]] auto const index : iter::range(iterations)) {
+        function(*surface);
+      }
+      return gsl::narrow_cast<double>(sizeInBytes) * iterations /
+             timer.elapsed() / 1e9;
+    }};
+
+    // The optimized and scalar flips must give the same result
+    std::vector<Uint8> const original(pixels.begin(), pixels.end());
+    for (auto const &[flip, scalarFlip] :
+         {std::pair{&abcg::flipHorizontally, &scalarFlipHorizontally},
+          std::pair{&abcg::flipVertically, &scalarFlipVertically}}) {
+      flip(*surface);
+      std::vector<Uint8> const flipped(pixels.begin(), pixels.end());
+      std::ranges::copy(original, pixels.begin());
+      scalarFlip(*surface);
+      if (!std::ranges::equal(flipped, pixels)) {
+        fmt::print(stderr, "Flipped images differ from the scalar baseline\n");
+        return -1;
+      }
+      std::ranges::copy(original, pixels.begin());
+    }
+
+    auto const horizontal{measure(abcg::flipHorizontally)};
+    auto const scalarHorizontal{measure(scalarFlipHorizontally)};
+    auto const vertical{measure(abcg::flipVertically)};
+    auto const scalarVertical{measure(scalarFlipVertically)};
+    fmt::print("{:4} {:4}x{:<4}  horizontal {:6.2f} GB/s (scalar {:6.2f} "
+               "GB/s)  vertical {:6.2f} GB/s (scalar {:6.2f} GB/s)\n",
+               format.name, size.x, size.y, horizontal, scalarHorizontal,
+               vertical, scalarVertical);
+
+    SDL_FreeSurface(surface);
+  }
+  return 0;
+}
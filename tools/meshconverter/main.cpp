@@ -0,0 +1,39 @@
+#include <span>
+#include <string_view>
+
+#include "abcgMesh.hpp"
+
+int main(int argc, char **argv) {
+  std::span const args{argv, gsl::narrow<std::size_t>(argc)};
+  auto interleaved{true};
+  auto optimize{false};
+  auto validArgs{args.size() >= 3};
+  for (std::string_view const arg :
+       args.subspan(std::min(args.size(), std::size_t{3}))) {
+    if (arg == "--deinterleaved") {
+      interleaved = false;
+    } else if (arg == "--optimize") {
+      optimize = true;
+    } else {
+      validArgs = false;
+    }
+  }
+  if (!validArgs) {
+    fmt::print(stderr,
+               "Usage: {} input.obj output.abcgmesh [--deinterleaved] "
+               "[--optimize]\n",
+               args[0]);
+    return -1;
+  }
+
+  try {
+    auto const mesh{abcg::loadOBJ(args[1], optimize)};
+    abcg::saveMesh(args[2], mesh, interleaved);
+    fmt::print("{}: {} vertices, {} indices\n", args[2], mesh.positions.size(),
+               mesh.indices.size());
+  } catch (std::exception const &exception) {
+    fmt::print(stderr, "{}\n", exception.what());
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,125 @@
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+#include <cppitertools/itertools.hpp>
+
+#include "abcgVulkan.hpp"
+
+// Measures the time to create a set of graphics pipelines with the device's
+// persistent pipeline cache. Run once with --cold to start from an empty cache,
+// then again without arguments to measure a warm start.
+class Window : public abcg::VulkanWindow {
+protected:
+  void onCreate() override;
+  void onDestroy() override;
+
+private:
+  std::vector<abcg::VulkanShader> m_shaders;
+  std::vector<abcg::VulkanPipeline> m_pipelines;
+};
+
+void Window::onCreate() {
+  std::array const sources{
+      abcg::ShaderSource{.source = R"glsl(#version 450
+layout(location = 0) out vec3 fragColor;
+void main() {
+  vec2 position = vec2(gl_VertexIndex & 1, gl_VertexIndex >> 1) * 2.0 - 1.0;
+  fragColor = vec3(position * 0.5 + 0.5, 0.5);
+  gl_Position = vec4(position, 0.0, 1.0);
+})glsl",
+                         .stage = abcg::ShaderStage::Vertex},
+      abcg::ShaderSource{.source = R"glsl(#version 450
+layout(location = 0) in vec3 fragColor;
+layout(location = 0) out vec4 outColor;
+void main() { outColor = vec4(pow(fragColor, vec3(2.2)), 1.0); })glsl",
+                         .stage = abcg::ShaderStage::Fragment}};
+  m_shaders = abcg::compileVulkanShaders(getDevice(), sources);
+
+  // Distinct combinations of fixed-function state, each of which results in a
+  // different pipeline
+  std::array const topologies{vk::PrimitiveTopology::eTriangleList,
+                              vk::PrimitiveTopology::eTriangleStrip,
+                              vk::PrimitiveTopology::eTriangleFan};
+  std::array const cullModes{vk::CullModeFlagBits::eNone,
+                             vk::CullModeFlagBits::eBack};
+  std::array const frontFaces{vk::FrontFace::eCounterClockwise,
+                              vk::FrontFace::eClockwise};
+  std::array const blendEnables{VK_FALSE, VK_TRUE};
+
+  abcg::Timer timer;
+  for (auto const &[topology, cullMode, frontFace, blendEnable] :
+       iter::product(topologies, cullModes, frontFaces, blendEnables)) {
+    auto &pipeline{m_pipelines.emplace_back()};
+    pipeline.create(
+        getSwapchain(),
+        {.shaders = m_shaders,
+         .inputAssemblyState = {.topology = topology},
+         .rasterizationState = {.polygonMode = vk::PolygonMode::eFill,
+                                .cullMode = cullMode,
+                                .frontFace = frontFace,
+                                .lineWidth = 1.0f},
+         .colorBlendAttachment = vk::PipelineColorBlendAttachmentState{
+             .blendEnable = blendEnable,
+             .srcColorBlendFactor = vk::BlendFactor::eSrcAlpha,
+             .dstColorBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha,
+             .colorBlendOp = vk::BlendOp::eAdd,
+             .srcAlphaBlendFactor = vk::BlendFactor::eOne,
+             .dstAlphaBlendFactor = vk::BlendFactor::eZero,
+             .alphaBlendOp = vk::BlendOp::eAdd,
+             .colorWriteMask = vk::ColorComponentFlagBits::eR |
+                               vk::ColorComponentFlagBits::eG |
+                               vk::ColorComponentFlagBits::eB |
+                               vk::ColorComponentFlagBits::eA}});
+  }
+  fmt::print("Created {} pipelines in {:.3f} ms\n", m_pipelines.size(),
+             timer.elapsed() * 1000.0);
+
+  // Quit right away. The pipeline cache is written back when the device is
+  // destroyed
+  SDL_Event event{.type = SDL_QUIT};
+  SDL_PushEvent(&event);
+}
+
+void Window::onDestroy() {
+  for (auto &pipeline : m_pipelines) {
+    pipeline.destroy();
+  }
+  for (auto &shader : m_shaders) {
+    shader.destroy();
+  }
+}
+
+int main(int argc, char **argv) {
+  std::span const args{argv, gsl::narrow<std::size_t>(argc)};
+  auto const cold{args.size() > 1 && std::string_view{args[1]} == "--cold"};
+  if (args.size() > 2 || (args.size() == 2 && !cold)) {
+    fmt::print(stderr, "Usage: {} [--cold]\n", args[0]);
+    return -1;
+  }
+
+  try {
+    abcg::Application app(argc, argv);
+
+    auto const cacheDirectory{abcg::getUserCacheDirectory()};
+    if (cacheDirectory.empty()) {
+      throw abcg::RuntimeError("No user cache directory");
+    }
+    auto const cachePath{cacheDirectory / "pipelines" /
+                         "pipelinecachebench.bin"};
+    if (cold) {
+      std::filesystem::remove(cachePath);
+    }
+
+    Window window;
+    window.setWindowSettings(
+        {.width = 320, .height = 240, .title = "Pipeline Cache Benchmark"});
+    window.setVulkanSettings({.pipelineCachePath = cachePath.string()});
+
+    app.run(window);
+  } catch (std::exception const &exception) {
+    fmt::print(stderr, "{}\n", exception.what());
+    return -1;
+  }
+  return 0;
+}
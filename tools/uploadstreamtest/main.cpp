@@ -0,0 +1,136 @@
+#include <numeric>
+#include <span>
+
+#include <cppitertools/itertools.hpp>
+
+#include "abcgVulkan.hpp"
+
+// Streams new contents into a device-local buffer every frame through
+// abcg::VulkanBuffer::loadData, while the frames in flight still read the
+// previous contents. Each frame copies the buffer into its own region of a
+// host-visible buffer, which is checked once the window is destroyed. The
+// test fails if a frame reads data uploaded for another frame.
+class Window : public abcg::VulkanWindow {
+public:
+  [[nodiscard]] std::size_t getErrorCount() const noexcept {
+    return m_errorCount;
+  }
+
+protected:
+  void onCreate() override;
+  void onUpdate() override;
+  void onPaint(abcg::VulkanFrame const &frame) override;
+  void onDestroy() override;
+
+private:
+  static constexpr std::size_t m_frameCount{120};
+  static constexpr std::size_t m_valueCount{16384};
+  static constexpr vk::DeviceSize m_bufferSize{m_valueCount *
+                                               sizeof(uint32_t)};
+
+  abcg::VulkanBuffer m_streamBuffer;
+  abcg::VulkanBuffer m_readbackBuffer;
+  std::vector<uint32_t> m_values;
+  std::size_t m_frame{};
+  std::size_t m_errorCount{};
+};
+
+void Window::onCreate() {
+  m_values.resize(m_valueCount);
+  m_streamBuffer.create(getDevice(),
+                        {.size = m_bufferSize,
+                         .usage = vk::BufferUsageFlagBits::eTransferSrc |
+                                  vk::BufferUsageFlagBits::eTransferDst,
+                         .properties = vk::MemoryPropertyFlagBits::eDeviceLocal,
+                         .data = m_values.data()});
+  m_readbackBuffer.create(
+      getDevice(), {.size = m_bufferSize * m_frameCount,
+                    .usage = vk::BufferUsageFlagBits::eTransferDst,
+                    .properties = vk::MemoryPropertyFlagBits::eHostVisible |
+                                  vk::MemoryPropertyFlagBits::eHostCoherent});
+}
+
+void Window::onUpdate() {
+  if (m_frame >= m_frameCount) {
+    return;
+  }
+
+  // Overwrite the whole buffer with values that identify the frame
+  std::iota(m_values.begin(), m_values.end(),
+            gsl::narrow<uint32_t>(m_frame * m_valueCount));
+  m_streamBuffer.loadData(m_values.data(), m_bufferSize);
+}
+
+void Window::onPaint(abcg::VulkanFrame const &frame) {
+  frame.commandBuffer.begin(
+      {.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+
+  if (m_frame < m_frameCount) {
+    frame.commandBuffer.copyBuffer(
+        static_cast<vk::Buffer>(m_streamBuffer),
+        static_cast<vk::Buffer>(m_readbackBuffer),
+        {{.dstOffset = m_bufferSize * m_frame, .size = m_bufferSize}});
+
+    // Make the copy visible to the host once the device is idle
+    vk::MemoryBarrier const memoryBarrier{
+        .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+        .dstAccessMask = vk::AccessFlagBits::eHostRead};
+    frame.commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost,
+        vk::DependencyFlags{}, memoryBarrier, nullptr, nullptr);
+  }
+
+  std::array<vk::ClearValue, 2> clearValues{};
+  clearValues.at(1).setDepthStencil({1.0f, 0});
+  frame.commandBuffer.beginRenderPass(
+      {.renderPass = getSwapchain().getMainRenderPass(),
+       .framebuffer = frame.framebufferMain,
+       .renderArea = {.offset{}, .extent{getSwapchain().getExtent()}},
+       .clearValueCount = clearValues.size(),
+       .pClearValues = clearValues.data()},
+      vk::SubpassContents::eInline);
+  frame.commandBuffer.endRenderPass();
+
+  frame.commandBuffer.end();
+
+  if (++m_frame == m_frameCount) {
+    SDL_Event event{.type = SDL_QUIT};
+    SDL_PushEvent(&event);
+  }
+}
+
+void Window::onDestroy() {
+  // The device is idle at this point
+  std::span const readback{
+      static_cast<uint32_t const *>(m_readbackBuffer.getAllocation().mappedData),
+      m_valueCount * std::min(m_frame, m_frameCount)};
+  for (auto const &[index, value] : iter::enumerate(readback)) {
+    if (value != index) {
+      ++m_errorCount;
+    }
+  }
+
+  m_readbackBuffer.destroy();
+  m_streamBuffer.destroy();
+}
+
+int main(int argc, char **argv) {
+  try {
+    abcg::Application app(argc, argv);
+
+    Window window;
+    window.setWindowSettings(
+        {.width = 320, .height = 240, .title = "Upload Stream Test"});
+    app.run(window);
+
+    if (window.getErrorCount() > 0) {
+      fmt::print(stderr, "{} values were read from another frame\n",
+                 window.getErrorCount());
+      return -1;
+    }
+  } catch (std::exception const &exception) {
+    fmt::print(stderr, "{}\n", exception.what());
+    return -1;
+  }
+  return 0;
+}